@@ -7,85 +7,69 @@
 // Global Variables
 Preferences preferences;
 AsyncWebServer server(80);
-String currentSSID = "bardo";
-String currentWiFiPassword = "12345679";
-String currentAPSSID = "ESP32_001";
-String currentAPPassword = "men0lel1";
-String currentUsername = "admin";
-String currentPassword = "password";
-String wifiOptionsHTML = "";
 
-unsigned long lastScanTime = 0;                // Tracks the last scan time
-const unsigned long SCAN_INTERVAL_MS = 10000;  // Time between scans (10 seconds)
+unsigned long lastCleanupTime = 0;                // Tracks the last session cleanup
+const unsigned long CLEANUP_INTERVAL_MS = 10000;  // Time between cleanups (10 seconds)
 
+// Only what the AP and the first response need runs here. The sensors, the
+// log and the STA connection come up in their tasks, see tasks.h, and
+// boot_timing.h records how long each step took.
 void setup() {
+  markBootPhase(BOOT_SETUP);
   Serial.begin(115200);
 
   // Load preferences
-  preferences.begin("settings", true);
-  currentSSID = preferences.getString("ssid", "bardo");
-  currentWiFiPassword = preferences.getString("wifi_password", "12345679");
-  currentAPSSID = preferences.getString("apssid", "ESP32_001");
-  currentAPPassword = preferences.getString("ap_password", "men0lel1");
-  currentUsername = preferences.getString("username", "admin");
-  currentPassword = preferences.getString("password", "password");
-  preferences.end();
+  loadConfig();
+  loadWiFiCache();
+  setupOta();
+  markBootPhase(BOOT_CONFIG_LOADED);
 
   // Initialize hardware components
-  pinMode(LED1_PIN, OUTPUT);
-  pinMode(LED2_PIN, OUTPUT);
-  digitalWrite(LED1_PIN, LOW);
-  digitalWrite(LED2_PIN, LOW);
-  dht.begin();
+  setupLEDs();
+  setupLEDControl();
+  setupMqtt();
 
+  // The credentials live in the settings, the driver's own copy in NVS would
+  // only cost a flash write per connection attempt
+  WiFi.persistent(false);
   WiFi.mode(WIFI_AP_STA);
 
-  // Connect to Wi-Fi
-  WiFi.begin(currentSSID.c_str(), currentWiFiPassword.c_str());
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < WIFI_ATTEMPTS) {
-    delay(WIFI_DELAY_MS);
-    Serial.print(".");
-    attempts++;
-  }
-  if (WiFi.status() == WL_CONNECTED) {
-    Serial.println("\nConnected to WiFi");
-    Serial.print("IP Address: ");
-    Serial.println(WiFi.localIP());
-  } else {
-    Serial.println("\nFailed to connect to WiFi");
-  }
-
-  // Configure Access Point
-  WiFi.softAP(currentAPSSID.c_str(), currentAPPassword.c_str());
+  // Configure Access Point. AP and STA share the radio, so starting on the
+  // channel the STA network was last found on spares AP clients a channel
+  // switch when the STA link comes up.
+  WiFi.softAP(config.apSSID, config.apPassword, wifiCache.channel ? wifiCache.channel : 1);
+  markBootPhase(BOOT_AP_STARTED);
   Serial.print("AP IP Address: ");
   Serial.println(WiFi.softAPIP());
 
-  // Set up routes and start the server
+  // Set up routes and start the server, the AP is usable right away
   setupRoutes();
   server.begin();
+  markBootPhase(BOOT_SERVER_STARTED);
   Serial.println("HTTP server started");
 
-  // Login credentials
-  Serial.println();
+  // Passwords are never printed, the serial log may end up anywhere
   Serial.print("Username: ");
-  Serial.println(currentUsername);
-  Serial.print("Password: ");
-  Serial.println(currentPassword);
-
-  // Access point credentials
-  Serial.println();
+  Serial.println(config.username);
   Serial.print("Access point: ");
-  Serial.println(currentAPSSID);
-  Serial.print("AP Password: ");
-  Serial.println(currentAPPassword);
+  Serial.println(config.apSSID);
+
+  // From here on config belongs to the persistence task, see tasks.h
+  startTasks();
+  markBootPhase(BOOT_TASKS_STARTED);
+  Serial.printf("Setup done %lu ms after start\n", (unsigned long)(bootPhaseUs[BOOT_TASKS_STARTED] / 1000));
 }
 
+// LEDs, sensors, Wi-Fi and settings run in their own tasks, loop() only
+// pushes their snapshots to the connected clients and looks after updates
 void loop() {
+  updateEvents();
+  updateWebSocket();
+  updateOta();
+
   unsigned long currentTime = millis();
-  if (currentTime - lastScanTime >= SCAN_INTERVAL_MS) {
-    lastScanTime = currentTime;
-    scanForWiFiNetworks();
+  if (currentTime - lastCleanupTime >= CLEANUP_INTERVAL_MS) {
+    lastCleanupTime = currentTime;
     cleanupExpiredSessions();
   }
   delay(10);
@@ -3,159 +3,84 @@
 
 #include <ESPAsyncWebServer.h>
 #include <IPAddress.h>
-#include <ctime>
-#include <map>
-#include <Preferences.h>
-#include "html_pages.h"
-
-std::map<IPAddress, String> userRoles;
-std::map<IPAddress, bool> loggedInUsers;
-std::map<IPAddress, time_t> loginTimestamps;
-
-extern String currentUsername;
-extern String currentPassword;
-extern AsyncWebServer server;
-
-
-bool isSessionValid(IPAddress clientIP) {
-  if (loginTimestamps.find(clientIP) != loginTimestamps.end()) {
-    time_t currentTime = time(nullptr);
-    time_t loginTime = loginTimestamps[clientIP];
-
-    if (difftime(currentTime, loginTime) > 300) {  // Session expired
-      loginTimestamps.erase(clientIP);
-      userRoles.erase(clientIP);
-      return false;
-    }
-    return true;
-  }
-  return false;  // No session found
-}
-
-bool ensureLoggedIn(AsyncWebServerRequest *request) {
-  // Get the client's IP address
-  IPAddress clientIP = request->client()->remoteIP();
-
-  if (!loggedInUsers[clientIP]) {
-    request->redirect("/login");
-    return false;
-  }
-
-  // Validate the session
-  if (!isSessionValid(clientIP)) {
-    loggedInUsers[clientIP] = false;
-    request->redirect("/login");
-    return false;
-  }
-
-  // Restrict access to settings for non-admin users
-  if (userRoles[clientIP] != "admin" && request->url().startsWith("/settings")) {
-    request->redirect("/");  // Redirect non-admin users to the dashboard
-    Serial.println("Redirected, not logged in!!");
-    return false;
-  }
-
-  return true;
+#include "config.h"
+#include "metrics.h"
+#include "route_table.h"
+#include "sessions.h"
+#include "static_pages.h"
+
+bool isSessionValid(AsyncWebServerRequest *request) {
+  return findSession(request) != nullptr;
 }
 
-bool ensureLoggedInAndAuthorized(AsyncWebServerRequest *request, String requiredRole) {
-  IPAddress clientIP = request->client()->remoteIP();
-  if (!isSessionValid(clientIP)) {
-    request->redirect("/login");
-    return false;
-  }
-
-  if (userRoles[clientIP] != requiredRole && !requiredRole.isEmpty()) {
-    request->redirect("/");
-    return false;
+// Redirect that also sets or clears the session cookie
+void redirectWithSession(AsyncWebServerRequest *request, const char *url, const char *token) {
+  noteResponseStatus(302);
+  AsyncWebServerResponse *response = request->beginResponse(302);
+  response->addHeader("Location", url);
+  if (token) {
+    char cookie[SESSION_TOKEN_LENGTH + 64];
+    snprintf(cookie, sizeof(cookie), SESSION_COOKIE "=%s; Path=/; HttpOnly; SameSite=Strict", token);
+    response->addHeader("Set-Cookie", cookie);
+  } else {
+    response->addHeader("Set-Cookie", SESSION_COOKIE "=; Path=/; Max-Age=0");
   }
-
-  return true;
+  request->send(response);
 }
 
 // Login Page Handler
-void sendLoginHtml(AsyncWebServerRequest *request, const char *message = nullptr) {
-  String html = FPSTR(LOGIN_HTML);
-  html.replace("%MESSAGE%", message ? message : "");
-  request->send(200, "text/html", html);
+void handleLoginPage(const RequestContext &context) {
+  sendPage(context.request, LOGIN_PAGE);
 }
 
 // Login Handler
-void handleLogin(AsyncWebServerRequest *request) {
-  IPAddress clientIP = request->client()->remoteIP();
-  if (isSessionValid(clientIP)) {
-    request->redirect(userRoles[clientIP] == "admin" ? "/settings" : "/");
+void handleLogin(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+  Session *session = context.session;
+  if (session) {
+    noteResponseStatus(302);
+    request->redirect(session->role == ROLE_ADMIN ? "/settings" : "/");
     return;
   }
 
   if (request->method() == HTTP_POST) {
-    String username = request->getParam("username", true)->value();
-    String password = request->getParam("password", true)->value();
-
-    if (username == currentUsername && password == currentPassword) {
-      loggedInUsers[clientIP] = true;
-
-      // Get the client's IP address
-      IPAddress clientIP = request->client()->remoteIP();
-
-      // Store the login timestamp
-      loginTimestamps[clientIP] = time(nullptr);
+    // A form without both fields is a failed login, not a crash
+    const AsyncWebParameter *username = request->hasParam("username", true) ? request->getParam("username", true) : nullptr;
+    const AsyncWebParameter *password = request->hasParam("password", true) ? request->getParam("password", true) : nullptr;
 
+    Config saved = readConfig();
+    if (username && password && username->value() == saved.username && password->value() == saved.password) {
       // Determine role based on client IP
-      String role;
-      if (clientIP[0] == 192 && clientIP[1] == 168 && clientIP[2] == 4) {
-        role = "admin";  // AP user
-        request->redirect("/settings");
-      } else {
-        role = "viewer";  // STA user
-        request->redirect("/");
-      }
-
-      // Store the user's role in the map
-      userRoles[clientIP] = role;
+      IPAddress clientIP = request->client()->remoteIP();
+      bool isAPClient = clientIP[0] == 192 && clientIP[1] == 168 && clientIP[2] == 4;
+      Role role = isAPClient ? ROLE_ADMIN : ROLE_VIEWER;
 
+      char token[SESSION_TOKEN_LENGTH + 1];
+      createSession(role, token);
+      redirectWithSession(request, role == ROLE_ADMIN ? "/settings" : "/", token);
       return;
     }
 
-    sendLoginHtml(request, "Invalid credentials. Please try again.");
+    noteResponseStatus(302);
+    request->redirect("/login?error");  // The page shows the message
   } else {
-    sendLoginHtml(request);
+    handleLoginPage(context);
   }
 }
 
 // Logout Handler
-void handleLogout(AsyncWebServerRequest *request) {
-  IPAddress clientIP = request->client()->remoteIP();
-
-  // Remove the user's login state and role
-  loggedInUsers.erase(clientIP);
-  userRoles.erase(clientIP);
-
-  request->redirect("/login");
+void handleLogout(const RequestContext &context) {
+  removeSession(context.session);
+  redirectWithSession(context.request, "/login", nullptr);
 }
 
 void cleanupExpiredSessions() {
-  time_t currentTime = time(nullptr);
-  for (auto it = loginTimestamps.begin(); it != loginTimestamps.end();) {
-    if (difftime(currentTime, it->second) > 300) {
-      userRoles.erase(it->first);
-      it = loginTimestamps.erase(it);
-    } else {
-      ++it;
+  unsigned long now = millis();
+  for (uint16_t i = 0; i < SESSION_CAPACITY; i++) {
+    if (sessions[i].secret != 0 && sessionExpired(sessions[i], now)) {
+      sessions[i].secret = 0;
     }
   }
 }
 
-// Route Setup
-void setupAuthRoutes() {
-  server.on("/login", HTTP_GET, [](AsyncWebServerRequest *request) {
-    sendLoginHtml(request);
-  });
-  server.on("/login", HTTP_POST, [](AsyncWebServerRequest *request) {
-    handleLogin(request);
-  });
-  server.on("/logout", HTTP_GET, handleLogout);
-}
-
-
 #endif
\ No newline at end of file
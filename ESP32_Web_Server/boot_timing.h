@@ -0,0 +1,54 @@
+#ifndef BOOT_TIMING_H
+#define BOOT_TIMING_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "metrics.h"
+
+// Boot timeline
+//
+// Each phase keeps the time it was first reached, in microseconds since the
+// app started, and /metrics shows them as boot_phase_seconds. The one to
+// watch is first_response: the AP and the server come up before anything
+// slow, so a client should get its first page well under a second after
+// power on. The phases after it run in the background tasks.
+
+enum BootPhase : uint8_t {
+  BOOT_SETUP,            // setup() entered, after the bootloader and static init
+  BOOT_CONFIG_LOADED,
+  BOOT_AP_STARTED,
+  BOOT_SERVER_STARTED,
+  BOOT_TASKS_STARTED,    // End of setup()
+  BOOT_FIRST_RESPONSE,   // First request answered
+  BOOT_SENSORS_READY,    // Sensor drivers probed, in the io task
+  BOOT_LOG_MOUNTED,      // LittleFS mounted and the log index read
+  BOOT_STA_CONNECTED,    // First station link
+  BOOT_PHASE_COUNT,
+};
+
+const char *const BOOT_PHASE_NAMES[BOOT_PHASE_COUNT] = {
+  "setup", "config_loaded", "ap_started", "server_started", "tasks_started",
+  "first_response", "sensors_ready", "log_mounted", "sta_connected",
+};
+
+// Marked from setup(), the tasks and the AsyncTCP task, 0 until reached
+std::atomic<uint32_t> bootPhaseUs[BOOT_PHASE_COUNT];
+
+// Record a phase the first time it is reached, later calls are ignored
+void markBootPhase(BootPhase phase) {
+  if (bootPhaseUs[phase].load(std::memory_order_relaxed)) return;
+  uint32_t now = esp_timer_get_time();
+  uint32_t unset = 0;
+  bootPhaseUs[phase].compare_exchange_strong(unset, now ? now : 1);
+}
+
+void writeBootMetrics(Print &out) {
+  out.print("# HELP boot_phase_seconds Time from start until each boot phase was reached.\n"
+            "# TYPE boot_phase_seconds gauge\n");
+  for (uint8_t i = 0; i < BOOT_PHASE_COUNT; i++) {
+    uint32_t us = bootPhaseUs[i].load();
+    if (us) printTo(out, "boot_phase_seconds{phase=\"%s\"} %.6f\n", BOOT_PHASE_NAMES[i], us / 1e6);
+  }
+}
+
+#endif  // BOOT_TIMING_H
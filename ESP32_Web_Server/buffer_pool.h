@@ -0,0 +1,196 @@
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdarg.h>
+
+// Response bodies are built in fixed-size blocks reserved at boot instead
+// of heap buffers that grow while the body is written. Every response
+// takes and returns the same blocks, so serving requests never fragments
+// the heap, and the pool's statistics show how close it runs to empty.
+
+#define POOL_BLOCK_SIZE 1024
+#define POOL_BLOCK_COUNT 12      // 12 KB, a few in-flight responses of a few blocks each
+#define RESPONSE_MAX_BLOCKS 4    // Largest pooled response body, 4 KB
+
+static_assert(POOL_BLOCK_COUNT <= 32, "The free map is one 32-bit word");
+
+struct PoolBlock {
+  PoolBlock *next;  // Next block of the same body
+  size_t length;    // Bytes used in data
+  uint8_t data[POOL_BLOCK_SIZE];
+};
+
+struct PoolStats {
+  std::atomic<uint32_t> inUse{ 0 };
+  std::atomic<uint32_t> peak{ 0 };
+  std::atomic<uint32_t> exhausted{ 0 };  // Blocks asked for while none were free
+};
+
+PoolBlock poolBlocks[POOL_BLOCK_COUNT];
+std::atomic<uint32_t> poolFreeMap{ (uint32_t)((1ULL << POOL_BLOCK_COUNT) - 1) };  // Bit set while a block is free
+PoolStats poolStats;
+
+// Take a free block, nullptr if the pool is empty
+PoolBlock *acquireBlock() {
+  uint32_t free = poolFreeMap.load(std::memory_order_relaxed);
+  for (;;) {
+    if (free == 0) {
+      poolStats.exhausted.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    uint32_t bit = free & -free;  // Lowest free block
+    if (poolFreeMap.compare_exchange_weak(free, free & ~bit, std::memory_order_acquire, std::memory_order_relaxed)) {
+      PoolBlock *block = &poolBlocks[__builtin_ctz(bit)];
+      block->next = nullptr;
+      block->length = 0;
+
+      uint32_t inUse = poolStats.inUse.fetch_add(1, std::memory_order_relaxed) + 1;
+      uint32_t peak = poolStats.peak.load(std::memory_order_relaxed);
+      while (inUse > peak && !poolStats.peak.compare_exchange_weak(peak, inUse, std::memory_order_relaxed)) {}
+      return block;
+    }
+  }
+}
+
+void releaseBlock(PoolBlock *block) {
+  poolStats.inUse.fetch_sub(1, std::memory_order_relaxed);
+  poolFreeMap.fetch_or(1u << (block - poolBlocks), std::memory_order_release);
+}
+
+// Release a block and every block chained after it
+void releaseChain(PoolBlock *block) {
+  while (block) {
+    PoolBlock *next = block->next;
+    releaseBlock(block);
+    block = next;
+  }
+}
+
+// A request-scoped body: written like any Print, stored in a chain of pool
+// blocks, then read back out by the response and released block by block
+// as it is sent. Writes past maxBlocks or into an empty pool are dropped
+// and flagged, the handler then answers 503 instead.
+class PoolWriter : public Print {
+public:
+  explicit PoolWriter(uint8_t maxBlocks = RESPONSE_MAX_BLOCKS) : _maxBlocks(maxBlocks) {}
+  ~PoolWriter() { releaseChain(_first); }
+
+  PoolWriter(const PoolWriter &) = delete;
+  PoolWriter &operator=(const PoolWriter &) = delete;
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+
+  size_t write(const uint8_t *data, size_t length) override {
+    size_t written = 0;
+    while (written < length) {
+      if (!_last || _last->length == POOL_BLOCK_SIZE) {
+        if (!grow()) break;
+      }
+      size_t chunk = POOL_BLOCK_SIZE - _last->length;
+      if (chunk > length - written) chunk = length - written;
+      memcpy(_last->data + _last->length, data + written, chunk);
+      _last->length += chunk;
+      written += chunk;
+    }
+    _length += written;
+    return written;
+  }
+
+  size_t length() const { return _length; }
+  bool overflowed() const { return _overflowed; }
+
+  // Copy the next part of the body out, returns 0 at the end
+  size_t read(uint8_t *buffer, size_t maxLen) {
+    size_t copied = 0;
+    while (_first && copied < maxLen) {
+      size_t chunk = _first->length - _readPos;
+      if (chunk > maxLen - copied) chunk = maxLen - copied;
+      memcpy(buffer + copied, _first->data + _readPos, chunk);
+      _readPos += chunk;
+      copied += chunk;
+
+      if (_readPos == _first->length) {
+        // Sent, hand the block back before the rest of the body is
+        PoolBlock *next = _first->next;
+        releaseBlock(_first);
+        _first = next;
+        if (!_first) _last = nullptr;
+        _readPos = 0;
+      }
+    }
+    return copied;
+  }
+
+private:
+  bool grow() {
+    if (_overflowed) return false;
+    PoolBlock *block = _blocks < _maxBlocks ? acquireBlock() : nullptr;
+    if (!block) {
+      _overflowed = true;
+      return false;
+    }
+    if (_last) {
+      _last->next = block;
+    } else {
+      _first = block;
+    }
+    _last = block;
+    _blocks++;
+    return true;
+  }
+
+  PoolBlock *_first = nullptr;
+  PoolBlock *_last = nullptr;
+  size_t _readPos = 0;
+  size_t _length = 0;
+  uint8_t _blocks = 0;
+  uint8_t _maxBlocks;
+  bool _overflowed = false;
+};
+
+// Text produced a line at a time into a small buffer, for bodies too long
+// to hold. nextLine() fills line and lineLen, and returns false at the end.
+struct LineSource {
+  char line[192];
+  size_t lineLen = 0;
+  size_t linePos = 0;
+
+  virtual ~LineSource() {}
+  virtual bool nextLine() = 0;
+
+  size_t read(uint8_t *buffer, size_t maxLen) {
+    size_t written = 0;
+    while (written < maxLen) {
+      if (linePos == lineLen) {
+        linePos = 0;
+        lineLen = 0;
+        if (!nextLine()) break;
+      }
+      size_t chunk = lineLen - linePos;
+      if (chunk > maxLen - written) chunk = maxLen - written;
+      memcpy(buffer + written, line + linePos, chunk);
+      linePos += chunk;
+      written += chunk;
+    }
+    return written;
+  }
+};
+
+// printf() into any Print through a stack buffer. Print::printf() falls
+// back to malloc() for anything over 64 bytes, which most metric lines are.
+size_t printTo(Print &out, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+size_t printTo(Print &out, const char *format, ...) {
+  char buffer[192];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (length < 0) return 0;
+  if ((size_t)length >= sizeof(buffer)) length = sizeof(buffer) - 1;  // Cut off, no line is this long
+  return out.write((const uint8_t *)buffer, length);
+}
+
+#endif  // BUFFER_POOL_H
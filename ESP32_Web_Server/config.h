@@ -0,0 +1,305 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <Preferences.h>
+#include "snapshot.h"
+#include "spsc_queue.h"
+
+// Persistent settings
+//
+// The settings live in RAM in one Config struct, loaded once at boot and
+// then owned by the persistence task. Other tasks queue changes with
+// setConfig() or queueConfig() and read the settings through
+// configSnapshot. updateConfig() applies the changes and writes the whole
+// struct as a single NVS blob once they have settled, unless every field
+// marked in configDirty is back to its saved value. Two slots are used
+// alternately, each with a sequence number and checksum, so a write cut short
+// by a reset leaves the previous slot intact.
+
+extern Preferences preferences;
+
+#define CONFIG_NAMESPACE "settings"
+#define CONFIG_VERSION 2  // 2: MQTT settings
+#define CONFIG_COMMIT_DELAY_MS 1000  // Batch changes made within this window
+
+struct Config {
+  char ssid[33];
+  char wifiPassword[65];
+  char apSSID[33];
+  char apPassword[65];
+  char username[33];
+  char password[65];
+  char mqttHost[65];  // Empty while MQTT is off
+  char mqttPort[6];
+  char mqttTopic[65];
+};
+
+enum ConfigField : uint16_t {
+  CONFIG_SSID = 1 << 0,
+  CONFIG_WIFI_PASSWORD = 1 << 1,
+  CONFIG_AP_SSID = 1 << 2,
+  CONFIG_AP_PASSWORD = 1 << 3,
+  CONFIG_USERNAME = 1 << 4,
+  CONFIG_PASSWORD = 1 << 5,
+  CONFIG_MQTT_HOST = 1 << 6,
+  CONFIG_MQTT_PORT = 1 << 7,
+  CONFIG_MQTT_TOPIC = 1 << 8,
+  CONFIG_ALL = 0x1FF,
+};
+
+// Layout of a slot in NVS
+struct StoredConfig {
+  uint16_t version;
+  uint16_t size;
+  uint32_t sequence;
+  Config values;
+  uint32_t checksum;  // CRC-32 of everything above
+};
+
+// Version 1 slots, from before the MQTT settings
+struct ConfigV1 {
+  char ssid[33];
+  char wifiPassword[65];
+  char apSSID[33];
+  char apPassword[65];
+  char username[33];
+  char password[65];
+};
+
+struct StoredConfigV1 {
+  uint16_t version;
+  uint16_t size;
+  uint32_t sequence;
+  ConfigV1 values;
+  uint32_t checksum;
+};
+
+const char *CONFIG_SLOTS[2] = { "config_a", "config_b" };
+
+// A queued change, one queue per producing task
+struct ConfigUpdate {
+  ConfigField field;
+  char value[65];
+};
+
+// Room for two full settings updates before the persistence task drains it
+#define CONFIG_QUEUE_SIZE 16
+#define CONFIG_FIELDS_PER_UPDATE 7  // Fields one settings POST may queue: AP x2, login x2, MQTT x3
+
+typedef SpscQueue<ConfigUpdate, CONFIG_QUEUE_SIZE> ConfigQueue;
+
+Config config = { "bardo", "12345679", "ESP32_001", "men0lel1", "admin", "password", "", "1883", "esp32" };
+Snapshot<Config> configSnapshot;
+ConfigQueue webConfigUpdates;   // From the web handlers
+ConfigQueue wifiConfigUpdates;  // From the Wi-Fi task
+uint16_t configDirty = 0;  // ConfigField bits changed since the last commit
+unsigned long configDirtyTime = 0;
+Config configSaved;               // The values in the newest slot
+bool configSavedCurrent = false;  // configSaved is stored in the current layout
+uint32_t configSequence = 0;
+bool configLegacyKeys = false;  // Pre-blob string keys still to be removed
+unsigned long configCommits = 0;
+
+// CRC-32 of a slot up to its checksum field
+uint32_t configChecksum(const void *stored, size_t length) {
+  const uint8_t *data = (const uint8_t *)stored;
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+  }
+  return ~crc;
+}
+
+// Buffer backing a field, nullptr for an unknown field
+char *configFieldBuffer(ConfigField field, size_t &size) {
+  switch (field) {
+    case CONFIG_SSID: size = sizeof(config.ssid); return config.ssid;
+    case CONFIG_WIFI_PASSWORD: size = sizeof(config.wifiPassword); return config.wifiPassword;
+    case CONFIG_AP_SSID: size = sizeof(config.apSSID); return config.apSSID;
+    case CONFIG_AP_PASSWORD: size = sizeof(config.apPassword); return config.apPassword;
+    case CONFIG_USERNAME: size = sizeof(config.username); return config.username;
+    case CONFIG_PASSWORD: size = sizeof(config.password); return config.password;
+    case CONFIG_MQTT_HOST: size = sizeof(config.mqttHost); return config.mqttHost;
+    case CONFIG_MQTT_PORT: size = sizeof(config.mqttPort); return config.mqttPort;
+    case CONFIG_MQTT_TOPIC: size = sizeof(config.mqttTopic); return config.mqttTopic;
+    default: size = 0; return nullptr;
+  }
+}
+
+// The dirty fields whose value differs from the saved one. All of them
+// while the slot is from older firmware, which must be rewritten anyway.
+uint16_t changedConfigFields(uint16_t dirty) {
+  if (!configSavedCurrent) return dirty;
+  uint16_t changed = 0;
+  for (uint16_t field = 1; field & CONFIG_ALL; field <<= 1) {
+    size_t size;
+    char *buffer = configFieldBuffer((ConfigField)field, size);
+    if (!(dirty & field) || !buffer) continue;
+    const char *saved = (const char *)&configSaved + (buffer - (char *)&config);
+    if (strcmp(buffer, saved) != 0) changed |= field;
+  }
+  return changed;
+}
+
+// Change a field in RAM and schedule the commit, persistence task only
+bool applyConfig(ConfigField field, const char *value) {
+  size_t size;
+  char *buffer = configFieldBuffer(field, size);
+  if (!buffer || strlen(value) >= size) return false;
+  if (strcmp(buffer, value) == 0) return true;
+
+  strcpy(buffer, value);
+  configDirty |= field;
+  configDirtyTime = millis();
+  return true;
+}
+
+// Queue a change for the persistence task, returns false if it doesn't fit
+bool queueConfig(ConfigQueue &queue, ConfigField field, const char *value) {
+  size_t size;
+  if (!configFieldBuffer(field, size) || strlen(value) >= size) return false;
+
+  ConfigUpdate update;
+  update.field = field;
+  strcpy(update.value, value);
+  return queue.push(update);
+}
+
+// Queue a change from a web handler
+bool setConfig(ConfigField field, const String &value) {
+  return queueConfig(webConfigUpdates, field, value.c_str());
+}
+
+// Copy of the current settings, from any task
+Config readConfig() {
+  Config copy;
+  configSnapshot.read(copy);
+  return copy;
+}
+
+// Read a version 1 slot into the current layout, the new fields keep their defaults
+bool readConfigSlotV1(const char *key, StoredConfig &stored) {
+  StoredConfigV1 old;
+  if (preferences.getBytes(key, &old, sizeof(old)) != sizeof(old)) return false;
+  if (old.size != sizeof(old) || old.version != 1) return false;
+  if (old.checksum != configChecksum(&old, offsetof(StoredConfigV1, checksum))) return false;
+
+  stored.version = old.version;
+  stored.size = sizeof(StoredConfig);
+  stored.sequence = old.sequence;
+  stored.values = config;
+  memcpy(stored.values.ssid, old.values.ssid, sizeof(old.values.ssid));
+  memcpy(stored.values.wifiPassword, old.values.wifiPassword, sizeof(old.values.wifiPassword));
+  memcpy(stored.values.apSSID, old.values.apSSID, sizeof(old.values.apSSID));
+  memcpy(stored.values.apPassword, old.values.apPassword, sizeof(old.values.apPassword));
+  memcpy(stored.values.username, old.values.username, sizeof(old.values.username));
+  memcpy(stored.values.password, old.values.password, sizeof(old.values.password));
+  return true;
+}
+
+// Read a slot, returns false if it is missing, torn or from an unknown version
+bool readConfigSlot(const char *key, StoredConfig &stored) {
+  size_t length = preferences.getBytesLength(key);
+  if (length == sizeof(StoredConfigV1)) return readConfigSlotV1(key, stored);
+  if (length != sizeof(StoredConfig)) return false;
+  if (preferences.getBytes(key, &stored, sizeof(StoredConfig)) != sizeof(StoredConfig)) return false;
+  if (stored.size != sizeof(StoredConfig) || stored.checksum != configChecksum(&stored, offsetof(StoredConfig, checksum))) return false;
+  return stored.version >= 2 && stored.version <= CONFIG_VERSION;
+}
+
+// Version 0: one string key per field, as written by older firmware
+void migrateLegacyConfig() {
+  String values[6] = {
+    preferences.getString("ssid", config.ssid),
+    preferences.getString("wifi_password", config.wifiPassword),
+    preferences.getString("apssid", config.apSSID),
+    preferences.getString("ap_password", config.apPassword),
+    preferences.getString("username", config.username),
+    preferences.getString("password", config.password),
+  };
+  for (int i = 0; i < 6; i++) applyConfig((ConfigField)(1 << i), values[i].c_str());
+
+  configDirty = CONFIG_ALL;  // Write the blob even if everything was default
+  configLegacyKeys = preferences.isKey("ssid");
+}
+
+// Load the newest valid slot, called once from setup()
+void loadConfig() {
+  preferences.begin(CONFIG_NAMESPACE, true);
+
+  StoredConfig slots[2];
+  bool valid[2];
+  for (int i = 0; i < 2; i++) valid[i] = readConfigSlot(CONFIG_SLOTS[i], slots[i]);
+
+  int newest = -1;
+  if (valid[0] && valid[1]) newest = (int32_t)(slots[1].sequence - slots[0].sequence) > 0 ? 1 : 0;
+  else if (valid[0]) newest = 0;
+  else if (valid[1]) newest = 1;
+
+  if (newest >= 0) {
+    config = slots[newest].values;
+    configSaved = config;
+    configSequence = slots[newest].sequence;
+    // Older slots were converted by readConfigSlot(), write the current layout
+    configSavedCurrent = slots[newest].version == CONFIG_VERSION;
+    if (!configSavedCurrent) configDirty = CONFIG_ALL;
+  } else {
+    configSavedCurrent = false;
+    migrateLegacyConfig();
+  }
+
+  preferences.end();
+  configSnapshot.publish(config);
+}
+
+// Write all fields as one blob into the older slot
+bool commitConfig() {
+  StoredConfig stored;
+  memset(&stored, 0, sizeof(stored));
+  stored.version = CONFIG_VERSION;
+  stored.size = sizeof(StoredConfig);
+  stored.sequence = configSequence + 1;
+  stored.values = config;
+  stored.checksum = configChecksum(&stored, offsetof(StoredConfig, checksum));
+
+  preferences.begin(CONFIG_NAMESPACE, false);
+  bool written = preferences.putBytes(CONFIG_SLOTS[stored.sequence % 2], &stored, sizeof(stored)) == sizeof(stored);
+  if (written && configLegacyKeys) {
+    const char *legacyKeys[] = { "ssid", "wifi_password", "apssid", "ap_password", "username", "password" };
+    for (const char *key : legacyKeys) preferences.remove(key);
+    configLegacyKeys = false;
+  }
+  preferences.end();
+
+  if (!written) return false;
+  configSaved = config;
+  configSavedCurrent = true;
+  configSequence = stored.sequence;
+  configCommits++;
+  return true;
+}
+
+// Called from the persistence task: applies queued changes, then commits
+// them once they have settled
+void updateConfig() {
+  ConfigUpdate update;
+  bool changed = false;
+  while (webConfigUpdates.pop(update)) changed |= applyConfig(update.field, update.value);
+  while (wifiConfigUpdates.pop(update)) changed |= applyConfig(update.field, update.value);
+  if (changed) configSnapshot.publish(config);
+
+  if (configDirty == 0 || millis() - configDirtyTime < CONFIG_COMMIT_DELAY_MS) return;
+  // A field set back to its saved value, by a second POST say, needs no write
+  configDirty = changedConfigFields(configDirty);
+  if (configDirty == 0) return;
+
+  uint16_t dirty = configDirty;
+  configDirty = 0;
+  if (!commitConfig()) {
+    configDirty |= dirty;  // Try again after the next delay
+    configDirtyTime = millis();
+  }
+}
+
+#endif  // CONFIG_H
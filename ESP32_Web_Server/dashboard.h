@@ -2,145 +2,287 @@
 #define DASHBOARD_H
 
 #include <ESPAsyncWebServer.h>
-#include <DHT.h>
+#include "auth.h"
+#include "json_writer.h"
+#include "led_control.h"
+#include "pooled_response.h"
+#include "sensors.h"
 
-// Pin definitions
-#define LED1_PIN 26
-#define LED2_PIN 27
-#define DHT_PIN 4
-#define DHT_TYPE DHT22
+//////////////////////// LED command core (HTTP routes and WebSocket) ////////////////////////
+// Commands go to the I/O task through led_control.h, which drives the
+// outputs. A manual command stops the playing scene.
 
-// State variables
-bool led1State = false;
-bool led2State = false;
-extern AsyncWebServer server;
-
-const char *ledOffSVG = "<svg class=\"svg-icon\" style=\"width: 50px; height: 50px; vertical-align: middle; fill: currentColor; overflow: hidden;\" viewBox=\"0 0 1024 1024\" version=\"1.1\" xmlns=\"http://www.w3.org/2000/svg\">"
-                        "<path d=\"M512 256a170.666667 170.666667 0 0 0-170.666667 170.666667v256H256v85.333333h128v213.333333h85.333333v-213.333333h85.333334v213.333333h85.333333v-213.333333h128v-85.333333h-85.333333v-256a170.666667 170.666667 0 0 0-170.666667-170.666667z\" fill=\"\" />"
-                        "</svg>";
-const String ledOnSVG_Part1 = "<svg class=\"svg-icon\" style=\"width: 50px; height: 50px; vertical-align: middle; fill: currentColor; overflow: hidden;\" viewBox=\"0 0 1024 1024\" version=\"1.1\" xmlns=\"http://www.w3.org/2000/svg\">";
-const String ledOnSVG_Part2 = "<path d=\"M469.333333 0v170.666667h85.333334V0h-85.333334m311.466667 97.706667l-130.56 128 59.733333 60.586666 130.56-128-59.733333-60.586666";
-const String ledOnSVG_Part3 = "m-537.173333 0L183.04 158.293333l128 128 60.586667-60.586666-128-128M512 256a170.666667 170.666667 0 0 0-170.666667 170.666667v256H256v85.333333h128v213.333333h85.333333v-213.333333h85.333334v213.333333";
-const String ledOnSVG_Part4 = "h85.333333v-213.333333h128v-85.333333h-85.333333v-256a170.666667 170.666667 0 0 0-170.666667-170.666667M85.333333 384v85.333333h170.666667V384H85.333333m682.666667 0v85.333333h170.666667V384h-170.666667z\" fill=\"\" />";
-const String ledOnSVG_Part5 = "</svg>";
-String ledOnSVG = ledOnSVG_Part1 + ledOnSVG_Part2 + ledOnSVG_Part3 + ledOnSVG_Part4 + ledOnSVG_Part5;
+bool isValidLED(int led) {
+  return ledChannel(led) != nullptr;
+}
 
-DHT dht(DHT_PIN, DHT_TYPE);
+// Toggle an LED by number, returns false if there is no such LED or the
+// I/O task is behind on commands
+bool toggleLEDCommand(int led) {
+  return isValidLED(led) && queueLEDToggle(led);
+}
 
+// Set an LED's intensity, switching it on or (at 0) off, over fadeMs
+bool fadeLEDCommand(int led, int intensity, uint32_t fadeMs) {
+  if (!isValidLED(led) || intensity < 0 || intensity > 255) return false;
+  return queueLEDFade(led, intensity, fadeMs);
+}
 
-void toggleLED(int pin, bool &state) {
-  state = !state;
-  digitalWrite(pin, state ? HIGH : LOW);
+// Slider changes are immediate; bursts coalesce in the LED's mailbox, only
+// the latest value reaches the hardware on each I/O task tick
+bool setLEDIntensityCommand(int led, int intensity) {
+  if (!isValidLED(led) || intensity < 0 || intensity > 255) return false;
+  postLEDIntensity(led, intensity);
+  return true;
 }
 
-void handleLED(AsyncWebServerRequest *request) {
-  request->send_P(200, "text/html", INDEX_HTML);
+// Answer for a command the I/O task could not take
+void sendLEDBusy(AsyncWebServerRequest *request) {
+  noteResponseStatus(503);
+  request->send(503, "text/plain", "LED commands busy");
 }
 
-// Helper function to escape double quotes inside SVG
-String escapeSVG(String svg) {
-  svg.replace("\"", "\\\"");  // Escape double quotes
-  svg.replace("\n", "\\n");   // Escape new lines
-  svg.replace("\r", "\\r");   // Escape carriage return
-  return svg;
+void handleLED(const RequestContext &context) {
+  sendPage(context.request, INDEX_PAGE);
 }
 
-void handleLEDState(AsyncWebServerRequest *request) {
-  String json = "{";
-  json += "\"led1State\":";
-  json += led1State ? "\"" + escapeSVG(ledOnSVG) + "\"" : "\"" + escapeSVG(String(ledOffSVG)) + "\"";
-  json += ",";
-  json += "\"led2State\":";
-  json += led2State ? "\"" + escapeSVG(ledOnSVG) + "\"" : "\"" + escapeSVG(String(ledOffSVG)) + "\"";
-  json += "}";
+// Compact LED state, the page picks the matching icon itself
+void writeLEDState(JsonWriter &json, const LedSnapshot &snapshot) {
+  char name[20];
+  json.beginObject();
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    snprintf(name, sizeof(name), "led%uState", i + 1);
+    json.field(name, snapshot.on[i]);
+  }
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    snprintf(name, sizeof(name), "led%uIntensity", i + 1);
+    json.field(name, (int)snapshot.level[i]);
+  }
+  json.endObject();
+}
 
-  request->send(200, "application/json", json);
+void handleLEDState(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+  PooledResponse *response = beginPooledResponse(request, "application/json");
+  JsonWriter json(response->source);
+  writeLEDState(json, readLEDSnapshot());
+  sendPooledResponse(request, response);
 }
 
 
 // LED Toggle Handler
-void handleToggleLED(AsyncWebServerRequest *request) {
-  if (request->hasParam("led")) {
-    String led = request->getParam("led")->value();
-    if (led == "1") {
-      toggleLED(LED1_PIN, led1State);
-      request->send(200, "text/plain", led1State ? "true" : "false");
-    } else if (led == "2") {
-      toggleLED(LED2_PIN, led2State);
-      request->send(200, "text/plain", led2State ? "true" : "false");
-    }
-  } else {
+void handleToggleLED(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+  if (!request->hasParam("led")) {
+    noteResponseStatus(400);
     request->send(400, "text/plain", "LED parameter missing");
+    return;
+  }
+
+  int led = request->getParam("led")->value().toInt();
+  if (!isValidLED(led)) {
+    noteResponseStatus(400);
+    request->send(400, "text/plain", "Invalid LED");
+    return;
   }
+
+  // The toggle runs on the I/O task, answer with the state it will produce
+  bool wasOn = readLEDSnapshot().on[led - 1];
+  if (!toggleLEDCommand(led)) {
+    sendLEDBusy(request);
+    return;
+  }
+  request->send(200, "text/plain", wasOn ? "false" : "true");
 }
 
 // Set LED Intensity Handler
-void handleSetLEDIntensity(AsyncWebServerRequest *request) {
-  if (!ensureLoggedIn(request)) return;
-
+void handleSetLEDIntensity(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
   if (request->hasParam("led") && request->hasParam("intensity")) {
-    String led = request->getParam("led")->value();
-    String intensity = request->getParam("intensity")->value();
-    int intensityValue = intensity.toInt();
+    int led = request->getParam("led")->value().toInt();
+    int intensity = request->getParam("intensity")->value().toInt();
 
-    if (intensityValue < 0 || intensityValue > 255) {
+    if (!setLEDIntensityCommand(led, intensity)) {
+      noteResponseStatus(400);
       request->send(400, "text/plain", "Invalid intensity value");
       return;
     }
-
-    if (led == "1") {
-      analogWrite(LED1_PIN, intensityValue);
-    } else if (led == "2") {
-      analogWrite(LED2_PIN, intensityValue);
-    }
   }
 
   request->send(200, "text/plain", "LED intensity set");
 }
 
-// Sensor Data Route
-void handleSensorData(AsyncWebServerRequest *request) {
-  if (!ensureLoggedIn(request)) return;
+// LED Fade Handler: /fade?led=<n>&intensity=<0-255>&ms=<duration>
+void handleFadeLED(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+  if (!request->hasParam("led") || !request->hasParam("intensity") || !request->hasParam("ms")) {
+    noteResponseStatus(400);
+    request->send(400, "text/plain", "led, intensity and ms are required");
+    return;
+  }
+
+  int led = request->getParam("led")->value().toInt();
+  int intensity = request->getParam("intensity")->value().toInt();
+  long fadeMs = request->getParam("ms")->value().toInt();
+  if (fadeMs < 0 || !isValidLED(led) || intensity < 0 || intensity > 255) {
+    noteResponseStatus(400);
+    request->send(400, "text/plain", "Invalid fade");
+    return;
+  }
+  if (!fadeLEDCommand(led, intensity, fadeMs)) {
+    sendLEDBusy(request);
+    return;
+  }
+  request->send(200, "text/plain", "Fading");
+}
 
-  float temperature = dht.readTemperature();
-  float humidity = dht.readHumidity();
+// Scenes, the playing one and the schedules
+void handleScenes(const RequestContext &context) {
+  LedSnapshot snapshot = readLEDSnapshot();
+  PooledResponse *response = beginPooledResponse(context.request, "application/json");
+  JsonWriter json(response->source);
+  json.beginObject();
+  json.field("active", snapshot.activeScene >= 0 ? SCENES[snapshot.activeScene].name : (const char *)nullptr);
 
-  String temperatureStr = isnan(temperature) ? "Error" : "Temperature:" + String(temperature);
-  String humidityStr = isnan(humidity) ? "Error" : "Humidity:" + String(humidity);
+  json.key("scenes");
+  json.beginArray();
+  for (uint8_t i = 0; i < SCENE_COUNT; i++) json.value(SCENES[i].name);
+  json.endArray();
 
-  String jsonResponse = "{\"temperature\": \"" + temperatureStr + " °C\", \"humidity\": \"" + humidityStr + " %\"}";
+  unsigned long now = millis();
+  json.key("schedules");
+  json.beginArray();
+  for (uint8_t i = 0; i < SCHEDULE_CAPACITY; i++) {
+    const SceneSchedule &schedule = snapshot.schedules[i];
+    if (schedule.scene < 0) continue;
+    json.beginObject();
+    json.field("id", (int)schedule.id);
+    json.field("scene", SCENES[schedule.scene].name);
+    json.field("in", (long)(schedule.nextRun - now) > 0 ? schedule.nextRun - now : 0UL);
+    json.field("every", (unsigned long)schedule.repeatMs);
+    json.endObject();
+  }
+  json.endArray();
+
+  json.endObject();
+  sendPooledResponse(context.request, response);
+}
 
-  request->send(200, "application/json", jsonResponse);
+// Scene Handler: POST name=<scene>, or name=stop
+void handleScene(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+  const char *name = request->hasParam("name", true) ? request->getParam("name", true)->value().c_str() : "";
+
+  bool stop = strcmp(name, "stop") == 0;
+  int scene = stop ? SCENE_NONE : findScene(name);
+  if (!stop && scene < 0) {
+    noteResponseStatus(400);
+    request->send(400, "text/plain", "Unknown scene");
+    return;
+  }
+  if (!queueScene(scene)) {
+    sendLEDBusy(request);
+    return;
+  }
+  request->send(200, "text/plain", "OK");
 }
 
-// Routes
-void setupLEDRoutes() {
-  server.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
-    if (!ensureLoggedInAndAuthorized(request, "")) return;
-    handleLED(request);
-  });
+// Schedule Handler: POST scene=<scene>&in=<ms>[&every=<ms>] adds one,
+// cancel=<id> removes one
+void handleSchedule(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+
+  if (request->hasParam("cancel", true)) {
+    long id = request->getParam("cancel", true)->value().toInt();
+    if (id <= 0 || id > 0xFFFF || !queueCancelSchedule(id)) {
+      noteResponseStatus(400);
+      request->send(400, "text/plain", "No such schedule");
+      return;
+    }
+    request->send(200, "text/plain", "OK");
+    return;
+  }
+
+  int scene = request->hasParam("scene", true) ? findScene(request->getParam("scene", true)->value().c_str()) : -1;
+  long delayMs = request->hasParam("in", true) ? request->getParam("in", true)->value().toInt() : 0;
+  long repeatMs = request->hasParam("every", true) ? request->getParam("every", true)->value().toInt() : 0;
+  if (scene < 0 || delayMs < 0 || repeatMs < 0) {
+    noteResponseStatus(400);
+    request->send(400, "text/plain", "Invalid schedule");
+    return;
+  }
 
-  server.on("/led-state", HTTP_GET, [](AsyncWebServerRequest *request) {
-    if (!ensureLoggedInAndAuthorized(request, "")) return;
-    handleLEDState(request);
-  });
+  uint16_t id = queueSceneSchedule(scene, delayMs, repeatMs);
+  if (id == 0) {
+    noteResponseStatus(409);
+    request->send(409, "text/plain", "Schedule table full");
+    return;
+  }
 
-  server.on("/toggle", HTTP_GET, [](AsyncWebServerRequest *request) {
-    if (!ensureLoggedInAndAuthorized(request, "")) return;
-    handleToggleLED(request);
-  });
+  char json[16];
+  snprintf(json, sizeof(json), "{\"id\":%u}", id);
+  request->send(200, "application/json", json);
+}
 
-  server.on("/set_led_intensity", HTTP_GET, [](AsyncWebServerRequest *request) {
-    if (!ensureLoggedInAndAuthorized(request, "")) return;
-    handleSetLEDIntensity(request);
-  });
+// Sensor values as published by updateSensors(), in SENSORS order.
+// Names, units and decimals come once from /sensors, the page formats.
+void writeSensorData(JsonWriter &json, const SensorSnapshot &snapshot) {
+  json.beginObject();
+  json.key("sensors");
+  json.beginArray();
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    const SensorReading &reading = snapshot.readings[i];
+    json.beginObject();
+    json.field("valid", reading.valid);
+    json.field("age", sensorSampleAge(reading));
+    json.key("values");
+    json.beginArray();
+    for (uint8_t v = 0; v < SENSORS[i]->valueCount; v++) {
+      json.value(reading.values[v], SENSORS[i]->quantities[v].decimals);
+    }
+    json.endArray();
+    json.endObject();
+  }
+  json.endArray();
+  json.endObject();
 }
 
-void setupSensorRoutes() {
-  server.on("/sensor_data", HTTP_GET, [](AsyncWebServerRequest *request) {
-    if (!ensureLoggedInAndAuthorized(request, "")) return;
-    handleSensorData(request);
-  });
+// Sensor Data Route
+void handleSensorData(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+  PooledResponse *response = beginPooledResponse(request, "application/json");
+  JsonWriter json(response->source);
+  writeSensorData(json, readSensorSnapshot());
+  sendPooledResponse(request, response);
+}
+
+// Sensor List Route: what each sensor measures and how often
+void handleSensors(const RequestContext &context) {
+  PooledResponse *response = beginPooledResponse(context.request, "application/json");
+  JsonWriter json(response->source);
+  json.beginObject();
+  json.key("sensors");
+  json.beginArray();
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    const SensorDriver &driver = *SENSORS[i];
+    json.beginObject();
+    json.field("name", driver.name);
+    json.field("period", (unsigned long)driver.periodMs);
+    json.key("values");
+    json.beginArray();
+    for (uint8_t v = 0; v < driver.valueCount; v++) {
+      json.beginObject();
+      json.field("name", driver.quantities[v].name);
+      json.field("unit", driver.quantities[v].unit);
+      json.field("decimals", (int)driver.quantities[v].decimals);
+      json.endObject();
+    }
+    json.endArray();
+    json.endObject();
+  }
+  json.endArray();
+  json.endObject();
+  sendPooledResponse(context.request, response);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,203 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <ESPAsyncWebServer.h>
+#include "auth.h"
+#include "boot_timing.h"
+#include "buffer_pool.h"
+#include "events.h"
+#include "json_writer.h"
+#include "metrics.h"
+#include "mqtt.h"
+#include "ota.h"
+#include "pooled_response.h"
+#include "rate_limit.h"
+#include "sensor_log.h"
+#include "sensors.h"
+#include "tasks.h"
+#include "websocket.h"
+#include "wifi_control.h"
+
+// Heap Stats Route, sampled by tools/loadtest.py between scenarios. A
+// largest block far below the free total means the heap is fragmented.
+void handleHeap(const RequestContext &context) {
+  char json[160];
+  snprintf(json, sizeof(json), "{\"free\":%lu,\"minFree\":%lu,\"maxAlloc\":%lu,\"poolInUse\":%lu,\"poolPeak\":%lu,\"poolExhausted\":%lu}",
+           (unsigned long)ESP.getFreeHeap(), (unsigned long)ESP.getMinFreeHeap(), (unsigned long)ESP.getMaxAllocHeap(),
+           (unsigned long)poolStats.inUse.load(), (unsigned long)poolStats.peak.load(),
+           (unsigned long)poolStats.exhausted.load());
+  context.request->send(200, "application/json", json);
+}
+
+// Rate Limit Route: current limits and counters
+void handleLimits(const RequestContext &context) {
+  PooledResponse *response = beginPooledResponse(context.request, "application/json");
+  JsonWriter json(response->source);
+  json.beginObject();
+  json.field("rate", (unsigned long)rateLimitRate);
+  json.field("burst", (unsigned long)rateLimitBurst);
+  json.field("maxInFlight", (unsigned long)maxInFlightRequests);
+  json.field("inFlight", (unsigned long)inFlightRequests);
+  json.field("admitted", rateLimitStats.admitted);
+  json.field("limited", rateLimitStats.limited);
+  json.field("overloaded", rateLimitStats.overloaded);
+  json.endObject();
+  sendPooledResponse(context.request, response);
+}
+
+// Per-sensor series, labelled with the driver name
+void writeSensorStat(Print &out, const SensorSnapshot &snapshot, const char *name, const char *type,
+                     const char *help, unsigned long SensorStats::*stat, double scale) {
+  printTo(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    printTo(out, "%s{sensor=\"%s\"} %.10g\n", name, SENSORS[i]->name, snapshot.stats[i].*stat * scale);
+  }
+}
+
+// The readings themselves only go to logged in clients, like /sensor_data
+void writeSensorMetrics(Print &out, bool withValues) {
+  SensorSnapshot snapshot = readSensorSnapshot();
+  writeSensorStat(out, snapshot, "sensor_reads_total", "counter", "Sensor reads.", &SensorStats::reads, 1);
+  writeSensorStat(out, snapshot, "sensor_read_failures_total", "counter", "Sensor reads that returned no data.",
+                  &SensorStats::failures, 1);
+  writeSensorStat(out, snapshot, "sensor_read_last_seconds", "gauge", "Duration of the last read.",
+                  &SensorStats::lastReadUs, 1e-6);
+  writeSensorStat(out, snapshot, "sensor_read_max_seconds", "gauge", "Longest read.", &SensorStats::maxReadUs, 1e-6);
+  if (!withValues) return;
+
+  out.print("# HELP sensor_value Latest good value of each quantity.\n# TYPE sensor_value gauge\n");
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    const SensorReading &reading = snapshot.readings[i];
+    if (reading.timestamp == 0) continue;  // Never read
+    for (uint8_t v = 0; v < SENSORS[i]->valueCount; v++) {
+      printTo(out, "sensor_value{sensor=\"%s\",quantity=\"%s\"} %.10g\n", SENSORS[i]->name,
+                 SENSORS[i]->quantities[v].name, reading.values[v]);
+    }
+  }
+}
+
+// Unused stack of each task, a value near zero means it needs a bigger stack
+void writeTaskMetrics(Print &out) {
+  out.print("# HELP task_stack_free_bytes Lowest free stack since the task started.\n# TYPE task_stack_free_bytes gauge\n");
+  for (uint8_t i = 0; i < TASK_COUNT; i++) {
+    if (!*TASKS[i].handle) continue;
+    printTo(out, "task_stack_free_bytes{task=\"%s\"} %u\n", TASKS[i].name,
+               (unsigned)uxTaskGetStackHighWaterMark(*TASKS[i].handle));
+  }
+}
+
+#define METRICS_MAX_BLOCKS 7  // Everything but the per-route series, about 5.5 KB with every sensor
+
+// The per-route series are produced while sending, the rest is sampled
+// into pool blocks when the request arrives
+struct MetricsSource {
+  RouteMetricsCursor routes;
+  PoolWriter rest{ METRICS_MAX_BLOCKS };
+
+  size_t read(uint8_t *buffer, size_t maxLen) {
+    size_t written = routes.read(buffer, maxLen);
+    return written + rest.read(buffer + written, maxLen - written);
+  }
+};
+
+void writePoolMetrics(Print &out) {
+  writeMetric(out, "pool_blocks", "gauge", "Response buffer blocks reserved at boot.", POOL_BLOCK_COUNT);
+  writeMetric(out, "pool_blocks_in_use", "gauge", "Response buffer blocks held by responses.", poolStats.inUse.load());
+  writeMetric(out, "pool_blocks_peak", "gauge", "Most blocks in use at once.", poolStats.peak.load());
+  writeMetric(out, "pool_exhausted_total", "counter", "Blocks asked for while none were free.", poolStats.exhausted.load());
+}
+
+void writeMqttMetrics(Print &out) {
+  MqttStats mqtt = readMqttSnapshot();
+  writeMetric(out, "mqtt_connected", "gauge", "1 while connected to the broker.", mqtt.connected);
+  writeMetric(out, "mqtt_queued_samples", "gauge", "Sensor readings waiting to be published.", mqtt.queued);
+  writeMetric(out, "mqtt_messages_published_total", "counter", "Sensor messages published.", mqtt.published);
+  writeMetric(out, "mqtt_publish_failures_total", "counter", "Publishes the connection did not take.", mqtt.publishFailures);
+  writeMetric(out, "mqtt_dropped_samples_total", "counter", "Readings dropped from a full queue.", mqtt.dropped);
+  writeMetric(out, "mqtt_connects_total", "counter", "Connections to the broker.", mqtt.connects);
+  writeMetric(out, "mqtt_connect_failures_total", "counter", "Failed connection attempts.", mqtt.connectFailures);
+}
+
+void writeLogMetrics(Print &out) {
+  LogIndex log = readLogIndex();
+  writeMetric(out, "log_bytes", "gauge", "Bytes in the sensor log on flash.", log.totalBytes);
+  writeMetric(out, "log_segments", "gauge", "Segment files in the sensor log.", log.count);
+  writeMetric(out, "log_batches_written_total", "counter", "Batches appended to the sensor log.", log.batchesWritten);
+  writeMetric(out, "log_write_failures_total", "counter", "Sensor log writes that failed.", log.writeFailures);
+  writeMetric(out, "log_evicted_segments_total", "counter", "Segments deleted to stay under the size cap.", log.evicted);
+  writeMetric(out, "log_evict_failures_total", "counter", "Segment deletes that failed and are retried.", log.evictFailures);
+  writeMetric(out, "log_crc_errors_total", "counter", "Damaged batches skipped by exports.", logCrcErrors.load());
+}
+
+// Metrics Route: Prometheus text format. It needs no login so a scraper
+// can read it, which gets the health counters only. Sensor values, the
+// session count and the RSSI are added for a logged in client.
+void handleMetrics(const RequestContext &context) {
+  bool loggedIn = context.session != nullptr;
+  SourceResponse<MetricsSource> *metrics = new SourceResponse<MetricsSource>(context.request, "text/plain; version=0.0.4");
+  PoolWriter *response = &metrics->source.rest;
+
+  writeMetric(*response, "heap_free_bytes", "gauge", "Free heap.", ESP.getFreeHeap());
+  writeMetric(*response, "heap_min_free_bytes", "gauge", "Lowest free heap since boot.", ESP.getMinFreeHeap());
+  writeMetric(*response, "heap_largest_block_bytes", "gauge", "Largest allocatable block.", ESP.getMaxAllocHeap());
+  if (loggedIn) writeMetric(*response, "sessions_active", "gauge", "Logged in sessions.", activeSessionCount());
+  writeMetric(*response, "http_requests_in_flight", "gauge", "Admitted requests not yet finished.", inFlightRequests);
+  writeMetric(*response, "http_requests_limited_total", "counter", "Requests rejected with 429.", rateLimitStats.limited);
+  writeMetric(*response, "http_requests_overloaded_total", "counter", "Requests rejected with 503.", rateLimitStats.overloaded);
+
+  const WiFiSnapshot &wifi = readWiFiSnapshot();
+  if (loggedIn && wifi.connected) {
+    writeMetric(*response, "wifi_rssi_dbm", "gauge", "Signal strength of the station connection.", wifi.rssi);
+  }
+  writeMetric(*response, "wifi_scans_total", "counter", "Completed Wi-Fi scans.", wifi.scanStats.scans);
+  writeMetric(*response, "wifi_scan_last_duration_seconds", "gauge", "Duration of the last scan.",
+              wifi.scanStats.lastDurationMs / 1e3);
+  writeMetric(*response, "wifi_scan_max_blocking_seconds", "gauge", "Longest time a scan call held up the Wi-Fi task.",
+              wifi.scanStats.maxBlockingUs / 1e6);
+  writeMetric(*response, "wifi_connects_total", "counter", "Station links brought up.", wifi.connectStats.connects);
+  writeMetric(*response, "wifi_fast_connects_total", "counter", "Links joined on the cached channel and BSSID.",
+              wifi.connectStats.fastConnects);
+  writeMetric(*response, "wifi_fast_connect_failures_total", "counter", "Cached joins that fell back to a full scan.",
+              wifi.connectStats.fastConnectFailures);
+  writeMetric(*response, "wifi_last_connect_seconds", "gauge", "Time the last station link took to come up.",
+              wifi.connectStats.lastConnectMs / 1e3);
+
+  writeMetric(*response, "ws_connections", "gauge", "Open WebSocket connections.", ws.count());
+  writeMetric(*response, "ws_connections_total", "counter", "WebSocket connections accepted.", wsStats.accepted);
+  writeMetric(*response, "ws_connections_rejected_total", "counter", "WebSocket upgrades refused over the cap.", wsStats.rejected);
+  writeMetric(*response, "ws_idle_closed_total", "counter", "WebSocket connections closed for not answering pings.", wsStats.idleClosed);
+  writeMetric(*response, "ws_session_closed_total", "counter", "WebSocket connections closed after their session ended.", wsStats.sessionClosed);
+  writeMetric(*response, "events_connections", "gauge", "Open /events streams.", events.count());
+  writeMetric(*response, "events_dropped_total", "counter", "Events too large for their buffer.", eventsDropped);
+
+  writeSensorMetrics(*response, loggedIn);
+  writeTaskMetrics(*response);
+  writePoolMetrics(*response);
+  writeMqttMetrics(*response);
+  writeLogMetrics(*response);
+  writeOtaMetrics(*response);
+  writeBootMetrics(*response);
+
+  writeMetric(*response, "uptime_seconds", "counter", "Time since boot.", millis() / 1e3);
+  sendPooledResponse(context.request, metrics, response->overflowed());
+}
+
+// Change the limits at runtime: POST rate, burst and/or max_in_flight
+void handleUpdateLimits(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+  if (request->hasParam("rate", true)) {
+    long rate = request->getParam("rate", true)->value().toInt();
+    if (rate > 0) rateLimitRate = rate;
+  }
+  if (request->hasParam("burst", true)) {
+    long burst = request->getParam("burst", true)->value().toInt();
+    if (burst >= RATE_LIMIT_LOGIN_COST) rateLimitBurst = burst;  // A login must still fit
+  }
+  if (request->hasParam("max_in_flight", true)) {
+    long maxInFlight = request->getParam("max_in_flight", true)->value().toInt();
+    if (maxInFlight > 0) maxInFlightRequests = maxInFlight;
+  }
+  handleLimits(context);
+}
+
+#endif  // DIAGNOSTICS_H
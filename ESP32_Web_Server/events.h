@@ -0,0 +1,99 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <ESPAsyncWebServer.h>
+#include "dashboard.h"
+#include "rate_limit.h"
+
+extern AsyncWebServer server;
+
+// Server-Sent Events stream pushing sensor and LED changes to the dashboard
+AsyncEventSource events("/events");
+
+#define EVENTS_MAX_CLIENTS 4  // Each stream holds a TCP connection open
+
+unsigned long pushedSensorVersion = 0;
+unsigned long pushedLEDVersion = 0;
+unsigned long eventsDropped = 0;  // Payloads that didn't fit, see sendEvent()
+
+// Event payloads are small, so they are built in a buffer on the stack. It
+// is sized for the longest sensor and LED events of the registered
+// sensors and LEDs, a value taking at most 32 characters.
+#define EVENT_SENSOR_BYTES (48 + SENSOR_MAX_VALUES * 33)  // {"valid":false,"age":4294967295,"values":[...]},
+#define EVENT_LED_BYTES 48                                // "led10State":false,"led10Intensity":255,
+#define EVENT_BUFFER_SIZE \
+  (16 + (SENSOR_COUNT * EVENT_SENSOR_BYTES > LED_COUNT * EVENT_LED_BYTES ? SENSOR_COUNT * EVENT_SENSOR_BYTES \
+                                                                         : LED_COUNT * EVENT_LED_BYTES))
+typedef JsonBuffer<EVENT_BUFFER_SIZE> EventBuffer;
+
+void formatSensorEvent(EventBuffer &buffer, const SensorSnapshot &snapshot) {
+  JsonWriter json(buffer);
+  writeSensorData(json, snapshot);
+}
+
+void formatLEDEvent(EventBuffer &buffer, const LedSnapshot &snapshot) {
+  JsonWriter json(buffer);
+  writeLEDState(json, snapshot);
+}
+
+// Send to one client, or to all without one. A truncated payload would
+// break JSON.parse() on the page, so it is counted and dropped instead.
+void sendEvent(const EventBuffer &buffer, const char *event, AsyncEventSourceClient *client = nullptr) {
+  if (buffer.overflow()) {
+    eventsDropped++;
+    return;
+  }
+  if (client) {
+    client->send(buffer.c_str(), event, millis());
+  } else {
+    events.send(buffer.c_str(), event, millis());
+  }
+}
+
+// Called from loop(): pushes whatever changed since the last call
+void updateEvents() {
+  SensorSnapshot sensors = readSensorSnapshot();
+  if (pushedSensorVersion != sensors.version) {
+    pushedSensorVersion = sensors.version;
+    if (events.count() > 0) {
+      EventBuffer buffer;
+      formatSensorEvent(buffer, sensors);
+      sendEvent(buffer, "sensor");
+    }
+  }
+
+  LedSnapshot leds = readLEDSnapshot();
+  if (pushedLEDVersion != leds.version) {
+    pushedLEDVersion = leds.version;
+    if (events.count() > 0) {
+      EventBuffer buffer;
+      formatLEDEvent(buffer, leds);
+      sendEvent(buffer, "led");
+    }
+  }
+}
+
+void setupEventRoutes() {
+  // Only logged in clients may open the stream
+  events.setFilter([](AsyncWebServerRequest *request) {
+    // Filters run for every request before the URL is matched
+    if (request->url() != "/events") return true;
+    if (events.count() >= EVENTS_MAX_CLIENTS) return false;
+    return admitConnection(request) && isSessionValid(request);
+  });
+
+  // Send the current state right away so the page doesn't wait for a change
+  events.onConnect([](AsyncEventSourceClient *client) {
+    EventBuffer buffer;
+    formatSensorEvent(buffer, readSensorSnapshot());
+    sendEvent(buffer, "sensor", client);
+
+    EventBuffer ledBuffer;
+    formatLEDEvent(ledBuffer, readLEDSnapshot());
+    sendEvent(ledBuffer, "led", client);
+  });
+
+  server.addHandler(&events);
+}
+
+#endif  // EVENTS_H
@@ -120,64 +120,164 @@ const char INDEX_HTML[] PROGMEM = R"rawliteral(
       <br>
       <button class="btn" onclick="toggleLED(2)">Toggle</button>
     </div>
+
+    <div class="card">
+      <h2>Scenes</h2>
+      <select id="scene"></select>
+      <br><br>
+      <button class="btn" onclick="runScene(document.getElementById('scene').value)">Play</button>
+      <button class="btn" onclick="runScene('stop')">Stop</button>
+      <p>Playing: <span id="active-scene">-</span></p>
+    </div>
   </div>
 
   <hr style="margin-top: 30px;">
   
   <h1>Capteurs</h1>
-  <div class="container">
-    <div class="card">
-      <h2>DHT22</h2>
-      <p id="temperature">Temperature:</p>
-      <p id="humidity">Humidity:</p>
-    </div>
-  </div>
+  <div class="container" id="sensors"></div>
   <script>
+    let streaming = false;  // True while the /events stream is connected
+    let pollTimer = null;
+
+    const ledOffSVG = '<svg class="svg-icon" style="width: 50px; height: 50px; vertical-align: middle; fill: currentColor; overflow: hidden;" viewBox="0 0 1024 1024" version="1.1" xmlns="http://www.w3.org/2000/svg"><path d="M512 256a170.666667 170.666667 0 0 0-170.666667 170.666667v256H256v85.333333h128v213.333333h85.333333v-213.333333h85.333334v213.333333h85.333333v-213.333333h128v-85.333333h-85.333333v-256a170.666667 170.666667 0 0 0-170.666667-170.666667z" fill="" /></svg>';
+    const ledOnSVG = '<svg class="svg-icon" style="width: 50px; height: 50px; vertical-align: middle; fill: currentColor; overflow: hidden;" viewBox="0 0 1024 1024" version="1.1" xmlns="http://www.w3.org/2000/svg"><path d="M469.333333 0v170.666667h85.333334V0h-85.333334m311.466667 97.706667l-130.56 128 59.733333 60.586666 130.56-128-59.733333-60.586666m-537.173333 0L183.04 158.293333l128 128 60.586667-60.586666-128-128M512 256a170.666667 170.666667 0 0 0-170.666667 170.666667v256H256v85.333333h128v213.333333h85.333333v-213.333333h85.333334v213.333333h85.333333v-213.333333h128v-85.333333h-85.333333v-256a170.666667 170.666667 0 0 0-170.666667-170.666667M85.333333 384v85.333333h170.666667V384H85.333333m682.666667 0v85.333333h170.666667V384h-170.666667z" fill="" /></svg>';
+
+    function showLEDState(data) {
+      // Update LED 1 Icon
+      //document.getElementById('led1Icon').innerHTML = data.led1State ? ledOnSVG : ledOffSVG;
+
+      // Update LED 2 Icon
+      document.getElementById('led2Icon').innerHTML = data.led2State ? ledOnSVG : ledOffSVG;
+    }
+
+    // Sensor cards are built from /sensors, updates only carry the numbers
+    let sensorInfo = null;
+    let lastSensorData = null;
+
+    function showSensors(data) {
+      sensorInfo = data.sensors;
+      const container = document.getElementById('sensors');
+      sensorInfo.forEach((sensor, i) => {
+        const card = document.createElement('div');
+        card.className = 'card';
+        card.innerHTML = `<h2>${sensor.name.toUpperCase()}</h2>` +
+          sensor.values.map((q, v) => `<p id="sensor${i}-${v}"></p>`).join('');
+        container.appendChild(card);
+      });
+      if (lastSensorData) showSensorData(lastSensorData);
+    }
+
+    function showSensorData(data) {
+      lastSensorData = data;
+      if (!sensorInfo) return;
+      data.sensors.forEach((sensor, i) => {
+        sensorInfo[i].values.forEach((q, v) => {
+          const value = sensor.values[v];
+          const label = q.name.charAt(0).toUpperCase() + q.name.slice(1);
+          document.getElementById(`sensor${i}-${v}`).innerText = sensor.valid && value !== null ?
+            `${label}: ${value.toFixed(q.decimals)} ${q.unit}` : `${label}: Error`;
+        });
+      });
+    }
 
+    fetch('/sensors')
+      .then(response => response.json())
+      .then(showSensors);
 
-  function updateLEDIcons() {
+    function updateLEDIcons() {
       fetch('/led-state')
         .then(response => response.json())
-        .then(data => {
-          // Update LED 1 Icon
-          //document.getElementById('led1Icon').innerHTML = data.led1State
-            
-          // Update LED 2 Icon
-          document.getElementById('led2Icon').innerHTML = data.led2State        
-        });
+        .then(showLEDState);
     }
 
+    // WebSocket control channel, the HTTP routes are used while it is down
+    let socket = null;
+
+    function connectSocket() {
+      socket = new WebSocket(`ws://${location.host}/ws`);
+      socket.onmessage = e => {
+        if (e.data.startsWith('e:session')) location.href = '/login';  // Logged out elsewhere or expired
+        if (!e.data.startsWith('s:')) return;
+        const state = e.data.substring(2).split(',');
+        document.getElementById('led1-slider').value = state[2];
+        document.getElementById('led1-intensity').innerText = state[2];
+      };
+      socket.onclose = () => setTimeout(connectSocket, 2000);
+    }
+
+    function socketReady() {
+      return socket && socket.readyState === WebSocket.OPEN;
+    }
+
+    if (window.WebSocket) connectSocket();
+
     function toggleLED(led) {
+      if (socketReady()) {
+        socket.send(`t${led}`);
+        return;
+      }
       fetch(`/toggle?led=${led}`)
-        .then(() => updateLEDIcons());
+        .then(() => { if (!streaming) updateLEDIcons(); });  // The stream pushes the new state
     }
 
-    // Call this function once when the page loads to set the initial state
-    function setInitialState() {
-      fetch('/led-state')
+    function updateSensorData() {
+      fetch("/sensor_data")
         .then(response => response.json())
-        .then(data => {
-          // Set the initial SVG based on the state received
-          //document.getElementById("led1Icon").innerHTML = data.led1State;
-          document.getElementById("led2Icon").innerHTML = data.led2State;
-        });
+        .then(showSensorData);
     }
 
-    // Initialize the page state on load
-    setInitialState();
+    // Fall back to polling when the event stream is unavailable
+    function startPolling() {
+      streaming = false;
+      if (pollTimer) return;
+      updateLEDIcons();
+      pollTimer = setInterval(updateSensorData, 1000);  // Update every 1 seconds
+    }
 
+    function stopPolling() {
+      streaming = true;
+      clearInterval(pollTimer);
+      pollTimer = null;
+    }
 
-    function updateSensorData() {
-      fetch("/sensor_data")
+    // Set the initial state and keep it current through the event stream
+    if (window.EventSource) {
+      const source = new EventSource('/events');
+      source.addEventListener('sensor', e => showSensorData(JSON.parse(e.data)));
+      source.addEventListener('led', e => showLEDState(JSON.parse(e.data)));
+      source.onopen = stopPolling;
+      source.onerror = startPolling;  // EventSource keeps retrying in the background
+    } else {
+      startPolling();
+    }
+
+    // Scenes run on the device, the page only starts and stops them
+    function showScenes(data) {
+      const select = document.getElementById('scene');
+      if (!select.options.length) {
+        data.scenes.forEach(name => select.add(new Option(name, name)));
+      }
+      document.getElementById('active-scene').innerText = data.active || '-';
+    }
+
+    function updateScenes() {
+      fetch('/scenes')
         .then(response => response.json())
-        .then(data => {
-          document.getElementById("temperature").innerText = data.temperature;
-          document.getElementById("humidity").innerText = data.humidity;
-        });
+        .then(showScenes);
+    }
+
+    function runScene(name) {
+      fetch('/scene', { method: 'POST', body: new URLSearchParams({ name: name }) })
+        .then(() => setTimeout(updateScenes, 100));  // Started by the I/O task, shortly after
     }
-    setInterval(updateSensorData, 1000);  // Update every 1 seconds
+
+    updateScenes();
 
     function updateLEDIntensity(led, intensity) {
+      if (socketReady()) {
+        socket.send(`i${led}:${intensity}`);  // The device coalesces bursts
+        return;
+      }
       fetch(`/set_led_intensity?led=${led}&intensity=${intensity}`)
         .then(response => response.text())
         .then(data => {
@@ -270,8 +370,14 @@ const char LOGIN_HTML[] PROGMEM = R"rawliteral(
       <input type="password" name="password" placeholder="Password" required>
       <button type="submit">Login</button>
     </form>
-    <p class="message">%MESSAGE%</p>
+    <p class="message" id="message"></p>
   </div>
+  <script>
+    // The page is static, a failed login redirects back with ?error
+    if (new URLSearchParams(location.search).has('error')) {
+      document.getElementById('message').innerText = 'Invalid credentials. Please try again.';
+    }
+  </script>
 </body>
 
 </html>
@@ -422,7 +528,6 @@ const char SETTINGS_HTML[] PROGMEM = R"rawliteral(
 
       <select type="text" id="ssid" name="ssid" default="Null">
         <option value="Null">--- Chouse Wifi  ---</option>
-        %WIFI_OPTIONS%
       </select>
 
       <label for="wifi_password">WiFi Password:</label>
@@ -437,9 +542,137 @@ const char SETTINGS_HTML[] PROGMEM = R"rawliteral(
       <label for="ap_password">Access Point Password:</label>
       <input type="password" id="ap_password" name="ap_password" placeholder="Password">
 
+      <hr>
+      <h2>MQTT Settings</h2>
+
+      <label for="mqtt_host">Broker (empty turns MQTT off):</label>
+      <input type="text" id="mqtt_host" name="mqtt_host" placeholder="Host">
+
+      <label for="mqtt_port">Port:</label>
+      <input type="number" id="mqtt_port" name="mqtt_port" min="1" max="65535">
+
+      <label for="mqtt_topic">Topic:</label>
+      <input type="text" id="mqtt_topic" name="mqtt_topic">
+
       <button type="submit">Update</button>
     </form>
   </div>
+  <script>
+    // The page is static, current values and scan results come from /settings_data
+    let mqttLoaded = false;
+    function loadSettings() {
+      fetch('/settings_data')
+        .then(response => response.json())
+        .then(data => {
+          document.getElementById('username').placeholder = data.username;
+          if (!mqttLoaded) {
+            // Filled in once, later refreshes would overwrite an edit
+            document.getElementById('mqtt_host').value = data.mqttHost;
+            document.getElementById('mqtt_port').value = data.mqttPort;
+            document.getElementById('mqtt_topic').value = data.mqttTopic;
+            mqttLoaded = true;
+          }
+
+          const select = document.getElementById('ssid');
+          const chosen = select.selectedIndex > 0 ? select.value : data.ssid;
+          select.length = 1;  // Keep the "Chouse Wifi" entry
+          if (data.scanning) {
+            select.add(new Option('Scanning...', 'Null'));
+            setTimeout(loadSettings, 2000);  // First scan still running
+            return;
+          }
+          if (data.networks.length === 0) {
+            select.add(new Option('No Networks Found', 'Null'));
+          }
+          data.networks.forEach(network => {
+            const option = new Option(`${network.ssid} (${network.rssi}dB)`, network.ssid);
+            option.selected = network.ssid === chosen;
+            select.add(option);
+          });
+        });
+    }
+    loadSettings();
+    setInterval(loadSettings, 15000);  // Keeps the device scanning while the page is open
+  </script>
+</body>
+
+</html>
+)rawliteral";
+
+
+////////////////////////////////// RESULT PAGE (template) //////////////////////////////////
+// Rendered by templates.h, placeholders: %TITLE%, %MESSAGE%, %REDIRECT%, %JOB%
+const char RESULT_TEMPLATE[] PROGMEM = R"rawliteral(
+<!DOCTYPE html>
+<html>
+
+<head>
+  <title>ESP32 Settings</title>
+  <meta name="viewport" content="width=device-width, initial-scale=1">
+  <style>
+    body {
+      font-family: Arial, sans-serif;
+      background: rgb(51, 51, 51);
+      display: flex;
+      justify-content: center;
+      align-items: center;
+      height: 100vh;
+      margin: 0;
+    }
+
+    .container {
+      background: white;
+      padding: 20px;
+      border-radius: 8px;
+      box-shadow: 0 4px 8px rgba(0, 0, 0, 0.2);
+      text-align: center;
+      width: 300px;
+    }
+
+    h1 {
+      color: #ff8800;
+    }
+
+    a {
+      color: #ff8801;
+    }
+  </style>
+</head>
+
+<body>
+  <div class="container" id="result" data-job="%JOB%" data-redirect="%REDIRECT%">
+    <h1 id="title">%TITLE%</h1>
+    <p id="message">%MESSAGE%</p>
+    <a href="%REDIRECT%">Continue</a>
+  </div>
+  <script>
+    const result = document.getElementById('result');
+
+    function finish() {
+      setTimeout(() => location.href = result.dataset.redirect, 3000);
+    }
+
+    // Wait for the Wi-Fi job started by the settings update
+    function pollJob() {
+      fetch(`/settings_job?id=${result.dataset.job}`)
+        .then(response => response.json())
+        .then(job => {
+          if (job.state === 'pending') {
+            setTimeout(pollJob, 1000);
+            return;
+          }
+          const connected = job.state === 'done';
+          document.getElementById('title').innerText = connected ? 'Settings Updated' : 'Connection Failed';
+          document.getElementById('message').innerText = connected
+            ? 'Connected to the new Wi-Fi network.'
+            : 'Could not connect, the previous Wi-Fi network was restored.';
+          finish();
+        })
+        .catch(() => setTimeout(pollJob, 1000));
+    }
+
+    if (result.dataset.job) pollJob(); else finish();
+  </script>
 </body>
 
 </html>
@@ -0,0 +1,377 @@
+#ifndef HTML_PAGES_GZ_H
+#define HTML_PAGES_GZ_H
+
+// Generated by tools/gzip_pages.py from html_pages.h, do not edit by hand
+
+// INDEX_HTML: 9013 bytes, 3002 bytes gzipped
+const char INDEX_HTML_ETAG[] = "\"473e57f4cd3b8390\"";
+const char INDEX_HTML_GZ_ETAG[] = "\"473e57f4cd3b8390-gz\"";
+const uint8_t INDEX_HTML_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xe5, 0x1a, 0xdb, 0x72, 0xdb, 0x36,
+  0xf6, 0xdd, 0x5f, 0x81, 0x72, 0xb3, 0x15, 0x35, 0x15, 0xa9, 0x8b, 0xed, 0xd8, 0x91, 0x25, 0x75,
+  0xda, 0xc4, 0xdd, 0x64, 0xc7, 0x6d, 0x3c, 0xb5, 0xd3, 0xce, 0x4e, 0xa7, 0x53, 0x43, 0x24, 0x24,
+  0xa2, 0xa1, 0x48, 0x06, 0x00, 0x25, 0xbb, 0xae, 0xfe, 0x7d, 0x0f, 0x2e, 0x04, 0x41, 0x4a, 0x72,
+  0xdc, 0xdd, 0xb7, 0xdd, 0x8c, 0x65, 0x53, 0xc0, 0xc1, 0xb9, 0x5f, 0xc1, 0x1c, 0x4d, 0xbe, 0x78,
+  0xf3, 0xfe, 0xf5, 0xed, 0xbf, 0xae, 0x2f, 0x51, 0x22, 0x56, 0xe9, 0xec, 0x68, 0x22, 0xff, 0xa0,
+  0x14, 0x67, 0xcb, 0xa9, 0x47, 0x32, 0x6f, 0x76, 0x04, 0x2b, 0x04, 0xc7, 0xb3, 0x23, 0x84, 0x26,
+  0x82, 0x8a, 0x94, 0xcc, 0x2e, 0x6f, 0xae, 0x8f, 0x47, 0xe8, 0x0d, 0xe6, 0xc9, 0x3c, 0xc7, 0x2c,
+  0x9e, 0xf4, 0xf5, 0xb2, 0x04, 0x58, 0x11, 0x81, 0x51, 0x94, 0x60, 0xc6, 0x89, 0x98, 0x7a, 0x1f,
+  0x6e, 0xbf, 0x0b, 0xce, 0xbd, 0x7a, 0x23, 0xc3, 0x2b, 0x32, 0xf5, 0xd6, 0x94, 0x6c, 0x8a, 0x9c,
+  0x09, 0x0f, 0x45, 0x79, 0x26, 0x48, 0x06, 0x80, 0x1b, 0x1a, 0x8b, 0x64, 0x1a, 0x93, 0x35, 0x8d,
+  0x48, 0xa0, 0xbe, 0xf4, 0x10, 0xcd, 0xa8, 0xa0, 0x38, 0x0d, 0x78, 0x84, 0x53, 0x32, 0x1d, 0x6a,
+  0x34, 0x5c, 0x3c, 0x68, 0x4a, 0x08, 0xcd, 0xf3, 0xf8, 0x01, 0x3d, 0xaa, 0x47, 0x84, 0x16, 0x80,
+  0x29, 0x58, 0xe0, 0x15, 0x4d, 0x1f, 0xc6, 0xe8, 0x1b, 0x06, 0xe7, 0x7a, 0x88, 0xe3, 0x8c, 0x07,
+  0x9c, 0x30, 0xba, 0xb8, 0x30, 0x50, 0x73, 0x1c, 0x7d, 0x5c, 0xb2, 0xbc, 0xcc, 0xe2, 0x31, 0x62,
+  0xcb, 0xb9, 0x7f, 0x3a, 0xec, 0x21, 0xfd, 0xe9, 0x56, 0x20, 0x05, 0x8e, 0x63, 0x9a, 0x2d, 0xc7,
+  0x68, 0x50, 0xad, 0xac, 0x30, 0x5b, 0xd2, 0xcc, 0x59, 0x10, 0xe4, 0x5e, 0x04, 0x38, 0xa5, 0x4b,
+  0x58, 0x8c, 0x80, 0x7d, 0xc2, 0xf4, 0xce, 0xf6, 0x48, 0xfd, 0x09, 0x33, 0xbc, 0xb6, 0x7c, 0xb9,
+  0x14, 0xff, 0xb6, 0x58, 0x9c, 0x9f, 0x0f, 0x86, 0x15, 0x9a, 0x28, 0x4f, 0x73, 0x36, 0x46, 0x9b,
+  0x84, 0x0a, 0x52, 0xad, 0x29, 0xd1, 0xc7, 0xe8, 0xd5, 0xe0, 0xef, 0x35, 0xf5, 0xfb, 0xc0, 0xac,
+  0x9e, 0x8d, 0x06, 0xc5, 0xfd, 0x0e, 0x9f, 0x43, 0x58, 0x44, 0xee, 0x8e, 0xe5, 0x17, 0xd6, 0x71,
+  0x29, 0xf2, 0x6a, 0x3d, 0xa6, 0xbc, 0x48, 0x31, 0xa8, 0x67, 0x91, 0x12, 0x0b, 0xfc, 0x7b, 0xc9,
+  0x05, 0x5d, 0x3c, 0x04, 0xc6, 0x12, 0x63, 0xc4, 0x0b, 0x0c, 0x26, 0x98, 0x13, 0xb1, 0x21, 0x24,
+  0xab, 0xa0, 0x94, 0xb0, 0x01, 0xf0, 0xb9, 0xe2, 0x4d, 0x91, 0xa5, 0x15, 0xee, 0x03, 0x9e, 0xe0,
+  0x38, 0xdf, 0x00, 0x45, 0x34, 0x02, 0x9a, 0x27, 0xf0, 0x01, 0xe5, 0x62, 0x7f, 0xd0, 0x43, 0xe6,
+  0x27, 0x1c, 0x59, 0xfd, 0x2a, 0x43, 0x71, 0xfa, 0x07, 0x01, 0xce, 0xc3, 0x11, 0x59, 0x35, 0xd6,
+  0x37, 0x84, 0x2e, 0x13, 0x60, 0x62, 0x9e, 0xa7, 0xf1, 0xae, 0x4e, 0xb1, 0xd5, 0xea, 0x3e, 0xd5,
+  0x29, 0xab, 0xc4, 0x24, 0xca, 0x19, 0x16, 0x34, 0x07, 0xf9, 0xb3, 0x3c, 0x23, 0x3b, 0x3a, 0x51,
+  0xea, 0xda, 0x83, 0x7a, 0x9c, 0xe4, 0x6b, 0xc2, 0x2c, 0x81, 0x1d, 0x64, 0x60, 0x40, 0xc2, 0x52,
+  0x5a, 0x61, 0x34, 0x67, 0x93, 0xe1, 0x13, 0x2c, 0x55, 0xf8, 0xa5, 0x6a, 0x31, 0x9c, 0xac, 0xb1,
+  0xef, 0xb5, 0x84, 0x7c, 0x0e, 0x36, 0x0c, 0x17, 0x80, 0x04, 0x7e, 0x1f, 0x34, 0x50, 0x53, 0xfd,
+  0x4b, 0x09, 0x3f, 0xda, 0x91, 0x29, 0x82, 0xb0, 0xdc, 0xeb, 0x83, 0x0d, 0x95, 0x1d, 0xf6, 0xa1,
+  0x79, 0xce, 0x40, 0xde, 0x80, 0xe1, 0x98, 0x96, 0x60, 0xf2, 0x73, 0x77, 0xc7, 0xb5, 0xb7, 0xb4,
+  0xf5, 0xf9, 0x93, 0xf6, 0x3e, 0x14, 0x2c, 0xd6, 0xd7, 0x47, 0xbb, 0xdc, 0xcf, 0x45, 0xb6, 0x87,
+  0xf9, 0xc0, 0xa8, 0xf8, 0x19, 0x61, 0xd4, 0x10, 0xac, 0x29, 0x53, 0xd3, 0x2f, 0x5a, 0x72, 0x9e,
+  0xd6, 0xd0, 0x51, 0xc9, 0xb8, 0xc4, 0x5b, 0xe4, 0xd4, 0x65, 0xda, 0x75, 0xdf, 0xca, 0x79, 0x1d,
+  0xb6, 0x5b, 0x6e, 0xb4, 0x97, 0x79, 0x7c, 0x72, 0xdc, 0x72, 0x6e, 0x9e, 0xd6, 0xc6, 0xc2, 0x45,
+  0x41, 0x30, 0xc3, 0x59, 0x44, 0x9a, 0x9c, 0x1a, 0x6d, 0x0d, 0x07, 0x75, 0x6a, 0x48, 0x4c, 0xb4,
+  0xb8, 0xd6, 0x39, 0x9c, 0x6e, 0x5a, 0xa2, 0x9e, 0xb4, 0x94, 0x2e, 0x53, 0xfc, 0xe7, 0x5c, 0xf4,
+  0x40, 0xb2, 0xc0, 0x8a, 0x60, 0x33, 0xd4, 0x82, 0x79, 0x2e, 0x44, 0xbe, 0x6a, 0xfa, 0x26, 0xe4,
+  0xef, 0xbe, 0x49, 0xe0, 0x47, 0x93, 0xbe, 0x2e, 0x2a, 0x47, 0x13, 0x99, 0xc7, 0x55, 0x6e, 0x8f,
+  0xe9, 0x1a, 0x45, 0x29, 0xe6, 0x7c, 0xea, 0x41, 0x4c, 0x7a, 0x3a, 0xcb, 0x4f, 0x80, 0x46, 0xb6,
+  0x5b, 0x71, 0xd4, 0xaa, 0x06, 0x80, 0x63, 0x33, 0x43, 0x7b, 0x82, 0x51, 0xc2, 0xc8, 0x62, 0xea,
+  0xf5, 0xbd, 0x99, 0x03, 0x8c, 0x77, 0xf7, 0xa1, 0x3c, 0x09, 0xf0, 0x10, 0xee, 0xcd, 0x6e, 0xcc,
+  0xd3, 0x5e, 0xb0, 0x34, 0x5f, 0xe6, 0xa5, 0xf0, 0x66, 0x57, 0xea, 0xaf, 0x05, 0x99, 0xf4, 0x0d,
+  0x51, 0xf3, 0x20, 0x9f, 0x92, 0xe1, 0xec, 0x35, 0xe8, 0x85, 0xe5, 0x29, 0x41, 0x31, 0x41, 0x57,
+  0x97, 0x6f, 0x00, 0x25, 0x2c, 0xb6, 0x24, 0xb3, 0xd9, 0xc0, 0xab, 0xd9, 0xb7, 0x7b, 0xc0, 0xad,
+  0x67, 0x99, 0x48, 0x46, 0x33, 0x40, 0x82, 0x86, 0x80, 0x65, 0x64, 0x17, 0x69, 0x56, 0x94, 0xa2,
+  0x82, 0x07, 0xbf, 0xf1, 0x90, 0x78, 0x28, 0xa0, 0xa6, 0x82, 0xc7, 0x2c, 0x89, 0x87, 0x68, 0x3c,
+  0xf5, 0x52, 0x12, 0x0f, 0x03, 0x9e, 0x52, 0x30, 0xa7, 0x87, 0x56, 0x34, 0x9b, 0x7a, 0x03, 0x4f,
+  0x96, 0x91, 0xa9, 0x37, 0x3a, 0x3d, 0xf5, 0xd0, 0x1a, 0xa7, 0x25, 0x91, 0x6b, 0x06, 0x25, 0x42,
+  0x79, 0xa6, 0xb0, 0x4e, 0xbd, 0xb2, 0x88, 0xb1, 0x20, 0x40, 0xf4, 0x9d, 0xb4, 0x2f, 0xa7, 0xe2,
+  0xc1, 0x87, 0xe2, 0x28, 0x12, 0xca, 0x43, 0x75, 0xaa, 0x5b, 0x33, 0x57, 0xcc, 0x2c, 0xcc, 0x58,
+  0xdb, 0xa8, 0xa6, 0x4d, 0xab, 0x1d, 0x6f, 0x36, 0x30, 0x96, 0x9a, 0xf4, 0x8b, 0x86, 0xe6, 0x9e,
+  0x27, 0xfa, 0xa8, 0x21, 0xba, 0x84, 0x36, 0x34, 0x46, 0xef, 0x40, 0x8d, 0xde, 0xcc, 0x9a, 0x41,
+  0xed, 0xcf, 0x59, 0xfd, 0x58, 0x82, 0xf3, 0x65, 0x15, 0x6e, 0x88, 0x4b, 0x0f, 0x84, 0x8c, 0x52,
+  0x1a, 0x7d, 0x9c, 0x7a, 0x22, 0x5f, 0x2e, 0x53, 0x29, 0xa4, 0x3f, 0x02, 0x79, 0x6e, 0xd5, 0xb7,
+  0x49, 0x5f, 0x9f, 0xf8, 0x8b, 0x3c, 0xde, 0x40, 0x42, 0x23, 0xbc, 0xc1, 0x24, 0x27, 0x29, 0x89,
+  0x84, 0xe2, 0x93, 0xcb, 0x5d, 0xc9, 0xa4, 0x5e, 0x73, 0xf9, 0x7c, 0x2e, 0xaf, 0xac, 0xcc, 0x14,
+  0x0d, 0x3f, 0xce, 0xa3, 0x72, 0x05, 0x21, 0x17, 0x2e, 0x89, 0xb8, 0x4c, 0x89, 0x7c, 0xfc, 0xf6,
+  0xe1, 0x5d, 0xec, 0x77, 0x14, 0x91, 0x4e, 0xd7, 0xda, 0xe7, 0x1a, 0x82, 0xb6, 0x29, 0xcd, 0x73,
+  0x49, 0x74, 0xb8, 0xc8, 0x8b, 0x0e, 0xa0, 0xb8, 0x81, 0xbf, 0x3b, 0x28, 0x0a, 0x85, 0x59, 0xe5,
+  0xd4, 0xda, 0xda, 0x38, 0x12, 0x74, 0x4d, 0x02, 0x23, 0x68, 0x70, 0xc0, 0xd6, 0xcd, 0x28, 0x61,
+  0x48, 0x65, 0x80, 0xa9, 0x67, 0xf2, 0x04, 0x10, 0x1b, 0xa3, 0x63, 0x99, 0x24, 0x94, 0x6a, 0xab,
+  0x48, 0xc2, 0x85, 0x20, 0x90, 0x81, 0x9f, 0x8e, 0x20, 0xad, 0x66, 0xf0, 0xb5, 0x9c, 0x71, 0xc7,
+  0x1b, 0x26, 0x3c, 0x62, 0xb4, 0x30, 0x0a, 0x4f, 0x89, 0x00, 0x8a, 0x8c, 0x40, 0x6b, 0x98, 0x2d,
+  0xd1, 0x14, 0x2d, 0x70, 0xca, 0xc9, 0x05, 0x42, 0xfd, 0x3e, 0xba, 0x65, 0x25, 0x91, 0x75, 0x03,
+  0x02, 0x56, 0x24, 0x04, 0xf5, 0xc9, 0x1a, 0xd4, 0xca, 0x0d, 0x34, 0xa2, 0x5c, 0xb6, 0xa7, 0x19,
+  0x58, 0x8e, 0xc4, 0x16, 0x53, 0x91, 0xa7, 0xe9, 0x2d, 0x5d, 0x41, 0xa2, 0x9c, 0xa2, 0xac, 0x4c,
+  0xd3, 0x0b, 0xed, 0x25, 0x00, 0xc8, 0x05, 0x00, 0xc4, 0xef, 0x17, 0x8b, 0x9b, 0x9f, 0xfe, 0x01,
+  0x9b, 0x9d, 0x09, 0x5f, 0x2f, 0x6d, 0x9c, 0xae, 0x97, 0x01, 0x95, 0x1e, 0x5b, 0xc9, 0x6e, 0x92,
+  0xf9, 0xa9, 0x14, 0xdb, 0xa6, 0x71, 0xfd, 0x0d, 0xca, 0x87, 0xa0, 0xd0, 0xf1, 0x56, 0x35, 0x73,
+  0x45, 0xe3, 0x38, 0x05, 0x86, 0x17, 0x34, 0x4d, 0xc7, 0xb2, 0x2a, 0x31, 0x60, 0xf2, 0xb5, 0x2c,
+  0x26, 0x17, 0x48, 0xd6, 0x9a, 0x45, 0x2a, 0x2b, 0x71, 0x02, 0x50, 0xd0, 0xae, 0x41, 0x74, 0x43,
+  0x6f, 0xfd, 0x6d, 0x0e, 0xb1, 0x3e, 0x50, 0xbd, 0xce, 0xe8, 0x44, 0xfd, 0xf2, 0x24, 0x5a, 0x0e,
+  0x8d, 0xcc, 0xd4, 0x1b, 0x86, 0x43, 0x0f, 0xdd, 0xaf, 0xd2, 0x0c, 0xf8, 0x4a, 0x84, 0x28, 0xc6,
+  0xfd, 0xfe, 0x66, 0xb3, 0x09, 0x37, 0xc7, 0x61, 0xce, 0x96, 0xfd, 0xd1, 0x60, 0x30, 0xe8, 0x03,
+  0xbb, 0xa0, 0xcd, 0x02, 0x8b, 0x04, 0x81, 0x7e, 0xbf, 0x3f, 0x1d, 0x8e, 0xd0, 0xe8, 0xf4, 0x25,
+  0x1e, 0x9e, 0x0d, 0xc2, 0x97, 0xf2, 0xdf, 0x19, 0x72, 0x1e, 0x25, 0x9d, 0x41, 0xb0, 0x77, 0x6f,
+  0x0d, 0xa7, 0xde, 0xc2, 0x67, 0x7d, 0x7e, 0x1a, 0x1e, 0xab, 0x7f, 0xc9, 0x70, 0x74, 0xbe, 0x1e,
+  0x0d, 0x8f, 0xab, 0xaf, 0x76, 0x63, 0x1d, 0xec, 0x59, 0x3d, 0xf9, 0x3c, 0xa8, 0xc4, 0x17, 0xd4,
+  0xe8, 0x03, 0x17, 0xea, 0xd9, 0x2c, 0x3b, 0x8f, 0x7f, 0x78, 0x4a, 0xd1, 0x53, 0xcf, 0x43, 0x7d,
+  0x19, 0xb9, 0xeb, 0xe5, 0xac, 0x73, 0xd1, 0x32, 0x71, 0xf6, 0x3f, 0x67, 0xe1, 0x93, 0x97, 0xaf,
+  0x8c, 0xda, 0xd0, 0x60, 0x5d, 0x2b, 0xa3, 0x36, 0xc4, 0x4f, 0x83, 0x5a, 0xb5, 0x27, 0xab, 0xe3,
+  0xe1, 0x30, 0x3c, 0xd1, 0xaa, 0x7c, 0x75, 0x16, 0x9e, 0x0d, 0xe4, 0x53, 0x1a, 0x0c, 0x8f, 0x07,
+  0xe1, 0xe9, 0x4b, 0x04, 0x16, 0x41, 0xa7, 0xaf, 0xc2, 0x33, 0x8d, 0xee, 0x25, 0xac, 0x9d, 0x4b,
+  0x50, 0xa4, 0xb7, 0x03, 0xd8, 0x0e, 0xec, 0x76, 0x60, 0xb7, 0x57, 0xc1, 0xe9, 0xf1, 0x59, 0x38,
+  0x3c, 0xd3, 0x3c, 0x5c, 0x0d, 0xcf, 0x8f, 0xc3, 0x01, 0x08, 0x76, 0x7a, 0x1e, 0x8e, 0x5e, 0xc9,
+  0xb5, 0x54, 0xa2, 0x95, 0x9f, 0xea, 0xc4, 0x59, 0x7d, 0x56, 0xe1, 0x84, 0xcf, 0xff, 0x95, 0xa3,
+  0x7e, 0x6f, 0x11, 0xa0, 0xe3, 0xf3, 0x13, 0x97, 0x71, 0x0b, 0xf2, 0x13, 0x6c, 0xbc, 0xb5, 0x1b,
+  0xab, 0x97, 0xe7, 0x23, 0x8b, 0xf7, 0x20, 0x7c, 0xf2, 0xd9, 0x58, 0x50, 0xc1, 0xb0, 0x28, 0xb3,
+  0x48, 0xce, 0x45, 0x88, 0x27, 0xf9, 0x06, 0x4a, 0xe9, 0x8d, 0x80, 0xbe, 0xc1, 0x87, 0xe6, 0x01,
+  0x77, 0x6d, 0x07, 0x09, 0x09, 0xf6, 0x83, 0xea, 0x27, 0x90, 0xea, 0x62, 0x90, 0x2c, 0xd9, 0x76,
+  0xeb, 0x60, 0x3d, 0x93, 0x0d, 0x84, 0x84, 0x84, 0x92, 0x46, 0x21, 0xf9, 0xb2, 0xb7, 0xb7, 0xdf,
+  0x5f, 0x41, 0xb0, 0x49, 0xd4, 0xa1, 0xdc, 0x53, 0x94, 0xd0, 0xd7, 0x75, 0x20, 0x8e, 0xeb, 0xb4,
+  0x6b, 0x98, 0x6b, 0x93, 0x1e, 0xb9, 0xa4, 0x9f, 0x22, 0x3c, 0x7a, 0x82, 0xf0, 0xe8, 0x69, 0xc2,
+  0x4e, 0x23, 0x0d, 0xc4, 0x6f, 0x54, 0x49, 0x42, 0xb2, 0x5f, 0xe0, 0x08, 0x33, 0x82, 0xe6, 0x25,
+  0x4d, 0x05, 0x5a, 0xb0, 0x7c, 0x85, 0xfa, 0xa6, 0x5e, 0xf5, 0x90, 0xee, 0xb6, 0x38, 0x94, 0xe2,
+  0xf4, 0x41, 0xc2, 0xb2, 0x07, 0x55, 0x86, 0xb2, 0x72, 0x35, 0x87, 0x50, 0xae, 0x8b, 0x97, 0x82,
+  0x7f, 0x97, 0x2d, 0x72, 0x5b, 0x73, 0xaa, 0x2d, 0xc8, 0x3d, 0x42, 0xd3, 0x7a, 0x03, 0x6c, 0x36,
+  0x4b, 0x52, 0xc3, 0x44, 0x1a, 0x88, 0xb7, 0x2c, 0xd4, 0xc0, 0xac, 0x04, 0x35, 0xbc, 0xd5, 0xa3,
+  0x95, 0xcc, 0x79, 0xf5, 0xfc, 0x3a, 0x3d, 0xac, 0x3e, 0x73, 0xb2, 0x63, 0xe7, 0xbe, 0x1a, 0x79,
+  0xb8, 0xc8, 0xd9, 0x25, 0x8e, 0x12, 0xdf, 0xd7, 0x6b, 0x3d, 0x44, 0xbb, 0x68, 0x3a, 0xb3, 0x6c,
+  0x58, 0x3a, 0x72, 0x66, 0x75, 0x48, 0x44, 0x50, 0x86, 0x05, 0x31, 0x54, 0xfc, 0x0e, 0x14, 0xf7,
+  0x1a, 0x3b, 0x52, 0xd0, 0xa1, 0xca, 0xbe, 0x3f, 0xe0, 0x15, 0x91, 0xf9, 0x58, 0xae, 0x74, 0x5a,
+  0x00, 0xae, 0x29, 0xef, 0x64, 0xcb, 0xf6, 0xe2, 0x51, 0x33, 0x11, 0xca, 0xab, 0xa8, 0x50, 0xe4,
+  0x1f, 0x60, 0xdc, 0x62, 0xaf, 0x31, 0x27, 0x7e, 0x77, 0xab, 0x1a, 0xb9, 0x3b, 0xf4, 0x95, 0x45,
+  0x51, 0x49, 0xa1, 0xbb, 0x2b, 0x1e, 0xae, 0x70, 0xe1, 0xfb, 0x9f, 0x7a, 0x68, 0xad, 0xf8, 0xbf,
+  0x9b, 0x14, 0x4e, 0x03, 0xf2, 0xe2, 0x91, 0x6e, 0x83, 0x17, 0x8f, 0xeb, 0xad, 0xa7, 0x1a, 0xa0,
+  0xbb, 0x6e, 0xf8, 0x3b, 0x4c, 0x8e, 0x7e, 0xa7, 0xc1, 0x73, 0xa5, 0xc9, 0x50, 0x4e, 0x79, 0x59,
+  0xfc, 0x1a, 0x7a, 0x8f, 0xd8, 0x97, 0x8c, 0x5a, 0xa0, 0xad, 0x7d, 0xa2, 0x0b, 0xe4, 0x37, 0x0d,
+  0xdc, 0x75, 0x6c, 0x29, 0xbf, 0xb7, 0xb7, 0x1b, 0x6e, 0xb8, 0xc7, 0xfe, 0xea, 0x4c, 0xd3, 0x05,
+  0x76, 0x3c, 0x48, 0x6e, 0xbb, 0x1c, 0x7c, 0x51, 0xdb, 0xb1, 0x8b, 0x18, 0x11, 0x25, 0xb3, 0x97,
+  0x42, 0xae, 0xc7, 0x7c, 0xde, 0xc6, 0x35, 0x9e, 0x5f, 0xe8, 0xaf, 0x95, 0x42, 0xed, 0x29, 0xab,
+  0xd4, 0x47, 0x47, 0xf9, 0xda, 0x2d, 0x14, 0x28, 0x70, 0xd6, 0x30, 0xc5, 0x2f, 0xeb, 0x5f, 0x2f,
+  0x76, 0x20, 0x53, 0x3c, 0x27, 0x29, 0x40, 0x7e, 0xd2, 0xc6, 0x95, 0xb7, 0x90, 0xdf, 0x08, 0x7f,
+  0xd0, 0x6d, 0x9a, 0x19, 0x7d, 0x55, 0x01, 0xc0, 0x8c, 0x14, 0x11, 0x7f, 0xd8, 0x75, 0x31, 0x1d,
+  0x72, 0xf0, 0xbb, 0x96, 0x95, 0xef, 0x4c, 0x9a, 0xb8, 0x25, 0xf7, 0xa2, 0xc1, 0x1c, 0x8d, 0xd1,
+  0x97, 0x5f, 0x1a, 0xa6, 0xbf, 0x98, 0xea, 0x90, 0x44, 0x5f, 0x3b, 0x14, 0x10, 0xba, 0x7b, 0xf1,
+  0xa8, 0x58, 0xdd, 0x8e, 0x11, 0xa0, 0x92, 0x90, 0xc0, 0xe1, 0x77, 0xf4, 0x9e, 0xc4, 0xfe, 0xa7,
+  0x30, 0x26, 0x11, 0x5d, 0x41, 0x8f, 0xda, 0xdd, 0xc2, 0xe6, 0xa7, 0xb0, 0xcc, 0xa8, 0xd8, 0xde,
+  0x41, 0xb2, 0x71, 0x0e, 0x5d, 0x32, 0x96, 0xb3, 0xbb, 0x9a, 0xeb, 0xed, 0x8e, 0xf7, 0x54, 0x3e,
+  0x40, 0x04, 0x28, 0xb7, 0xd3, 0xb7, 0xc1, 0x69, 0xc0, 0x42, 0xc8, 0x33, 0x99, 0xcf, 0x08, 0x2f,
+  0x40, 0x6f, 0x44, 0xaa, 0xbd, 0x7a, 0x0e, 0x7f, 0xe7, 0x79, 0xe6, 0x77, 0x9b, 0x80, 0x4e, 0x06,
+  0xe9, 0xb6, 0xb3, 0x4b, 0x3d, 0x32, 0x4a, 0x1b, 0xf8, 0xb5, 0x67, 0x55, 0xb4, 0x21, 0x49, 0x06,
+  0x5c, 0xe6, 0x4e, 0x4b, 0xfd, 0x2f, 0xd0, 0x77, 0x39, 0xa8, 0xca, 0x4c, 0xb7, 0x9d, 0x6d, 0x7f,
+  0x26, 0xf3, 0x9b, 0x3c, 0xfa, 0x48, 0x74, 0xa6, 0x82, 0xf9, 0x5b, 0xde, 0x3f, 0x83, 0x6d, 0xd2,
+  0x9e, 0xca, 0xa7, 0x6f, 0x6f, 0x6f, 0xaf, 0x11, 0x83, 0xe9, 0x9d, 0xe8, 0x5c, 0x5c, 0x72, 0x12,
+  0x9b, 0xae, 0x9f, 0x0a, 0xd9, 0xe5, 0xc7, 0xf9, 0x26, 0xab, 0xb3, 0xad, 0xc6, 0xb4, 0x3f, 0x95,
+  0x9a, 0x79, 0x40, 0x53, 0x73, 0x64, 0xad, 0x0f, 0x91, 0x4d, 0xcd, 0x8e, 0x7f, 0xb7, 0xe1, 0xd0,
+  0x7b, 0x81, 0xdd, 0xf2, 0x48, 0xdd, 0x22, 0x86, 0x49, 0xce, 0xc5, 0xb6, 0xbf, 0xe1, 0x77, 0x75,
+  0x96, 0x54, 0x90, 0x61, 0x9e, 0xad, 0x08, 0xe7, 0x78, 0x29, 0xfd, 0x9c, 0x34, 0xc3, 0x40, 0x06,
+  0x21, 0x09, 0x75, 0xac, 0x09, 0xcc, 0x04, 0xff, 0x99, 0x0a, 0xd0, 0x2b, 0x19, 0x73, 0x38, 0x41,
+  0x65, 0xbd, 0xea, 0xa2, 0x9a, 0x00, 0x23, 0x0b, 0x99, 0x0a, 0xe5, 0xbd, 0x05, 0xcd, 0x3a, 0x7a,
+  0xcc, 0xb9, 0x82, 0x11, 0x17, 0x44, 0x06, 0x0d, 0x20, 0x02, 0xb3, 0xcf, 0x26, 0x21, 0xa0, 0x05,
+  0x28, 0x4f, 0xe4, 0xbe, 0xa0, 0xcc, 0xcc, 0x36, 0x36, 0xdc, 0xf7, 0x90, 0xe2, 0x63, 0x49, 0xa3,
+  0x19, 0xfb, 0x55, 0xc8, 0x29, 0xcb, 0x4a, 0xa6, 0xcd, 0xb1, 0x72, 0x0e, 0xd3, 0x13, 0x0c, 0x5a,
+  0x30, 0x5b, 0x87, 0xbc, 0x48, 0x29, 0xe4, 0xed, 0x9e, 0x9b, 0x01, 0x9f, 0xac, 0xfb, 0xe6, 0xd2,
+  0xa2, 0x9a, 0x66, 0x65, 0x58, 0x49, 0xf4, 0xbf, 0x8c, 0x7e, 0x7d, 0x2e, 0x02, 0x7b, 0xf3, 0xd0,
+  0x69, 0x85, 0x67, 0x0b, 0xcf, 0x76, 0x47, 0xff, 0x51, 0x9a, 0x4b, 0x4f, 0x44, 0xbe, 0xca, 0x42,
+  0x9c, 0x08, 0x39, 0xe5, 0x81, 0xca, 0xfc, 0x86, 0xcd, 0x7b, 0x48, 0xb6, 0xcf, 0x87, 0x12, 0xad,
+  0x02, 0xf9, 0x91, 0xe0, 0xf8, 0xc1, 0xf1, 0x0d, 0xad, 0xb7, 0xca, 0x45, 0x20, 0x35, 0x18, 0x92,
+  0x4c, 0xc2, 0xe9, 0xa6, 0x62, 0x0a, 0x69, 0xc2, 0x7a, 0x4d, 0xf8, 0xfe, 0xfa, 0xf2, 0x87, 0x06,
+  0x01, 0x69, 0x97, 0x0d, 0xcd, 0xc0, 0x4d, 0x43, 0x0b, 0xd5, 0x6d, 0xfb, 0x62, 0xdb, 0x55, 0xeb,
+  0x5b, 0x0e, 0x50, 0x4c, 0xcd, 0x8d, 0xc4, 0xd5, 0xe0, 0xb3, 0xeb, 0xa6, 0x68, 0xcd, 0x00, 0x64,
+  0x0b, 0xc8, 0x77, 0x02, 0xfc, 0x96, 0xc4, 0xdb, 0x3b, 0xc7, 0x78, 0x4d, 0x17, 0xd8, 0x36, 0x02,
+  0xfd, 0xae, 0xaf, 0x29, 0x7e, 0x0d, 0x87, 0xa6, 0xd5, 0xd1, 0x56, 0x14, 0x6b, 0xdd, 0x3e, 0x9a,
+  0xba, 0x52, 0xcd, 0xe4, 0xdd, 0x9d, 0x1c, 0x72, 0x21, 0xf3, 0x98, 0x9e, 0xd0, 0x21, 0x7e, 0xcd,
+  0x38, 0x5e, 0x94, 0x3c, 0x81, 0x08, 0x56, 0x1d, 0x12, 0x44, 0x99, 0xb2, 0xe8, 0x5e, 0x33, 0x68,
+  0x6c, 0x4e, 0xc5, 0x6b, 0xe7, 0x24, 0xcf, 0xe4, 0xc3, 0xdf, 0xa4, 0xcb, 0x7a, 0xff, 0x65, 0x56,
+  0x3a, 0x54, 0x7e, 0x81, 0xf9, 0xef, 0x30, 0x64, 0x7e, 0x79, 0x21, 0x0b, 0xc6, 0x50, 0x17, 0x07,
+  0xf2, 0x02, 0x02, 0xa2, 0x2f, 0x53, 0x42, 0xa8, 0xcb, 0x06, 0xe7, 0xae, 0xa1, 0xcc, 0xf0, 0x1a,
+  0x53, 0x48, 0xf1, 0x29, 0x69, 0xb9, 0x95, 0x0c, 0xc5, 0x6b, 0x7d, 0xdc, 0xcd, 0x39, 0x3b, 0x77,
+  0x1a, 0x8e, 0x89, 0xed, 0x35, 0x45, 0x3b, 0x6e, 0x77, 0x54, 0x5d, 0x5d, 0x98, 0x3b, 0xf7, 0x1a,
+  0xe0, 0xfc, 0xf2, 0x6e, 0x8f, 0x41, 0x10, 0xfa, 0x6d, 0x65, 0xf6, 0xe4, 0x05, 0xf4, 0xc0, 0x58,
+  0xc7, 0xf4, 0xd8, 0x20, 0x09, 0xb4, 0xae, 0x43, 0x38, 0x07, 0x38, 0x63, 0xbe, 0x3f, 0x36, 0x44,
+  0x5e, 0x3c, 0x2d, 0x83, 0x60, 0xa5, 0x15, 0x21, 0x4a, 0x09, 0x66, 0x96, 0x87, 0x5a, 0x98, 0x7d,
+  0xdc, 0xd6, 0x1d, 0xb1, 0xdb, 0x7f, 0x0b, 0xa5, 0x63, 0xf3, 0x06, 0xd1, 0x64, 0x29, 0x9c, 0xc5,
+  0xe8, 0x23, 0x21, 0x85, 0x4c, 0xfb, 0x66, 0xca, 0x06, 0x28, 0xa8, 0x0c, 0xcb, 0x64, 0xc7, 0x22,
+  0xed, 0xc0, 0xbb, 0x94, 0x7b, 0x37, 0x79, 0xc9, 0x22, 0xd2, 0x75, 0x5e, 0xf9, 0xa8, 0x14, 0xa8,
+  0x56, 0x4d, 0xf2, 0x77, 0xe0, 0xa0, 0xf6, 0xe9, 0x0b, 0x25, 0xa7, 0x27, 0x56, 0x1b, 0x21, 0x8e,
+  0x63, 0x05, 0x77, 0x45, 0x39, 0xa4, 0x2b, 0xc2, 0xaa, 0xee, 0xb9, 0xd3, 0xd3, 0xc9, 0xbf, 0xd5,
+  0xb1, 0xfd, 0xf3, 0xe6, 0xfd, 0x0f, 0x61, 0x21, 0xdf, 0xa8, 0x9a, 0x42, 0xd0, 0xed, 0x7e, 0x1e,
+  0x23, 0x04, 0xa0, 0x8b, 0xce, 0xce, 0x68, 0xcf, 0x40, 0x96, 0x67, 0x39, 0x34, 0xa7, 0x2a, 0x6b,
+  0x5a, 0xa3, 0xed, 0x80, 0x10, 0xd9, 0x83, 0xe8, 0xcc, 0x6a, 0xbd, 0x53, 0x7b, 0x85, 0xa3, 0x02,
+  0xa5, 0x6e, 0x2e, 0x5d, 0x90, 0xc9, 0xab, 0x43, 0xb0, 0x87, 0x52, 0x74, 0xfd, 0x92, 0x42, 0xdb,
+  0x4d, 0x95, 0x25, 0xc7, 0x29, 0x5c, 0x7f, 0xdf, 0x31, 0xad, 0xba, 0x72, 0x45, 0xac, 0xcc, 0x50,
+  0xae, 0xb1, 0xe9, 0x97, 0xc6, 0xba, 0xd6, 0x17, 0xb2, 0x84, 0xaa, 0x79, 0x4a, 0x17, 0x30, 0x65,
+  0x73, 0x29, 0x86, 0x4a, 0x1c, 0xab, 0x3d, 0x8d, 0xb1, 0x42, 0xd7, 0x6a, 0x8a, 0x8d, 0x5d, 0xf5,
+  0x4d, 0xee, 0x53, 0x33, 0x8f, 0xbe, 0x7b, 0x6d, 0xb5, 0xcb, 0xf2, 0x54, 0x98, 0x17, 0x92, 0x04,
+  0x87, 0xc9, 0x31, 0x5b, 0x8a, 0xc4, 0x4d, 0xb2, 0xba, 0x4e, 0x2a, 0xb2, 0xb6, 0xfd, 0xcd, 0xd4,
+  0x04, 0x33, 0x33, 0x24, 0xa5, 0x35, 0x7d, 0xe9, 0x4c, 0xef, 0x15, 0x12, 0xb5, 0xdb, 0x53, 0xaf,
+  0xce, 0x1d, 0x5b, 0x6d, 0x3f, 0x37, 0xcf, 0xba, 0x77, 0xb3, 0xad, 0x6a, 0xa8, 0x58, 0xd0, 0xfb,
+  0xe8, 0xcf, 0x3f, 0x51, 0x27, 0xe8, 0x5c, 0x3c, 0x95, 0x49, 0xb5, 0x8a, 0x76, 0x3b, 0x3b, 0x2d,
+  0xc4, 0x7f, 0xdb, 0xd6, 0x69, 0xf4, 0x07, 0x4a, 0xaa, 0xbd, 0x9c, 0x56, 0xd2, 0xef, 0xe7, 0x00,
+  0xdc, 0xfc, 0x11, 0xad, 0x88, 0x48, 0xf2, 0x78, 0x8c, 0x3a, 0xd7, 0xef, 0x6f, 0x6e, 0x61, 0x45,
+  0xbe, 0x53, 0x1a, 0xab, 0x88, 0xfc, 0xf0, 0xe3, 0xd5, 0x0d, 0x64, 0x93, 0x28, 0xb9, 0xc6, 0x0c,
+  0xaf, 0xb8, 0xff, 0xa8, 0x34, 0x39, 0x56, 0xbf, 0xa1, 0xce, 0xc0, 0xcf, 0xde, 0x2a, 0xe5, 0x74,
+  0x00, 0xae, 0x1a, 0x54, 0xfe, 0xeb, 0x9a, 0xfc, 0x77, 0x23, 0x7d, 0x0c, 0x3a, 0xab, 0xb9, 0x1e,
+  0xdc, 0xdf, 0xf5, 0xdf, 0x23, 0x81, 0xf9, 0xc7, 0x9e, 0xf4, 0x2c, 0x26, 0xc0, 0x09, 0xf1, 0x02,
+  0x52, 0x98, 0x2b, 0x58, 0x53, 0xa3, 0x87, 0x7b, 0x69, 0xfb, 0xfa, 0x05, 0xc2, 0x58, 0xfe, 0x47,
+  0x08, 0xf3, 0xf5, 0x3f, 0xa9, 0xe3, 0x54, 0x17, 0xe3, 0x31, 0x4c, 0x2e, 0x15, 0x1a, 0x59, 0xd4,
+  0x6d, 0x79, 0xd5, 0xe1, 0x03, 0x3e, 0x8f, 0x53, 0x02, 0xfa, 0xe4, 0x68, 0x5e, 0x32, 0x2e, 0xf8,
+  0x33, 0x8b, 0x3e, 0xa8, 0xe9, 0x37, 0x40, 0xff, 0x9b, 0xc5, 0xed, 0xd4, 0xff, 0x2f, 0xed, 0xe2,
+  0xb4, 0x49, 0xfc, 0x39, 0x0e, 0x23, 0x5f, 0x1b, 0xef, 0x3a, 0x4c, 0xac, 0x86, 0xd4, 0xe6, 0x94,
+  0x78, 0x70, 0x62, 0x03, 0x1e, 0x34, 0x23, 0x75, 0x5b, 0xd8, 0x9a, 0xda, 0xec, 0xfa, 0xee, 0x2c,
+  0x65, 0x5e, 0x56, 0x9a, 0x17, 0x09, 0x93, 0xbe, 0x7e, 0x49, 0x29, 0xdf, 0x5a, 0xaa, 0xff, 0x23,
+  0xf3, 0x6f, 0x27, 0x7f, 0xc6, 0x3e, 0x35, 0x23, 0x00, 0x00,
+};
+
+// LOGIN_HTML: 1814 bytes, 834 bytes gzipped
+const char LOGIN_HTML_ETAG[] = "\"0ae1ac40b290bdae\"";
+const char LOGIN_HTML_GZ_ETAG[] = "\"0ae1ac40b290bdae-gz\"";
+const uint8_t LOGIN_HTML_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x7d, 0x55, 0xdb, 0x8e, 0xdb, 0x36,
+  0x10, 0x7d, 0xf7, 0x57, 0x4c, 0x55, 0x04, 0xb6, 0x01, 0xeb, 0xe2, 0xdd, 0x04, 0xd8, 0x6a, 0x2d,
+  0x17, 0xbd, 0xec, 0x43, 0x80, 0x00, 0x31, 0xb2, 0x9b, 0x87, 0x3e, 0xd2, 0x24, 0x25, 0xb1, 0xa5,
+  0x48, 0x95, 0xa4, 0xec, 0x75, 0x8a, 0xfe, 0x7b, 0x46, 0x12, 0x25, 0xcb, 0x6b, 0xb7, 0x80, 0x6d,
+  0x51, 0x33, 0xc3, 0xe1, 0x9c, 0x33, 0x87, 0xe3, 0xd9, 0xe6, 0x87, 0xdf, 0x3f, 0xff, 0xf6, 0xf2,
+  0xc7, 0xee, 0x09, 0x4a, 0x57, 0xc9, 0xed, 0x6c, 0xd3, 0x3f, 0xf0, 0xc9, 0x09, 0xdb, 0xce, 0x00,
+  0x36, 0x4e, 0x38, 0xc9, 0xb7, 0x4f, 0xcf, 0xbb, 0xfb, 0x3b, 0xf8, 0xa4, 0x0b, 0xa1, 0x36, 0x71,
+  0x6f, 0x6a, 0x9d, 0x15, 0x77, 0x04, 0x14, 0xa9, 0x78, 0x16, 0x1c, 0x04, 0x3f, 0xd6, 0xda, 0xb8,
+  0x00, 0xa8, 0x56, 0x8e, 0x2b, 0x97, 0x05, 0x47, 0xc1, 0x5c, 0x99, 0x31, 0x7e, 0x10, 0x94, 0x87,
+  0xdd, 0xcb, 0x0a, 0x84, 0x12, 0x4e, 0x10, 0x19, 0x5a, 0x4a, 0x24, 0xcf, 0xd6, 0x41, 0x97, 0xc6,
+  0xba, 0x53, 0x9f, 0x10, 0x60, 0xaf, 0xd9, 0x09, 0xfe, 0xe9, 0x96, 0x00, 0x39, 0x66, 0x0a, 0x73,
+  0x52, 0x09, 0x79, 0x4a, 0xe1, 0x17, 0x83, 0xfb, 0x56, 0x60, 0x89, 0xb2, 0xa1, 0xe5, 0x46, 0xe4,
+  0x8f, 0x3e, 0x6a, 0x4f, 0xe8, 0x5f, 0x85, 0xd1, 0x8d, 0x62, 0x29, 0x98, 0x62, 0xbf, 0xf8, 0xb0,
+  0x5e, 0x41, 0xff, 0x5d, 0x0e, 0x21, 0x4c, 0xd8, 0x5a, 0x12, 0x4c, 0x92, 0x4b, 0xfe, 0x3a, 0x18,
+  0xff, 0x6c, 0xac, 0x13, 0xf9, 0x29, 0xf4, 0xf5, 0xa6, 0x40, 0xf1, 0x97, 0x9b, 0xc1, 0x4d, 0xa4,
+  0x28, 0x54, 0x28, 0x1c, 0xaf, 0xec, 0x5b, 0x57, 0xc9, 0x45, 0x51, 0xe2, 0x86, 0x75, 0x92, 0x1c,
+  0xca, 0xc1, 0x58, 0x11, 0x83, 0xec, 0xa4, 0x90, 0xf4, 0x86, 0x7f, 0x67, 0xdd, 0x23, 0x6a, 0xb3,
+  0x13, 0xa1, 0xb8, 0x19, 0x51, 0x4d, 0xeb, 0x3d, 0x96, 0x78, 0xc0, 0x90, 0xa1, 0x26, 0x8c, 0x09,
+  0x55, 0xa4, 0x70, 0x97, 0xd4, 0x63, 0x95, 0x7b, 0x6d, 0x18, 0x37, 0xa1, 0x21, 0x4c, 0x34, 0x58,
+  0xc8, 0xc3, 0xd4, 0xf3, 0x1a, 0xda, 0x92, 0x30, 0x7d, 0xc4, 0x43, 0xe1, 0x7d, 0xfd, 0xda, 0x3a,
+  0x5b, 0x06, 0xc8, 0x22, 0x59, 0x81, 0xff, 0x44, 0x77, 0x23, 0x09, 0x8e, 0xbf, 0xba, 0xb0, 0x43,
+  0xf5, 0x16, 0x4f, 0xd7, 0x9b, 0x14, 0xee, 0x93, 0xf1, 0x5c, 0x5f, 0x7d, 0xb9, 0x1e, 0xab, 0xa6,
+  0x5a, 0x6a, 0x93, 0xc2, 0x8f, 0x79, 0xfe, 0xf0, 0x90, 0x5c, 0x62, 0x14, 0xaa, 0x6e, 0xdc, 0x18,
+  0xe8, 0x93, 0x3d, 0x24, 0xef, 0xae, 0x70, 0xad, 0x27, 0xb8, 0x06, 0xba, 0x5a, 0xdb, 0xc0, 0xd9,
+  0x80, 0x16, 0xf1, 0x5c, 0x11, 0xb0, 0xd7, 0xce, 0xe9, 0x0a, 0xe3, 0x31, 0xdc, 0x6a, 0x29, 0xd8,
+  0xe3, 0x54, 0x24, 0x56, 0x7c, 0xe3, 0xe8, 0xe3, 0xd5, 0x75, 0x61, 0x69, 0xae, 0x69, 0x63, 0xc7,
+  0xf2, 0x74, 0xe3, 0x24, 0xb6, 0x23, 0x05, 0xa5, 0x15, 0xff, 0xaf, 0xe8, 0x34, 0x45, 0xb9, 0x50,
+  0x5e, 0x6a, 0xc9, 0x26, 0x8d, 0xf3, 0x14, 0x38, 0x83, 0x12, 0xac, 0x89, 0x41, 0x0a, 0x2f, 0xf6,
+  0xef, 0x1b, 0xac, 0x50, 0xdd, 0x68, 0x73, 0x78, 0xc1, 0xdd, 0xfa, 0xf1, 0x32, 0xdd, 0x6d, 0x09,
+  0x4c, 0xa9, 0xf2, 0x8c, 0xa2, 0xda, 0xde, 0xbd, 0xe5, 0xe9, 0x0c, 0xe2, 0x4a, 0x29, 0x1f, 0xce,
+  0x09, 0x68, 0x63, 0x6c, 0x7b, 0x54, 0xad, 0xc5, 0xb4, 0xed, 0xff, 0xc3, 0x5c, 0x8f, 0x25, 0x2d,
+  0xf5, 0xe1, 0xa6, 0x70, 0x27, 0x88, 0xc8, 0xfb, 0x7b, 0x76, 0xa9, 0xf8, 0x8a, 0x5b, 0x4b, 0x0a,
+  0xfe, 0x96, 0x36, 0xc3, 0x6f, 0xb5, 0x2c, 0x89, 0x7e, 0x3a, 0x1f, 0x8d, 0xa3, 0x20, 0xf6, 0xb3,
+  0x60, 0x13, 0xf7, 0x13, 0x68, 0xb6, 0x69, 0x27, 0x42, 0x37, 0x25, 0x98, 0x38, 0x00, 0x95, 0xc4,
+  0xda, 0x2c, 0x18, 0x2f, 0x55, 0xd0, 0x4f, 0x8d, 0x4d, 0xb9, 0xbe, 0x1c, 0x51, 0xf8, 0xde, 0x3b,
+  0x72, 0x6d, 0x2a, 0xc0, 0x31, 0x55, 0x6a, 0x96, 0x05, 0xbb, 0xcf, 0xcf, 0x2f, 0x01, 0x10, 0xea,
+  0x84, 0x56, 0x59, 0x10, 0xcb, 0x36, 0xd6, 0x67, 0xc0, 0xd0, 0x5e, 0xc6, 0xee, 0x54, 0xe3, 0x34,
+  0x6b, 0xef, 0x4a, 0xe0, 0x27, 0x5b, 0x83, 0xd3, 0xa6, 0x5d, 0x05, 0x30, 0x11, 0x45, 0x16, 0x7c,
+  0x1d, 0xcd, 0x86, 0xff, 0xdd, 0x08, 0x84, 0x77, 0x33, 0x53, 0x8d, 0x05, 0x1f, 0xb1, 0x33, 0x43,
+  0xb6, 0xf3, 0xfb, 0x45, 0xb6, 0xdd, 0x68, 0xbe, 0xca, 0xe6, 0x75, 0xd5, 0xa7, 0xb3, 0xcd, 0xbe,
+  0x12, 0x2e, 0xd8, 0x7a, 0x9c, 0xbd, 0xcf, 0x63, 0x8d, 0x5b, 0xb0, 0x7e, 0x5d, 0x0f, 0x54, 0xf9,
+  0x6e, 0x04, 0x20, 0xd8, 0xf9, 0x65, 0xbb, 0x89, 0xeb, 0x8e, 0xd3, 0x18, 0x49, 0xed, 0x47, 0x30,
+  0x35, 0xa2, 0x76, 0xfd, 0xe6, 0x38, 0x86, 0x97, 0x92, 0xa3, 0x16, 0xb1, 0x89, 0xc2, 0x82, 0x75,
+  0xc4, 0x09, 0xba, 0x02, 0x02, 0x39, 0x11, 0x92, 0x33, 0xe8, 0x78, 0x6b, 0xfb, 0x89, 0x65, 0x52,
+  0x67, 0x3b, 0x5d, 0xa0, 0x48, 0x5d, 0x09, 0x3f, 0x73, 0x63, 0xb4, 0xe9, 0x6f, 0x53, 0x0e, 0x0b,
+  0xc5, 0x8f, 0xf0, 0xf5, 0xcb, 0xa7, 0x67, 0x4e, 0x0c, 0x2d, 0x77, 0xc4, 0x90, 0xca, 0x2e, 0xa4,
+  0xa6, 0xa4, 0xe5, 0x3f, 0xb2, 0x9d, 0x75, 0x19, 0x95, 0xc4, 0x2e, 0xe6, 0xdd, 0xbe, 0xf9, 0x72,
+  0x39, 0x8a, 0x86, 0xe1, 0x35, 0xac, 0xf0, 0x86, 0x45, 0x05, 0x77, 0x4f, 0x92, 0xb7, 0xcb, 0x5f,
+  0x4f, 0x1f, 0xd9, 0x62, 0xee, 0x21, 0xcc, 0x97, 0x91, 0x50, 0x28, 0x80, 0x17, 0x6c, 0x14, 0x64,
+  0x30, 0xff, 0xa8, 0x0e, 0x38, 0xda, 0x18, 0x50, 0x2c, 0x0b, 0x63, 0xf1, 0xaf, 0xc2, 0x46, 0xb0,
+  0x93, 0x9c, 0x58, 0x8e, 0x17, 0xf6, 0x04, 0xa4, 0x40, 0xbd, 0x44, 0xf3, 0x0b, 0xa5, 0x79, 0xc8,
+  0xc8, 0x62, 0x27, 0xb1, 0x56, 0x73, 0xdd, 0xbf, 0xdf, 0x77, 0x9a, 0x5b, 0xdd, 0xa1, 0x16, 0x07,
+  0x00, 0x00,
+};
+
+// SETTINGS_HTML: 5471 bytes, 1782 bytes gzipped
+const char SETTINGS_HTML_ETAG[] = "\"ef82a7731eafd51a\"";
+const char SETTINGS_HTML_GZ_ETAG[] = "\"ef82a7731eafd51a-gz\"";
+const uint8_t SETTINGS_HTML_GZ[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xc5, 0x58, 0x6d, 0x73, 0xdb, 0xb8,
+  0x11, 0xfe, 0xee, 0x5f, 0xb1, 0xc7, 0xf6, 0x46, 0xd2, 0x8c, 0xa8, 0x17, 0x27, 0x6e, 0x5d, 0x49,
+  0x54, 0xe7, 0x72, 0x49, 0xa6, 0x99, 0x5e, 0x13, 0x77, 0xec, 0xcc, 0x4d, 0x3f, 0xe5, 0x20, 0x12,
+  0x14, 0x71, 0x21, 0x01, 0x1e, 0x00, 0x5a, 0x76, 0x33, 0xf9, 0xef, 0x5d, 0xbc, 0xf0, 0x55, 0x92,
+  0xf3, 0xf2, 0xa5, 0x33, 0xb6, 0x49, 0x2e, 0x80, 0x67, 0x77, 0x9f, 0x5d, 0x2c, 0x16, 0xbe, 0xd8,
+  0xfc, 0xf0, 0xf2, 0xdd, 0xcf, 0x77, 0xff, 0xb9, 0x79, 0x05, 0x99, 0x2e, 0xf2, 0xed, 0xc5, 0xc6,
+  0x3c, 0x20, 0x27, 0x7c, 0x1f, 0x05, 0x94, 0x07, 0xdb, 0x0b, 0x94, 0x50, 0x92, 0x6c, 0x2f, 0x00,
+  0x36, 0x05, 0xd5, 0x04, 0xe2, 0x8c, 0x48, 0x45, 0x75, 0x14, 0xbc, 0xbf, 0x7b, 0x1d, 0x5e, 0x07,
+  0xed, 0x00, 0x27, 0x05, 0x8d, 0x82, 0x7b, 0x46, 0x0f, 0xa5, 0x90, 0x3a, 0x80, 0x58, 0x70, 0x4d,
+  0x39, 0x4e, 0x3c, 0xb0, 0x44, 0x67, 0x51, 0x42, 0xef, 0x59, 0x4c, 0x43, 0xfb, 0x31, 0x05, 0xc6,
+  0x99, 0x66, 0x24, 0x0f, 0x55, 0x4c, 0x72, 0x1a, 0x2d, 0x67, 0x0b, 0x07, 0xa4, 0x99, 0xce, 0xe9,
+  0xf6, 0xd5, 0xed, 0xcd, 0xb3, 0x4b, 0xb8, 0xa5, 0x5a, 0x33, 0xbe, 0x57, 0x9b, 0xb9, 0x93, 0x9a,
+  0x71, 0xa5, 0x1f, 0xdd, 0x1b, 0xc0, 0x4e, 0x24, 0x8f, 0xf0, 0xc9, 0xbe, 0x02, 0xa4, 0xa8, 0x2b,
+  0x4c, 0x49, 0xc1, 0xf2, 0xc7, 0x15, 0xfc, 0x24, 0x11, 0x79, 0x0a, 0x8a, 0x70, 0x15, 0x2a, 0x2a,
+  0x59, 0xba, 0xf6, 0xb3, 0x76, 0x24, 0xfe, 0xb8, 0x97, 0xa2, 0xe2, 0xc9, 0x0a, 0xe4, 0x7e, 0x37,
+  0xbe, 0x5a, 0x4e, 0xc1, 0xfd, 0x4e, 0xea, 0x29, 0x25, 0x49, 0x12, 0x54, 0xba, 0x82, 0x45, 0x2d,
+  0x29, 0x88, 0xdc, 0x33, 0xde, 0x11, 0x24, 0x4c, 0x95, 0x39, 0x41, 0x3d, 0x69, 0x4e, 0x1f, 0x6a,
+  0xa1, 0x79, 0x0f, 0x13, 0x26, 0x69, 0xac, 0x99, 0xc0, 0xd9, 0xb1, 0xc8, 0xab, 0x82, 0xd7, 0xa3,
+  0x24, 0x67, 0x7b, 0x1e, 0x32, 0x4d, 0x0b, 0x85, 0x43, 0x48, 0x0a, 0x95, 0xf5, 0x50, 0x46, 0xd9,
+  0x3e, 0xd3, 0x2b, 0x58, 0x2e, 0x16, 0xf7, 0x99, 0x13, 0x7e, 0xbe, 0xb0, 0x8f, 0x19, 0x27, 0xf7,
+  0x8d, 0x83, 0x5d, 0xd3, 0xff, 0x94, 0xa6, 0xd7, 0xd7, 0x8b, 0x65, 0x8d, 0x80, 0xaa, 0x84, 0x5c,
+  0xc1, 0x21, 0x43, 0xfc, 0x5a, 0x66, 0x59, 0x5e, 0xc1, 0xdf, 0x16, 0x3f, 0xb6, 0x6e, 0x3c, 0x84,
+  0x5e, 0xfa, 0xd7, 0xcb, 0x45, 0xf9, 0x70, 0xe4, 0xf0, 0x12, 0x85, 0xd0, 0x1d, 0xf9, 0x3a, 0xc7,
+  0x7f, 0xaf, 0x94, 0x66, 0xe9, 0x63, 0xe8, 0xa3, 0xbd, 0x02, 0x55, 0x12, 0x0c, 0xf3, 0x8e, 0xea,
+  0x03, 0xa5, 0x5f, 0x43, 0xc0, 0x4e, 0x3c, 0x84, 0x2a, 0x23, 0x89, 0x38, 0xa0, 0x2a, 0xb8, 0x44,
+  0x23, 0x9e, 0xe3, 0x2f, 0x86, 0x87, 0x8c, 0x17, 0x53, 0xf0, 0x3f, 0xb3, 0xcb, 0x26, 0x42, 0x36,
+  0xd4, 0x8a, 0xfd, 0x97, 0xa2, 0xc9, 0xb3, 0x4b, 0x5a, 0xf4, 0xe4, 0x07, 0xcf, 0xe6, 0x4e, 0xe4,
+  0xc9, 0x31, 0x99, 0xa4, 0xa1, 0xf3, 0x14, 0x67, 0x9a, 0x3e, 0xe8, 0x30, 0xa1, 0xb1, 0x90, 0xc4,
+  0xc5, 0x90, 0x0b, 0x4e, 0x8f, 0xc8, 0xb0, 0x3c, 0x9d, 0x80, 0x5e, 0x65, 0xe2, 0x9e, 0xca, 0x46,
+  0xc1, 0x11, 0x18, 0x46, 0x8e, 0xca, 0x9c, 0xd5, 0x88, 0xf5, 0x5a, 0x43, 0x1b, 0x41, 0xa9, 0x3c,
+  0x19, 0xe9, 0x9e, 0x7d, 0xce, 0x84, 0x50, 0x8b, 0x72, 0x05, 0x27, 0x23, 0xd8, 0x15, 0xee, 0x84,
+  0x44, 0x7d, 0xa1, 0x24, 0x09, 0xab, 0xd4, 0xaa, 0x63, 0x74, 0x2f, 0x13, 0x9e, 0x2f, 0x3a, 0x72,
+  0x2f, 0xc3, 0x44, 0xfc, 0xf1, 0x74, 0x6c, 0x4c, 0x5c, 0xae, 0x9f, 0x8c, 0x8d, 0xf5, 0xda, 0xc6,
+  0xba, 0x1f, 0x65, 0xef, 0x6d, 0x76, 0x39, 0x0c, 0xc0, 0x20, 0x95, 0xbf, 0xb0, 0x3e, 0x27, 0x3b,
+  0x9a, 0x37, 0x10, 0x4d, 0x3a, 0xee, 0x72, 0x11, 0x7f, 0x1c, 0xb0, 0xb4, 0x13, 0x5a, 0x8b, 0x62,
+  0x05, 0x57, 0xad, 0x7f, 0x67, 0x12, 0xa4, 0xaf, 0x55, 0x69, 0x22, 0xf5, 0x00, 0x2b, 0xa7, 0x29,
+  0xae, 0x78, 0x36, 0x8c, 0x3b, 0xe3, 0x65, 0xa5, 0x1b, 0x6b, 0x3c, 0x7b, 0xd7, 0xdd, 0x1d, 0xd7,
+  0xb3, 0x64, 0x79, 0x75, 0x66, 0xd3, 0xf5, 0x43, 0x86, 0x44, 0x1f, 0x45, 0xb1, 0x81, 0x40, 0xf2,
+  0x95, 0xc8, 0x59, 0x72, 0x6a, 0x2f, 0xd4, 0x3b, 0xa1, 0x6b, 0xdd, 0x2a, 0x15, 0x71, 0xa5, 0x1a,
+  0x1b, 0x45, 0xa5, 0x4d, 0x06, 0x76, 0x33, 0xfb, 0x78, 0xf6, 0x6a, 0x85, 0xac, 0xc6, 0x34, 0x43,
+  0x82, 0x3a, 0x59, 0xe9, 0xe3, 0xa5, 0x25, 0x16, 0xd5, 0x92, 0x48, 0x8c, 0x4d, 0x6f, 0xfd, 0xae,
+  0x42, 0x0b, 0xf9, 0xf7, 0x56, 0xab, 0x93, 0x74, 0x0c, 0xe9, 0x3b, 0xc1, 0x54, 0x77, 0x83, 0x0e,
+  0x12, 0xbe, 0x43, 0x76, 0x5c, 0x49, 0x65, 0x54, 0x96, 0x82, 0x75, 0xeb, 0xce, 0x89, 0x74, 0x7f,
+  0x82, 0x4e, 0xe7, 0xe0, 0x60, 0x93, 0xb7, 0x6e, 0x86, 0x6d, 0x3e, 0x93, 0xe7, 0xcf, 0xfa, 0xa5,
+  0x27, 0x6b, 0x17, 0xd4, 0x55, 0xc4, 0xe4, 0x12, 0x0c, 0xf3, 0x49, 0xd1, 0x1c, 0x4f, 0x8f, 0xa3,
+  0x84, 0xba, 0xfa, 0x7f, 0x27, 0xd4, 0x19, 0x3f, 0xd3, 0xda, 0x78, 0x3c, 0x96, 0xe7, 0xfe, 0x5c,
+  0xde, 0xcc, 0x5d, 0xaf, 0x70, 0xb1, 0x31, 0xa7, 0xb3, 0x3d, 0xb1, 0x13, 0x76, 0x0f, 0x71, 0x4e,
+  0x94, 0x8a, 0x02, 0xac, 0x93, 0x81, 0x3b, 0xbb, 0x37, 0x98, 0x43, 0xfc, 0xe8, 0x98, 0xb7, 0x42,
+  0x37, 0x8e, 0xab, 0xb6, 0x5e, 0xf9, 0x86, 0x20, 0x83, 0x34, 0x8d, 0x82, 0x79, 0xb0, 0x7d, 0x49,
+  0x54, 0xb6, 0x13, 0x44, 0x26, 0x9b, 0x39, 0x39, 0x1e, 0x57, 0x1e, 0x29, 0xd8, 0xb6, 0x98, 0x27,
+  0xa6, 0xe5, 0x62, 0x8f, 0x1b, 0x21, 0xd8, 0xfe, 0x62, 0x9f, 0xcd, 0x94, 0xcd, 0xdc, 0x2b, 0x6d,
+  0x5f, 0x3a, 0xb6, 0x37, 0x75, 0xba, 0xf6, 0x20, 0xbb, 0x34, 0x00, 0x8c, 0x77, 0xec, 0x47, 0x91,
+  0x1b, 0x4b, 0x85, 0x2c, 0x80, 0xd8, 0x4e, 0x00, 0xf5, 0x55, 0x65, 0x42, 0x34, 0xfd, 0xd0, 0x58,
+  0x07, 0xd8, 0x2d, 0x65, 0x22, 0x89, 0x82, 0x9b, 0x77, 0xb7, 0x77, 0x41, 0x63, 0x9f, 0x2b, 0x6e,
+  0xb8, 0x34, 0x0a, 0x2a, 0xec, 0x5a, 0x4c, 0x37, 0x15, 0x6c, 0xdf, 0xfb, 0xb7, 0xd5, 0x66, 0x6e,
+  0xc7, 0x9b, 0xd9, 0xae, 0xf8, 0xe8, 0xc7, 0x12, 0x5b, 0x2e, 0x53, 0xbf, 0x02, 0x60, 0x49, 0x67,
+  0xa1, 0x6f, 0xc6, 0xda, 0xef, 0xce, 0x9e, 0xc6, 0xce, 0xad, 0xc1, 0xbf, 0x38, 0xa1, 0xbd, 0x44,
+  0x87, 0x0f, 0x98, 0x27, 0xc1, 0xf6, 0xc6, 0xbf, 0x3d, 0xa9, 0xbd, 0x99, 0x6e, 0x2d, 0x68, 0xbf,
+  0x9c, 0x05, 0xed, 0x77, 0xcf, 0x82, 0x9b, 0x46, 0x47, 0x63, 0x41, 0x26, 0x1b, 0x78, 0x24, 0xf2,
+  0x57, 0x96, 0xb2, 0x01, 0xb5, 0x27, 0x4c, 0x55, 0x8a, 0x21, 0xc4, 0xaf, 0xec, 0x35, 0xce, 0xbd,
+  0x7d, 0xf3, 0xb2, 0xb5, 0xb3, 0x9e, 0xeb, 0xf7, 0xd4, 0x90, 0x27, 0xbb, 0xce, 0x5b, 0xe8, 0xde,
+  0x13, 0x9a, 0x92, 0x2a, 0xc7, 0x66, 0xf5, 0x6d, 0x95, 0xe7, 0x4d, 0x50, 0x10, 0x41, 0x94, 0x26,
+  0x8c, 0x70, 0x4f, 0xf2, 0x8a, 0xd6, 0xa3, 0x61, 0x18, 0xc2, 0xcf, 0x99, 0x40, 0x76, 0xc1, 0xda,
+  0x09, 0x28, 0xd8, 0xcc, 0xdd, 0xcc, 0xc6, 0x89, 0xb9, 0xd3, 0x7d, 0xd2, 0xee, 0x03, 0xae, 0xfa,
+  0xd0, 0xf2, 0x6c, 0x1d, 0xf8, 0x0e, 0xb2, 0xfb, 0x30, 0xde, 0x9f, 0x81, 0xf0, 0xdb, 0x68, 0xff,
+  0x29, 0x8e, 0xa9, 0x52, 0x70, 0x63, 0x4a, 0xe5, 0x97, 0xe9, 0x27, 0xa5, 0x0b, 0x40, 0x7f, 0x55,
+  0x2f, 0x10, 0x4f, 0xa6, 0xab, 0x5f, 0xef, 0x0d, 0xaf, 0xbf, 0x7a, 0x16, 0x1b, 0xb4, 0xe0, 0x8c,
+  0xf2, 0x0e, 0x83, 0x3d, 0x0b, 0xbe, 0x83, 0xc9, 0x2e, 0x58, 0x63, 0xce, 0x77, 0xb3, 0xf8, 0xaf,
+  0x7f, 0xdf, 0xdd, 0x7d, 0x99, 0xbd, 0xe2, 0x0f, 0xad, 0x3f, 0x64, 0x42, 0x61, 0x29, 0x7a, 0x21,
+  0xc5, 0x47, 0x3c, 0x57, 0xc6, 0xb4, 0x28, 0xf5, 0x23, 0xe8, 0x4a, 0x72, 0x05, 0x16, 0x44, 0xa4,
+  0xe9, 0xe4, 0x2b, 0xc9, 0x6c, 0xe1, 0xbc, 0x03, 0x1d, 0x41, 0xcf, 0xfc, 0x7f, 0x58, 0x95, 0x67,
+  0x2d, 0xb2, 0x97, 0xb7, 0xed, 0x0d, 0xfe, 0x7d, 0x52, 0x31, 0xaf, 0x8a, 0x1d, 0x56, 0xc3, 0x56,
+  0xb5, 0xbb, 0xf4, 0x75, 0x54, 0x3b, 0x41, 0xc1, 0xb0, 0x06, 0x2e, 0x03, 0xd3, 0x75, 0x46, 0xc1,
+  0x5f, 0xae, 0xae, 0x9e, 0x5d, 0x3d, 0xa1, 0x1b, 0x7b, 0x5b, 0x16, 0x07, 0xdb, 0x3b, 0xf3, 0xf8,
+  0x16, 0xb7, 0xdd, 0xba, 0xae, 0x72, 0x8f, 0xd4, 0x68, 0xf2, 0x0d, 0x8a, 0x5b, 0xad, 0xaa, 0x5d,
+  0xc1, 0xd0, 0xc9, 0xf7, 0xb6, 0x32, 0x6f, 0xe6, 0x6e, 0xb0, 0x3e, 0x06, 0x4c, 0xf5, 0xee, 0x9f,
+  0x03, 0x2a, 0x96, 0xac, 0xd4, 0x6e, 0x7c, 0x3e, 0x87, 0xbb, 0x8c, 0xe2, 0x81, 0xbb, 0xa7, 0xc0,
+  0x94, 0xe9, 0x17, 0x35, 0x8b, 0xa7, 0xa6, 0xc9, 0x30, 0x4d, 0x91, 0xab, 0x13, 0x0a, 0x08, 0x4f,
+  0x00, 0xaf, 0xb6, 0x1c, 0x24, 0x55, 0x58, 0x56, 0x14, 0xb6, 0x3d, 0x05, 0x85, 0x54, 0x8a, 0x02,
+  0x9a, 0x63, 0xea, 0x03, 0x2a, 0x27, 0xae, 0xaf, 0xa5, 0x1a, 0x8c, 0xd5, 0xbf, 0x08, 0x92, 0xd0,
+  0x04, 0x22, 0x48, 0x49, 0xae, 0x7c, 0x67, 0x93, 0x56, 0xdc, 0x1e, 0x24, 0x90, 0xe3, 0x60, 0x9d,
+  0x53, 0xe3, 0x49, 0x7b, 0xf3, 0xa5, 0x3a, 0xce, 0xc6, 0xa3, 0x3e, 0xea, 0x68, 0xd2, 0x14, 0xb0,
+  0x99, 0xce, 0x28, 0x1f, 0xa3, 0x19, 0xa5, 0xe0, 0x58, 0xaf, 0xa2, 0x2d, 0xd4, 0xef, 0xb3, 0xdf,
+  0x95, 0xe0, 0xe3, 0xc9, 0x70, 0xaa, 0x59, 0x6f, 0xa6, 0x7d, 0x6a, 0xe4, 0xd8, 0x6a, 0x63, 0x63,
+  0x58, 0xa0, 0x7b, 0xb3, 0x3d, 0xd5, 0xaf, 0x72, 0x6a, 0x5e, 0x5f, 0x3c, 0xbe, 0x49, 0xc6, 0xa3,
+  0xfa, 0x80, 0x19, 0x4d, 0x66, 0xdd, 0xae, 0x31, 0x02, 0x83, 0x32, 0xab, 0x47, 0xd7, 0x1d, 0x28,
+  0x96, 0xc2, 0xf8, 0x87, 0xd6, 0xd9, 0x49, 0x4f, 0x8f, 0xa5, 0xf7, 0x35, 0xcb, 0x73, 0x64, 0x01,
+  0x8f, 0x56, 0xc1, 0x63, 0x3a, 0xc5, 0xae, 0x1f, 0xbb, 0x36, 0xb4, 0x3a, 0x45, 0xc3, 0x33, 0xe4,
+  0xf6, 0x20, 0xaa, 0x3c, 0x01, 0xd3, 0x88, 0x1d, 0x24, 0x36, 0x91, 0xc8, 0x35, 0xd0, 0x84, 0xe9,
+  0x1e, 0xcc, 0x59, 0x83, 0x9b, 0x4d, 0x81, 0x16, 0xdb, 0x58, 0xd5, 0xb6, 0x9a, 0x01, 0xb3, 0x33,
+  0xd6, 0xdf, 0x80, 0x63, 0x32, 0xfc, 0x14, 0x8e, 0xd9, 0x3c, 0xdf, 0x82, 0x63, 0x93, 0xf5, 0x14,
+  0x90, 0xdd, 0x08, 0x7d, 0xa4, 0x5e, 0x9e, 0x68, 0x59, 0xf5, 0xc8, 0xfd, 0x7c, 0xd1, 0xf9, 0xc0,
+  0x96, 0x45, 0xe9, 0xba, 0xab, 0x8c, 0xce, 0x9b, 0x60, 0xaa, 0xee, 0x68, 0xb2, 0x3e, 0x5a, 0x19,
+  0x23, 0x4d, 0x94, 0xe3, 0x4a, 0x07, 0x31, 0x73, 0x0f, 0x9a, 0xbc, 0xc1, 0x9b, 0xec, 0x03, 0x6c,
+  0xf1, 0x42, 0xf8, 0xf7, 0x7a, 0xc8, 0x19, 0xbe, 0x72, 0x86, 0x1b, 0xbc, 0x2e, 0x9a, 0x9f, 0x93,
+  0x53, 0xbe, 0xd7, 0x19, 0xc2, 0x2d, 0xd7, 0x36, 0xcc, 0xff, 0xa4, 0xb4, 0x04, 0xcc, 0x38, 0x08,
+  0x3a, 0x47, 0x69, 0x00, 0x68, 0x96, 0x7c, 0x1c, 0xe4, 0x8b, 0x83, 0xc5, 0xed, 0xc4, 0x31, 0xc3,
+  0x87, 0x19, 0xe3, 0xe1, 0xb1, 0x01, 0x1e, 0x73, 0x7a, 0x80, 0x77, 0xf6, 0x14, 0x1e, 0x8f, 0x6e,
+  0xfd, 0xf4, 0xd9, 0x6c, 0x36, 0x9a, 0xc2, 0xc8, 0x1c, 0xdc, 0xa3, 0xc9, 0x64, 0x3d, 0x58, 0xaa,
+  0xef, 0x58, 0x41, 0xb1, 0x0b, 0x1c, 0x77, 0x77, 0xd7, 0x14, 0x6f, 0xd2, 0x8b, 0xc5, 0x64, 0xed,
+  0xb3, 0x51, 0x1a, 0x16, 0xcd, 0x5e, 0x56, 0x1a, 0x33, 0x13, 0x64, 0x65, 0x71, 0x7b, 0x40, 0x92,
+  0x9a, 0x9a, 0xdd, 0x8f, 0xc4, 0x09, 0x17, 0x38, 0xd5, 0x78, 0x6e, 0x7c, 0x54, 0x0d, 0x17, 0x51,
+  0x04, 0x8b, 0xaf, 0xf4, 0xe7, 0xad, 0x80, 0xb7, 0x7e, 0x39, 0xbc, 0x36, 0xad, 0xf8, 0x19, 0xaf,
+  0xba, 0x8a, 0xfb, 0x4a, 0xb1, 0xae, 0xbd, 0x22, 0x58, 0x2b, 0xbc, 0x60, 0xb8, 0xc7, 0xeb, 0xb0,
+  0xfb, 0x86, 0x27, 0x82, 0x8e, 0xf6, 0xdf, 0xfe, 0xfc, 0xc9, 0xaf, 0xb2, 0xd1, 0xfd, 0x0c, 0xe3,
+  0x56, 0x20, 0x51, 0xf2, 0x39, 0x79, 0x31, 0xf9, 0x6d, 0x0a, 0xdd, 0x39, 0x03, 0xaa, 0x1d, 0x6a,
+  0x93, 0x43, 0x16, 0xbe, 0x9d, 0x6c, 0x99, 0x70, 0xf9, 0xb6, 0x3e, 0x47, 0x86, 0x43, 0xe8, 0xfb,
+  0xda, 0xf9, 0xaa, 0xdf, 0x9d, 0xff, 0xfd, 0x62, 0xb9, 0xf6, 0xf7, 0x2b, 0xfd, 0xc6, 0x5c, 0x00,
+  0x31, 0x59, 0x07, 0xe1, 0x5e, 0x5e, 0xb5, 0xf1, 0x36, 0x69, 0xa9, 0x6c, 0x5e, 0xba, 0x7f, 0x58,
+  0x42, 0x9d, 0x77, 0xe6, 0xca, 0x9a, 0x53, 0x3b, 0x52, 0x17, 0x7f, 0x51, 0x52, 0xee, 0xae, 0x3f,
+  0xfe, 0x80, 0xc0, 0xa3, 0xc4, 0xde, 0x7b, 0xcc, 0x45, 0xc8, 0xfe, 0x37, 0xf5, 0x7f, 0x63, 0x86,
+  0x9e, 0x59, 0x5f, 0x15, 0x00, 0x00,
+};
+
+#endif  // HTML_PAGES_GZ_H
\ No newline at end of file
@@ -0,0 +1,156 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Arduino.h>
+
+// Streaming JSON writer
+//
+// Writes straight to any Print (a pooled response body, or a JsonBuffer on
+// the stack) without building temporary Strings. Commas are tracked per
+// nesting level, strings are escaped as they are written.
+
+#define JSON_MAX_DEPTH 16
+
+// Fixed-size Print target, output that doesn't fit is dropped and flagged
+template <size_t N>
+class JsonBuffer : public Print {
+public:
+  JsonBuffer() : _length(0), _overflow(false) { _buffer[0] = '\0'; }
+
+  size_t write(uint8_t c) override {
+    if (_length + 1 >= N) {
+      _overflow = true;
+      return 0;
+    }
+    _buffer[_length++] = c;
+    _buffer[_length] = '\0';
+    return 1;
+  }
+
+  const char *c_str() const { return _buffer; }
+  size_t length() const { return _length; }
+  bool overflow() const { return _overflow; }
+
+private:
+  char _buffer[N];
+  size_t _length;
+  bool _overflow;
+};
+
+class JsonWriter {
+public:
+  explicit JsonWriter(Print &out) : _out(out), _depth(0), _hasValue(0), _afterKey(false) {}
+
+  void beginObject() { open('{'); }
+  void endObject() { close('}'); }
+  void beginArray() { open('['); }
+  void endArray() { close(']'); }
+
+  void key(const char *name) {
+    separate();
+    writeString(name);
+    _out.write(':');
+    _afterKey = true;
+  }
+
+  void value(const char *text) {
+    separate();
+    if (text) writeString(text);
+    else _out.print("null");
+  }
+
+  void value(bool flag) {
+    separate();
+    _out.print(flag ? "true" : "false");
+  }
+
+  void value(int number) { value((long)number); }
+  void value(unsigned int number) { value((unsigned long)number); }
+
+  void value(long number) {
+    char text[24];
+    snprintf(text, sizeof(text), "%ld", number);
+    separate();
+    _out.print(text);
+  }
+
+  void value(unsigned long number) {
+    char text[24];
+    snprintf(text, sizeof(text), "%lu", number);
+    separate();
+    _out.print(text);
+  }
+
+  // NaN and infinity have no JSON representation and are written as null
+  void value(double number, int decimals) {
+    separate();
+    if (isnan(number) || isinf(number)) {
+      _out.print("null");
+      return;
+    }
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", decimals, number);
+    _out.print(text);
+  }
+
+  // Shorthands for "key": value
+  template <typename T>
+  void field(const char *name, T v) {
+    key(name);
+    value(v);
+  }
+
+  void field(const char *name, double number, int decimals) {
+    key(name);
+    value(number, decimals);
+  }
+
+private:
+  void open(char bracket) {
+    separate();
+    _out.write(bracket);
+    if (_depth < JSON_MAX_DEPTH) _depth++;
+    _hasValue &= ~(1UL << _depth);
+  }
+
+  void close(char bracket) {
+    _out.write(bracket);
+    if (_depth > 0) _depth--;
+    _hasValue |= 1UL << _depth;
+  }
+
+  // Comma before every element except the first one of a level
+  void separate() {
+    if (_afterKey) {
+      _afterKey = false;
+      return;
+    }
+    if (_hasValue & (1UL << _depth)) _out.write(',');
+    _hasValue |= 1UL << _depth;
+  }
+
+  void writeString(const char *text) {
+    _out.write('"');
+    for (const char *p = text; *p; p++) {
+      char c = *p;
+      if (c == '"' || c == '\\') {
+        _out.write('\\');
+        _out.write(c);
+      } else if ((uint8_t)c < 0x20) {
+        char code[7];
+        snprintf(code, sizeof(code), "\\u%04x", c);
+        _out.print(code);
+      } else {
+        _out.write(c);
+      }
+    }
+    _out.write('"');
+  }
+
+  Print &_out;
+  uint8_t _depth;
+  uint32_t _hasValue;  // Bit per nesting level: something was already written
+  bool _afterKey;
+};
+
+#endif  // JSON_WRITER_H
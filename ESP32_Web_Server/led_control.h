@@ -0,0 +1,208 @@
+#ifndef LED_CONTROL_H
+#define LED_CONTROL_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "led_driver.h"
+#include "scenes.h"
+#include "snapshot.h"
+#include "spsc_queue.h"
+
+// The I/O task owns led_driver.h and scenes.h. Web handlers send it
+// commands and read the LED state from ledSnapshot.
+//
+// Slider intensities don't go through the queue: each LED has a mailbox
+// holding only the latest value, so a burst of slider changes never fills
+// the queue and the task applies just the last one.
+
+enum LedCommandType : uint8_t {
+  LED_COMMAND_TOGGLE,
+  LED_COMMAND_FADE,             // Set led to level over fadeMs
+  LED_COMMAND_SCENE,            // Play scene, or stop with SCENE_NONE
+  LED_COMMAND_SCHEDULE,         // Add schedule id
+  LED_COMMAND_CANCEL_SCHEDULE,  // Remove schedule id
+};
+
+struct LedCommand {
+  LedCommandType type;
+  uint8_t led;  // 1-based
+  uint8_t level;
+  int8_t scene;
+  uint16_t scheduleId;
+  uint32_t fadeMs;
+  uint32_t delayMs;
+  uint32_t repeatMs;
+};
+
+// Everything the web side shows about the LEDs
+struct LedSnapshot {
+  bool on[LED_COUNT];
+  uint8_t level[LED_COUNT];
+  int8_t activeScene;
+  SceneSchedule schedules[SCHEDULE_CAPACITY];
+  uint32_t schedulesAdded;  // LED_COMMAND_SCHEDULE commands processed
+  unsigned long version;    // ledVersion at the time of the snapshot
+};
+
+#define LED_MAILBOX_EMPTY -1
+
+SpscQueue<LedCommand, 16> ledCommands;  // From the web handlers and /ws
+std::atomic<int16_t> ledIntensityMailbox[LED_COUNT];
+Snapshot<LedSnapshot> ledSnapshot;
+
+// Web side bookkeeping
+uint16_t lastScheduleId = 0;
+uint32_t schedulesSent = 0;
+
+// I/O task side
+uint32_t schedulesAdded = 0;
+
+LedSnapshot readLEDSnapshot() {
+  LedSnapshot snapshot;
+  ledSnapshot.read(snapshot);
+  return snapshot;
+}
+
+//////////////////////// Web side ////////////////////////
+
+bool sendLEDCommand(const LedCommand &command) {
+  return ledCommands.push(command);
+}
+
+// Toggle an LED, returns false if the queue is full
+bool queueLEDToggle(uint8_t led) {
+  LedCommand command = {};
+  command.type = LED_COMMAND_TOGGLE;
+  command.led = led;
+  return sendLEDCommand(command);
+}
+
+bool queueLEDFade(uint8_t led, uint8_t level, uint32_t fadeMs) {
+  LedCommand command = {};
+  command.type = LED_COMMAND_FADE;
+  command.led = led;
+  command.level = level;
+  command.fadeMs = fadeMs;
+  return sendLEDCommand(command);
+}
+
+// Latest slider value for an LED, replaces one not yet applied
+void postLEDIntensity(uint8_t led, uint8_t level) {
+  ledIntensityMailbox[led - 1].store(level, std::memory_order_release);
+}
+
+bool queueScene(int8_t scene) {
+  LedCommand command = {};
+  command.type = LED_COMMAND_SCENE;
+  command.scene = scene;
+  return sendLEDCommand(command);
+}
+
+// Add a schedule, returns its ID or 0 if the table or the queue is full.
+// Schedules still in the queue count as taken, so the answer is exact
+// except that a one-shot schedule may have just run.
+uint16_t queueSceneSchedule(int8_t scene, uint32_t delayMs, uint32_t repeatMs) {
+  LedSnapshot snapshot = readLEDSnapshot();
+  uint32_t used = schedulesSent - snapshot.schedulesAdded;
+  for (uint8_t i = 0; i < SCHEDULE_CAPACITY; i++) {
+    if (snapshot.schedules[i].scene >= 0) used++;
+  }
+  if (used >= SCHEDULE_CAPACITY) return 0;
+
+  uint16_t id = lastScheduleId + 1;
+  if (id == 0) id = 1;  // 0 means no schedule
+
+  LedCommand command = {};
+  command.type = LED_COMMAND_SCHEDULE;
+  command.scene = scene;
+  command.scheduleId = id;
+  command.delayMs = delayMs;
+  command.repeatMs = repeatMs;
+  if (!sendLEDCommand(command)) return 0;
+
+  lastScheduleId = id;
+  schedulesSent++;
+  return id;
+}
+
+// Remove a schedule, returns false if there is no such schedule
+bool queueCancelSchedule(uint16_t id) {
+  LedSnapshot snapshot = readLEDSnapshot();
+  bool found = false;
+  for (uint8_t i = 0; i < SCHEDULE_CAPACITY; i++) {
+    if (snapshot.schedules[i].scene >= 0 && snapshot.schedules[i].id == id) found = true;
+  }
+  if (!found) return false;
+
+  LedCommand command = {};
+  command.type = LED_COMMAND_CANCEL_SCHEDULE;
+  command.scheduleId = id;
+  return sendLEDCommand(command);
+}
+
+//////////////////////// I/O task side ////////////////////////
+
+void runLEDCommand(const LedCommand &command) {
+  LedChannel *channel = ledChannel(command.led);
+
+  switch (command.type) {
+    case LED_COMMAND_TOGGLE:
+      if (!channel) break;
+      playScene(SCENE_NONE);  // A manual command stops the playing scene
+      setLEDOutput(*channel, !channel->on, channel->level ? channel->level : 255, 0);  // Switching on at level 0 would stay dark
+      break;
+
+    case LED_COMMAND_FADE:
+      if (!channel) break;
+      playScene(SCENE_NONE);
+      setLEDOutput(*channel, command.level > 0, command.level, command.fadeMs);
+      break;
+
+    case LED_COMMAND_SCENE:
+      playScene(command.scene);
+      break;
+
+    case LED_COMMAND_SCHEDULE:
+      addSceneSchedule(command.scheduleId, command.scene, command.delayMs, command.repeatMs);
+      schedulesAdded++;
+      break;
+
+    case LED_COMMAND_CANCEL_SCHEDULE:
+      cancelSceneSchedule(command.scheduleId);
+      break;
+  }
+}
+
+// Apply queued commands, then the latest slider values
+void processLEDCommands() {
+  LedCommand command;
+  while (ledCommands.pop(command)) runLEDCommand(command);
+
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    int16_t level = ledIntensityMailbox[i].exchange(LED_MAILBOX_EMPTY, std::memory_order_acquire);
+    if (level == LED_MAILBOX_EMPTY) continue;
+    playScene(SCENE_NONE);
+    setLEDOutput(ledChannels[i], level > 0, level, 0);
+  }
+}
+
+// A few dozen bytes, cheap enough to publish on every tick
+void publishLEDSnapshot() {
+  LedSnapshot snapshot;
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    snapshot.on[i] = ledChannels[i].on;
+    snapshot.level[i] = ledChannels[i].level;
+  }
+  snapshot.activeScene = activeScene;
+  memcpy(snapshot.schedules, sceneSchedules, sizeof(sceneSchedules));
+  snapshot.schedulesAdded = schedulesAdded;
+  snapshot.version = ledVersion;
+  ledSnapshot.publish(snapshot);
+}
+
+void setupLEDControl() {
+  for (uint8_t i = 0; i < LED_COUNT; i++) ledIntensityMailbox[i].store(LED_MAILBOX_EMPTY);
+  publishLEDSnapshot();
+}
+
+#endif  // LED_CONTROL_H
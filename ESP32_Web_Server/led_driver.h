@@ -0,0 +1,145 @@
+#ifndef LED_DRIVER_H
+#define LED_DRIVER_H
+
+#include <Arduino.h>
+#include <driver/ledc.h>
+#include <math.h>
+
+// Output pins, one LEDC channel each: LED 1 is the first pin
+const uint8_t LED_PINS[] = { 26, 27 };
+#define LED_COUNT (sizeof(LED_PINS) / sizeof(LED_PINS[0]))
+
+// Channels 0-7 are the high speed group ledcSetup() puts them in
+static_assert(LED_COUNT <= 8, "Only 8 high speed LEDC channels");
+
+// 12-bit duty at 5 kHz, levels 0-255 are mapped onto it through the gamma table
+#define LED_PWM_FREQUENCY 5000
+#define LED_PWM_BITS 12
+#define LED_PWM_MAX ((1 << LED_PWM_BITS) - 1)
+#define LED_GAMMA 2.2f
+
+// Long fades run as hardware fades of this length, each between two points
+// of the gamma curve. A new change waits at most this long for the hardware.
+#define LED_FADE_SEGMENT_MS 250
+
+struct LedChannel {
+  // Requested state, set by the commands
+  bool on;
+  uint8_t level;   // Brightness used while on
+  uint32_t fadeMs; // Fade to the requested state, 0 to switch at once
+  bool dirty;      // Not yet picked up by updateLEDs()
+
+  // Output side, only touched by updateLEDs()
+  uint8_t outputLevel;  // Level the output is at, or heading to in the running segment
+  uint8_t fadeFrom;
+  uint8_t fadeTo;
+  unsigned long fadeStart;
+  uint32_t fadeDuration;  // 0 when no fade is running
+  unsigned long segmentStart;
+  uint32_t segmentMs;     // Running hardware fade, 0 when the channel is idle
+};
+
+// Only touched from the I/O task, other tasks go through led_control.h
+LedChannel ledChannels[LED_COUNT];
+uint16_t ledGamma[256];
+unsigned long ledVersion = 0;  // Bumped whenever an LED's requested state changes
+
+// Hardware access. These are the only LEDC calls, so a host stand-in can
+// replace them to record the PWM timeline.
+void pwmAttach(uint8_t channel, uint8_t pin) {
+  ledcSetup(channel, LED_PWM_FREQUENCY, LED_PWM_BITS);
+  ledcAttachPin(pin, channel);
+}
+
+void pwmWrite(uint8_t channel, uint32_t duty) {
+  ledcWrite(channel, duty);
+}
+
+void pwmFade(uint8_t channel, uint32_t duty, uint32_t durationMs) {
+  ledc_set_fade_with_time(LEDC_HIGH_SPEED_MODE, (ledc_channel_t)channel, duty, durationMs);
+  ledc_fade_start(LEDC_HIGH_SPEED_MODE, (ledc_channel_t)channel, LEDC_FADE_NO_WAIT);
+}
+
+// LED by its 1-based number, nullptr if there is no such LED
+LedChannel *ledChannel(int led) {
+  return led >= 1 && led <= (int)LED_COUNT ? &ledChannels[led - 1] : nullptr;
+}
+
+// Request a new state, the output follows from updateLEDs()
+void setLEDOutput(LedChannel &channel, bool on, uint8_t level, uint32_t fadeMs) {
+  channel.on = on;
+  channel.level = level;
+  channel.fadeMs = fadeMs;
+  channel.dirty = true;
+  ledVersion++;
+}
+
+// Start the next hardware segment of a running fade
+void startFadeSegment(uint8_t index, unsigned long now) {
+  LedChannel &channel = ledChannels[index];
+  uint32_t elapsed = now - channel.fadeStart;
+  if (elapsed > channel.fadeDuration) elapsed = channel.fadeDuration;
+  uint32_t segmentEnd = elapsed + LED_FADE_SEGMENT_MS;
+  if (segmentEnd > channel.fadeDuration) segmentEnd = channel.fadeDuration;
+
+  int span = (int)channel.fadeTo - channel.fadeFrom;
+  uint8_t next = channel.fadeFrom + (int64_t)span * segmentEnd / channel.fadeDuration;
+  uint32_t segmentMs = segmentEnd - elapsed;
+
+  if (ledGamma[next] != ledGamma[channel.outputLevel]) {
+    if (segmentMs > 0) {
+      pwmFade(index, ledGamma[next], segmentMs);
+    } else {
+      pwmWrite(index, ledGamma[next]);
+    }
+  }
+  channel.outputLevel = next;
+  channel.segmentStart = now;
+  channel.segmentMs = segmentMs;
+  if (segmentEnd == channel.fadeDuration) channel.fadeDuration = 0;
+}
+
+// Called from the I/O task: moves the outputs towards the requested states
+void updateLEDs() {
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    LedChannel &channel = ledChannels[i];
+
+    // The hardware takes no new duty while a fade runs
+    if (channel.segmentMs && now - channel.segmentStart < channel.segmentMs) continue;
+    channel.segmentMs = 0;
+
+    if (channel.dirty) {
+      channel.dirty = false;
+      uint8_t target = channel.on ? channel.level : 0;
+      if (channel.fadeMs == 0) {
+        channel.fadeDuration = 0;
+        if (ledGamma[target] != ledGamma[channel.outputLevel]) pwmWrite(i, ledGamma[target]);
+        channel.outputLevel = target;
+        continue;
+      }
+      channel.fadeFrom = channel.outputLevel;
+      channel.fadeTo = target;
+      channel.fadeStart = now;
+      channel.fadeDuration = channel.fadeMs;
+    }
+
+    if (channel.fadeDuration) startFadeSegment(i, now);
+  }
+}
+
+void setupLEDs() {
+  for (int i = 0; i < 256; i++) {
+    ledGamma[i] = lroundf(powf(i / 255.0f, LED_GAMMA) * LED_PWM_MAX);
+  }
+
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    ledChannels[i] = {};
+    ledChannels[i].level = 255;  // Switching on without a level gives full brightness
+    pwmAttach(i, LED_PINS[i]);
+    pwmWrite(i, 0);
+  }
+  ledc_fade_func_install(0);
+}
+
+#endif  // LED_DRIVER_H
@@ -0,0 +1,147 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <ESPAsyncWebServer.h>
+#include <atomic>
+#include "buffer_pool.h"
+#include "route_table.h"
+
+// Per-route request metrics
+//
+// dispatchRoute() in router.h times the synchronous part of each handler
+// (the time it holds the AsyncTCP task) and counts the status noted by
+// noteResponseStatus(). All counters are 32-bit relaxed atomics in static
+// arrays indexed like the route table, so recording never locks or allocates.
+
+// Histogram bucket upper bounds in microseconds, the last bucket is +Inf
+#define LATENCY_BUCKETS 10
+const uint32_t LATENCY_BOUNDS_US[LATENCY_BUCKETS - 1] = { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000 };
+const char *LATENCY_BOUNDS_LABELS[LATENCY_BUCKETS] = {
+  "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005", "0.01", "0.025", "0.05", "+Inf"
+};
+
+// Status classes 1xx..5xx
+#define STATUS_CLASSES 5
+
+struct RouteMetrics {
+  std::atomic<uint32_t> statuses[STATUS_CLASSES];
+  std::atomic<uint32_t> latency[LATENCY_BUCKETS];  // Non-cumulative, summed when exported
+  std::atomic<uint32_t> latencySumUs;              // Wraps, scrapers treat that as a reset
+};
+
+RouteMetrics routeMetrics[MAX_ROUTES];
+
+// Status of the request being handled. AsyncTCP runs all handlers on one
+// task, so a single slot is enough.
+uint16_t currentResponseStatus = 200;
+
+// Record the status of a response sent by something other than a 200
+void noteResponseStatus(uint16_t status) {
+  currentResponseStatus = status;
+}
+
+void recordRequest(uint8_t route, uint16_t status, uint32_t elapsedUs) {
+  RouteMetrics &metrics = routeMetrics[route];
+
+  int statusClass = status / 100 - 1;
+  if (statusClass < 0 || statusClass >= STATUS_CLASSES) statusClass = STATUS_CLASSES - 1;
+  metrics.statuses[statusClass].fetch_add(1, std::memory_order_relaxed);
+
+  int bucket = 0;
+  while (bucket < LATENCY_BUCKETS - 1 && elapsedUs > LATENCY_BOUNDS_US[bucket]) bucket++;
+  metrics.latency[bucket].fetch_add(1, std::memory_order_relaxed);
+  metrics.latencySumUs.fetch_add(elapsedUs, std::memory_order_relaxed);
+}
+
+// Prometheus text format for the per-route metrics. With every route
+// seen that is tens of KB, so it is produced a line at a time while the
+// response is sent instead of being buffered.
+enum RouteMetricsSection : uint8_t {
+  ROUTE_METRICS_REQUESTS_HEADER,
+  ROUTE_METRICS_REQUESTS,   // item: status class
+  ROUTE_METRICS_LATENCY_HEADER,
+  ROUTE_METRICS_LATENCY,    // item: bucket, then the sum and the count
+  ROUTE_METRICS_DONE,
+};
+
+struct RouteMetricsCursor : LineSource {
+  RouteMetricsSection section = ROUTE_METRICS_REQUESTS_HEADER;
+  uint8_t route = 0;
+  uint8_t item = 0;
+
+  bool nextLine() override;
+};
+
+// Move to the next item of the current section, or its next route
+bool advanceRouteMetrics(RouteMetricsCursor &cursor, uint8_t items) {
+  if (++cursor.item < items) return true;
+  cursor.item = 0;
+  return ++cursor.route < routeCount;
+}
+
+uint32_t cumulativeLatency(uint8_t route, uint8_t lastBucket) {
+  uint32_t count = 0;
+  for (uint8_t b = 0; b <= lastBucket; b++) count += routeMetrics[route].latency[b].load(std::memory_order_relaxed);
+  return count;
+}
+
+bool RouteMetricsCursor::nextLine() {
+  while (section != ROUTE_METRICS_DONE) {
+    switch (section) {
+      case ROUTE_METRICS_REQUESTS_HEADER:
+        lineLen = snprintf(line, sizeof(line), "# HELP http_requests_total Requests handled, by route and status class.\n"
+                                               "# TYPE http_requests_total counter\n");
+        section = routeCount ? ROUTE_METRICS_REQUESTS : ROUTE_METRICS_LATENCY_HEADER;
+        return true;
+
+      case ROUTE_METRICS_REQUESTS: {
+        uint8_t r = route, c = item;
+        if (!advanceRouteMetrics(*this, STATUS_CLASSES)) {
+          section = ROUTE_METRICS_LATENCY_HEADER;
+          route = 0;
+        }
+        uint32_t count = routeMetrics[r].statuses[c].load(std::memory_order_relaxed);
+        if (count == 0) continue;
+        lineLen = snprintf(line, sizeof(line), "http_requests_total{route=\"%s\",method=\"%s\",code=\"%dxx\"} %lu\n",
+                           routeTable[r].path, routeMethodName(routeTable[r].method), c + 1, (unsigned long)count);
+        return true;
+      }
+
+      case ROUTE_METRICS_LATENCY_HEADER:
+        lineLen = snprintf(line, sizeof(line), "# HELP http_request_duration_seconds Time a handler held the network task.\n"
+                                               "# TYPE http_request_duration_seconds histogram\n");
+        section = routeCount ? ROUTE_METRICS_LATENCY : ROUTE_METRICS_DONE;
+        return true;
+
+      case ROUTE_METRICS_LATENCY: {
+        uint8_t r = route, b = item;
+        if (!advanceRouteMetrics(*this, LATENCY_BUCKETS + 2)) section = ROUTE_METRICS_DONE;
+        const char *path = routeTable[r].path;
+        const char *method = routeMethodName(routeTable[r].method);
+        if (b < LATENCY_BUCKETS) {
+          lineLen = snprintf(line, sizeof(line), "http_request_duration_seconds_bucket{route=\"%s\",method=\"%s\",le=\"%s\"} %lu\n",
+                             path, method, LATENCY_BOUNDS_LABELS[b], (unsigned long)cumulativeLatency(r, b));
+        } else if (b == LATENCY_BUCKETS) {
+          lineLen = snprintf(line, sizeof(line), "http_request_duration_seconds_sum{route=\"%s\",method=\"%s\"} %.6f\n",
+                             path, method, routeMetrics[r].latencySumUs.load(std::memory_order_relaxed) / 1e6);
+        } else {
+          lineLen = snprintf(line, sizeof(line), "http_request_duration_seconds_count{route=\"%s\",method=\"%s\"} %lu\n",
+                             path, method, (unsigned long)cumulativeLatency(r, LATENCY_BUCKETS - 1));
+        }
+        return true;
+      }
+
+      default:
+        break;
+    }
+  }
+  return false;
+}
+
+// One gauge or counter with its HELP and TYPE lines
+void writeMetric(Print &out, const char *name, const char *type, const char *help, double value) {
+  printTo(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+  printTo(out, "%s %.10g\n", name, value);
+}
+
+#endif  // METRICS_H
@@ -0,0 +1,263 @@
+#ifndef MQTT_H
+#define MQTT_H
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <WiFi.h>
+#include "config.h"
+#include "json_writer.h"
+#include "led_control.h"
+#include "sensors.h"
+#include "snapshot.h"
+
+// MQTT telemetry
+//
+// The mqtt task pushes the sensor readings and the LED state to a broker,
+// so a backend doesn't have to poll /sensor_data. Every new reading goes
+// into a ring buffer, and readings leave it MQTT_BATCH_SIZE at a time as
+// one message on <topic>/sensors. While the STA link or the broker is down
+// the ring keeps the newest MQTT_QUEUE_CAPACITY readings and drops the
+// oldest. After reconnecting the backlog goes out at most
+// MQTT_FLUSH_BATCHES messages per tick, and a publish the socket doesn't
+// take leaves the readings queued for the next tick.
+//
+// The LED state isn't queued, only the latest one matters: it is published
+// retained on <topic>/leds when it changed. <topic>/status is "online"
+// while connected and "offline" through the last will. The broker and topic
+// are settings, an empty broker host turns MQTT off.
+
+#define MQTT_QUEUE_CAPACITY 256       // Readings kept while offline, 20 bytes each
+#define MQTT_BATCH_SIZE 10            // Readings per message
+#define MQTT_BATCH_MAX_AGE_MS 30000   // Send a smaller batch once its oldest reading is this old
+#define MQTT_FLUSH_BATCHES 4          // Messages per tick while catching up
+#define MQTT_MESSAGE_SIZE 768         // Enough for MQTT_BATCH_SIZE readings of three values
+#define MQTT_LED_MIN_INTERVAL_MS 250  // A slider drag publishes a few states, not every step
+#define MQTT_RECONNECT_MIN_MS 2000
+#define MQTT_RECONNECT_MAX_MS 60000
+#define MQTT_KEEPALIVE_S 30
+#define MQTT_SOCKET_TIMEOUT_S 3       // Longest wait for the broker, holds only the mqtt task
+
+// One reading waiting to be sent
+struct TelemetrySample {
+  unsigned long timestamp;  // millis() of the read
+  uint8_t sensor;           // Index into SENSORS
+  float values[SENSOR_MAX_VALUES];
+};
+
+// Shown by /metrics
+struct MqttStats {
+  bool connected;
+  uint32_t queued;           // Readings waiting
+  uint32_t published;        // Sensor messages sent
+  uint32_t publishFailures;  // Publishes the socket didn't take
+  uint32_t dropped;          // Readings lost to a full queue
+  uint32_t connects;
+  uint32_t connectFailures;
+};
+
+WiFiClient mqttSocket;
+PubSubClient mqttClient(mqttSocket);
+Snapshot<MqttStats> mqttSnapshot;
+
+// Everything below is only touched from the mqtt task
+TelemetrySample mqttQueue[MQTT_QUEUE_CAPACITY];
+uint32_t mqttQueueHead = 0;   // Oldest reading
+uint32_t mqttQueueCount = 0;
+unsigned long mqttLastRead[SENSOR_COUNT];  // Timestamp of each sensor's last queued reading
+MqttStats mqttStats = {};
+
+// Broker in use, compared against the settings every tick
+char mqttHost[65] = "";
+char mqttTopic[65] = "";
+uint16_t mqttPort = 0;
+char mqttClientId[24];
+
+unsigned long mqttNextConnect = 0;
+unsigned long mqttBackoff = MQTT_RECONNECT_MIN_MS;
+unsigned long mqttLEDVersion = 0;   // LED state last published
+bool mqttLEDPublished = false;
+unsigned long mqttLEDPublishTime = 0;
+
+MqttStats readMqttSnapshot() {
+  MqttStats snapshot;
+  mqttSnapshot.read(snapshot);
+  return snapshot;
+}
+
+// <topic>/<name>
+void mqttTopicFor(char *buffer, size_t size, const char *name) {
+  snprintf(buffer, size, "%s/%s", mqttTopic, name);
+}
+
+// Queue the readings that came in since the last tick, dropping the oldest
+// ones when the queue is full
+void queueTelemetry() {
+  SensorSnapshot snapshot;
+  sensorSnapshot.read(snapshot);
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    const SensorReading &reading = snapshot.readings[i];
+    if (!reading.valid || reading.timestamp == mqttLastRead[i]) continue;
+    mqttLastRead[i] = reading.timestamp;
+
+    if (mqttQueueCount == MQTT_QUEUE_CAPACITY) {
+      mqttQueueHead = (mqttQueueHead + 1) % MQTT_QUEUE_CAPACITY;
+      mqttQueueCount--;
+      mqttStats.dropped++;
+    }
+    TelemetrySample &sample = mqttQueue[(mqttQueueHead + mqttQueueCount) % MQTT_QUEUE_CAPACITY];
+    sample.timestamp = reading.timestamp;
+    sample.sensor = i;
+    memcpy(sample.values, reading.values, sizeof(sample.values));
+    mqttQueueCount++;
+  }
+}
+
+// {"now":<millis>,"samples":[["DHT22",<millis>,21.5,40.2],...]}, the
+// backend dates each reading from its distance to now
+void writeTelemetryBatch(JsonWriter &json, uint32_t count) {
+  json.beginObject();
+  json.field("now", millis());
+  json.key("samples");
+  json.beginArray();
+  for (uint32_t n = 0; n < count; n++) {
+    const TelemetrySample &sample = mqttQueue[(mqttQueueHead + n) % MQTT_QUEUE_CAPACITY];
+    const SensorDriver &driver = *SENSORS[sample.sensor];
+    json.beginArray();
+    json.value(driver.name);
+    json.value(sample.timestamp);
+    for (uint8_t v = 0; v < driver.valueCount; v++) json.value(sample.values[v], driver.quantities[v].decimals);
+    json.endArray();
+  }
+  json.endArray();
+  json.endObject();
+}
+
+// Send full batches, or the batch whose oldest reading has waited long enough
+void flushTelemetry() {
+  char topic[80];
+  mqttTopicFor(topic, sizeof(topic), "sensors");
+
+  for (uint8_t sent = 0; sent < MQTT_FLUSH_BATCHES && mqttQueueCount > 0; sent++) {
+    bool full = mqttQueueCount >= MQTT_BATCH_SIZE;
+    if (!full && millis() - mqttQueue[mqttQueueHead].timestamp < MQTT_BATCH_MAX_AGE_MS) return;
+
+    uint32_t count = full ? MQTT_BATCH_SIZE : mqttQueueCount;
+    JsonBuffer<MQTT_MESSAGE_SIZE> message;
+    JsonWriter json(message);
+    writeTelemetryBatch(json, count);
+
+    if (message.overflow()) {
+      // Can't happen with the sizes above, but must not stall the queue
+      mqttStats.dropped += count;
+    } else if (!mqttClient.publish(topic, message.c_str())) {
+      // Keep the readings while the socket is backed up, they go with the next tick
+      mqttStats.publishFailures++;
+      return;
+    } else {
+      mqttStats.published++;
+    }
+    mqttQueueHead = (mqttQueueHead + count) % MQTT_QUEUE_CAPACITY;
+    mqttQueueCount -= count;
+    mqttClient.loop();  // Answer pings between messages of a long backlog
+  }
+}
+
+// {"on":[true,false],"level":[255,0],"scene":-1}, retained
+void publishLEDState() {
+  if (mqttLEDPublished && millis() - mqttLEDPublishTime < MQTT_LED_MIN_INTERVAL_MS) return;
+  LedSnapshot snapshot = readLEDSnapshot();
+  if (mqttLEDPublished && snapshot.version == mqttLEDVersion) return;
+
+  JsonBuffer<128> message;
+  JsonWriter json(message);
+  json.beginObject();
+  json.key("on");
+  json.beginArray();
+  for (uint8_t i = 0; i < LED_COUNT; i++) json.value(snapshot.on[i]);
+  json.endArray();
+  json.key("level");
+  json.beginArray();
+  for (uint8_t i = 0; i < LED_COUNT; i++) json.value((int)snapshot.level[i]);
+  json.endArray();
+  json.field("scene", (int)snapshot.activeScene);
+  json.endObject();
+
+  char topic[80];
+  mqttTopicFor(topic, sizeof(topic), "leds");
+  if (mqttClient.publish(topic, message.c_str(), true)) {
+    mqttLEDVersion = snapshot.version;
+    mqttLEDPublished = true;
+    mqttLEDPublishTime = millis();
+  }
+}
+
+// Follow changes of the broker settings, leaving the old broker first
+void loadMqttSettings() {
+  Config saved = readConfig();
+  uint16_t port = atoi(saved.mqttPort);
+  if (port == mqttPort && strcmp(saved.mqttHost, mqttHost) == 0 && strcmp(saved.mqttTopic, mqttTopic) == 0) return;
+
+  if (mqttClient.connected()) {
+    char topic[80];
+    mqttTopicFor(topic, sizeof(topic), "status");
+    mqttClient.publish(topic, "offline", true);  // A clean disconnect doesn't trigger the will
+    mqttClient.disconnect();
+  }
+  strcpy(mqttHost, saved.mqttHost);
+  strcpy(mqttTopic, saved.mqttTopic);
+  mqttPort = port;
+  mqttClient.setServer(mqttHost, mqttPort);  // Keeps the pointer, mqttHost stays put
+  mqttNextConnect = millis();
+  mqttBackoff = MQTT_RECONNECT_MIN_MS;
+  mqttLEDPublished = false;
+}
+
+// Connect once the STA link is up, backing off while the broker refuses
+void connectMqtt() {
+  if (WiFi.status() != WL_CONNECTED || (long)(millis() - mqttNextConnect) < 0) return;
+
+  char topic[80];
+  mqttTopicFor(topic, sizeof(topic), "status");
+  if (mqttClient.connect(mqttClientId, topic, 0, true, "offline")) {
+    mqttClient.publish(topic, "online", true);
+    mqttStats.connects++;
+    mqttBackoff = MQTT_RECONNECT_MIN_MS;
+    Serial.printf("MQTT connected to %s\n", mqttHost);
+  } else {
+    mqttStats.connectFailures++;
+    mqttNextConnect = millis() + mqttBackoff;
+    mqttBackoff *= 2;
+    if (mqttBackoff > MQTT_RECONNECT_MAX_MS) mqttBackoff = MQTT_RECONNECT_MAX_MS;
+  }
+}
+
+// Called once from setup()
+void setupMqtt() {
+  snprintf(mqttClientId, sizeof(mqttClientId), "esp32-%012llx", (unsigned long long)ESP.getEfuseMac());
+  mqttClient.setBufferSize(MQTT_MESSAGE_SIZE + 96);  // Room for the topic and header
+  mqttClient.setKeepAlive(MQTT_KEEPALIVE_S);
+  mqttClient.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);
+  mqttSnapshot.publish(mqttStats);
+}
+
+// Called from the mqtt task
+void updateMqtt() {
+  loadMqttSettings();
+  if (mqttHost[0] == '\0') {
+    mqttQueueCount = 0;  // Off, nothing to keep readings for
+  } else {
+    queueTelemetry();
+    if (!mqttClient.connected()) connectMqtt();
+    if (mqttClient.connected()) {
+      mqttClient.loop();
+      publishLEDState();
+      flushTelemetry();
+    }
+  }
+
+  mqttStats.connected = mqttClient.connected();
+  mqttStats.queued = mqttQueueCount;
+  mqttSnapshot.publish(mqttStats);
+}
+
+#endif  // MQTT_H
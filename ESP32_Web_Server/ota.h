@@ -0,0 +1,285 @@
+#ifndef OTA_H
+#define OTA_H
+
+#include <ESPAsyncWebServer.h>
+#include <esp_ota_ops.h>
+#include <mbedtls/sha256.h>
+#include "json_writer.h"
+#include "metrics.h"
+#include "pooled_response.h"
+#include "route_table.h"
+#include "tasks.h"
+
+// Firmware updates over HTTP
+//
+// POST /update?size=<bytes>&sha256=<hex> with the image as a multipart file
+// upload. Each piece is hashed and written to the inactive OTA partition as
+// it arrives, so the image is never held in RAM. The new image boots once
+// its size, its SHA-256 and esp_ota_end()'s own checks pass, and is only
+// kept after it has run healthily for OTA_HEALTH_CHECK_MS. A reset before
+// that makes the bootloader go back to the previous image.
+
+#define OTA_RESTART_DELAY_MS 2000   // Lets the response go out and pending settings commit
+#define OTA_HEALTH_CHECK_MS 60000   // A new image must run this long before it is kept
+#define OTA_MIN_HEALTHY_HEAP 20000  // and have this much heap left
+
+enum OtaState : uint8_t {
+  OTA_IDLE,
+  OTA_RECEIVING,
+  OTA_DONE,    // Written and verified, boots after the restart
+  OTA_FAILED,
+};
+
+// The last upload, shown by GET /update and /metrics
+struct OtaStatus {
+  OtaState state;
+  const char *error;
+  uint32_t size;           // Announced image size
+  uint32_t bytes;          // Received so far
+  unsigned long startMs;
+  unsigned long durationMs;
+  uint32_t startFreeHeap;
+  uint32_t minFreeHeap;    // Lowest free heap seen while receiving
+};
+
+OtaStatus otaStatus = { OTA_IDLE, nullptr, 0, 0, 0, 0, 0, 0 };
+AsyncWebServerRequest *otaRequest = nullptr;  // The upload being received, one at a time
+uint8_t otaExpectedHash[32];
+mbedtls_sha256_context otaHash;
+unsigned long otaRestartAt = 0;  // 0 while no restart is due
+bool otaPendingVerify = false;   // Running a new image that is not kept yet
+
+const esp_partition_t *otaPartition = nullptr;
+esp_ota_handle_t otaHandle = 0;
+
+// Arduino marks a new image valid as soon as it boots unless this says
+// the sketch checks it itself, see updateOta()
+extern "C" bool verifyRollbackLater() {
+  return true;
+}
+
+// Flash access. These are the only OTA partition calls, so a host stand-in
+// can replace them with a file acting as the partition.
+bool flashBegin(size_t size) {
+  otaPartition = esp_ota_get_next_update_partition(nullptr);
+  if (!otaPartition || size > otaPartition->size) return false;
+  // Erase sector by sector as data arrives, erasing the whole partition
+  // up front would hold the network task for seconds
+  return esp_ota_begin(otaPartition, OTA_WITH_SEQUENTIAL_WRITES, &otaHandle) == ESP_OK;
+}
+
+bool flashWrite(const uint8_t *data, size_t length) {
+  return esp_ota_write(otaHandle, data, length) == ESP_OK;
+}
+
+// Validate the image and boot it on the next restart
+bool flashFinish() {
+  return esp_ota_end(otaHandle) == ESP_OK && esp_ota_set_boot_partition(otaPartition) == ESP_OK;
+}
+
+void flashAbort() {
+  esp_ota_abort(otaHandle);
+}
+
+const char *otaStateName(OtaState state) {
+  switch (state) {
+    case OTA_RECEIVING: return "receiving";
+    case OTA_DONE: return "done";
+    case OTA_FAILED: return "failed";
+    default: return "idle";
+  }
+}
+
+// Parse 64 hex digits, returns false if it isn't a SHA-256
+bool parseSha256(const String &hex, uint8_t *hash) {
+  if (hex.length() != 64) return false;
+  for (int i = 0; i < 32; i++) {
+    char pair[3] = { hex[i * 2], hex[i * 2 + 1], 0 };
+    char *end;
+    hash[i] = strtoul(pair, &end, 16);
+    if (*end != '\0') return false;
+  }
+  return true;
+}
+
+// Image size over receive time, bytes per millisecond being about KB/s
+uint32_t otaThroughputKBps() {
+  return otaStatus.durationMs ? otaStatus.bytes / otaStatus.durationMs : 0;
+}
+
+void failOta(const char *error) {
+  if (otaStatus.state == OTA_RECEIVING) {
+    flashAbort();
+    mbedtls_sha256_free(&otaHash);
+  }
+  otaStatus.state = OTA_FAILED;
+  otaStatus.error = error;
+  otaStatus.durationMs = millis() - otaStatus.startMs;
+  Serial.print("Firmware update failed: ");
+  Serial.println(error);
+}
+
+// First piece: check the parameters and open the partition
+void startOta(AsyncWebServerRequest *request) {
+  otaStatus = { OTA_RECEIVING, nullptr, 0, 0, millis(), 0, ESP.getFreeHeap(), ESP.getFreeHeap() };
+  otaRequest = request;
+
+  long size = request->hasParam("size") ? request->getParam("size")->value().toInt() : 0;
+  if (size <= 0 || !request->hasParam("sha256") || !parseSha256(request->getParam("sha256")->value(), otaExpectedHash)) {
+    otaStatus.state = OTA_IDLE;  // Nothing opened yet
+    failOta("size and sha256 are required");
+    return;
+  }
+  otaStatus.size = size;
+
+  if (!flashBegin(size)) {
+    otaStatus.state = OTA_IDLE;
+    failOta("No OTA partition for an image this size");
+    return;
+  }
+  mbedtls_sha256_init(&otaHash);
+  mbedtls_sha256_starts_ret(&otaHash, 0);
+  Serial.printf("Receiving firmware, %lu bytes\n", (unsigned long)size);
+}
+
+// Last piece: the image must be complete and match its hash
+void finishOta() {
+  uint8_t hash[32];
+  mbedtls_sha256_finish_ret(&otaHash, hash);
+
+  if (otaStatus.bytes != otaStatus.size) {
+    failOta("Image shorter than size");
+  } else if (memcmp(hash, otaExpectedHash, sizeof(hash)) != 0) {
+    failOta("SHA-256 mismatch");
+  } else if (!flashFinish()) {
+    mbedtls_sha256_free(&otaHash);
+    otaStatus.state = OTA_IDLE;  // Already closed by esp_ota_end()
+    failOta("Image rejected by the bootloader checks");
+  } else {
+    mbedtls_sha256_free(&otaHash);
+    otaStatus.state = OTA_DONE;
+    otaStatus.durationMs = millis() - otaStatus.startMs;
+    Serial.printf("Firmware written in %lu ms, %lu KB/s\n", otaStatus.durationMs, (unsigned long)otaThroughputKBps());
+  }
+}
+
+// Upload Handler: one piece of the image at a time, straight to flash
+void handleFirmwareUpload(const RequestContext &context, size_t index, uint8_t *data, size_t length, bool final) {
+  AsyncWebServerRequest *request = context.request;
+  if (index == 0) {
+    // One upload at a time and one image per upload, handleUpdate() answers the rest
+    if (otaRequest || otaRestartAt) return;
+    startOta(request);
+  }
+  if (otaRequest != request || otaStatus.state != OTA_RECEIVING) return;
+
+  if (otaStatus.bytes + length > otaStatus.size) {
+    failOta("Image larger than size");
+    return;
+  }
+  mbedtls_sha256_update_ret(&otaHash, data, length);
+  if (!flashWrite(data, length)) {
+    failOta("Flash write failed");
+    return;
+  }
+  otaStatus.bytes += length;
+
+  uint32_t freeHeap = ESP.getFreeHeap();
+  if (freeHeap < otaStatus.minFreeHeap) otaStatus.minFreeHeap = freeHeap;
+
+  if (final) finishOta();
+}
+
+// End Handler: the upload request is gone. One that goes away mid-upload
+// leaves the partition half written.
+void endFirmwareUpload(AsyncWebServerRequest *request) {
+  if (otaRequest != request) return;
+  if (otaStatus.state == OTA_RECEIVING) failOta("Upload interrupted");
+  otaRequest = nullptr;
+}
+
+// Update Handler: runs once the upload is complete
+void handleUpdate(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+  if (otaRequest != request) {
+    bool busy = otaRequest || otaRestartAt;
+    noteResponseStatus(busy ? 409 : 400);
+    request->send(busy ? 409 : 400, "text/plain", busy ? "Another update is running" : "No firmware received");
+    return;
+  }
+
+  // Answered below either way, the next upload may start
+  otaRequest = nullptr;
+  if (otaStatus.state == OTA_RECEIVING) failOta("Upload incomplete");
+  if (otaStatus.state == OTA_FAILED) {
+    noteResponseStatus(400);
+    request->send(400, "text/plain", otaStatus.error);
+    return;
+  }
+
+  request->send(200, "text/plain", "Firmware updated, restarting");
+  otaRestartAt = millis() + OTA_RESTART_DELAY_MS;
+  if (otaRestartAt == 0) otaRestartAt = 1;
+}
+
+// Update Status Route: the last upload and the running image
+void handleUpdateStatus(const RequestContext &context) {
+  PooledResponse *response = beginPooledResponse(context.request, "application/json");
+  JsonWriter json(response->source);
+  json.beginObject();
+  json.field("state", otaStateName(otaStatus.state));
+  json.field("error", otaStatus.error);
+  json.field("size", (unsigned long)otaStatus.size);
+  json.field("bytes", (unsigned long)otaStatus.bytes);
+  json.field("ms", otaStatus.durationMs);
+  json.field("throughputKBps", (unsigned long)otaThroughputKBps());
+  json.field("heapUsedPeak", (unsigned long)(otaStatus.startFreeHeap - otaStatus.minFreeHeap));
+  json.field("running", esp_ota_get_running_partition()->label);
+  json.field("pendingVerify", otaPendingVerify);
+  json.endObject();
+  sendPooledResponse(context.request, response);
+}
+
+void writeOtaMetrics(Print &out) {
+  writeMetric(out, "ota_last_bytes", "gauge", "Bytes received by the last firmware upload.", otaStatus.bytes);
+  writeMetric(out, "ota_last_throughput_bytes_per_second", "gauge", "Receive rate of the last firmware upload.",
+              otaStatus.durationMs ? otaStatus.bytes * 1000.0 / otaStatus.durationMs : 0);
+  writeMetric(out, "ota_last_heap_used_bytes", "gauge", "Most heap in use above the start of the last upload.",
+              otaStatus.startFreeHeap - otaStatus.minFreeHeap);
+  writeMetric(out, "ota_pending_verify", "gauge", "1 while a new image runs on probation.", otaPendingVerify);
+}
+
+// Called once from setup()
+void setupOta() {
+  esp_ota_img_states_t state;
+  otaPendingVerify = esp_ota_get_state_partition(esp_ota_get_running_partition(), &state) == ESP_OK &&
+                     state == ESP_OTA_IMG_PENDING_VERIFY;
+  if (otaPendingVerify) Serial.println("New firmware, checking it before keeping it");
+}
+
+// Healthy enough to keep: every task came up and there is heap to spare
+bool firmwareHealthy() {
+  for (const TaskInfo &task : TASKS) {
+    if (!*task.handle) return false;
+  }
+  return ESP.getFreeHeap() >= OTA_MIN_HEALTHY_HEAP;
+}
+
+// Called from loop(): restarts into a new image, and keeps or rejects the
+// running one once it had time to show it works
+void updateOta() {
+  if (otaRestartAt && (long)(millis() - otaRestartAt) >= 0) ESP.restart();
+
+  if (otaPendingVerify && millis() >= OTA_HEALTH_CHECK_MS) {
+    otaPendingVerify = false;
+    if (firmwareHealthy()) {
+      esp_ota_mark_app_valid_cancel_rollback();
+      Serial.println("New firmware kept");
+    } else {
+      Serial.println("New firmware unhealthy, rolling back");
+      esp_ota_mark_app_invalid_rollback_and_reboot();
+    }
+  }
+}
+
+#endif  // OTA_H
@@ -0,0 +1,56 @@
+#ifndef POOLED_RESPONSE_H
+#define POOLED_RESPONSE_H
+
+#include <ESPAsyncWebServer.h>
+#include "buffer_pool.h"
+#include "metrics.h"
+
+// A response that sends whatever its source produces. The source lives
+// inside the response object and is destroyed with it, so a streamed
+// response costs one fixed-size allocation instead of a growing buffer
+// plus a std::function and a shared_ptr. A source has
+//   size_t read(uint8_t *buffer, size_t maxLen)  // 0 at the end
+template <typename Source>
+class SourceResponse : public AsyncAbstractResponse {
+public:
+  SourceResponse(AsyncWebServerRequest *request, const char *contentType) {
+    _code = 200;
+    _contentType = contentType;
+    _contentLength = 0;
+    _sendContentLength = false;
+    _chunked = request->version() > 0;  // HTTP/1.0 clients read until the connection closes
+  }
+
+  Source source;
+
+  bool _sourceValid() const override { return true; }
+
+  size_t _fillBuffer(uint8_t *buffer, size_t maxLen) override {
+    return source.read(buffer, maxLen);
+  }
+};
+
+typedef SourceResponse<PoolWriter> PooledResponse;
+
+// Start a response whose body is written into pool blocks
+PooledResponse *beginPooledResponse(AsyncWebServerRequest *request, const char *contentType) {
+  return new PooledResponse(request, contentType);
+}
+
+// Send it, or a 503 if the body did not fit into the pool
+template <typename Source>
+void sendPooledResponse(AsyncWebServerRequest *request, SourceResponse<Source> *response, bool overflowed) {
+  if (overflowed) {
+    delete response;
+    noteResponseStatus(503);
+    request->send(503, "text/plain", "Out of response buffers");
+    return;
+  }
+  request->send(response);
+}
+
+void sendPooledResponse(AsyncWebServerRequest *request, PooledResponse *response) {
+  sendPooledResponse(request, response, response->source.overflowed());
+}
+
+#endif  // POOLED_RESPONSE_H
@@ -0,0 +1,113 @@
+#ifndef RATE_LIMIT_H
+#define RATE_LIMIT_H
+
+#include <ESPAsyncWebServer.h>
+#include "metrics.h"
+#include "route_table.h"
+
+// Request admission control
+//
+// Every route calls admitRequest() before any auth check or rendering.
+// Requests are refused with 503 while too many are in flight, and with 429
+// when the client's token bucket is empty. Buckets are keyed by client IP
+// in a small fixed table, so a rejection costs no allocation besides the
+// short response itself.
+
+#define RATE_LIMIT_CLIENTS 16
+#define RATE_LIMIT_DEFAULT_RATE 20    // Tokens refilled per second
+#define RATE_LIMIT_DEFAULT_BURST 40   // Bucket size
+#define RATE_LIMIT_DEFAULT_IN_FLIGHT 8
+#define RATE_LIMIT_LOGIN_COST 10      // Tokens taken by a login attempt
+
+struct RateLimitBucket {
+  uint32_t ip;  // 0 marks a free entry
+  uint32_t milliTokens;
+  unsigned long lastRefill;
+};
+
+struct RateLimitStats {
+  unsigned long admitted;
+  unsigned long limited;     // 429: client over its rate
+  unsigned long overloaded;  // 503: too many requests in flight
+};
+
+RateLimitBucket rateLimitBuckets[RATE_LIMIT_CLIENTS];
+RateLimitStats rateLimitStats = {};
+uint32_t rateLimitRate = RATE_LIMIT_DEFAULT_RATE;
+uint32_t rateLimitBurst = RATE_LIMIT_DEFAULT_BURST;
+uint32_t maxInFlightRequests = RATE_LIMIT_DEFAULT_IN_FLIGHT;
+volatile uint32_t inFlightRequests = 0;
+
+// Bucket for an IP, taking over the least recently used one if needed
+RateLimitBucket &rateLimitBucket(uint32_t ip, unsigned long now) {
+  int freeSlot = -1;
+  int oldest = 0;
+  for (int i = 0; i < RATE_LIMIT_CLIENTS; i++) {
+    if (rateLimitBuckets[i].ip == ip) return rateLimitBuckets[i];
+    if (rateLimitBuckets[i].ip == 0) {
+      if (freeSlot < 0) freeSlot = i;
+    } else if ((long)(rateLimitBuckets[i].lastRefill - rateLimitBuckets[oldest].lastRefill) < 0) {
+      oldest = i;
+    }
+  }
+  int slot = freeSlot >= 0 ? freeSlot : oldest;
+
+  RateLimitBucket &bucket = rateLimitBuckets[slot];
+  bucket.ip = ip;
+  bucket.milliTokens = rateLimitBurst * 1000;
+  bucket.lastRefill = now;
+  return bucket;
+}
+
+// Refill the client's bucket and take cost tokens, false if there aren't enough
+bool takeRateLimitTokens(uint32_t ip, uint32_t cost) {
+  unsigned long now = millis();
+  RateLimitBucket &bucket = rateLimitBucket(ip, now);
+
+  uint32_t capacity = rateLimitBurst * 1000;
+  uint64_t refilled = bucket.milliTokens + (uint64_t)(now - bucket.lastRefill) * rateLimitRate;
+  bucket.milliTokens = refilled > capacity ? capacity : refilled;
+  bucket.lastRefill = now;
+
+  if (bucket.milliTokens < cost * 1000) return false;
+  bucket.milliTokens -= cost * 1000;
+  return true;
+}
+
+// Admit or reject a request, rejected requests are answered here. A request
+// keeps only one disconnect callback and admission takes it, so anyone else
+// who needs to know when the request is gone passes onEnd.
+bool admitRequest(AsyncWebServerRequest *request, uint32_t cost = 1, RequestEndHandler onEnd = nullptr) {
+  if (inFlightRequests >= maxInFlightRequests) {
+    rateLimitStats.overloaded++;
+    noteResponseStatus(503);
+    request->send(503, "text/plain", "Server Busy");
+    return false;
+  }
+
+  if (!takeRateLimitTokens(request->client()->remoteIP(), cost)) {
+    rateLimitStats.limited++;
+    noteResponseStatus(429);
+    AsyncWebServerResponse *response = request->beginResponse(429, "text/plain", "Too Many Requests");
+    response->addHeader("Retry-After", "1");
+    request->send(response);
+    return false;
+  }
+
+  rateLimitStats.admitted++;
+  inFlightRequests++;
+  request->onDisconnect([request, onEnd]() {
+    inFlightRequests--;
+    if (onEnd) onEnd(request);
+  });
+  return true;
+}
+
+// For long-lived channels (SSE, WebSocket) only the rate applies
+bool admitConnection(AsyncWebServerRequest *request) {
+  if (takeRateLimitTokens(request->client()->remoteIP(), 1)) return true;
+  rateLimitStats.limited++;
+  return false;
+}
+
+#endif  // RATE_LIMIT_H
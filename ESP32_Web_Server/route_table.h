@@ -0,0 +1,52 @@
+#ifndef ROUTE_TABLE_H
+#define ROUTE_TABLE_H
+
+#include <ESPAsyncWebServer.h>
+#include "sessions.h"
+
+// Route table types. The table itself is in routes.h and is plain constexpr
+// data, so it can be checked on its own without a server.
+
+// What a route handler gets: the request and its session, looked up once
+struct RequestContext {
+  AsyncWebServerRequest *request;
+  Session *session;  // nullptr only on public routes
+};
+
+typedef void (*RouteHandler)(const RequestContext &context);
+
+// One piece of a multipart file upload, called before the route's handler.
+// index is the offset of data in the file, final is set on the last piece.
+typedef void (*RouteUploadHandler)(const RequestContext &context, size_t index, uint8_t *data, size_t length, bool final);
+
+// Told when an admitted request is gone, answered or dropped mid-upload
+typedef void (*RequestEndHandler)(AsyncWebServerRequest *request);
+
+struct Route {
+  const char *path;
+  WebRequestMethodComposite method;
+  Role role;      // Lowest role allowed, ROLE_NONE for public routes
+  uint8_t cost;   // Rate limit tokens taken per request
+  RouteHandler handler;
+  RouteUploadHandler upload;  // Only for routes taking file uploads
+  RequestEndHandler end;      // Releases what the upload handler holds on to
+};
+
+// Upper bound on the table size, metrics are kept per route
+#define MAX_ROUTES 32
+
+// The registered table, see registerRoutes()
+const Route *routeTable = nullptr;
+size_t routeCount = 0;
+
+const char *routeMethodName(WebRequestMethodComposite method) {
+  switch (method) {
+    case HTTP_GET: return "GET";
+    case HTTP_POST: return "POST";
+    case HTTP_PUT: return "PUT";
+    case HTTP_DELETE: return "DELETE";
+    default: return "ANY";
+  }
+}
+
+#endif  // ROUTE_TABLE_H
@@ -0,0 +1,99 @@
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <ESPAsyncWebServer.h>
+#include "boot_timing.h"
+#include "metrics.h"
+#include "rate_limit.h"
+#include "route_table.h"
+#include "sessions.h"
+
+extern AsyncWebServer server;
+
+// Admission of an upload, decided at its first piece. It is kept in the
+// request's _tempObject, which the library frees with the request.
+struct UploadAdmission {
+  bool admitted;
+  uint16_t status;  // The rejection already sent
+};
+
+// Run one request through admission, the session and role check, then the
+// route's handler. The handler's time and status go to the route's metrics.
+void dispatchRoute(uint8_t index, AsyncWebServerRequest *request) {
+  const Route &route = routeTable[index];
+  unsigned long start = micros();
+  currentResponseStatus = 200;
+
+  // An upload went through admission at its first piece, and a rejected
+  // one has its answer already
+  const UploadAdmission *upload = (const UploadAdmission *)request->_tempObject;
+  bool admitted;
+  if (upload) {
+    admitted = upload->admitted;
+    if (!admitted) currentResponseStatus = upload->status;
+  } else {
+    admitted = admitRequest(request, route.cost, route.end);
+  }
+
+  if (admitted) {
+    RequestContext context = { request, findSession(request) };
+
+    if (route.role == ROLE_NONE || (context.session && context.session->role >= route.role)) {
+      route.handler(context);
+    } else {
+      // Not logged in goes to the login page, too low a role to the dashboard
+      noteResponseStatus(302);
+      request->redirect(context.session ? "/" : "/login");
+    }
+  }
+
+  recordRequest(index, currentResponseStatus, micros() - start);
+  markBootPhase(BOOT_FIRST_RESPONSE);
+}
+
+// Pass one piece of an upload to the route, if the client may use it. The
+// pieces arrive before the request itself is dispatched, so admission runs
+// at the first piece, before anything is written, and the role is checked
+// here too. Pieces of a rejected upload or from anyone else are dropped.
+void dispatchUpload(uint8_t index, AsyncWebServerRequest *request, size_t offset, uint8_t *data, size_t length,
+                    bool final) {
+  const Route &route = routeTable[index];
+  UploadAdmission *upload = (UploadAdmission *)request->_tempObject;
+  if (!upload) {
+    if (offset != 0) return;  // Can't happen, the first piece starts the file
+    upload = (UploadAdmission *)malloc(sizeof(UploadAdmission));
+    if (!upload) return;
+    request->_tempObject = upload;
+    currentResponseStatus = 200;
+    upload->admitted = admitRequest(request, route.cost, route.end);
+    upload->status = currentResponseStatus;
+  }
+  if (!upload->admitted) return;
+
+  RequestContext context = { request, findSession(request) };
+  if (route.role != ROLE_NONE && (!context.session || context.session->role < route.role)) return;
+  route.upload(context, offset, data, length, final);
+}
+
+// Register every route of the table with the server
+void registerRoutes(const Route *routes, size_t count) {
+  routeTable = routes;
+  routeCount = count;
+  for (size_t i = 0; i < count; i++) {
+    uint8_t index = i;
+    ArRequestHandlerFunction onRequest = [index](AsyncWebServerRequest *request) {
+      dispatchRoute(index, request);
+    };
+    if (routes[i].upload) {
+      server.on(routes[i].path, routes[i].method, onRequest,
+                [index](AsyncWebServerRequest *request, const String &filename, size_t offset, uint8_t *data, size_t length,
+                        bool final) {
+        dispatchUpload(index, request, offset, data, length, final);
+      });
+    } else {
+      server.on(routes[i].path, routes[i].method, onRequest);
+    }
+  }
+}
+
+#endif  // ROUTER_H
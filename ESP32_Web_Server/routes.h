@@ -2,26 +2,69 @@
 #define ROUTES_H
 
 #include <ESPAsyncWebServer.h>
-#include <Preferences.h>
 #include "auth.h"
 #include "dashboard.h"
 #include "settings.h"
+#include "events.h"
+#include "websocket.h"
+#include "diagnostics.h"
+#include "ota.h"
+#include "sensor_log.h"
+#include "router.h"
 
-// External variables
-extern Preferences preferences;
-extern AsyncWebServer server;
+// Every HTTP route: path, method, lowest role allowed, rate limit cost,
+// handler, and the upload and end handlers of routes taking uploads.
+// router.h checks the role and looks the session up before calling the
+// handler, so handlers don't check the login themselves.
+constexpr Route ROUTES[] = {
+  // Authentication Routes
+  { "/login", HTTP_GET, ROLE_NONE, 1, handleLoginPage, nullptr, nullptr },
+  { "/login", HTTP_POST, ROLE_NONE, RATE_LIMIT_LOGIN_COST, handleLogin, nullptr, nullptr },  // Slows down password guessing
+  { "/logout", HTTP_GET, ROLE_NONE, 1, handleLogout, nullptr, nullptr },
+
+  // LED and Dashboard Routes
+  { "/", HTTP_GET, ROLE_VIEWER, 1, handleLED, nullptr, nullptr },
+  { "/led-state", HTTP_GET, ROLE_VIEWER, 1, handleLEDState, nullptr, nullptr },
+  { "/toggle", HTTP_GET, ROLE_VIEWER, 1, handleToggleLED, nullptr, nullptr },
+  { "/set_led_intensity", HTTP_GET, ROLE_VIEWER, 1, handleSetLEDIntensity, nullptr, nullptr },
+  { "/fade", HTTP_GET, ROLE_VIEWER, 1, handleFadeLED, nullptr, nullptr },
+  { "/scenes", HTTP_GET, ROLE_VIEWER, 1, handleScenes, nullptr, nullptr },
+  { "/scene", HTTP_POST, ROLE_VIEWER, 1, handleScene, nullptr, nullptr },
+  { "/schedule", HTTP_POST, ROLE_VIEWER, 1, handleSchedule, nullptr, nullptr },
+
+  // Sensor Data Routes
+  { "/sensors", HTTP_GET, ROLE_VIEWER, 1, handleSensors, nullptr, nullptr },
+  { "/sensor_data", HTTP_GET, ROLE_VIEWER, 1, handleSensorData, nullptr, nullptr },
+  { "/sensor_history", HTTP_GET, ROLE_VIEWER, 1, handleSensorHistory, nullptr, nullptr },
+  { "/log", HTTP_GET, ROLE_VIEWER, 2, handleLog, nullptr, nullptr },  // Reads flash while streaming
+
+  // Settings Routes
+  { "/settings", HTTP_GET, ROLE_ADMIN, 1, handleSettings, nullptr, nullptr },
+  { "/settings_data", HTTP_GET, ROLE_ADMIN, 1, handleSettingsData, nullptr, nullptr },
+  { "/settings_job", HTTP_GET, ROLE_ADMIN, 1, handleSettingsJob, nullptr, nullptr },
+  { "/update_settings", HTTP_POST, ROLE_ADMIN, 1, handleUpdateSettings, nullptr, nullptr },
 
+  // Diagnostics, /metrics has no login so a scraper can read it
+  { "/heap", HTTP_GET, ROLE_VIEWER, 1, handleHeap, nullptr, nullptr },
+  { "/metrics", HTTP_GET, ROLE_NONE, 1, handleMetrics, nullptr, nullptr },
+  { "/limits", HTTP_GET, ROLE_VIEWER, 1, handleLimits, nullptr, nullptr },
+  { "/limits", HTTP_POST, ROLE_ADMIN, 1, handleUpdateLimits, nullptr, nullptr },
+
+  // Firmware update, the image is streamed to flash by the upload handler
+  { "/update", HTTP_GET, ROLE_ADMIN, 1, handleUpdateStatus, nullptr, nullptr },
+  { "/update", HTTP_POST, ROLE_ADMIN, 1, handleUpdate, handleFirmwareUpload, endFirmwareUpload },
+};
+
+constexpr size_t ROUTE_COUNT = sizeof(ROUTES) / sizeof(ROUTES[0]);
+static_assert(ROUTE_COUNT <= MAX_ROUTES, "Raise MAX_ROUTES in route_table.h");
 
 // Main Setup Function for All Routes
 void setupRoutes() {
-  // Authentication Routes
-  setupAuthRoutes();
-  // LED and Dashboard Routes
-  setupLEDRoutes();
-  // Settings Routes (with access control)
-  setupSettingsRoutes();
-  // Sensor Data Routes
-  setupSensorRoutes();
+  registerRoutes(ROUTES, ROUTE_COUNT);
+  // Server-Sent Events (dashboard push updates)
+  setupEventRoutes();
+  // WebSocket LED control channel
+  setupWebSocketRoutes();
 }
 
-#endif  // ROUTES_H
\ No newline at end of file
+#endif  // ROUTES_H
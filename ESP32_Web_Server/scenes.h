@@ -0,0 +1,140 @@
+#ifndef SCENES_H
+#define SCENES_H
+
+#include <Arduino.h>
+#include "led_driver.h"
+
+// Scenes are timed lists of LED changes the device plays on its own, so
+// the page sends one command instead of a stream of intensities.
+
+struct SceneStep {
+  uint32_t atMs;    // Offset from the start of the scene
+  uint8_t led;      // 1-based, 0 for all LEDs
+  uint8_t level;    // 0 switches the LED off
+  uint32_t fadeMs;
+};
+
+struct Scene {
+  const char *name;
+  const SceneStep *steps;  // Sorted by atMs
+  uint8_t stepCount;
+  uint32_t periodMs;       // Restart after this long, 0 to play once
+};
+
+const SceneStep SCENE_ON_STEPS[] = { { 0, 0, 255, 1000 } };
+const SceneStep SCENE_OFF_STEPS[] = { { 0, 0, 0, 1000 } };
+const SceneStep SCENE_WAKE_STEPS[] = { { 0, 0, 255, 600000 } };
+const SceneStep SCENE_BREATHE_STEPS[] = { { 0, 0, 255, 2000 }, { 2000, 0, 16, 2000 } };
+const SceneStep SCENE_ALTERNATE_STEPS[] = {
+  { 0, 1, 255, 500 }, { 0, 2, 0, 500 }, { 1000, 1, 0, 500 }, { 1000, 2, 255, 500 }
+};
+
+#define SCENE(name, steps, periodMs) { name, steps, sizeof(steps) / sizeof(steps[0]), periodMs }
+
+const Scene SCENES[] = {
+  SCENE("on", SCENE_ON_STEPS, 0),
+  SCENE("off", SCENE_OFF_STEPS, 0),
+  SCENE("wake", SCENE_WAKE_STEPS, 0),  // 10 minute sunrise
+  SCENE("breathe", SCENE_BREATHE_STEPS, 4000),
+  SCENE("alternate", SCENE_ALTERNATE_STEPS, 2000),
+};
+#define SCENE_COUNT (sizeof(SCENES) / sizeof(SCENES[0]))
+
+// Scheduled scene starts, relative to when they were added
+#define SCHEDULE_CAPACITY 4
+
+struct SceneSchedule {
+  uint16_t id;         // Handed out by the web side, see led_control.h
+  int8_t scene;        // -1 for a free slot
+  unsigned long nextRun;
+  uint32_t repeatMs;   // 0 to run once
+};
+
+// Scenes and schedules are only touched from the I/O task. Handlers go
+// through the commands in led_control.h.
+SceneSchedule sceneSchedules[SCHEDULE_CAPACITY] = { { 0, -1, 0, 0 }, { 0, -1, 0, 0 }, { 0, -1, 0, 0 }, { 0, -1, 0, 0 } };
+
+#define SCENE_NONE -1
+int8_t activeScene = SCENE_NONE;
+unsigned long sceneStart = 0;
+uint8_t sceneStep = 0;
+
+int findScene(const char *name) {
+  for (uint8_t i = 0; i < SCENE_COUNT; i++) {
+    if (strcmp(SCENES[i].name, name) == 0) return i;
+  }
+  return -1;
+}
+
+// Start a scene, or stop the playing one with SCENE_NONE
+void playScene(int8_t scene) {
+  activeScene = scene;
+  sceneStart = millis();
+  sceneStep = 0;
+}
+
+// Add a schedule, returns false if the table is full
+bool addSceneSchedule(uint16_t id, int8_t scene, uint32_t delayMs, uint32_t repeatMs) {
+  for (uint8_t i = 0; i < SCHEDULE_CAPACITY; i++) {
+    if (sceneSchedules[i].scene >= 0) continue;
+    sceneSchedules[i] = { id, scene, millis() + delayMs, repeatMs };
+    return true;
+  }
+  return false;
+}
+
+bool cancelSceneSchedule(uint16_t id) {
+  for (uint8_t i = 0; i < SCHEDULE_CAPACITY; i++) {
+    if (sceneSchedules[i].scene < 0 || sceneSchedules[i].id != id) continue;
+    sceneSchedules[i].scene = -1;
+    return true;
+  }
+  return false;
+}
+
+void applySceneStep(const SceneStep &step) {
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    if (step.led != 0 && step.led != i + 1) continue;
+    LedChannel &channel = ledChannels[i];
+    if (step.level == 0) {
+      setLEDOutput(channel, false, channel.level, step.fadeMs);  // Keep the level for the next switch on
+    } else {
+      setLEDOutput(channel, true, step.level, step.fadeMs);
+    }
+  }
+}
+
+// Called from the I/O task: runs due schedules and plays the active scene
+void updateScenes() {
+  unsigned long now = millis();
+
+  for (uint8_t i = 0; i < SCHEDULE_CAPACITY; i++) {
+    SceneSchedule &schedule = sceneSchedules[i];
+    if (schedule.scene < 0 || (long)(now - schedule.nextRun) < 0) continue;
+    playScene(schedule.scene);
+    if (schedule.repeatMs) {
+      schedule.nextRun += schedule.repeatMs;
+    } else {
+      schedule.scene = -1;
+    }
+  }
+
+  if (activeScene == SCENE_NONE) return;
+
+  const Scene &scene = SCENES[activeScene];
+  uint32_t elapsed = now - sceneStart;
+  while (sceneStep < scene.stepCount && scene.steps[sceneStep].atMs <= elapsed) {
+    applySceneStep(scene.steps[sceneStep++]);
+  }
+
+  if (sceneStep == scene.stepCount) {
+    if (scene.periodMs == 0) {
+      activeScene = SCENE_NONE;
+    } else if (elapsed >= scene.periodMs) {
+      sceneStart += scene.periodMs;
+      sceneStep = 0;
+    }
+  }
+}
+
+#endif  // SCENES_H
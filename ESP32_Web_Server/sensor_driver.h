@@ -0,0 +1,42 @@
+#ifndef SENSOR_DRIVER_H
+#define SENSOR_DRIVER_H
+
+#include <Arduino.h>
+
+// Most values one sensor reports (BME280: temperature, humidity, pressure)
+#define SENSOR_MAX_VALUES 3
+
+// One measured quantity, formatted by the page with its unit and decimals
+struct SensorQuantity {
+  const char *name;
+  const char *unit;
+  uint8_t decimals;
+};
+
+// A sensor driver. The scheduler in sensors.h calls start() every periodMs,
+// then read() once the measurement is ready, so a sensor that needs time to
+// convert never holds up the I/O task while it does. periodMs is also the
+// shortest period setSensorPeriod() accepts, the fastest the part can go.
+class SensorDriver {
+public:
+  SensorDriver(const char *name, uint32_t periodMs, const SensorQuantity *quantities, uint8_t valueCount)
+    : name(name), periodMs(periodMs), quantities(quantities), valueCount(valueCount) {}
+  virtual ~SensorDriver() {}
+
+  const char *const name;
+  const uint32_t periodMs;
+  const SensorQuantity *const quantities;
+  const uint8_t valueCount;
+
+  virtual void begin() {}
+
+  // Start a measurement, returns the milliseconds until read() can fetch it
+  virtual uint32_t start() {
+    return 0;
+  }
+
+  // Fetch valueCount values, false if the sensor did not answer
+  virtual bool read(float *values) = 0;
+};
+
+#endif  // SENSOR_DRIVER_H
@@ -0,0 +1,161 @@
+#ifndef SENSOR_DRIVERS_H
+#define SENSOR_DRIVERS_H
+
+#include <Arduino.h>
+#include <DHT.h>
+#include "sensor_driver.h"
+
+// Optional sensors: define the pin or address to enable one, each needs
+// its library (OneWire + DallasTemperature, Adafruit BME280)
+// #define DS18B20_PIN 5
+// #define BME280_ADDRESS 0x76
+// #define ADC_SENSOR_PIN 34
+
+#ifdef DS18B20_PIN
+#include <DallasTemperature.h>
+#include <OneWire.h>
+#endif
+#ifdef BME280_ADDRESS
+#include <Adafruit_BME280.h>
+#endif
+
+//////////////////////// DHT22 ////////////////////////
+
+#define DHT_PIN 4
+#define DHT_TYPE DHT22
+
+const SensorQuantity DHT22_QUANTITIES[] = { { "temperature", "°C", 1 }, { "humidity", "%", 1 } };
+
+// The DHT22 cannot deliver fresh data more often than every 2 seconds, and
+// its read bit-bangs for about 5 ms
+class Dht22Sensor : public SensorDriver {
+public:
+  Dht22Sensor() : SensorDriver("dht22", 2000, DHT22_QUANTITIES, 2), dht(DHT_PIN, DHT_TYPE) {}
+
+  void begin() override {
+    dht.begin();
+  }
+
+  bool read(float *values) override {
+    values[0] = dht.readTemperature();
+    values[1] = dht.readHumidity();  // Same transfer, the library caches it
+    return !isnan(values[0]) && !isnan(values[1]);
+  }
+
+private:
+  DHT dht;
+};
+
+//////////////////////// DS18B20 ////////////////////////
+
+#ifdef DS18B20_PIN
+const SensorQuantity DS18B20_QUANTITIES[] = { { "temperature", "°C", 2 } };
+
+// 12-bit conversions take 750 ms, they run while other sensors are read
+class Ds18b20Sensor : public SensorDriver {
+public:
+  Ds18b20Sensor() : SensorDriver("ds18b20", 5000, DS18B20_QUANTITIES, 1), wire(DS18B20_PIN), sensors(&wire) {}
+
+  void begin() override {
+    sensors.begin();
+    sensors.setResolution(12);
+    sensors.setWaitForConversion(false);
+  }
+
+  uint32_t start() override {
+    sensors.requestTemperatures();
+    return 750;
+  }
+
+  bool read(float *values) override {
+    values[0] = sensors.getTempCByIndex(0);
+    return values[0] != DEVICE_DISCONNECTED_C;
+  }
+
+private:
+  OneWire wire;
+  DallasTemperature sensors;
+};
+#endif
+
+//////////////////////// BME280 ////////////////////////
+
+#ifdef BME280_ADDRESS
+const SensorQuantity BME280_QUANTITIES[] = { { "temperature", "°C", 2 }, { "humidity", "%", 1 }, { "pressure", "hPa", 1 } };
+
+// Runs in normal mode, so a read only fetches the last measurement
+class Bme280Sensor : public SensorDriver {
+public:
+  Bme280Sensor() : SensorDriver("bme280", 5000, BME280_QUANTITIES, 3) {}
+
+  void begin() override {
+    found = bme.begin(BME280_ADDRESS);
+    if (found) {
+      bme.setSampling(Adafruit_BME280::MODE_NORMAL, Adafruit_BME280::SAMPLING_X2, Adafruit_BME280::SAMPLING_X16,
+                      Adafruit_BME280::SAMPLING_X1, Adafruit_BME280::FILTER_X16, Adafruit_BME280::STANDBY_MS_1000);
+    }
+  }
+
+  bool read(float *values) override {
+    if (!found) return false;
+    values[0] = bme.readTemperature();
+    values[1] = bme.readHumidity();
+    values[2] = bme.readPressure() / 100.0f;
+    return !isnan(values[0]) && !isnan(values[1]) && !isnan(values[2]);
+  }
+
+private:
+  Adafruit_BME280 bme;
+  bool found = false;
+};
+#endif
+
+//////////////////////// Analog input ////////////////////////
+
+#ifdef ADC_SENSOR_PIN
+const SensorQuantity ADC_QUANTITIES[] = { { "voltage", "V", 3 } };
+
+// Calibrated reading from the ADC, averaged over a few conversions
+class AdcSensor : public SensorDriver {
+public:
+  AdcSensor() : SensorDriver("adc", 1000, ADC_QUANTITIES, 1) {}
+
+  bool read(float *values) override {
+    uint32_t total = 0;
+    for (int i = 0; i < 8; i++) total += analogReadMilliVolts(ADC_SENSOR_PIN);
+    values[0] = total / 8000.0f;
+    return true;
+  }
+};
+#endif
+
+//////////////////////// Registry ////////////////////////
+
+Dht22Sensor dht22Sensor;
+#ifdef DS18B20_PIN
+Ds18b20Sensor ds18b20Sensor;
+#endif
+#ifdef BME280_ADDRESS
+Bme280Sensor bme280Sensor;
+#endif
+#ifdef ADC_SENSOR_PIN
+AdcSensor adcSensor;
+#endif
+
+// The sensors the scheduler runs, in the order the page shows them. The
+// first one feeds the temperature/humidity history.
+SensorDriver *const SENSORS[] = {
+  &dht22Sensor,
+#ifdef DS18B20_PIN
+  &ds18b20Sensor,
+#endif
+#ifdef BME280_ADDRESS
+  &bme280Sensor,
+#endif
+#ifdef ADC_SENSOR_PIN
+  &adcSensor,
+#endif
+};
+#define SENSOR_COUNT (sizeof(SENSORS) / sizeof(SENSORS[0]))
+
+#endif  // SENSOR_DRIVERS_H
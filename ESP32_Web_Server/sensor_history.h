@@ -0,0 +1,183 @@
+#ifndef SENSOR_HISTORY_H
+#define SENSOR_HISTORY_H
+
+#include <ESPAsyncWebServer.h>
+#include <atomic>
+#include "pooled_response.h"
+#include "route_table.h"
+#include "snapshot.h"
+
+// 1800 samples at the DHT22's 2 s pace cover one hour in ~10.5 KB of RAM
+#define HISTORY_CAPACITY 1800
+#define HISTORY_DEFAULT_STEP_MS 60000
+#define HISTORY_MIN_STEP_MS 1000
+#define HISTORY_MAX_DELTA 0xFFFF  // in HISTORY_TIME_UNIT_MS units
+#define HISTORY_TIME_UNIT_MS 100
+
+// Compact sample: values in centi-units, time as a delta to the previous sample
+struct HistorySample {
+  int16_t temperature;  // 1/100 °C
+  int16_t humidity;     // 1/100 %
+  uint16_t delta;       // HISTORY_TIME_UNIT_MS units since the previous sample
+};
+
+// Preallocated ring buffer, the memory use never changes at runtime. The
+// I/O task appends, web handlers read on another task: the head moves
+// before a slot is overwritten, so a reader that finds its sequence number
+// still at or after the head after copying a sample got an intact one.
+HistorySample historySamples[HISTORY_CAPACITY];
+std::atomic<uint32_t> historyHead{ 0 };   // Sequence number of the oldest stored sample
+std::atomic<uint32_t> historyCount{ 0 };  // Number of stored samples
+unsigned long historyHeadTime = 0;  // millis() of the oldest stored sample
+unsigned long historyLastTime = 0;  // millis() of the newest stored sample
+
+// Where a reader starts: the head and its time, always from the same moment
+struct HistoryStart {
+  uint32_t seq;
+  unsigned long time;
+};
+
+Snapshot<HistoryStart> historyStart;
+
+// Append a sample, overwriting the oldest one when the buffer is full
+void recordSensorHistory(float temperature, float humidity, unsigned long timestamp) {
+  HistorySample sample;
+  sample.temperature = (int16_t)lroundf(temperature * 100);
+  sample.humidity = (int16_t)lroundf(humidity * 100);
+
+  if (historyCount.load(std::memory_order_relaxed) == 0) {
+    sample.delta = 0;
+    historyHeadTime = timestamp;
+  } else {
+    unsigned long delta = (timestamp - historyLastTime) / HISTORY_TIME_UNIT_MS;
+    sample.delta = delta > HISTORY_MAX_DELTA ? HISTORY_MAX_DELTA : delta;
+  }
+  historyLastTime = timestamp;
+
+  uint32_t head = historyHead.load(std::memory_order_relaxed);
+  uint32_t count = historyCount.load(std::memory_order_relaxed);
+  if (count == HISTORY_CAPACITY) {
+    // Drop the oldest sample and move the base time to its successor
+    head++;
+    historyHeadTime += (unsigned long)historySamples[head % HISTORY_CAPACITY].delta * HISTORY_TIME_UNIT_MS;
+    historyHead.store(head, std::memory_order_relaxed);
+    count--;
+    std::atomic_thread_fence(std::memory_order_release);  // Readers see the new head before the overwrite
+  }
+  historySamples[(head + count) % HISTORY_CAPACITY] = sample;
+  historyCount.store(count + 1, std::memory_order_release);
+  historyStart.publish({ head, historyHeadTime });
+}
+
+// State of one /sensor_history response while it is being streamed
+struct HistoryCursor : LineSource {
+  uint32_t seq = 0;        // Next sample to read
+  unsigned long time = 0;  // Timestamp of the sample at seq
+  unsigned long since = 0;
+  unsigned long step = HISTORY_DEFAULT_STEP_MS;
+  bool started = false;
+  bool finished = false;
+  bool firstBucket = true;
+
+  bool nextLine() override;
+};
+
+// Min/max/sum of the samples falling into one time bucket
+struct HistoryBucket {
+  unsigned long start;
+  int count;
+  int32_t tMin, tMax, tSum;
+  int32_t hMin, hMax, hSum;
+};
+
+// Move the cursor to the next sample, keeping its timestamp in step
+void advanceHistoryCursor(HistoryCursor &cursor) {
+  cursor.seq++;
+  if (cursor.seq < historyHead.load(std::memory_order_relaxed) + historyCount.load(std::memory_order_acquire)) {
+    cursor.time += (unsigned long)historySamples[cursor.seq % HISTORY_CAPACITY].delta * HISTORY_TIME_UNIT_MS;
+  }
+}
+
+// Fold samples into the next bucket, returns false once history is exhausted
+bool nextHistoryBucket(HistoryCursor &cursor, HistoryBucket &bucket) {
+  bucket.count = 0;
+  // Stop early if the sampler overwrote the samples we were about to read
+  while (cursor.seq >= historyHead.load(std::memory_order_acquire) &&
+         cursor.seq < historyHead.load(std::memory_order_relaxed) + historyCount.load(std::memory_order_acquire)) {
+    if (cursor.time < cursor.since) {
+      advanceHistoryCursor(cursor);
+      continue;
+    }
+
+    HistorySample sample = historySamples[cursor.seq % HISTORY_CAPACITY];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (cursor.seq < historyHead.load(std::memory_order_relaxed)) break;  // Overwritten while copying
+    unsigned long start = cursor.time - (cursor.time % cursor.step);
+    if (bucket.count > 0 && start != bucket.start) return true;  // Sample belongs to the next bucket
+    if (bucket.count == 0) {
+      bucket.start = start;
+      bucket.tMin = bucket.tMax = sample.temperature;
+      bucket.hMin = bucket.hMax = sample.humidity;
+      bucket.tSum = bucket.hSum = 0;
+    }
+    if (sample.temperature < bucket.tMin) bucket.tMin = sample.temperature;
+    if (sample.temperature > bucket.tMax) bucket.tMax = sample.temperature;
+    if (sample.humidity < bucket.hMin) bucket.hMin = sample.humidity;
+    if (sample.humidity > bucket.hMax) bucket.hMax = sample.humidity;
+    bucket.tSum += sample.temperature;
+    bucket.hSum += sample.humidity;
+    bucket.count++;
+
+    advanceHistoryCursor(cursor);
+  }
+  return bucket.count > 0;
+}
+
+// Produce the next piece of JSON into cursor.line, returns false at the end
+bool nextHistoryLine(HistoryCursor &cursor) {
+  if (!cursor.started) {
+    cursor.started = true;
+    cursor.lineLen = snprintf(cursor.line, sizeof(cursor.line), "{\"now\":%lu,\"step\":%lu,\"buckets\":[",
+                              millis(), cursor.step);
+    return true;
+  }
+  if (cursor.finished) return false;
+
+  HistoryBucket bucket;
+  if (!nextHistoryBucket(cursor, bucket)) {
+    cursor.finished = true;
+    cursor.lineLen = snprintf(cursor.line, sizeof(cursor.line), "]}");
+    return true;
+  }
+
+  // [start, count, tMin, tAvg, tMax, hMin, hAvg, hMax]
+  cursor.lineLen = snprintf(cursor.line, sizeof(cursor.line), "%s[%lu,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f]",
+                            cursor.firstBucket ? "" : ",", bucket.start, bucket.count,
+                            bucket.tMin / 100.0, bucket.tSum / 100.0 / bucket.count, bucket.tMax / 100.0,
+                            bucket.hMin / 100.0, bucket.hSum / 100.0 / bucket.count, bucket.hMax / 100.0);
+  cursor.firstBucket = false;
+  return true;
+}
+
+bool HistoryCursor::nextLine() {
+  return nextHistoryLine(*this);
+}
+
+// Sensor History Route: /sensor_history?since=<millis>&step=<ms>
+void handleSensorHistory(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+
+  // Stream the buckets as they are computed, the cursor lives in the response
+  SourceResponse<HistoryCursor> *response = new SourceResponse<HistoryCursor>(request, "application/json");
+  HistoryCursor *cursor = &response->source;
+  cursor->since = request->hasParam("since") ? request->getParam("since")->value().toInt() : 0;
+  cursor->step = request->hasParam("step") ? request->getParam("step")->value().toInt() : HISTORY_DEFAULT_STEP_MS;
+  if (cursor->step < HISTORY_MIN_STEP_MS) cursor->step = HISTORY_MIN_STEP_MS;
+  HistoryStart start;
+  historyStart.read(start);
+  cursor->seq = start.seq;
+  cursor->time = start.time;
+  request->send(response);
+}
+
+#endif  // SENSOR_HISTORY_H
@@ -0,0 +1,750 @@
+#ifndef SENSOR_LOG_H
+#define SENSOR_LOG_H
+
+#include <ESPAsyncWebServer.h>
+#include <FS.h>
+#include <LittleFS.h>
+#include <atomic>
+#include <time.h>
+#include "buffer_pool.h"
+#include "pooled_response.h"
+#include "route_table.h"
+#include "sensors.h"
+#include "snapshot.h"
+#include "spsc_queue.h"
+
+// Sensor log on flash
+//
+// Every reading also goes into an append-only log on LittleFS, so it
+// survives a power cut. The log is a series of segment files under /log,
+// each at most LOG_SEGMENT_SIZE bytes: a header, then batches. A batch is
+// up to LOG_BATCH_SIZE bytes of records, delta-encoded against the previous
+// record of the same batch and covered by a CRC-32. Batches are built in
+// RAM and written whole, a flash page at a time, so the flash sees one
+// write per few dozen readings. A batch damaged by a reset fails its CRC
+// and is skipped, the rest of the log stays readable.
+//
+// Each boot starts a new segment, and so does a full one. The oldest
+// segments are deleted to keep the log under LOG_MAX_BYTES. The index in
+// RAM has each segment's time range and each batch header has its own, so
+// /log?from=&to= only reads the batches it returns.
+//
+// Times are Unix seconds once SNTP has set the clock. Readings taken
+// before that go into segments without LOG_SEGMENT_CLOCK_SET, timed in
+// seconds since that boot.
+//
+// Only the persistence task touches the files, exports included, see
+// the Export section. The filesystem is logFS, which a host build can point
+// at a RAM-backed fs::FS.
+
+#define LOG_DIR "/log"
+#define LOG_SEGMENT_SIZE 16384          // Four LittleFS blocks
+#define LOG_MAX_BYTES (512 * 1024)      // Oldest segments go beyond this
+#define LOG_MAX_SEGMENTS 48             // Index capacity, short boots leave small segments
+#define LOG_BATCH_SIZE 256              // One flash page, header included
+#define LOG_MAX_BATCH_AGE_MS 300000     // Write a partial batch after this long, bounds the loss on a power cut
+#define LOG_CLOCK_VALID 1600000000UL    // time() past this means SNTP has set the clock
+#define LOG_NTP_SERVER "pool.ntp.org"
+
+#define LOG_SEGMENT_MAGIC 0x474F4C53  // "SLOG"
+#define LOG_BATCH_MAGIC 0xB47C
+#define LOG_FORMAT_VERSION 1
+#define LOG_SEGMENT_CLOCK_SET 1       // Segment flag: times are Unix seconds
+
+// File layout, little-endian as the ESP32 writes it
+struct LogSegmentHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t boot;      // Boot number, tells apart times counted from different boots
+  uint32_t sequence;  // Also the file name, in hex
+  uint32_t flags;
+  uint32_t crc;       // CRC-32 of the fields above
+};
+
+// Followed by length bytes of records. A record is a tag byte (sensor index
+// in the low 5 bits, value count in the top 3), the seconds since the
+// previous record as a varint (since firstTime for the first one), then
+// each value times 10^decimals as a zigzag varint, as a difference to the
+// same sensor's previous value in the batch (to 0 for the first one).
+struct LogBatchHeader {
+  uint16_t magic;
+  uint16_t length;  // Payload bytes
+  uint16_t count;   // Records
+  uint16_t reserved;
+  uint32_t firstTime;
+  uint32_t lastTime;
+  uint32_t crc;     // CRC-32 of the fields above and the payload
+};
+
+#define LOG_BATCH_PAYLOAD (LOG_BATCH_SIZE - sizeof(LogBatchHeader))
+#define LOG_RECORD_MAX (1 + 5 + SENSOR_MAX_VALUES * 5)
+
+// A batch as stored, header and payload back to back
+struct LogBatch {
+  LogBatchHeader header;
+  uint8_t payload[LOG_BATCH_PAYLOAD];
+};
+
+static_assert(sizeof(LogBatch) == LOG_BATCH_SIZE, "A batch is one page");
+static_assert(SENSOR_COUNT <= 32 && SENSOR_MAX_VALUES <= 7, "Record tags hold 5 bits of sensor, 3 of count");
+
+struct LogSegmentInfo {
+  uint32_t sequence;
+  uint16_t boot;
+  uint16_t flags;
+  uint32_t firstTime;
+  uint32_t lastTime;
+  uint32_t size;     // Bytes written, readers stop here
+  uint16_t batches;
+};
+
+// What the export and /metrics see, oldest segment first
+struct LogIndex {
+  LogSegmentInfo segments[LOG_MAX_SEGMENTS];
+  uint8_t count;
+  uint32_t totalBytes;
+  uint32_t batchesWritten;
+  uint32_t writeFailures;
+  uint32_t evicted;       // Segments deleted to stay under LOG_MAX_BYTES
+  uint32_t evictFailures; // Deletes that failed, retried at the next segment
+};
+
+fs::FS *logFS = &LittleFS;
+Snapshot<LogIndex> logIndexSnapshot;
+std::atomic<uint32_t> logCrcErrors{ 0 };  // Damaged batches found by exports
+
+std::atomic<bool> logReady{ false };  // Mounted and indexed, exports can start
+
+// Persistence task only
+LogIndex logIndex = {};
+uint16_t logBoot = 0;
+File logFile;            // Newest segment, open for appending
+bool logSegmentOpen = false;
+LogBatch logBatch;
+int32_t logPrevious[SENSOR_COUNT][SENSOR_MAX_VALUES];
+unsigned long logBatchStarted = 0;
+unsigned long logLastRead[SENSOR_COUNT];
+
+LogIndex readLogIndex() {
+  LogIndex copy;
+  logIndexSnapshot.read(copy);
+  return copy;
+}
+
+uint32_t logCrc(uint32_t crc, const void *data, size_t length) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= bytes[i];
+    for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+  }
+  return ~crc;
+}
+
+uint32_t logBatchCrc(const LogBatch &batch) {
+  uint32_t crc = logCrc(0, &batch.header, offsetof(LogBatchHeader, crc));
+  return logCrc(crc, batch.payload, batch.header.length);
+}
+
+size_t putVarint(uint8_t *out, uint32_t value) {
+  size_t length = 0;
+  while (value >= 0x80) {
+    out[length++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  out[length++] = value;
+  return length;
+}
+
+bool getVarint(const uint8_t *data, size_t length, size_t &pos, uint32_t &value) {
+  value = 0;
+  for (int shift = 0; shift < 35 && pos < length; shift += 7) {
+    uint8_t byte = data[pos++];
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+uint32_t zigzag(int32_t value) {
+  return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+int32_t unzigzag(uint32_t value) {
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+int32_t logScale(uint8_t decimals) {
+  int32_t scale = 1;
+  while (decimals--) scale *= 10;
+  return scale;
+}
+
+void logSegmentPath(char *path, size_t size, uint32_t sequence) {
+  snprintf(path, size, LOG_DIR "/%08lx", (unsigned long)sequence);
+}
+
+// Seconds for a new record, and whether they are Unix time
+uint32_t logTime(bool &clockSet) {
+  time_t now = time(nullptr);
+  clockSet = now > (time_t)LOG_CLOCK_VALID;
+  return clockSet ? (uint32_t)now : millis() / 1000;
+}
+
+// Read a segment's header and batch headers into its index entry. Stops at
+// the first batch header that makes no sense, the segment ends there.
+bool scanLogSegment(uint32_t sequence, LogSegmentInfo &info) {
+  char path[24];
+  logSegmentPath(path, sizeof(path), sequence);
+  File file = logFS->open(path, FILE_READ);
+  if (!file) return false;
+
+  LogSegmentHeader header;
+  if (file.read((uint8_t *)&header, sizeof(header)) != sizeof(header) || header.magic != LOG_SEGMENT_MAGIC ||
+      header.crc != logCrc(0, &header, offsetof(LogSegmentHeader, crc)) || header.sequence != sequence) {
+    return false;
+  }
+  info = { sequence, header.boot, (uint16_t)header.flags, 0, 0, sizeof(header), 0 };
+
+  size_t fileSize = file.size();
+  LogBatchHeader batch;
+  while (info.size + sizeof(batch) <= fileSize) {
+    if (file.read((uint8_t *)&batch, sizeof(batch)) != sizeof(batch)) break;
+    if (batch.magic != LOG_BATCH_MAGIC || batch.length > LOG_BATCH_PAYLOAD) break;
+    if (info.size + sizeof(batch) + batch.length > fileSize) break;  // Cut short
+    if (info.batches == 0) info.firstTime = batch.firstTime;
+    info.lastTime = batch.lastTime;
+    info.size += sizeof(batch) + batch.length;
+    info.batches++;
+    file.seek(info.size);
+  }
+  return true;
+}
+
+// Build the index from the files in /log, oldest first
+void loadLogIndex() {
+  logIndex.count = 0;
+  logIndex.totalBytes = 0;
+  logFS->mkdir(LOG_DIR);
+
+  uint32_t sequences[LOG_MAX_SEGMENTS];
+  uint8_t found = 0;
+  File dir = logFS->open(LOG_DIR);
+  for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) {
+    char *end;
+    uint32_t sequence = strtoul(entry.name(), &end, 16);
+    if (*end != '\0' || sequence == 0) continue;
+    if (found == LOG_MAX_SEGMENTS) break;  // Eviction keeps it below that
+    sequences[found++] = sequence;
+  }
+
+  // Insertion sort, a few dozen entries at most
+  for (uint8_t i = 1; i < found; i++) {
+    uint32_t sequence = sequences[i];
+    int j = i - 1;
+    for (; j >= 0 && sequences[j] > sequence; j--) sequences[j + 1] = sequences[j];
+    sequences[j + 1] = sequence;
+  }
+
+  for (uint8_t i = 0; i < found; i++) {
+    LogSegmentInfo &info = logIndex.segments[logIndex.count];
+    if (!scanLogSegment(sequences[i], info)) {
+      Serial.printf("Sensor log: segment %08lx unreadable, removed\n", (unsigned long)sequences[i]);
+      char path[24];
+      logSegmentPath(path, sizeof(path), sequences[i]);
+      logFS->remove(path);
+      continue;
+    }
+    logIndex.totalBytes += info.size;
+    logIndex.count++;
+  }
+}
+
+void closeExportsOn(uint32_t sequence);
+
+// Delete the oldest segment. If the delete fails the segment stays in the
+// index and in the size budget, and returns false.
+bool evictLogSegment() {
+  char path[24];
+  logSegmentPath(path, sizeof(path), logIndex.segments[0].sequence);
+  closeExportsOn(logIndex.segments[0].sequence);  // They go on with the next segment
+  if (!logFS->remove(path)) {
+    logIndex.evictFailures++;
+    return false;
+  }
+  logIndex.totalBytes -= logIndex.segments[0].size;
+  memmove(&logIndex.segments[0], &logIndex.segments[1], (logIndex.count - 1) * sizeof(LogSegmentInfo));
+  logIndex.count--;
+  logIndex.evicted++;
+  return true;
+}
+
+// Start a new segment, making room for it first. Without the room no
+// segment is opened, the next reading tries again.
+bool openLogSegment(bool clockSet) {
+  if (logSegmentOpen) logFile.close();
+  logSegmentOpen = false;
+
+  while (logIndex.count > 0 &&
+         (logIndex.count == LOG_MAX_SEGMENTS || logIndex.totalBytes + LOG_SEGMENT_SIZE > LOG_MAX_BYTES)) {
+    if (!evictLogSegment()) {
+      logIndexSnapshot.publish(logIndex);
+      return false;
+    }
+  }
+
+  LogSegmentHeader header;
+  header.magic = LOG_SEGMENT_MAGIC;
+  header.version = LOG_FORMAT_VERSION;
+  header.boot = logBoot;
+  header.sequence = logIndex.count ? logIndex.segments[logIndex.count - 1].sequence + 1 : 1;
+  header.flags = clockSet ? LOG_SEGMENT_CLOCK_SET : 0;
+  header.crc = logCrc(0, &header, offsetof(LogSegmentHeader, crc));
+
+  char path[24];
+  logSegmentPath(path, sizeof(path), header.sequence);
+  logFile = logFS->open(path, FILE_WRITE);
+  if (!logFile || logFile.write((const uint8_t *)&header, sizeof(header)) != sizeof(header)) {
+    if (logFile) logFile.close();
+    logFS->remove(path);
+    logIndex.writeFailures++;
+    logIndexSnapshot.publish(logIndex);
+    return false;
+  }
+  logFile.flush();
+
+  logIndex.segments[logIndex.count++] = { header.sequence, logBoot, (uint16_t)header.flags, 0, 0, sizeof(header), 0 };
+  logIndex.totalBytes += sizeof(header);
+  logSegmentOpen = true;
+  logIndexSnapshot.publish(logIndex);
+  return true;
+}
+
+void resetLogBatch() {
+  logBatch.header.count = 0;
+  logBatch.header.length = 0;
+  memset(logPrevious, 0, sizeof(logPrevious));
+}
+
+// Append the batch being filled to the newest segment
+void writeLogBatch() {
+  LogBatchHeader &header = logBatch.header;
+  if (header.count == 0) return;
+
+  LogSegmentInfo *segment = logSegmentOpen ? &logIndex.segments[logIndex.count - 1] : nullptr;
+  if (segment && segment->size + sizeof(header) + header.length > LOG_SEGMENT_SIZE) {
+    if (!openLogSegment(segment->flags & LOG_SEGMENT_CLOCK_SET)) segment = nullptr;
+    else segment = &logIndex.segments[logIndex.count - 1];
+  }
+
+  header.magic = LOG_BATCH_MAGIC;
+  header.reserved = 0;
+  header.crc = logBatchCrc(logBatch);
+  size_t length = sizeof(header) + header.length;
+
+  if (!segment || logFile.write((const uint8_t *)&logBatch, length) != length) {
+    // The batch is lost, a short write is cut off by the next scan
+    logIndex.writeFailures++;
+    if (logSegmentOpen) logFile.close();
+    logSegmentOpen = false;
+  } else {
+    logFile.flush();  // Commits the write, littlefs keeps the previous state until then
+    if (segment->batches == 0) segment->firstTime = header.firstTime;
+    segment->lastTime = header.lastTime;
+    segment->size += length;
+    segment->batches++;
+    logIndex.totalBytes += length;
+    logIndex.batchesWritten++;
+  }
+
+  resetLogBatch();
+  logIndexSnapshot.publish(logIndex);
+}
+
+// Encode one reading into the batch, writing the batch out first if full
+void appendLogRecord(uint8_t sensor, uint32_t time, const float *values) {
+  const SensorDriver &driver = *SENSORS[sensor];
+  for (int attempt = 0; attempt < 2; attempt++) {
+    LogBatchHeader &header = logBatch.header;
+    if (header.count == 0) {
+      header.firstTime = header.lastTime = time;
+      logBatchStarted = millis();
+    }
+
+    uint8_t record[LOG_RECORD_MAX];
+    int32_t scaled[SENSOR_MAX_VALUES];
+    size_t length = 0;
+    record[length++] = sensor | (driver.valueCount << 5);
+    length += putVarint(record + length, time >= header.lastTime ? time - header.lastTime : 0);
+    for (uint8_t v = 0; v < driver.valueCount; v++) {
+      scaled[v] = lroundf(values[v] * logScale(driver.quantities[v].decimals));
+      length += putVarint(record + length, zigzag(scaled[v] - logPrevious[sensor][v]));
+    }
+
+    if (header.length + length > LOG_BATCH_PAYLOAD) {
+      writeLogBatch();  // Deltas start over in the next batch, so encode again
+      continue;
+    }
+    memcpy(logBatch.payload + header.length, record, length);
+    header.length += length;
+    header.count++;
+    if (time > header.lastTime) header.lastTime = time;
+    memcpy(logPrevious[sensor], scaled, driver.valueCount * sizeof(int32_t));
+    return;
+  }
+}
+
+// Called once from the persistence task: mounts the filesystem and reads
+// the index, which takes a moment with a full log
+void setupLog() {
+  if (!LittleFS.begin(true)) {
+    Serial.println("Sensor log: LittleFS mount failed, not logging");
+    return;
+  }
+  configTime(0, 0, LOG_NTP_SERVER);  // Sets the clock once the STA connection is up
+
+  loadLogIndex();
+  logBoot = logIndex.count ? logIndex.segments[logIndex.count - 1].boot + 1 : 0;
+  resetLogBatch();
+  logReady = true;
+  logIndexSnapshot.publish(logIndex);
+  Serial.printf("Sensor log: %u segments, %lu bytes\n", logIndex.count, (unsigned long)logIndex.totalBytes);
+}
+
+// Called from the persistence task: logs the readings that came in since
+// the last call, writing a batch once it is full or old enough
+void updateLog() {
+  if (!logReady) return;
+
+  SensorSnapshot snapshot;
+  sensorSnapshot.read(snapshot);
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    const SensorReading &reading = snapshot.readings[i];
+    if (!reading.valid || reading.timestamp == logLastRead[i]) continue;
+    logLastRead[i] = reading.timestamp;
+
+    bool clockSet;
+    uint32_t time = logTime(clockSet);
+    // Segments hold one kind of time, the clock being set starts a new one
+    if (!logSegmentOpen || (bool)(logIndex.segments[logIndex.count - 1].flags & LOG_SEGMENT_CLOCK_SET) != clockSet) {
+      writeLogBatch();
+      if (!openLogSegment(clockSet)) continue;
+    }
+    appendLogRecord(i, time, reading.values);
+  }
+
+  if (logBatch.header.count > 0 && millis() - logBatchStarted >= LOG_MAX_BATCH_AGE_MS) writeLogBatch();
+}
+
+//////////////////////// Export ////////////////////////
+//
+// /log responses are sent from the AsyncTCP task, which must not wait on
+// flash. The persistence task reads each export's batches in range and
+// hands them over through a queue, LOG_EXPORT_AHEAD at a time. The response
+// turns them into CSV rows, or sends them as stored. While the queue is
+// empty it has the server try again at its next poll.
+
+#define LOG_EXPORTS 2       // /log responses at a time
+#define LOG_EXPORT_AHEAD 8  // Batches read ahead per export, 2 KB
+
+enum LogFormat : uint8_t {
+  LOG_FORMAT_CSV,     // time,boot,sensor,values...
+  LOG_FORMAT_BINARY,  // Segment headers and batches as stored
+};
+
+enum LogExportState : uint8_t {
+  LOG_EXPORT_FREE,
+  LOG_EXPORT_OPEN,    // A response reads it, the persistence task fills it
+  LOG_EXPORT_CLOSED,  // The response is gone, the persistence task frees it
+};
+
+// One batch handed from the persistence task to a response
+struct LogExportItem {
+  bool last;                 // The export is complete, nothing else is set
+  bool newSegment;           // First batch of its segment
+  LogSegmentHeader segment;  // The segment the batch is from
+  LogBatch batch;
+};
+
+struct LogExport {
+  std::atomic<uint8_t> state{ LOG_EXPORT_FREE };
+  uint32_t from;  // Set by handleLog() before it opens the export
+  uint32_t to;
+  SpscQueue<LogExportItem, LOG_EXPORT_AHEAD + 1> items;
+
+  // Persistence task only
+  bool reading;          // Picked up since it was opened
+  bool finished;         // The last item is queued
+  uint32_t sequence;     // Segment being read, 0 before the first
+  uint32_t segmentEnd;
+  bool newSegment;
+  LogSegmentHeader segment;
+  File file;
+};
+
+LogExport logExports[LOG_EXPORTS];
+
+//////////////////////// Export, persistence task side ////////////////////////
+
+// A segment is about to be deleted, exports reading it skip to the next one
+void closeExportsOn(uint32_t sequence) {
+  for (LogExport &exp : logExports) {
+    if (exp.reading && exp.sequence == sequence && exp.file) exp.file.close();
+  }
+}
+
+// Open the next segment with readings in range, false when there is none
+bool openNextExportSegment(LogExport &exp) {
+  if (exp.file) exp.file.close();
+  for (uint8_t i = 0; i < logIndex.count; i++) {
+    const LogSegmentInfo &info = logIndex.segments[i];
+    if (info.sequence <= exp.sequence) continue;
+    exp.sequence = info.sequence;
+    if (info.batches == 0 || info.lastTime < exp.from || info.firstTime > exp.to) continue;
+
+    char path[24];
+    logSegmentPath(path, sizeof(path), info.sequence);
+    exp.file = logFS->open(path, FILE_READ);
+    if (!exp.file) continue;
+    if (exp.file.read((uint8_t *)&exp.segment, sizeof(exp.segment)) != sizeof(exp.segment)) {
+      exp.file.close();
+      continue;
+    }
+    exp.segmentEnd = info.size;
+    exp.newSegment = true;
+    return true;
+  }
+  return false;
+}
+
+// Read the next intact batch in range of the open segment, false at its end
+bool readNextExportBatch(LogExport &exp, LogBatch &batch) {
+  if (!exp.file) return false;
+  LogBatchHeader &header = batch.header;
+  for (;;) {
+    size_t position = exp.file.position();
+    if (position + sizeof(header) > exp.segmentEnd) return false;
+    if (exp.file.read((uint8_t *)&header, sizeof(header)) != sizeof(header)) return false;
+    if (header.magic != LOG_BATCH_MAGIC || header.length > LOG_BATCH_PAYLOAD) {
+      logCrcErrors.fetch_add(1, std::memory_order_relaxed);
+      return false;  // Lost the batch boundaries, skip the rest of the segment
+    }
+    if (header.lastTime < exp.from || header.firstTime > exp.to) {
+      exp.file.seek(position + sizeof(header) + header.length);
+      continue;
+    }
+    if (exp.file.read(batch.payload, header.length) != header.length) return false;
+    if (header.crc != logBatchCrc(batch)) {
+      logCrcErrors.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    return true;
+  }
+}
+
+// Fill one export's queue, ending it with a last item
+void fillLogExport(LogExport &exp) {
+  static LogExportItem item;  // Off the task's stack
+  while (!exp.finished && exp.items.space() > 0) {
+    if (readNextExportBatch(exp, item.batch)) {
+      item.last = false;
+      item.newSegment = exp.newSegment;
+      item.segment = exp.segment;
+      exp.newSegment = false;
+      exp.items.push(item);
+    } else if (!openNextExportSegment(exp)) {
+      item.last = true;
+      exp.items.push(item);
+      exp.finished = true;
+    }
+  }
+}
+
+// Called from the persistence task: reads ahead for the open exports and
+// frees the ones whose response is gone
+void updateLogExports() {
+  if (!logReady) return;
+  for (LogExport &exp : logExports) {
+    uint8_t state = exp.state.load(std::memory_order_acquire);
+    if (state == LOG_EXPORT_CLOSED) {
+      if (exp.file) exp.file.close();
+      exp.reading = false;
+      exp.state.store(LOG_EXPORT_FREE, std::memory_order_release);
+    } else if (state == LOG_EXPORT_OPEN) {
+      if (!exp.reading) {
+        exp.reading = true;
+        exp.finished = false;
+        exp.sequence = 0;
+      }
+      fillLogExport(exp);
+    }
+  }
+}
+
+//////////////////////// Export, response side ////////////////////////
+
+// State of one /log response while it is being streamed. Holds one batch
+// at a time, however long the range.
+struct LogCursor : LineSource {
+  LogExport *exp = nullptr;
+  uint32_t from = 0;
+  uint32_t to = UINT32_MAX;
+  LogFormat format = LOG_FORMAT_CSV;
+
+  LogExportItem item;    // Batch being sent
+  size_t recordPos = 0;  // Next record in item.batch.payload
+  uint16_t recordsLeft = 0;
+  uint32_t time = 0;
+  int32_t previous[SENSOR_COUNT][SENSOR_MAX_VALUES];
+
+  const uint8_t *raw = nullptr;  // Binary bytes still to send
+  size_t rawLength = 0;
+  bool batchPending = false;     // Binary: the batch follows its segment header
+
+  bool started = false;
+  bool ended = false;
+
+  // The response is gone, the persistence task frees the export
+  ~LogCursor() {
+    if (exp) exp->state.store(LOG_EXPORT_CLOSED, std::memory_order_release);
+  }
+
+  bool nextLine() override;
+
+  // Nothing to send yet isn't the end, the server asks again later
+  size_t read(uint8_t *buffer, size_t maxLen) {
+    size_t written = LineSource::read(buffer, maxLen);
+    return written == 0 && !ended ? RESPONSE_TRY_AGAIN : written;
+  }
+};
+
+// Decode the next record into a CSV row, returns false if it is out of
+// range. A record the firmware can't decode ends the batch.
+bool nextLogRow(LogCursor &cursor) {
+  const LogBatchHeader &header = cursor.item.batch.header;
+  const uint8_t *payload = cursor.item.batch.payload;
+  cursor.recordsLeft--;
+
+  uint8_t tag = payload[cursor.recordPos++];
+  uint8_t sensor = tag & 0x1F;
+  uint8_t count = tag >> 5;
+  uint32_t delta;
+  if (sensor >= SENSOR_COUNT || count > SENSOR_MAX_VALUES || !getVarint(payload, header.length, cursor.recordPos, delta)) {
+    cursor.recordsLeft = 0;  // Written by a firmware with other sensors
+    return false;
+  }
+  cursor.time += delta;
+
+  const SensorDriver &driver = *SENSORS[sensor];
+  int length = snprintf(cursor.line, sizeof(cursor.line), "%lu,%u,%s", (unsigned long)cursor.time,
+                        cursor.item.segment.boot, driver.name);
+  for (uint8_t v = 0; v < count; v++) {
+    uint32_t encoded;
+    if (!getVarint(payload, header.length, cursor.recordPos, encoded)) {
+      cursor.recordsLeft = 0;
+      return false;
+    }
+    cursor.previous[sensor][v] += unzigzag(encoded);
+    uint8_t decimals = v < driver.valueCount ? driver.quantities[v].decimals : 0;
+    length += snprintf(cursor.line + length, sizeof(cursor.line) - length, ",%.*f", decimals,
+                       cursor.previous[sensor][v] / (double)logScale(decimals));
+  }
+  if (cursor.time < cursor.from || cursor.time > cursor.to) return false;
+  length += snprintf(cursor.line + length, sizeof(cursor.line) - length, "\n");
+  cursor.lineLen = length;
+  return true;
+}
+
+// Produce the next row, or the next piece of a binary batch. Returns false
+// at the end, and while the persistence task hasn't read further yet.
+bool nextLogLine(LogCursor &cursor) {
+  if (!cursor.started) {
+    cursor.started = true;
+    if (cursor.format == LOG_FORMAT_CSV) {
+      cursor.lineLen = snprintf(cursor.line, sizeof(cursor.line), "time,boot,sensor,values\n");
+      return true;
+    }
+  }
+
+  for (;;) {
+    if (cursor.rawLength > 0) {
+      size_t chunk = cursor.rawLength < sizeof(cursor.line) ? cursor.rawLength : sizeof(cursor.line);
+      memcpy(cursor.line, cursor.raw, chunk);
+      cursor.raw += chunk;
+      cursor.rawLength -= chunk;
+      cursor.lineLen = chunk;
+      return true;
+    }
+    if (cursor.batchPending) {
+      cursor.batchPending = false;
+      cursor.raw = (const uint8_t *)&cursor.item.batch;
+      cursor.rawLength = sizeof(LogBatchHeader) + cursor.item.batch.header.length;
+      continue;
+    }
+    if (cursor.recordsLeft > 0) {
+      if (nextLogRow(cursor)) return true;
+      continue;
+    }
+
+    if (cursor.ended || !cursor.exp->items.pop(cursor.item)) return false;
+    if (cursor.item.last) {
+      cursor.ended = true;
+      return false;
+    }
+    if (cursor.format == LOG_FORMAT_BINARY) {
+      if (cursor.item.newSegment) {
+        cursor.raw = (const uint8_t *)&cursor.item.segment;
+        cursor.rawLength = sizeof(cursor.item.segment);
+      }
+      cursor.batchPending = true;
+    } else {
+      cursor.recordPos = 0;
+      cursor.recordsLeft = cursor.item.batch.header.count;
+      cursor.time = cursor.item.batch.header.firstTime;
+      memset(cursor.previous, 0, sizeof(cursor.previous));
+    }
+  }
+}
+
+bool LogCursor::nextLine() {
+  return nextLogLine(*this);
+}
+
+// Log Route: /log?from=<s>&to=<s>&format=csv|binary, streamed from flash by
+// way of the persistence task
+void handleLog(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+
+  // Only this handler opens exports, so a free one stays free until it does
+  LogExport *exp = nullptr;
+  for (LogExport &candidate : logExports) {
+    if (candidate.state.load(std::memory_order_acquire) == LOG_EXPORT_FREE) {
+      exp = &candidate;
+      break;
+    }
+  }
+  if (!logReady || !exp) {
+    noteResponseStatus(503);
+    request->send(503, "text/plain", logReady ? "Too many log exports" : "Sensor log not mounted");
+    return;
+  }
+
+  bool binary = request->hasParam("format") && request->getParam("format")->value() == "binary";
+  SourceResponse<LogCursor> *response =
+    new SourceResponse<LogCursor>(request, binary ? "application/octet-stream" : "text/csv");
+  LogCursor *cursor = &response->source;
+  cursor->format = binary ? LOG_FORMAT_BINARY : LOG_FORMAT_CSV;
+  if (request->hasParam("from")) cursor->from = strtoul(request->getParam("from")->value().c_str(), nullptr, 10);
+  if (request->hasParam("to")) cursor->to = strtoul(request->getParam("to")->value().c_str(), nullptr, 10);
+
+  // Drop what the last export left queued, the persistence task stopped
+  // filling the queue before it freed the export
+  while (exp->items.pop(cursor->item)) {}
+  exp->from = cursor->from;
+  exp->to = cursor->to;
+  cursor->exp = exp;
+  exp->state.store(LOG_EXPORT_OPEN, std::memory_order_release);
+  request->send(response);
+}
+
+#endif  // SENSOR_LOG_H
@@ -0,0 +1,159 @@
+#ifndef SENSORS_H
+#define SENSORS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "sensor_driver.h"
+#include "sensor_drivers.h"
+#include "sensor_history.h"
+#include "snapshot.h"
+
+// Per-sensor timing, exported by /metrics
+struct SensorStats {
+  unsigned long reads;
+  unsigned long failures;
+  unsigned long lastReadUs;  // read() runs on the I/O task, the DHT22 holds it for several milliseconds
+  unsigned long maxReadUs;
+};
+
+// Latest values of one sensor
+struct SensorReading {
+  float values[SENSOR_MAX_VALUES];
+  unsigned long timestamp;  // millis() of the last successful read
+  bool valid;               // false until the first good read, or after a failed one
+};
+
+// State of one sensor, only touched from the I/O task
+struct SensorState {
+  SensorReading reading;
+
+  // Scheduling
+  bool measuring;           // start() was called, read() is still due
+  unsigned long lastStart;
+  unsigned long readyAt;
+
+  SensorStats stats;
+};
+
+// What the web handlers see, published after every read
+struct SensorSnapshot {
+  SensorReading readings[SENSOR_COUNT];
+  SensorStats stats[SENSOR_COUNT];
+  unsigned long version;
+};
+
+SensorState sensorStates[SENSOR_COUNT];
+std::atomic<uint32_t> sensorPeriodMs[SENSOR_COUNT];  // 0 for the driver's own, set from any task
+unsigned long sensorVersion = 0;  // Bumped whenever any cached value changes
+Snapshot<SensorSnapshot> sensorSnapshot;
+
+SensorSnapshot readSensorSnapshot() {
+  SensorSnapshot snapshot;
+  sensorSnapshot.read(snapshot);
+  return snapshot;
+}
+
+void publishSensorSnapshot() {
+  SensorSnapshot snapshot;
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    snapshot.readings[i] = sensorStates[i].reading;
+    snapshot.stats[i] = sensorStates[i].stats;
+  }
+  snapshot.version = sensorVersion;
+  sensorSnapshot.publish(snapshot);
+}
+
+// Change how often a sensor is read, never going below what the driver
+// supports. Takes effect from the next start, so a shorter period does not
+// wait out the old one. False if there is no such sensor.
+bool setSensorPeriod(uint8_t index, uint32_t periodMs) {
+  if (index >= SENSOR_COUNT) return false;
+  sensorPeriodMs[index] = periodMs < SENSORS[index]->periodMs ? SENSORS[index]->periodMs : periodMs;
+  return true;
+}
+
+// Milliseconds since the values of a reading were taken
+unsigned long sensorSampleAge(const SensorReading &reading) {
+  return millis() - reading.timestamp;
+}
+
+// Fetch one sensor's measurement and update its cache
+void readSensor(uint8_t index) {
+  SensorDriver &driver = *SENSORS[index];
+  SensorState &state = sensorStates[index];
+  SensorReading &reading = state.reading;
+  float values[SENSOR_MAX_VALUES];
+
+  unsigned long readStart = micros();
+  bool ok = driver.read(values);
+  state.measuring = false;
+
+  state.stats.reads++;
+  state.stats.lastReadUs = micros() - readStart;
+  if (state.stats.lastReadUs > state.stats.maxReadUs) state.stats.maxReadUs = state.stats.lastReadUs;
+
+  if (!ok) {
+    state.stats.failures++;
+    if (reading.valid) sensorVersion++;
+    reading.valid = false;  // Keep the last good values, but flag them
+    publishSensorSnapshot();
+    return;
+  }
+
+  bool changed = !reading.valid;
+  for (uint8_t i = 0; i < driver.valueCount; i++) {
+    if (values[i] != reading.values[i]) changed = true;
+    reading.values[i] = values[i];
+  }
+  if (changed) sensorVersion++;
+
+  reading.timestamp = millis();
+  reading.valid = true;
+  publishSensorSnapshot();
+
+  if (index == 0 && driver.valueCount >= 2) {
+    recordSensorHistory(values[0], values[1], reading.timestamp);
+  }
+}
+
+// Called from the I/O task: starts due measurements, then reads at most
+// one sensor, the one whose data has been ready the longest. Reads can
+// block for a few milliseconds, so one per tick keeps the LEDs responsive
+// and no sensor waits behind another's conversion.
+void updateSensors() {
+  unsigned long now = millis();
+  int next = -1;
+  long longestReady = -1;
+
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    SensorState &state = sensorStates[i];
+
+    if (!state.measuring) {
+      uint32_t period = sensorPeriodMs[i].load(std::memory_order_relaxed);
+      if (!period) period = SENSORS[i]->periodMs;
+      if (state.stats.reads && now - state.lastStart < period) continue;
+      state.lastStart = now;
+      state.readyAt = now + SENSORS[i]->start();
+      state.measuring = true;
+    }
+
+    long ready = now - state.readyAt;
+    if (ready >= 0 && ready > longestReady) {
+      longestReady = ready;
+      next = i;
+    }
+  }
+
+  if (next >= 0) readSensor(next);
+}
+
+void setupSensors() {
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) {
+    SENSORS[i]->begin();
+    sensorStates[i] = {};
+    for (uint8_t v = 0; v < SENSOR_MAX_VALUES; v++) sensorStates[i].reading.values[v] = NAN;
+  }
+  publishSensorSnapshot();
+}
+
+#endif  // SENSORS_H
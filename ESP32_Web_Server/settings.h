@@ -2,115 +2,140 @@
 #define SETTINGS_H
 
 #include <ESPAsyncWebServer.h>
-#include <Preferences.h>
 #include <WiFi.h>
 #include <ctime>
+#include "auth.h"
+#include "config.h"
+#include "json_writer.h"
+#include "pooled_response.h"
+#include "templates.h"
+#include "wifi_control.h"
+
+PageTemplate RESULT_PAGE = { RESULT_TEMPLATE };
+
+// What a result page shows. The response keeps a copy, the message may
+// live on the caller's stack and the page is rendered later.
+struct ResultPageValues {
+  const char *title;  // String literals
+  const char *redirect;
+  char message[80];
+  char jobId[11];
+};
+
+const char *resultPageValue(const ResultPageValues &values, const char *name, size_t length) {
+  if (templateNameIs(name, length, "TITLE")) return values.title;
+  if (templateNameIs(name, length, "MESSAGE")) return values.message;
+  if (templateNameIs(name, length, "REDIRECT")) return values.redirect;
+  if (templateNameIs(name, length, "JOB")) return values.jobId;
+  return nullptr;
+}
 
-extern String currentSSID;
-extern String currentWiFiPassword;
-extern String currentAPSSID;
-extern String currentAPPassword;
-extern String wifiOptionsHTML;
-extern String currentUsername;
-extern String currentPassword;
-extern AsyncWebServer server;
-extern Preferences preferences;
-
-#define WIFI_ATTEMPTS 10
-#define WIFI_DELAY_MS 1000
-
-// Scan available wifi SSID
-void scanForWiFiNetworks() {
-  String options = "";
-  int n = WiFi.scanNetworks();  // Perform Wi-Fi scan
-  if (n == 0) {
-    options = "<option value='Null'>No Networks Found</option>";
-  } else {
-    for (int i = 0; i < n; i++) {
-      options += "<option value='" + WiFi.SSID(i) + "'>";
-      options += WiFi.SSID(i) + " (" + String(WiFi.RSSI(i)) + "dB)";
-      options += "</option>";
-    }
-  }
-  wifiOptionsHTML = options;
-  WiFi.scanDelete();
+// Show the outcome of a settings update, then go back to the given page.
+// With a job ID the page waits for the Wi-Fi job to finish first.
+void sendResultPage(AsyncWebServerRequest *request, const char *title, const char *message, const char *redirect,
+                    uint32_t job = 0) {
+  ResultPageValues values = { title, redirect, "", "" };
+  snprintf(values.message, sizeof(values.message), "%s", message);
+  if (job) snprintf(values.jobId, sizeof(values.jobId), "%lu", (unsigned long)job);
+  sendTemplate(request, 200, RESULT_PAGE, resultPageValue, values);
 }
 
 // Settings Page Handler
-void handleSettings(AsyncWebServerRequest *request) {
-  if (!ensureLoggedIn(request)) return;
-
-  String html = FPSTR(SETTINGS_HTML);
-  html.replace("%WIFI_OPTIONS%", wifiOptionsHTML);
-  html.replace("CURRENT_SSID", currentSSID);
-  html.replace("CURRENT_USERNAME", currentUsername);
-  request->send(200, "text/html", html);
+void handleSettings(const RequestContext &context) {
+  sendPage(context.request, SETTINGS_PAGE);
+}
+
+// Dynamic values of the settings page, also keeps the Wi-Fi scan going
+void handleSettingsData(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+  requestWiFiScan();
+
+  Config saved = readConfig();
+  const WiFiSnapshot &wifi = readWiFiSnapshot();
+
+  PooledResponse *response = beginPooledResponse(request, "application/json");
+  JsonWriter json(response->source);
+  json.beginObject();
+  json.field("ssid", (const char *)saved.ssid);
+  json.field("username", (const char *)saved.username);
+  json.field("mqttHost", (const char *)saved.mqttHost);
+  json.field("mqttPort", (const char *)saved.mqttPort);
+  json.field("mqttTopic", (const char *)saved.mqttTopic);
+  json.field("scanning", wifi.scanning);
+
+  json.key("networks");
+  json.beginArray();
+  for (int i = 0; i < wifi.networkCount; i++) {
+    json.beginObject();
+    json.field("ssid", (const char *)wifi.networks[i].ssid);
+    json.field("rssi", (long)wifi.networks[i].rssi);
+    json.endObject();
+  }
+  json.endArray();
+
+  const WiFiScanStats &stats = wifi.scanStats;
+  json.key("scan");
+  json.beginObject();
+  json.field("count", stats.scans);
+  json.field("lastMs", stats.lastDurationMs);
+  json.field("maxMs", stats.maxDurationMs);
+  json.field("maxBlockingUs", stats.maxBlockingUs);
+  json.field("stalls", stats.stalls);
+  json.field("requestsDuringScan", stats.requestsDuringScan);
+  json.endObject();
+
+  json.endObject();
+  sendPooledResponse(request, response);
 }
 
 // Update Settings Handler
-void handleUpdateSettings(AsyncWebServerRequest *request) {
+void handleUpdateSettings(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
   bool isUpdated = false;
-  IPAddress clientIP = request->client()->remoteIP();
-
-  if (!ensureLoggedIn(request)) return;
-  if (userRoles[clientIP] != "admin") return;
+  uint32_t job = 0;
+  char connectingMessage[64];
+  Config saved = readConfig();
 
   if (request->method() == HTTP_POST) {
-    preferences.begin("settings", false);
+    // Queue all of the changes or none of them. This handler is the queue's
+    // only producer, so the room checked here can't shrink below.
+    if (webConfigUpdates.space() < CONFIG_FIELDS_PER_UPDATE) {
+      noteResponseStatus(503);
+      request->send(503, "text/plain", "Settings busy, try again");
+      return;
+    }
+    bool busy = false;  // A change was refused by a full queue
 
-    // Wifi SSID and password
+    // Changes are saved in one batch by updateConfig()
+    // Wifi SSID and password, connected in the background by wifi_manager.h
     if (request->hasParam("ssid", true) && request->hasParam("wifi_password", true)) {
-      currentSSID = request->getParam("ssid", true)->value();
-      currentWiFiPassword = request->getParam("wifi_password", true)->value();
-
-      if (currentSSID.length() != 0 && currentWiFiPassword.length() != 0) {
-        Serial.print("Attempting to connect to SSID: ");
-        Serial.println(currentSSID);
-
-        WiFi.begin(currentSSID.c_str(), currentWiFiPassword.c_str());
-
-        int attempts = 0;
-        while (WiFi.status() != WL_CONNECTED && attempts < WIFI_ATTEMPTS) {
-          delay(WIFI_DELAY_MS);
-          Serial.print(".");
-          attempts++;
-        }
-
-        if (WiFi.status() == WL_CONNECTED) {
-          preferences.putString("ssid", currentSSID);
-          preferences.putString("wifi_password", currentWiFiPassword);
-          isUpdated = true;
-          Serial.println("Connected to WiFi");
-          Serial.print("IP address: ");
-          Serial.println(WiFi.localIP());
-        } else {
-          Serial.println("Failed to connect to Wi-Fi.");
-        }
+      const String &newSSID = request->getParam("ssid", true)->value();
+      const String &newWiFiPassword = request->getParam("wifi_password", true)->value();
+
+      if (newSSID.length() != 0 && newWiFiPassword.length() != 0 && newSSID.length() < sizeof(saved.ssid) &&
+          newWiFiPassword.length() < sizeof(saved.wifiPassword)) {
+        job = startWiFiJob(newSSID.c_str(), newWiFiPassword.c_str());
+        snprintf(connectingMessage, sizeof(connectingMessage), "Connecting to %s...", newSSID.c_str());
+        isUpdated = job != 0;
+        busy |= job == 0;
       }
     }
 
     // AP SSID and password
     if (request->hasParam("apssid", true) && request->hasParam("ap_password", true)) {
-      String newAPSSID = request->getParam("apssid", true)->value();
-      String newAPPassword = request->getParam("ap_password", true)->value();
-
-      if (newAPSSID.length() > 0 && newAPPassword.length() >= 8) {  // Password length should be at least 8 characters
-        preferences.putString("apssid", newAPSSID);
-        preferences.putString("ap_password", newAPPassword);
-        isUpdated = true;
-
-        Serial.println("Updating Access Point settings...");
-
-        WiFi.softAPdisconnect(true);  // Disconnect any existing AP
-        bool apStarted = WiFi.softAP(newAPSSID.c_str(), newAPPassword.c_str());
-
-        if (apStarted) {
-          Serial.print("New AP SSID: ");
-          Serial.println(newAPSSID);
-          Serial.print("AP Password: ");
-          Serial.println(newAPPassword);
-        } else {
-          Serial.println("Failed to start Access Point.");
+      const String &newAPSSID = request->getParam("apssid", true)->value();
+      const String &newAPPassword = request->getParam("ap_password", true)->value();
+
+      if (newAPSSID.length() > 0 && newAPSSID.length() < sizeof(saved.apSSID) &&
+          newAPPassword.length() >= 8 && newAPPassword.length() < sizeof(saved.apPassword)) {  // Password length should be at least 8 characters
+        bool queued = setConfig(CONFIG_AP_SSID, newAPSSID);
+        queued = setConfig(CONFIG_AP_PASSWORD, newAPPassword) && queued;
+        isUpdated |= queued;
+        busy |= !queued;
+
+        // The Wi-Fi task restarts the access point
+        if (queued && !startAccessPoint(newAPSSID.c_str(), newAPPassword.c_str())) {
+          Serial.println("Wi-Fi task busy, AP restarts after a reboot.");
         }
       } else {
         Serial.println("Invalid AP SSID or Password.");
@@ -119,50 +144,82 @@ void handleUpdateSettings(AsyncWebServerRequest *request) {
 
     // Username and password
     if (request->hasParam("username", true)) {
-      String newUsername = request->getParam("username", true)->value();
-      if (newUsername.length() != 0 && newUsername != currentUsername) {
-        currentUsername = newUsername;
-        preferences.putString("username", currentUsername);
-        isUpdated = true;
-        handleLogout(request);
-        Serial.println("Username updated, user logged out.");
+      const String &newUsername = request->getParam("username", true)->value();
+      if (newUsername.length() != 0 && newUsername != saved.username) {
+        if (setConfig(CONFIG_USERNAME, newUsername)) {
+          isUpdated = true;
+          removeSession(context.session);  // Log out, the result page is still sent
+          Serial.println("Username updated, user logged out.");
+        } else {
+          busy = true;
+        }
       }
     }
 
     if (request->hasParam("password", true)) {
-      String newPassword = request->getParam("password", true)->value();
-      if (newPassword.length() != 0 && newPassword != currentPassword) {
-        currentPassword = newPassword;
-        preferences.putString("password", currentPassword);
-        isUpdated = true;
-        handleLogout(request);
-        Serial.println("Password updated, user logged out.");
+      const String &newPassword = request->getParam("password", true)->value();
+      if (newPassword.length() != 0 && newPassword != saved.password) {
+        if (setConfig(CONFIG_PASSWORD, newPassword)) {
+          isUpdated = true;
+          removeSession(context.session);  // Log out, the result page is still sent
+          Serial.println("Password updated, user logged out.");
+        } else {
+          busy = true;
+        }
       }
     }
 
-    preferences.end();
+    // MQTT broker, the page sends the current values back unless they were
+    // edited. An empty host turns MQTT off.
+    if (request->hasParam("mqtt_host", true) && request->hasParam("mqtt_port", true) && request->hasParam("mqtt_topic", true)) {
+      const String &newHost = request->getParam("mqtt_host", true)->value();
+      const String &newTopic = request->getParam("mqtt_topic", true)->value();
+      long newPort = request->getParam("mqtt_port", true)->value().toInt();
+
+      if (newHost.length() < sizeof(saved.mqttHost) && newPort > 0 && newPort <= 65535 && newTopic.length() > 0 &&
+          newTopic.length() < sizeof(saved.mqttTopic) && newTopic.indexOf('+') < 0 && newTopic.indexOf('#') < 0) {
+        char port[sizeof(saved.mqttPort)];
+        snprintf(port, sizeof(port), "%ld", newPort);
+        if (newHost != saved.mqttHost || strcmp(port, saved.mqttPort) != 0 || newTopic != saved.mqttTopic) {
+          // The mqtt task reconnects once the settings snapshot has them
+          bool queued = setConfig(CONFIG_MQTT_HOST, newHost);
+          queued = queueConfig(webConfigUpdates, CONFIG_MQTT_PORT, port) && queued;
+          queued = setConfig(CONFIG_MQTT_TOPIC, newTopic) && queued;
+          isUpdated |= queued;
+          busy |= !queued;
+        }
+      } else {
+        Serial.println("Invalid MQTT settings.");
+      }
+    }
 
-    if (isUpdated) {
-      request->send(200, "text/html", "<script>alert('Settings Updated Successfully!'); window.location.href='/';</script>");
+    if (busy) {
+      // Only reached if the Wi-Fi task is backed up, or the check above is wrong
+      noteResponseStatus(503);
+      request->send(503, "text/plain", "Some changes were not saved, try again");
+    } else if (job) {
+      sendResultPage(request, "Connecting", connectingMessage, "/", job);
+    } else if (isUpdated) {
+      sendResultPage(request, "Settings Updated", "Settings Updated Successfully!", "/");
     } else {
-      request->send(200, "text/html", "<script>alert('No Changes Made or Connection Failed!'); window.location.href='/settings';</script>");
+      sendResultPage(request, "No Changes", "No Changes Made!", "/settings");
     }
 
   } else {
+    noteResponseStatus(405);
     request->send(405, "text/plain", "Method Not Allowed");
   }
 }
 
-void setupSettingsRoutes() {
-  server.on("/settings", HTTP_GET, [](AsyncWebServerRequest *request) {
-    if (!ensureLoggedInAndAuthorized(request, "admin")) return;
-    handleSettings(request);  // Call the actual settings handler
-  });
+// Wi-Fi Job Status Handler: /settings_job?id=<job>
+void handleSettingsJob(const RequestContext &context) {
+  AsyncWebServerRequest *request = context.request;
+  uint32_t id = request->hasParam("id") ? request->getParam("id")->value().toInt() : 0;
+  WiFiJobState state = wifiJobStateOf(id, readWiFiSnapshot());
 
-  server.on("/update_settings", HTTP_POST, [](AsyncWebServerRequest *request) {
-    if (!ensureLoggedInAndAuthorized(request, "admin")) return;
-    handleUpdateSettings(request);  // Handle settings update
-  });
+  char json[64];
+  snprintf(json, sizeof(json), "{\"id\":%lu,\"state\":\"%s\"}", (unsigned long)id, wifiJobStateName(state));
+  request->send(200, "application/json", json);
 }
 
 #endif
\ No newline at end of file
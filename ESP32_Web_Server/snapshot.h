@@ -0,0 +1,41 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <string.h>
+
+// A value one task publishes and any task can copy out whole (a seqlock).
+// The sequence is odd while a publish is in progress, readers retry until
+// they copied between two publishes. T must be trivially copyable.
+template <typename T>
+class Snapshot {
+public:
+  // Only ever called from the owning task
+  void publish(const T &value) {
+    uint32_t sequence = _sequence.load(std::memory_order_relaxed);
+    _sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&_value, &value, sizeof(T));
+    _sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  void read(T &value) const {
+    for (;;) {
+      uint32_t before = _sequence.load(std::memory_order_acquire);
+      if ((before & 1) == 0) {
+        memcpy(&value, &_value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_sequence.load(std::memory_order_relaxed) == before) return;
+      }
+      // The writer may be a lower priority task on this core, let it finish
+      vTaskDelay(1);
+    }
+  }
+
+private:
+  T _value = {};
+  std::atomic<uint32_t> _sequence{ 0 };
+};
+
+#endif  // SNAPSHOT_H
@@ -0,0 +1,45 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+
+// Fixed-size lock-free queue for exactly one producer task and one consumer
+// task. Holds N - 1 items, push() fails instead of blocking when it is full.
+template <typename T, size_t N>
+class SpscQueue {
+public:
+  // Producer side
+  bool push(const T &item) {
+    size_t head = _head.load(std::memory_order_relaxed);
+    size_t next = (head + 1) % N;
+    if (next == _tail.load(std::memory_order_acquire)) return false;
+    _items[head] = item;
+    _head.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Items that can still be pushed. Only the consumer changes it
+  // meanwhile, and only upwards.
+  size_t space() const {
+    size_t head = _head.load(std::memory_order_relaxed);
+    size_t tail = _tail.load(std::memory_order_acquire);
+    return (tail + N - head - 1) % N;
+  }
+
+  // Consumer side
+  bool pop(T &item) {
+    size_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail == _head.load(std::memory_order_acquire)) return false;
+    item = _items[tail];
+    _tail.store((tail + 1) % N, std::memory_order_release);
+    return true;
+  }
+
+private:
+  T _items[N];
+  std::atomic<size_t> _head{ 0 };
+  std::atomic<size_t> _tail{ 0 };
+};
+
+#endif  // SPSC_QUEUE_H
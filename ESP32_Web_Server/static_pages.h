@@ -0,0 +1,49 @@
+#ifndef STATIC_PAGES_H
+#define STATIC_PAGES_H
+
+#include <ESPAsyncWebServer.h>
+#include "html_pages.h"
+#include "html_pages_gz.h"
+#include "metrics.h"
+
+// A page served straight from flash, with a gzipped copy and their ETags
+struct StaticPage {
+  const char *html;
+  const uint8_t *gzip;
+  size_t gzipLength;
+  const char *etag;
+  const char *gzipEtag;
+};
+
+const StaticPage INDEX_PAGE = { INDEX_HTML, INDEX_HTML_GZ, sizeof(INDEX_HTML_GZ), INDEX_HTML_ETAG, INDEX_HTML_GZ_ETAG };
+const StaticPage LOGIN_PAGE = { LOGIN_HTML, LOGIN_HTML_GZ, sizeof(LOGIN_HTML_GZ), LOGIN_HTML_ETAG, LOGIN_HTML_GZ_ETAG };
+const StaticPage SETTINGS_PAGE = { SETTINGS_HTML, SETTINGS_HTML_GZ, sizeof(SETTINGS_HTML_GZ), SETTINGS_HTML_ETAG, SETTINGS_HTML_GZ_ETAG };
+
+bool acceptsGzip(AsyncWebServerRequest *request) {
+  return request->hasHeader("Accept-Encoding") && request->getHeader("Accept-Encoding")->value().indexOf("gzip") >= 0;
+}
+
+// Send a page without copying it to the heap, or 304 if the client has it
+void sendPage(AsyncWebServerRequest *request, const StaticPage &page) {
+  bool gzip = acceptsGzip(request);
+  const char *etag = gzip ? page.gzipEtag : page.etag;
+
+  AsyncWebServerResponse *response;
+  if (request->hasHeader("If-None-Match") && request->getHeader("If-None-Match")->value().indexOf(etag) >= 0) {
+    noteResponseStatus(304);
+    response = request->beginResponse(304);
+  } else if (gzip) {
+    response = request->beginResponse_P(200, "text/html", page.gzip, page.gzipLength);
+    response->addHeader("Content-Encoding", "gzip");
+  } else {
+    response = request->beginResponse_P(200, "text/html", page.html);
+  }
+
+  // Pages sit behind the login, so caches must revalidate every time
+  response->addHeader("ETag", etag);
+  response->addHeader("Cache-Control", "private, no-cache");
+  response->addHeader("Vary", "Accept-Encoding");
+  request->send(response);
+}
+
+#endif  // STATIC_PAGES_H
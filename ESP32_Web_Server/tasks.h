@@ -0,0 +1,108 @@
+#ifndef TASKS_H
+#define TASKS_H
+
+#include <Arduino.h>
+#include "boot_timing.h"
+#include "config.h"
+#include "led_control.h"
+#include "mqtt.h"
+#include "sensor_log.h"
+#include "sensors.h"
+#include "wifi_control.h"
+
+// Background work runs in its own FreeRTOS tasks instead of loop():
+//   io           LED commands, scenes, fades and the sensors
+//   wifi         STA connection, access point and scans
+//   persistence  Settings and Wi-Fi cache commits to NVS, the sensor log and its exports
+//   mqtt         Telemetry to the MQTT broker
+// Each task owns its state and shares it only through an SpscQueue in and
+// a Snapshot out, so none of them takes a lock. All are pinned to the APP
+// core: the Wi-Fi driver and lwIP run on core 0, and a DHT22 read or an
+// NVS write on that core would hold up the network.
+
+#define TASK_CORE 1  // APP_CPU_NUM
+
+#define IO_TASK_PERIOD_MS 10  // Fade segments and sensor polling need no finer steps
+#define WIFI_TASK_PERIOD_MS 50
+#define PERSISTENCE_TASK_PERIOD_MS 100
+#define MQTT_TASK_PERIOD_MS 100
+
+TaskHandle_t ioTaskHandle = nullptr;
+TaskHandle_t wifiTaskHandle = nullptr;
+TaskHandle_t persistenceTaskHandle = nullptr;
+TaskHandle_t mqttTaskHandle = nullptr;
+
+void ioTask(void *) {
+  // Probing the sensor buses takes a while, so it waits until the server is up
+  setupSensors();
+  markBootPhase(BOOT_SENSORS_READY);
+  for (;;) {
+    processLEDCommands();
+    updateScenes();
+    updateLEDs();
+    publishLEDSnapshot();
+    updateSensors();
+    vTaskDelay(pdMS_TO_TICKS(IO_TASK_PERIOD_MS));
+  }
+}
+
+void wifiTask(void *) {
+  // Connect in the background, see updateWiFiConnection()
+  startWiFiConnection();
+  for (;;) {
+    processWiFiCommands();
+    updateWiFiConnection();
+    updateWiFiScan();
+    publishWiFiSnapshot();
+    vTaskDelay(pdMS_TO_TICKS(WIFI_TASK_PERIOD_MS));
+  }
+}
+
+void persistenceTask(void *) {
+  // Mount the log here, reading its index would hold up setup()
+  setupLog();
+  markBootPhase(BOOT_LOG_MOUNTED);
+  for (;;) {
+    updateConfig();
+    commitWiFiCache();
+    updateLog();
+    updateLogExports();
+    vTaskDelay(pdMS_TO_TICKS(PERSISTENCE_TASK_PERIOD_MS));
+  }
+}
+
+void mqttTask(void *) {
+  for (;;) {
+    updateMqtt();
+    vTaskDelay(pdMS_TO_TICKS(MQTT_TASK_PERIOD_MS));
+  }
+}
+
+struct TaskInfo {
+  const char *name;
+  TaskFunction_t function;
+  uint32_t stackBytes;
+  UBaseType_t priority;  // loop() runs at 1
+  TaskHandle_t *handle;
+};
+
+const TaskInfo TASKS[] = {
+  { "io", ioTask, 4096, 2, &ioTaskHandle },
+  { "wifi", wifiTask, 4096, 1, &wifiTaskHandle },
+  { "persistence", persistenceTask, 8192, 1, &persistenceTaskHandle },  // NVS and LittleFS need a few KB each
+  { "mqtt", mqttTask, 6144, 1, &mqttTaskHandle },  // A message is built on the stack
+};
+#define TASK_COUNT (sizeof(TASKS) / sizeof(TASKS[0]))
+
+// Called once from setup(), after everything the tasks use is set up
+void startTasks() {
+  for (const TaskInfo &task : TASKS) {
+    if (xTaskCreatePinnedToCore(task.function, task.name, task.stackBytes, nullptr, task.priority, task.handle,
+                                TASK_CORE) != pdPASS) {
+      Serial.print("Failed to start task ");
+      Serial.println(task.name);
+    }
+  }
+}
+
+#endif  // TASKS_H
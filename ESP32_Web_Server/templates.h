@@ -0,0 +1,211 @@
+#ifndef TEMPLATES_H
+#define TEMPLATES_H
+
+#include <ESPAsyncWebServer.h>
+#include "pooled_response.h"
+
+// Streaming %PLACEHOLDER% templates
+//
+// A template is split once, on first use, into literal and placeholder
+// segments pointing into the PROGMEM text. Rendering walks the segments and
+// writes straight into the chunked response buffer, so no page-sized String
+// is ever built. Placeholder values are HTML-escaped unless the name starts
+// with '!' (e.g. %!RAW_HTML%). A '%' not followed by [A-Z_!]+% stays literal,
+// so CSS like "width: 100%;" needs no escaping.
+//
+// A template needing more than TEMPLATE_MAX_SEGMENTS segments is cut after
+// the last one that fits. The parse says so on Serial and the page ends in
+// TEMPLATE_CUT_MARKER. tests/test_templates.cpp parses each template in
+// html_pages.h, so the cut also fails the host tests.
+
+#define TEMPLATE_MAX_SEGMENTS 16
+#define TEMPLATE_CUT_MARKER "\n<p>[Page cut short: raise TEMPLATE_MAX_SEGMENTS in templates.h]</p>\n"
+
+struct TemplateSegment {
+  uint16_t offset;  // Into the template text (placeholders: the name, without '%')
+  uint16_t length;
+  bool placeholder;
+  bool raw;  // Placeholder value is written without escaping
+};
+
+struct PageTemplate {
+  const char *text;
+  bool parsed;
+  bool cut;  // More segments than TEMPLATE_MAX_SEGMENTS
+  uint8_t segmentCount;
+  TemplateSegment segments[TEMPLATE_MAX_SEGMENTS];
+};
+
+// Returns the value of a placeholder, or nullptr to leave it empty. context
+// is the response's own copy of what the handler passed to sendTemplate(),
+// so values may point into it.
+template <typename Context>
+using TemplateValues = const char *(*)(const Context &context, const char *name, size_t length);
+
+// True if a placeholder name passed to TemplateValues is exactly key
+bool templateNameIs(const char *name, size_t length, const char *key) {
+  return strlen(key) == length && strncmp(name, key, length) == 0;
+}
+
+void addTemplateSegment(PageTemplate &page, size_t offset, size_t length, bool placeholder, bool raw) {
+  if (length == 0 || page.cut) return;
+  if (page.segmentCount == TEMPLATE_MAX_SEGMENTS) {
+    page.cut = true;
+    Serial.printf("Template cut at byte %u, it needs more than %d segments\n", (unsigned)offset, TEMPLATE_MAX_SEGMENTS);
+    return;
+  }
+  page.segments[page.segmentCount++] = { (uint16_t)offset, (uint16_t)length, placeholder, raw };
+}
+
+// Split the template into segments, done once per template
+void parseTemplate(PageTemplate &page) {
+  if (page.parsed) return;
+  page.parsed = true;
+  page.cut = false;
+  page.segmentCount = 0;
+
+  size_t literalStart = 0;
+  size_t i = 0;
+  while (page.text[i] != '\0') {
+    if (page.text[i] != '%') {
+      i++;
+      continue;
+    }
+
+    size_t nameStart = i + 1;
+    bool raw = page.text[nameStart] == '!';
+    if (raw) nameStart++;
+    size_t end = nameStart;
+    while ((page.text[end] >= 'A' && page.text[end] <= 'Z') || page.text[end] == '_') end++;
+
+    if (end == nameStart || page.text[end] != '%') {
+      i++;  // Not a placeholder, keep it in the literal
+      continue;
+    }
+    addTemplateSegment(page, literalStart, i - literalStart, false, false);
+    addTemplateSegment(page, nameStart, end - nameStart, true, raw);
+    i = end + 1;
+    literalStart = i;
+  }
+  addTemplateSegment(page, literalStart, i - literalStart, false, false);
+}
+
+// HTML entity for a character, or nullptr if it can be written as is
+const char *htmlEntity(char c) {
+  switch (c) {
+    case '&': return "&amp;";
+    case '<': return "&lt;";
+    case '>': return "&gt;";
+    case '"': return "&quot;";
+    case '\'': return "&#39;";
+    default: return nullptr;
+  }
+}
+
+// Position of a response in its template while it is being streamed
+struct TemplateCursor {
+  PageTemplate *page = nullptr;
+  uint8_t segment = 0;
+  size_t position = 0;         // Within the current literal or value
+  const char *value = nullptr;  // Value of the current placeholder, once looked up
+  uint8_t entityPosition = 0;  // Bytes of the current HTML entity already written
+
+  virtual ~TemplateCursor() {}
+  virtual const char *lookup(const char *name, size_t length) const = 0;
+
+  size_t read(uint8_t *buffer, size_t maxLen);
+};
+
+// A cursor with the handler's values, held in the response object. The
+// context is a plain struct and values a plain function, so a page costs
+// the response allocation and nothing else.
+template <typename Context>
+struct TemplateSource : TemplateCursor {
+  Context context;
+  TemplateValues<Context> values = nullptr;
+
+  const char *lookup(const char *name, size_t length) const override {
+    return values(context, name, length);
+  }
+};
+
+// Fill buffer with the next part of the page, returns 0 when done
+size_t renderTemplate(TemplateCursor &cursor, uint8_t *buffer, size_t maxLen) {
+  size_t written = 0;
+  while (written < maxLen && cursor.segment < cursor.page->segmentCount) {
+    const TemplateSegment &segment = cursor.page->segments[cursor.segment];
+
+    if (!segment.placeholder) {
+      size_t chunk = segment.length - cursor.position;
+      if (chunk > maxLen - written) chunk = maxLen - written;
+      memcpy_P(buffer + written, cursor.page->text + segment.offset + cursor.position, chunk);
+      written += chunk;
+      cursor.position += chunk;
+      if (cursor.position < segment.length) break;
+    } else {
+      if (cursor.position == 0 && cursor.value == nullptr) {
+        cursor.value = cursor.lookup(cursor.page->text + segment.offset, segment.length);
+        if (cursor.value == nullptr) cursor.value = "";
+      }
+
+      while (cursor.value[cursor.position] != '\0') {
+        char c = cursor.value[cursor.position];
+        const char *entity = segment.raw ? nullptr : htmlEntity(c);
+        if (entity == nullptr) {
+          if (written == maxLen) return written;
+          buffer[written++] = c;
+          cursor.position++;
+          continue;
+        }
+
+        // Entities may be split across buffers when space is tight
+        size_t size = strlen(entity);
+        while (cursor.entityPosition < size) {
+          if (written == maxLen) return written;
+          buffer[written++] = entity[cursor.entityPosition++];
+        }
+        cursor.entityPosition = 0;
+        cursor.position++;
+      }
+      cursor.value = nullptr;
+    }
+
+    cursor.segment++;
+    cursor.position = 0;
+  }
+
+  // After the last segment of a cut template
+  if (cursor.page->cut && cursor.segment == cursor.page->segmentCount) {
+    static const char marker[] = TEMPLATE_CUT_MARKER;
+    size_t chunk = sizeof(marker) - 1 - cursor.position;
+    if (chunk > maxLen - written) chunk = maxLen - written;
+    memcpy(buffer + written, marker + cursor.position, chunk);
+    written += chunk;
+    cursor.position += chunk;
+    if (cursor.position == sizeof(marker) - 1) {
+      cursor.segment++;
+      cursor.position = 0;
+    }
+  }
+  return written;
+}
+
+size_t TemplateCursor::read(uint8_t *buffer, size_t maxLen) {
+  return renderTemplate(*this, buffer, maxLen);
+}
+
+// Stream a template as a chunked response
+template <typename Context>
+void sendTemplate(AsyncWebServerRequest *request, int code, PageTemplate &page, TemplateValues<Context> values,
+                  const Context &context) {
+  parseTemplate(page);
+
+  SourceResponse<TemplateSource<Context>> *response = new SourceResponse<TemplateSource<Context>>(request, "text/html");
+  response->source.page = &page;
+  response->source.values = values;
+  response->source.context = context;
+  response->setCode(code);
+  request->send(response);
+}
+
+#endif  // TEMPLATES_H
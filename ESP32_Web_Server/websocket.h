@@ -0,0 +1,198 @@
+#ifndef WEBSOCKET_H
+#define WEBSOCKET_H
+
+#include <ESPAsyncWebServer.h>
+#include "dashboard.h"
+#include "rate_limit.h"
+#include "sessions.h"
+
+extern AsyncWebServer server;
+
+// WebSocket control channel for the LEDs
+//   client -> server: "t<led>" toggles, "i<led>:<0-255>" sets the intensity
+//   server -> client: "s:<led1State>,<led2State>,...,<led1Intensity>,<led2Intensity>,..."
+//
+// The dashboard sends its toggles and slider moves here, over one
+// connection, instead of opening a connection per HTTP request.
+// ESPAsyncWebServer closes plain HTTP connections after each response, so
+// this is the dashboard's persistent connection.
+AsyncWebSocket ws("/ws");
+
+#define WS_MAX_CLIENTS 4           // Each holds a TCP connection and its lwIP buffers
+#define WS_PING_INTERVAL_MS 15000  // A connection idle this long is pinged
+#define WS_IDLE_TIMEOUT_MS 45000   // No frame or pong for this long: the peer is gone
+
+// The session of an open connection, resolved from the cookie once at the
+// upgrade. Frames and pongs check it with touchSession(), a compare, which
+// also keeps the session alive while the page is open. A logout or an
+// expired session closes the connection at its next frame or pong.
+struct WsConnection {
+  uint32_t clientId;  // 0 while free
+  uint8_t slot;
+  uint64_t secret;
+  unsigned long lastActivity;
+  unsigned long lastPing;
+};
+
+struct WsStats {
+  unsigned long accepted;
+  unsigned long rejected;       // Over WS_MAX_CLIENTS
+  unsigned long idleClosed;
+  unsigned long sessionClosed;  // Closed after a logout or expiry
+};
+
+// Written by the WebSocket events on the AsyncTCP task, except lastPing
+// and idleClosed, which only the sweep in loop() writes after the open.
+// Each is an aligned 32-bit word, so no write is seen half done. A sweep
+// racing a close and a reopen of the slot can at worst give the new
+// connection a later first ping.
+WsConnection wsConnections[WS_MAX_CLIENTS];
+WsStats wsStats;
+unsigned long wsLastSweep = 0;
+
+// Room for "s:" and a state and an intensity per LED
+#define LED_STATE_MESSAGE_SIZE (3 + LED_COUNT * 6)
+
+unsigned long broadcastLEDVersion = 0;
+
+// Compact LED state message shared by the broadcast and new clients
+void formatLEDStateMessage(char *buffer, size_t size, const LedSnapshot &snapshot) {
+  int length = snprintf(buffer, size, "s:");
+  for (uint8_t i = 0; i < LED_COUNT * 2 && length < (int)size; i++) {
+    int value = i < LED_COUNT ? snapshot.on[i] : snapshot.level[i - LED_COUNT];
+    length += snprintf(buffer + length, size - length, i ? ",%d" : "%d", value);
+  }
+}
+
+// Parse and run one command, returns false if it is malformed
+bool handleWebSocketCommand(const char *command, size_t len) {
+  if (len < 2) return false;
+
+  int led = command[1] - '0';
+  if (command[0] == 't' && len == 2) {
+    return toggleLEDCommand(led);
+  }
+  if (command[0] == 'i' && len > 3 && command[2] == ':') {
+    char value[4] = { 0 };
+    size_t digits = len - 3;
+    if (digits > 3) return false;
+    memcpy(value, command + 3, digits);
+    return setLEDIntensityCommand(led, atoi(value));
+  }
+  return false;
+}
+
+WsConnection *findWsConnection(uint32_t clientId) {
+  for (WsConnection &connection : wsConnections) {
+    if (connection.clientId == clientId) return &connection;
+  }
+  return nullptr;
+}
+
+// Remember the session of a new connection, false if there is no room
+bool openWsConnection(AsyncWebSocketClient *client, AsyncWebServerRequest *request) {
+  WsConnection *connection = findWsConnection(0);
+  if (!connection || !parseSessionCookie(request, connection->slot, connection->secret)) return false;
+  connection->lastActivity = millis();
+  connection->lastPing = connection->lastActivity;
+  connection->clientId = client->id();
+  return true;
+}
+
+// A frame or pong came in: refresh the session, false if it is gone
+bool touchWsConnection(AsyncWebSocketClient *client) {
+  WsConnection *connection = findWsConnection(client->id());
+  if (!connection || !touchSession(connection->slot, connection->secret)) {
+    wsStats.sessionClosed++;
+    client->text("e:session expired");
+    client->close();
+    return false;
+  }
+  connection->lastActivity = millis();
+  return true;
+}
+
+void onWebSocketEvent(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type,
+                      void *arg, uint8_t *data, size_t len) {
+  if (type == WS_EVT_CONNECT) {
+    // The request that was upgraded, its cookie passed the filter
+    if (!openWsConnection(client, (AsyncWebServerRequest *)arg)) {
+      wsStats.rejected++;
+      client->close();
+      return;
+    }
+    wsStats.accepted++;
+
+    char message[LED_STATE_MESSAGE_SIZE];
+    formatLEDStateMessage(message, sizeof(message), readLEDSnapshot());
+    client->text(message);
+  } else if (type == WS_EVT_DISCONNECT) {
+    WsConnection *connection = findWsConnection(client->id());
+    if (connection) connection->clientId = 0;
+  } else if (type == WS_EVT_PONG) {
+    touchWsConnection(client);
+  } else if (type == WS_EVT_DATA) {
+    if (!touchWsConnection(client)) return;
+    // Commands are tiny, so only single-frame text messages are accepted
+    AwsFrameInfo *info = (AwsFrameInfo *)arg;
+    if (info->final && info->index == 0 && info->len == len && info->opcode == WS_TEXT) {
+      if (!handleWebSocketCommand((const char *)data, len)) client->text("e:invalid command");
+    }
+  }
+}
+
+// Ping idle connections and close those whose peer stopped answering, a
+// browser that lost Wi-Fi would otherwise hold its slot until TCP gives up.
+// The pings are ours, not keepAlivePeriod()'s: the library swallows the
+// pongs to its own pings, so they would never count as activity.
+void sweepWsConnections() {
+  unsigned long now = millis();
+  if (now - wsLastSweep < 1000) return;
+  wsLastSweep = now;
+
+  for (WsConnection &connection : wsConnections) {
+    uint32_t clientId = connection.clientId;
+    if (clientId == 0 || now - connection.lastActivity < WS_PING_INTERVAL_MS) continue;
+    AsyncWebSocketClient *client = ws.client(clientId);
+    if (!client) continue;
+    if (now - connection.lastActivity >= WS_IDLE_TIMEOUT_MS) {
+      wsStats.idleClosed++;
+      client->close();
+    } else if (now - connection.lastPing >= WS_PING_INTERVAL_MS) {
+      connection.lastPing = now;
+      client->ping();  // No payload, so the pong raises WS_EVT_PONG
+    }
+  }
+}
+
+// Called from loop(): broadcasts the LED state after it changed
+void updateWebSocket() {
+  LedSnapshot snapshot = readLEDSnapshot();
+  if (broadcastLEDVersion != snapshot.version) {
+    broadcastLEDVersion = snapshot.version;
+    if (ws.count() > 0) {
+      char message[LED_STATE_MESSAGE_SIZE];
+      formatLEDStateMessage(message, sizeof(message), snapshot);
+      ws.textAll(message);
+    }
+  }
+  sweepWsConnections();
+  ws.cleanupClients(WS_MAX_CLIENTS);
+}
+
+void setupWebSocketRoutes() {
+  // Only logged in clients may open the channel
+  ws.setFilter([](AsyncWebServerRequest *request) {
+    // Filters run for every request before the URL is matched
+    if (request->url() != "/ws") return true;
+    if (ws.count() >= WS_MAX_CLIENTS) {
+      wsStats.rejected++;
+      return false;
+    }
+    return admitConnection(request) && isSessionValid(request);
+  });
+  ws.onEvent(onWebSocketEvent);
+  server.addHandler(&ws);
+}
+
+#endif  // WEBSOCKET_H
@@ -0,0 +1,133 @@
+#ifndef WIFI_CONTROL_H
+#define WIFI_CONTROL_H
+
+#include <WiFi.h>
+#include "snapshot.h"
+#include "spsc_queue.h"
+#include "wifi_manager.h"
+#include "wifi_scan.h"
+
+// The Wi-Fi task owns wifi_manager.h and wifi_scan.h. Web handlers send it
+// commands through wifiCommands and read its state from wifiSnapshot, so no
+// Wi-Fi call is made from a web callback.
+
+enum WiFiCommandType : uint8_t {
+  WIFI_COMMAND_CONNECT,   // Try new STA credentials as a job
+  WIFI_COMMAND_START_AP,  // Restart the access point
+  WIFI_COMMAND_SCAN,      // Keep scanning for a while
+};
+
+struct WiFiCommand {
+  WiFiCommandType type;
+  uint32_t jobId;
+  char ssid[33];
+  char password[65];
+};
+
+// Everything the web side shows about Wi-Fi
+struct WiFiSnapshot {
+  uint32_t jobId;
+  WiFiJobState jobState;
+  bool connected;
+  int32_t rssi;
+  bool scanning;  // No scan has finished yet
+  uint8_t networkCount;
+  WiFiNetwork networks[WIFI_SCAN_MAX_NETWORKS];
+  WiFiScanStats scanStats;
+  WiFiConnectStats connectStats;
+};
+
+SpscQueue<WiFiCommand, 4> wifiCommands;  // From the web handlers
+Snapshot<WiFiSnapshot> wifiSnapshot;
+uint32_t lastWiFiJobId = 0;  // Last job handed out, web side
+
+//////////////////////// Web side ////////////////////////
+
+// Copy of the Wi-Fi state for the web handlers. They all run on the
+// AsyncTCP task, so one static copy serves them and keeps the network list
+// off that task's stack.
+const WiFiSnapshot &readWiFiSnapshot() {
+  static WiFiSnapshot copy;
+  wifiSnapshot.read(copy);
+  return copy;
+}
+
+bool sendWiFiCommand(WiFiCommandType type, uint32_t jobId, const char *ssid, const char *password) {
+  WiFiCommand command;
+  command.type = type;
+  command.jobId = jobId;
+  snprintf(command.ssid, sizeof(command.ssid), "%s", ssid);
+  snprintf(command.password, sizeof(command.password), "%s", password);
+  return wifiCommands.push(command);
+}
+
+// Switch to new credentials, returns the job ID the settings page polls, or
+// 0 if the Wi-Fi task is still busy with earlier commands
+uint32_t startWiFiJob(const char *ssid, const char *password) {
+  uint32_t jobId = lastWiFiJobId + 1;
+  if (!sendWiFiCommand(WIFI_COMMAND_CONNECT, jobId, ssid, password)) return 0;
+  lastWiFiJobId = jobId;
+  return jobId;
+}
+
+bool startAccessPoint(const char *ssid, const char *password) {
+  return sendWiFiCommand(WIFI_COMMAND_START_AP, 0, ssid, password);
+}
+
+// Called whenever scan results are served. A full queue already holds work
+// for the task, so a dropped request only delays the next scan.
+void requestWiFiScan() {
+  sendWiFiCommand(WIFI_COMMAND_SCAN, 0, "", "");
+}
+
+// State of a job, pending until the Wi-Fi task has picked it up
+WiFiJobState wifiJobStateOf(uint32_t jobId, const WiFiSnapshot &snapshot) {
+  if (jobId == 0 || jobId > lastWiFiJobId) return WIFI_JOB_NONE;
+  if (jobId == snapshot.jobId) return snapshot.jobState;
+  return jobId > snapshot.jobId ? WIFI_JOB_PENDING : WIFI_JOB_NONE;
+}
+
+//////////////////////// Wi-Fi task side ////////////////////////
+
+void processWiFiCommands() {
+  WiFiCommand command;
+  while (wifiCommands.pop(command)) {
+    switch (command.type) {
+      case WIFI_COMMAND_CONNECT:
+        beginWiFiJob(command.jobId, command.ssid, command.password);
+        break;
+
+      case WIFI_COMMAND_START_AP:
+        Serial.println("Updating Access Point settings...");
+        WiFi.softAPdisconnect(true);  // Disconnect any existing AP
+        // Same channel as at boot, see setup()
+        if (WiFi.softAP(command.ssid, command.password, wifiCache.channel ? wifiCache.channel : 1)) {
+          Serial.print("New AP SSID: ");
+          Serial.println(command.ssid);
+        } else {
+          Serial.println("Failed to start Access Point.");
+        }
+        break;
+
+      case WIFI_COMMAND_SCAN:
+        extendWiFiScanDemand();
+        break;
+    }
+  }
+}
+
+void publishWiFiSnapshot() {
+  static WiFiSnapshot snapshot;  // Too big for the task's stack
+  snapshot.jobId = wifiJobId;
+  snapshot.jobState = wifiJobState;
+  snapshot.connected = WiFi.status() == WL_CONNECTED;
+  snapshot.rssi = snapshot.connected ? WiFi.RSSI() : 0;
+  snapshot.scanning = !wifiScanDone;
+  snapshot.networkCount = wifiNetworkCount;
+  memcpy(snapshot.networks, wifiNetworks, sizeof(WiFiNetwork) * wifiNetworkCount);
+  snapshot.scanStats = wifiScanStats;
+  snapshot.connectStats = wifiConnectStats;
+  wifiSnapshot.publish(snapshot);
+}
+
+#endif  // WIFI_CONTROL_H
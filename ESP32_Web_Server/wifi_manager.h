@@ -0,0 +1,240 @@
+#ifndef WIFI_MANAGER_H
+#define WIFI_MANAGER_H
+
+#include <WiFi.h>
+#include "boot_timing.h"
+#include "config.h"
+#include "spsc_queue.h"
+
+// Non-blocking STA connection manager
+//
+// Driven from the Wi-Fi task: each attempt gets WIFI_CONNECT_TIMEOUT_MS,
+// failures and dropped links are retried with exponential backoff.
+// Credential changes from the settings page run as a job whose outcome the
+// page polls, see wifi_control.h.
+//
+// The channel and BSSID of the last network joined are kept in NVS next to
+// the settings. An attempt on that network starts with them, so the driver
+// joins without scanning every channel first. If the access point has moved
+// it gets WIFI_FAST_CONNECT_TIMEOUT_MS, then the same attempt goes on with a
+// full scan.
+
+#define WIFI_CONNECT_TIMEOUT_MS 10000
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 3000  // A join on a known channel takes well under a second
+#define WIFI_CACHE_KEY "wifi_cache"
+#define WIFI_RETRY_MIN_MS 2000
+#define WIFI_RETRY_MAX_MS 60000
+
+enum WiFiState : uint8_t {
+  WIFI_STATE_IDLE,
+  WIFI_STATE_CONNECTING,
+  WIFI_STATE_CONNECTED,
+  WIFI_STATE_BACKOFF,  // Waiting before the next attempt
+};
+
+enum WiFiJobState : uint8_t {
+  WIFI_JOB_NONE,
+  WIFI_JOB_PENDING,
+  WIFI_JOB_DONE,
+  WIFI_JOB_FAILED,
+};
+
+// Where the last network was found, stored in CONFIG_NAMESPACE
+struct WiFiCache {
+  char ssid[33];      // The network it belongs to
+  uint8_t bssid[6];
+  uint8_t channel;    // 0 while nothing is cached
+  uint32_t checksum;  // CRC-32 of everything above
+};
+
+// Shown by /metrics
+struct WiFiConnectStats {
+  uint32_t connects;
+  uint32_t fastConnects;         // Joined on the cached channel and BSSID
+  uint32_t fastConnectFailures;  // Cached attempts that fell back to a scan
+  uint32_t lastConnectMs;        // From the start of an attempt to the link coming up
+};
+
+WiFiState wifiState = WIFI_STATE_IDLE;
+unsigned long wifiStateTime = 0;  // millis() when the current state was entered
+unsigned long wifiRetryDelay = WIFI_RETRY_MIN_MS;
+
+uint32_t wifiJobId = 0;
+WiFiJobState wifiJobState = WIFI_JOB_NONE;
+char connectSSID[33];  // Credentials of the current attempt, saved once they work
+char connectPassword[65];
+
+// Loaded in setup(), then owned by the Wi-Fi task
+WiFiCache wifiCache = {};
+bool wifiCacheStale = false;    // The cached access point didn't answer, scan until the next join
+bool wifiAttemptCached = false;  // The current attempt uses the cache
+unsigned long wifiConnectStart = 0;
+WiFiConnectStats wifiConnectStats = {};
+SpscQueue<WiFiCache, 2> wifiCacheUpdates;  // To the persistence task
+
+const char *wifiJobStateName(WiFiJobState state) {
+  switch (state) {
+    case WIFI_JOB_PENDING: return "pending";
+    case WIFI_JOB_DONE: return "done";
+    case WIFI_JOB_FAILED: return "failed";
+    default: return "none";
+  }
+}
+
+void setWiFiState(WiFiState state) {
+  wifiState = state;
+  wifiStateTime = millis();
+}
+
+// Read the cached channel and BSSID, called once from setup()
+void loadWiFiCache() {
+  preferences.begin(CONFIG_NAMESPACE, true);
+  WiFiCache stored;
+  bool valid = preferences.getBytes(WIFI_CACHE_KEY, &stored, sizeof(stored)) == sizeof(stored) &&
+               stored.checksum == configChecksum(&stored, offsetof(WiFiCache, checksum));
+  preferences.end();
+  if (valid) wifiCache = stored;
+}
+
+// Called from the persistence task, which owns NVS: writes the newest cache
+void commitWiFiCache() {
+  WiFiCache cache;
+  bool pending = false;
+  while (wifiCacheUpdates.pop(cache)) pending = true;
+  if (!pending) return;
+
+  preferences.begin(CONFIG_NAMESPACE, false);
+  preferences.putBytes(WIFI_CACHE_KEY, &cache, sizeof(cache));
+  preferences.end();
+}
+
+// Remember where the network was found, only written when it moved
+void updateWiFiCache() {
+  uint8_t channel = WiFi.channel();
+  const uint8_t *bssid = WiFi.BSSID();
+  if (!bssid || channel == 0) return;
+  if (channel == wifiCache.channel && memcmp(bssid, wifiCache.bssid, 6) == 0 && strcmp(connectSSID, wifiCache.ssid) == 0) {
+    return;
+  }
+
+  memset(&wifiCache, 0, sizeof(wifiCache));
+  strcpy(wifiCache.ssid, connectSSID);
+  memcpy(wifiCache.bssid, bssid, 6);
+  wifiCache.channel = channel;
+  wifiCache.checksum = configChecksum(&wifiCache, offsetof(WiFiCache, checksum));
+  wifiCacheUpdates.push(wifiCache);  // A full queue already holds a write, the next join retries
+}
+
+void beginWiFiAttempt() {
+  Serial.print("Attempting to connect to SSID: ");
+  Serial.println(connectSSID);
+  if (wifiState != WIFI_STATE_CONNECTING) wifiConnectStart = millis();
+
+  wifiAttemptCached = wifiCache.channel != 0 && !wifiCacheStale && strcmp(wifiCache.ssid, connectSSID) == 0;
+  if (wifiAttemptCached) {
+    WiFi.begin(connectSSID, connectPassword, wifiCache.channel, wifiCache.bssid);
+  } else {
+    WiFi.begin(connectSSID, connectPassword);
+  }
+  setWiFiState(WIFI_STATE_CONNECTING);
+}
+
+// Start connecting with the saved credentials, returns immediately
+void startWiFiConnection() {
+  Config saved = readConfig();
+  strcpy(connectSSID, saved.ssid);
+  strcpy(connectPassword, saved.wifiPassword);
+  wifiRetryDelay = WIFI_RETRY_MIN_MS;
+  beginWiFiAttempt();
+}
+
+// Switch to new credentials as the given job
+void beginWiFiJob(uint32_t jobId, const char *ssid, const char *password) {
+  snprintf(connectSSID, sizeof(connectSSID), "%s", ssid);
+  snprintf(connectPassword, sizeof(connectPassword), "%s", password);
+
+  wifiJobId = jobId;
+  wifiJobState = WIFI_JOB_PENDING;
+
+  // Attempt on the next update
+  wifiRetryDelay = 0;
+  setWiFiState(WIFI_STATE_BACKOFF);
+}
+
+void onWiFiConnected() {
+  Serial.println("Connected to WiFi");
+  Serial.print("IP address: ");
+  Serial.println(WiFi.localIP());
+  wifiRetryDelay = WIFI_RETRY_MIN_MS;
+  markBootPhase(BOOT_STA_CONNECTED);
+
+  wifiConnectStats.connects++;
+  if (wifiAttemptCached) wifiConnectStats.fastConnects++;
+  wifiConnectStats.lastConnectMs = millis() - wifiConnectStart;
+  wifiCacheStale = false;
+  updateWiFiCache();
+
+  // The new credentials work, keep them
+  if (wifiJobState == WIFI_JOB_PENDING) {
+    queueConfig(wifiConfigUpdates, CONFIG_SSID, connectSSID);
+    queueConfig(wifiConfigUpdates, CONFIG_WIFI_PASSWORD, connectPassword);
+    wifiJobState = WIFI_JOB_DONE;
+  }
+}
+
+void onWiFiAttemptFailed() {
+  Serial.println("Failed to connect to Wi-Fi.");
+
+  // The new credentials don't work, go back to the previous network
+  if (wifiJobState == WIFI_JOB_PENDING) {
+    wifiJobState = WIFI_JOB_FAILED;
+    startWiFiConnection();
+    return;
+  }
+
+  WiFi.disconnect();
+  setWiFiState(WIFI_STATE_BACKOFF);
+}
+
+// Called from the Wi-Fi task: advances the connection state machine
+void updateWiFiConnection() {
+  unsigned long elapsed = millis() - wifiStateTime;
+  bool connected = WiFi.status() == WL_CONNECTED;
+
+  switch (wifiState) {
+    case WIFI_STATE_CONNECTING:
+      if (connected) {
+        setWiFiState(WIFI_STATE_CONNECTED);
+        onWiFiConnected();
+      } else if (wifiAttemptCached && elapsed >= WIFI_FAST_CONNECT_TIMEOUT_MS) {
+        // The access point moved or is gone, look for the network on every channel
+        Serial.println("Cached access point not found, scanning");
+        wifiConnectStats.fastConnectFailures++;
+        wifiCacheStale = true;
+        WiFi.disconnect();
+        beginWiFiAttempt();
+      } else if (elapsed >= WIFI_CONNECT_TIMEOUT_MS) {
+        onWiFiAttemptFailed();
+        wifiRetryDelay = wifiRetryDelay * 2 > WIFI_RETRY_MAX_MS ? WIFI_RETRY_MAX_MS : wifiRetryDelay * 2;
+        if (wifiRetryDelay < WIFI_RETRY_MIN_MS) wifiRetryDelay = WIFI_RETRY_MIN_MS;
+      }
+      break;
+
+    case WIFI_STATE_CONNECTED:
+      if (!connected) {
+        Serial.println("Wi-Fi connection lost, reconnecting");
+        wifiRetryDelay = WIFI_RETRY_MIN_MS;
+        setWiFiState(WIFI_STATE_BACKOFF);
+      }
+      break;
+
+    case WIFI_STATE_BACKOFF:
+      if (elapsed >= wifiRetryDelay) beginWiFiAttempt();
+      break;
+
+    default:
+      break;
+  }
+}
+
+#endif  // WIFI_MANAGER_H
@@ -0,0 +1,135 @@
+#ifndef WIFI_SCAN_H
+#define WIFI_SCAN_H
+
+#include <WiFi.h>
+
+// Asynchronous Wi-Fi scanning
+//
+// Scans only run while the settings page is asking for results, and use
+// WiFi.scanNetworks(true) so the Wi-Fi task just polls for completion.
+// Results are kept in a fixed table, deduplicated by SSID and sorted by
+// signal strength. Everything here runs on the Wi-Fi task, see wifi_control.h.
+
+#define WIFI_SCAN_MAX_NETWORKS 20
+#define WIFI_SCAN_INTERVAL_MS 10000  // Time between scans while in demand
+#define WIFI_SCAN_DEMAND_MS 30000    // How long a request keeps scans going
+#define WIFI_SCAN_STALL_US 20000     // A scan call blocking the Wi-Fi task longer than this counts as a stall
+
+struct WiFiNetwork {
+  char ssid[33];
+  int32_t rssi;
+  uint8_t channel;
+  bool secure;
+};
+
+struct WiFiScanStats {
+  unsigned long scans;            // Completed scans
+  unsigned long lastDurationMs;   // Radio time of the last scan
+  unsigned long maxDurationMs;
+  unsigned long maxBlockingUs;    // Longest time a scan call held up the Wi-Fi task
+  unsigned long stalls;           // Scan calls longer than WIFI_SCAN_STALL_US
+  unsigned long requestsDuringScan;
+};
+
+WiFiNetwork wifiNetworks[WIFI_SCAN_MAX_NETWORKS];
+uint8_t wifiNetworkCount = 0;
+WiFiScanStats wifiScanStats = {};
+
+bool wifiScanRunning = false;
+bool wifiScanDone = false;  // At least one scan finished since boot
+unsigned long wifiScanStartTime = 0;
+unsigned long lastWiFiScanTime = 0;
+unsigned long wifiScanDemandUntil = 0;
+
+// Keep scanning for a while, called whenever scan results are served
+void extendWiFiScanDemand() {
+  wifiScanDemandUntil = millis() + WIFI_SCAN_DEMAND_MS;
+  if (wifiScanRunning) wifiScanStats.requestsDuringScan++;
+}
+
+void recordWiFiScanBlocking(unsigned long startUs) {
+  unsigned long blockedUs = micros() - startUs;
+  if (blockedUs > wifiScanStats.maxBlockingUs) wifiScanStats.maxBlockingUs = blockedUs;
+  if (blockedUs > WIFI_SCAN_STALL_US) wifiScanStats.stalls++;
+}
+
+// Add a scan result, keeping the strongest entry per SSID and the table sorted
+void addWiFiNetwork(const String &ssid, int32_t rssi, uint8_t channel, bool secure) {
+  if (ssid.length() == 0) return;  // Hidden network
+
+  int index = -1;
+  for (int i = 0; i < wifiNetworkCount; i++) {
+    if (strcmp(wifiNetworks[i].ssid, ssid.c_str()) == 0) {
+      index = i;
+      break;
+    }
+  }
+  if (index >= 0 && wifiNetworks[index].rssi >= rssi) return;
+  if (index < 0) {
+    if (wifiNetworkCount == WIFI_SCAN_MAX_NETWORKS) {
+      if (wifiNetworks[wifiNetworkCount - 1].rssi >= rssi) return;
+      index = wifiNetworkCount - 1;  // Replace the weakest one
+    } else {
+      index = wifiNetworkCount++;
+    }
+  }
+
+  WiFiNetwork network;
+  strncpy(network.ssid, ssid.c_str(), sizeof(network.ssid) - 1);
+  network.ssid[sizeof(network.ssid) - 1] = '\0';
+  network.rssi = rssi;
+  network.channel = channel;
+  network.secure = secure;
+
+  // Move it up to its place by signal strength
+  while (index > 0 && wifiNetworks[index - 1].rssi < rssi) {
+    wifiNetworks[index] = wifiNetworks[index - 1];
+    index--;
+  }
+  wifiNetworks[index] = network;
+}
+
+void collectWiFiScanResults(int count) {
+  wifiNetworkCount = 0;
+  for (int i = 0; i < count; i++) {
+    addWiFiNetwork(WiFi.SSID(i), WiFi.RSSI(i), WiFi.channel(i), WiFi.encryptionType(i) != 0);
+  }
+  WiFi.scanDelete();
+}
+
+// Called from the Wi-Fi task: starts scans while in demand and collects the results
+void updateWiFiScan() {
+  unsigned long currentTime = millis();
+
+  if (wifiScanRunning) {
+    unsigned long startUs = micros();
+    int16_t n = WiFi.scanComplete();
+    if (n == WIFI_SCAN_RUNNING) return;
+
+    wifiScanRunning = false;
+    if (n >= 0) {
+      collectWiFiScanResults(n);
+      wifiScanDone = true;
+      wifiScanStats.scans++;
+      wifiScanStats.lastDurationMs = currentTime - wifiScanStartTime;
+      if (wifiScanStats.lastDurationMs > wifiScanStats.maxDurationMs) {
+        wifiScanStats.maxDurationMs = wifiScanStats.lastDurationMs;
+      }
+    }
+    recordWiFiScanBlocking(startUs);
+    return;
+  }
+
+  if ((long)(wifiScanDemandUntil - currentTime) <= 0) return;
+  if (wifiScanDone && currentTime - lastWiFiScanTime < WIFI_SCAN_INTERVAL_MS) return;
+
+  unsigned long startUs = micros();
+  if (WiFi.scanNetworks(true) == WIFI_SCAN_RUNNING) {
+    wifiScanRunning = true;
+    wifiScanStartTime = currentTime;
+  }
+  lastWiFiScanTime = currentTime;
+  recordWiFiScanBlocking(startUs);
+}
+
+#endif  // WIFI_SCAN_H
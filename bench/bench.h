@@ -0,0 +1,35 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Timing for the host benchmarks. Each benchmark is one executable that
+// includes the sketch headers it measures and links the stand-ins, see
+// CMakeLists.txt. They print a table and are not run by ctest; the
+// figures are the host's, not the board's.
+
+#include <stdio.h>
+
+#include <chrono>
+
+// Stores results the compiler must not optimise away
+static volatile unsigned long benchSink;
+
+static double benchSeconds() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Nanoseconds per call of body(i), for i from 0 to calls - 1. With more
+// than one run the fastest counts, which keeps out most of the noise of a
+// busy machine; body must then cope with being run again from i = 0.
+template <typename Body>
+static double benchNsPerCall(unsigned long calls, Body body, int runs = 1) {
+  double best = 0;
+  for (int run = 0; run < runs; run++) {
+    double start = benchSeconds();
+    for (unsigned long i = 0; i < calls; i++) body(i);
+    double ns = (benchSeconds() - start) * 1e9 / calls;
+    if (run == 0 || ns < best) best = ns;
+  }
+  return best;
+}
+
+#endif  // BENCH_H
@@ -0,0 +1,91 @@
+// History ring buffer insert cost and /sensor_history range queries
+// (sensor_history.h)
+//
+// The queries read the response body through the cursor in 1436-byte
+// pieces, as the server sends them, without the HTTP around it.
+
+#include "../ESP32_Web_Server/sensor_history.h"
+#include <host.h>
+#include "bench.h"
+
+#define SAMPLE_PERIOD_MS 2000  // The DHT22's pace
+#define QUERIES 50
+#define RUNS 5
+
+static void clearHistory() {
+  historyHead = 0;
+  historyCount = 0;
+  historyHeadTime = 0;
+  historyLastTime = 0;
+  historyStart.publish({ 0, 0 });
+}
+
+static void record(unsigned long i) {
+  recordSensorHistory(20.0f + (i % 50) / 10.0f, 40.0f + (i % 70) / 10.0f, 1000 + i * SAMPLE_PERIOD_MS);
+}
+
+struct QueryResult {
+  size_t bytes;
+  size_t buckets;
+};
+
+// One response, read the way the server reads it
+static QueryResult query(unsigned long since, unsigned long step) {
+  HistoryCursor cursor;
+  cursor.since = since;
+  cursor.step = step;
+  HistoryStart start;
+  historyStart.read(start);
+  cursor.seq = start.seq;
+  cursor.time = start.time;
+
+  uint8_t piece[1436];
+  QueryResult result = { 0, 0 };
+  for (size_t read; (read = cursor.read(piece, sizeof(piece))) > 0;) {
+    result.bytes += read;
+    for (size_t i = 0; i < read; i++) result.buckets += piece[i] == '[';
+  }
+  result.buckets--;  // The array holding them
+  return result;
+}
+
+int main() {
+  hostUseManualClock();
+  printf("HISTORY_CAPACITY %d, %zu bytes of samples, one every %d ms\n\n", HISTORY_CAPACITY,
+         sizeof(historySamples), SAMPLE_PERIOD_MS);
+
+  double fill = benchNsPerCall(HISTORY_CAPACITY, [](unsigned long i) {
+    if (i == 0) clearHistory();
+    record(i);
+  }, RUNS);
+  double full = benchNsPerCall(100000, [](unsigned long i) { record(HISTORY_CAPACITY + i); }, RUNS);
+  printf("insert into an empty buffer  %6.1f ns\n", fill);
+  printf("insert into a full buffer    %6.1f ns\n\n", full);
+
+  clearHistory();
+  for (unsigned long i = 0; i < HISTORY_CAPACITY; i++) record(i);
+  unsigned long newest = historyLastTime;
+
+  struct {
+    const char *range;
+    unsigned long since;
+  } ranges[] = {
+    { "all (1 h)", 0 },
+    { "last 30 min", newest - 30 * 60000 },
+    { "last 5 min", newest - 5 * 60000 },
+  };
+  unsigned long steps[] = { 2000, 60000, 600000 };
+
+  printf("range         step ms   buckets   bytes    us/query  heap peak\n");
+  for (auto &range : ranges) {
+    for (unsigned long step : steps) {
+      hostResetHeapPeak();
+      size_t heapBefore = hostHeapInUse();
+      QueryResult result;
+      double ns = benchNsPerCall(QUERIES, [&](unsigned long) { result = query(range.since, step); }, RUNS);
+      printf("%-12s %8lu  %8zu  %6zu  %10.1f  %9zu\n", range.range, step, result.buckets, result.bytes, ns / 1000,
+             hostHeapPeak() - heapBefore);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,117 @@
+// Session lookup cost and memory at 8, 64 and 256 clients (sessions.h),
+// against the three IP-keyed std::maps of the old auth.h
+//
+// Each client polls in turn, as open dashboards do. A request whose session
+// was evicted or expired logs in again, that is counted as a logout. The
+// old maps expired a session 300 s after the login, used or not.
+
+#include "../ESP32_Web_Server/sessions.h"
+#include <host.h>
+#include <array>
+#include <map>
+#include "bench.h"
+
+#define REQUESTS_PER_CLIENT 2000
+
+struct Result {
+  double nsPerRequest;
+  unsigned long logouts;
+  size_t staticBytes;
+  size_t heapPeak;  // Above the heap in use before the clients logged in
+};
+
+// The cookie lookup of findSession() without the header search: parse the
+// token, check the slot, refresh the expiry. A miss logs in again.
+static Result benchTable(int clients) {
+  memset(sessions, 0, sizeof(sessions));
+  std::vector<std::array<char, SESSION_TOKEN_LENGTH + 1>> tokens(clients);  // The browsers' cookies
+  hostResetHeapPeak();
+  size_t heapBefore = hostHeapInUse();
+
+  for (int c = 0; c < clients; c++) {
+    hostAdvanceMs(1);
+    createSession(ROLE_VIEWER, tokens[c].data());
+  }
+
+  unsigned long logouts = 0;
+  double ns = benchNsPerCall((unsigned long)clients * REQUESTS_PER_CLIENT, [&](unsigned long i) {
+    hostAdvanceMs(1);
+    char *cookie = tokens[i % clients].data();
+    uint64_t slot, secret;
+    Session *session = nullptr;
+    if (parseHex(cookie, 2, slot) && parseHex(cookie + 2, SESSION_TOKEN_LENGTH - 2, secret) &&
+        slot < SESSION_CAPACITY) {
+      session = touchSession(slot, secret);
+    }
+    if (!session) {
+      logouts++;
+      session = createSession(ROLE_VIEWER, cookie);
+    }
+    benchSink += session->role;
+  });
+  return { ns, logouts, sizeof(sessions), hostHeapPeak() - heapBefore };
+}
+
+// What ensureLoggedIn() did per request before the table
+struct MapSessions {
+  std::map<IPAddress, String> userRoles;
+  std::map<IPAddress, bool> loggedInUsers;
+  std::map<IPAddress, time_t> loginTimestamps;
+
+  void login(IPAddress ip, time_t now) {
+    loggedInUsers[ip] = true;
+    userRoles[ip] = "viewer";
+    loginTimestamps[ip] = now;
+  }
+
+  bool check(IPAddress ip, time_t now) {
+    if (!loggedInUsers[ip]) return false;
+    if (loginTimestamps.find(ip) == loginTimestamps.end()) return false;
+    if (difftime(now, loginTimestamps[ip]) > 300) {
+      loginTimestamps.erase(ip);
+      userRoles.erase(ip);
+      return false;
+    }
+    benchSink += userRoles[ip] != "admin";
+    return true;
+  }
+};
+
+static Result benchMaps(int clients) {
+  hostResetHeapPeak();
+  size_t heapBefore = hostHeapInUse();
+  unsigned long logouts = 0;
+  double ns;
+  {
+    MapSessions maps;
+    for (int c = 0; c < clients; c++) maps.login(IPAddress(192, 168, 1 + c / 200, 2 + c % 200), millis() / 1000);
+    ns = benchNsPerCall((unsigned long)clients * REQUESTS_PER_CLIENT, [&](unsigned long i) {
+      hostAdvanceMs(1);
+      int c = i % clients;
+      IPAddress ip(192, 168, 1 + c / 200, 2 + c % 200);
+      if (!maps.check(ip, millis() / 1000)) {
+        logouts++;
+        maps.login(ip, millis() / 1000);
+      }
+    });
+  }
+  return { ns, logouts, 0, hostHeapPeak() - heapBefore };
+}
+
+static void print(int clients, const char *design, const Result &result) {
+  unsigned long requests = (unsigned long)clients * REQUESTS_PER_CLIENT;
+  printf("%7d  %-12s %8.1f  %8lu (%5.1f%%)  %8zu  %9zu\n", clients, design, result.nsPerRequest, result.logouts,
+         100.0 * result.logouts / requests, result.staticBytes, result.heapPeak);
+}
+
+int main() {
+  hostUseManualClock();
+  printf("SESSION_CAPACITY %d, %d requests per client, round robin\n", SESSION_CAPACITY, REQUESTS_PER_CLIENT);
+  printf("A Session is %zu bytes here, 16 on the ESP32 where unsigned long is 4\n\n", sizeof(Session));
+  printf("clients  design        ns/req   logged out         static  heap peak\n");
+  for (int clients : { 8, 64, 256, 2 * SESSION_CAPACITY }) {  // The last one overflows the table
+    print(clients, "table", benchTable(clients));
+    print(clients, "std::map x3", benchMaps(clients));
+  }
+  return 0;
+}
@@ -0,0 +1,122 @@
+// Streaming templates (templates.h) against the String::replace pages they
+// replaced
+//
+// The old handlers copied the page out of flash into a String, replaced
+// each placeholder in it and handed it to request->send(), which copied it
+// once more. The result page is the one /update_settings renders, the
+// settings page is rendered the way the old handleSettings() did, with its
+// three replaces. Both are timed on their own, read in 1436-byte pieces as
+// the server sends them, and then as whole requests through the server.
+
+#include "../ESP32_Web_Server/templates.h"
+#include "../ESP32_Web_Server/html_pages.h"
+#include <host.h>
+#include "bench.h"
+
+#define RENDERS 2000
+#define REQUESTS 500
+#define RUNS 5
+
+static AsyncWebServer server(80);
+
+struct PageValues {
+  const char *title;
+  const char *message;
+  const char *redirect;
+};
+
+static const char *pageValue(const PageValues &values, const char *name, size_t length) {
+  if (templateNameIs(name, length, "TITLE")) return values.title;
+  if (templateNameIs(name, length, "MESSAGE")) return values.message;
+  if (templateNameIs(name, length, "REDIRECT")) return values.redirect;
+  return nullptr;
+}
+
+static const PageValues VALUES = { "Settings Updated", "Wi-Fi settings saved, connecting to home-network", "/" };
+
+static PageTemplate resultPage = { RESULT_TEMPLATE };
+static PageTemplate settingsPage = { SETTINGS_HTML };
+
+static size_t renderTemplate(PageTemplate &page) {
+  parseTemplate(page);
+  TemplateSource<PageValues> source;
+  source.page = &page;
+  source.values = pageValue;
+  source.context = VALUES;
+
+  uint8_t piece[1436];
+  size_t bytes = 0;
+  for (size_t read; (read = source.read(piece, sizeof(piece))) > 0;) bytes += read;
+  return bytes;
+}
+
+static String replaceResultPage() {
+  String html = FPSTR(RESULT_TEMPLATE);
+  html.replace("%TITLE%", VALUES.title);
+  html.replace("%MESSAGE%", VALUES.message);
+  html.replace("%REDIRECT%", VALUES.redirect);
+  html.replace("%JOB%", "");
+  return html;
+}
+
+static String replaceSettingsPage() {
+  String html = FPSTR(SETTINGS_HTML);
+  html.replace("%WIFI_OPTIONS%", "");
+  html.replace("CURRENT_SSID", "home-network");
+  html.replace("CURRENT_USERNAME", "admin");
+  return html;
+}
+
+struct Result {
+  size_t bytes;
+  double ns;
+  size_t heapPeak;  // Above the heap in use before
+};
+
+template <typename Body>
+static Result measure(unsigned long calls, Body body) {
+  Result result = { body(), 0, 0 };
+  hostResetHeapPeak();
+  size_t heapBefore = hostHeapInUse();
+  result.ns = benchNsPerCall(calls, [&](unsigned long) { benchSink += body(); }, RUNS);
+  result.heapPeak = hostHeapPeak() - heapBefore;
+  return result;
+}
+
+static void print(const char *page, const char *design, const Result &result) {
+  printf("%-10s %-16s %6zu  %9.2f  %9zu\n", page, design, result.bytes, result.ns / 1000, result.heapPeak);
+}
+
+int main() {
+  hostUseManualClock();
+  server.on("/result/template", HTTP_GET,
+            [](AsyncWebServerRequest *request) { sendTemplate(request, 200, resultPage, pageValue, VALUES); });
+  server.on("/result/replace", HTTP_GET,
+            [](AsyncWebServerRequest *request) { request->send(200, "text/html", replaceResultPage()); });
+  server.on("/settings/template", HTTP_GET,
+            [](AsyncWebServerRequest *request) { sendTemplate(request, 200, settingsPage, pageValue, VALUES); });
+  server.on("/settings/replace", HTTP_GET,
+            [](AsyncWebServerRequest *request) { request->send(200, "text/html", replaceSettingsPage()); });
+
+  parseTemplate(resultPage);
+  parseTemplate(settingsPage);
+  printf("Result page %zu segments, settings page %zu, of TEMPLATE_MAX_SEGMENTS %d\n\n",
+         (size_t)resultPage.segmentCount, (size_t)settingsPage.segmentCount, TEMPLATE_MAX_SEGMENTS);
+
+  printf("page       render            bytes   us/page  heap peak\n");
+  print("result", "template", measure(RENDERS, [] { return renderTemplate(resultPage); }));
+  print("result", "String::replace", measure(RENDERS, [] { return (size_t)replaceResultPage().length(); }));
+  print("settings", "template", measure(RENDERS, [] { return renderTemplate(settingsPage); }));
+  print("settings", "String::replace", measure(RENDERS, [] { return (size_t)replaceSettingsPage().length(); }));
+
+  // The host server's request and response objects and the body it
+  // collects count in both designs alike
+  printf("\npage       request           bytes    us/req  heap peak\n");
+  for (const char *page : { "result", "settings" }) {
+    for (const char *design : { "template", "replace" }) {
+      std::string path = std::string("/") + page + "/" + design;
+      print(page, design, measure(REQUESTS, [&] { return hostRequest(server, "GET", path.c_str()).body.size(); }));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef HOST_ADAFRUIT_BME280_H
+#define HOST_ADAFRUIT_BME280_H
+
+// Host stand-in for the Adafruit BME280 library, reporting what
+// hostSetBme280() set. begin() fails while the sensor is set absent.
+
+#include <Arduino.h>
+
+class Adafruit_BME280 {
+public:
+  enum sensor_mode { MODE_SLEEP = 0, MODE_FORCED = 1, MODE_NORMAL = 3 };
+  enum sensor_sampling { SAMPLING_NONE, SAMPLING_X1, SAMPLING_X2, SAMPLING_X4, SAMPLING_X8, SAMPLING_X16 };
+  enum sensor_filter { FILTER_OFF, FILTER_X2, FILTER_X4, FILTER_X8, FILTER_X16 };
+  enum standby_duration {
+    STANDBY_MS_0_5,
+    STANDBY_MS_62_5,
+    STANDBY_MS_125,
+    STANDBY_MS_250,
+    STANDBY_MS_500,
+    STANDBY_MS_1000,
+    STANDBY_MS_10,
+    STANDBY_MS_20,
+  };
+
+  bool begin(uint8_t address = 0x77);
+  void setSampling(sensor_mode mode = MODE_NORMAL, sensor_sampling temperature = SAMPLING_X16,
+                   sensor_sampling pressure = SAMPLING_X16, sensor_sampling humidity = SAMPLING_X16,
+                   sensor_filter filter = FILTER_OFF, standby_duration duration = STANDBY_MS_0_5) {}
+  float readTemperature();
+  float readPressure();
+  float readHumidity();
+
+private:
+  bool _found = false;
+};
+
+#endif  // HOST_ADAFRUIT_BME280_H
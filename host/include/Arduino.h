@@ -0,0 +1,282 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Host stand-in for the parts of the ESP32 Arduino core the sketch uses:
+// Print, String, Serial, time, pins, LEDC, ESP and the FreeRTOS calls that
+// the ESP32 Arduino.h pulls in. What the stand-ins do, and how the tests
+// steer them, is in host.h.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+using std::isinf;
+using std::isnan;
+using std::max;
+using std::min;
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+#define F(s) (s)
+#define FPSTR(p) (p)
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define IRAM_ATTR
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+class String;
+
+// Anything that can print itself, IPAddress is one
+class Printable {
+public:
+  virtual ~Printable() {}
+  virtual size_t printTo(class Print &out) const = 0;
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t size);
+  size_t write(const char *text) { return text ? write((const uint8_t *)text, strlen(text)) : 0; }
+  size_t write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+
+  size_t print(const char *text) { return write(text); }
+  size_t print(const String &text);
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(long long value, int base = DEC);
+  size_t print(unsigned long long value, int base = DEC);
+  size_t print(double value, int digits = 2);
+  size_t print(const Printable &value) { return value.printTo(*this); }
+
+  template <typename T>
+  size_t println(const T &value) {
+    size_t n = print(value);
+    return n + println();
+  }
+  template <typename T>
+  size_t println(const T &value, int format) {
+    size_t n = print(value, format);
+    return n + println();
+  }
+  size_t println() { return write("\r\n"); }
+
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual void flush() {}
+};
+
+// Arduino's String over std::string
+class String {
+public:
+  String() {}
+  String(const char *text) : s(text ? text : "") {}
+  String(const char *text, size_t length) : s(text ? std::string(text, length) : std::string()) {}
+  String(const std::string &text) : s(text) {}
+  explicit String(char c) : s(1, c) {}
+  explicit String(int value, unsigned char base = DEC);
+  explicit String(unsigned int value, unsigned char base = DEC);
+  explicit String(long value, unsigned char base = DEC);
+  explicit String(unsigned long value, unsigned char base = DEC);
+  explicit String(float value, unsigned int decimals = 2);
+  explicit String(double value, unsigned int decimals = 2);
+
+  const char *c_str() const { return s.c_str(); }
+  unsigned int length() const { return s.size(); }
+  bool isEmpty() const { return s.empty(); }
+  bool reserve(unsigned int size) {
+    s.reserve(size);
+    return true;
+  }
+
+  bool concat(const String &other) {
+    s += other.s;
+    return true;
+  }
+  bool concat(const char *text, unsigned int length) {
+    s.append(text, length);
+    return true;
+  }
+  String &operator+=(const String &other) {
+    s += other.s;
+    return *this;
+  }
+  String &operator+=(const char *text) {
+    s += text ? text : "";
+    return *this;
+  }
+  String &operator+=(char c) {
+    s += c;
+    return *this;
+  }
+  String &operator+=(int value) { return *this += String(value); }
+  String &operator+=(unsigned int value) { return *this += String(value); }
+  String &operator+=(long value) { return *this += String(value); }
+  String &operator+=(unsigned long value) { return *this += String(value); }
+
+  friend String operator+(const String &a, const String &b) { return a.s + b.s; }
+  friend String operator+(const String &a, const char *b) { return a.s + (b ? b : ""); }
+  friend String operator+(const char *a, const String &b) { return (a ? a : "") + b.s; }
+
+  bool equals(const String &other) const { return s == other.s; }
+  bool equalsIgnoreCase(const String &other) const;
+  bool operator==(const String &other) const { return s == other.s; }
+  bool operator!=(const String &other) const { return s != other.s; }
+  bool operator==(const char *text) const { return s == (text ? text : ""); }
+  bool operator!=(const char *text) const { return !(*this == text); }
+  bool operator<(const String &other) const { return s < other.s; }
+  int compareTo(const String &other) const { return s.compare(other.s); }
+
+  char charAt(unsigned int index) const { return index < s.size() ? s[index] : 0; }
+  char operator[](unsigned int index) const { return charAt(index); }
+  char &operator[](unsigned int index) { return s[index]; }
+
+  bool startsWith(const String &prefix) const { return s.compare(0, prefix.s.size(), prefix.s) == 0; }
+  bool endsWith(const String &suffix) const {
+    return s.size() >= suffix.s.size() && s.compare(s.size() - suffix.s.size(), suffix.s.size(), suffix.s) == 0;
+  }
+  int indexOf(char c, unsigned int from = 0) const { return found(s.find(c, from)); }
+  int indexOf(const String &text, unsigned int from = 0) const { return found(s.find(text.s, from)); }
+  int lastIndexOf(char c) const { return found(s.rfind(c)); }
+  String substring(unsigned int from) const { return from < s.size() ? s.substr(from) : std::string(); }
+  String substring(unsigned int from, unsigned int to) const;
+
+  void replace(const String &find, const String &replacement);
+  void remove(unsigned int index, unsigned int count = (unsigned int)-1) {
+    if (index < s.size()) s.erase(index, count);
+  }
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return atof(s.c_str()); }
+
+private:
+  static int found(size_t position) { return position == std::string::npos ? -1 : (int)position; }
+
+  std::string s;
+};
+
+inline size_t Print::print(const String &text) {
+  return write((const uint8_t *)text.c_str(), text.length());
+}
+
+// Serial writes to stdout
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) {}
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  void flush() override;
+};
+
+extern HardwareSerial Serial;
+
+// Time, from a monotonic clock or the one the tests drive, see host.h
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+extern "C" int64_t esp_timer_get_time();
+
+// Pins, the levels are kept for the tests
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+uint16_t analogRead(uint8_t pin);
+uint32_t analogReadMilliVolts(uint8_t pin);
+
+// LEDC, as in arduino-esp32 2.x
+uint32_t ledcSetup(uint8_t channel, uint32_t frequency, uint8_t resolutionBits);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+uint32_t ledcRead(uint8_t channel);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+extern "C" uint32_t esp_random();
+
+template <typename T, typename L, typename H>
+T constrain(T value, L low, H high) {
+  return value < low ? low : (value > high ? high : value);
+}
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh);
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1, const char *server2 = nullptr,
+                const char *server3 = nullptr);
+
+// Heap figures come from malloc's own statistics, against a heap the size
+// of an ESP32's, so they move the way the board's do but are not its numbers
+class EspClass {
+public:
+  uint32_t getHeapSize();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint64_t getEfuseMac();
+  void restart();
+};
+
+extern EspClass ESP;
+
+// FreeRTOS, tasks are threads, a tick is a millisecond
+typedef void *TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define pdPASS 1
+#define pdFAIL 0
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackBytes, void *parameter,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+BaseType_t xPortGetCoreID();
+
+#include "IPAddress.h"
+
+#endif  // HOST_ARDUINO_H
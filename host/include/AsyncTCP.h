@@ -0,0 +1,32 @@
+#ifndef HOST_ASYNCTCP_H
+#define HOST_ASYNCTCP_H
+
+#include <Arduino.h>
+
+class HostConnection;
+
+// One TCP connection of the host web server, a socket or a connection a
+// test feeds directly (see HostRequest in host.h)
+class AsyncClient {
+public:
+  explicit AsyncClient(HostConnection *connection) : _connection(connection) {}
+
+  IPAddress remoteIP() const;
+  uint16_t remotePort() const;
+  IPAddress localIP() const;
+  uint16_t localPort() const;
+
+  size_t space() const;
+  bool canSend() const;
+  bool connected() const;
+  void close(bool now = false);
+
+  void setRxTimeout(uint32_t seconds) {}
+  void setAckTimeout(uint32_t ms) {}
+  void setNoDelay(bool noDelay) {}
+  void setKeepAlive(uint32_t ms, uint8_t count) {}
+
+  HostConnection *_connection;
+};
+
+#endif  // HOST_ASYNCTCP_H
@@ -0,0 +1,27 @@
+#ifndef HOST_DHT_H
+#define HOST_DHT_H
+
+// Host stand-in for the Adafruit DHT library, reporting what hostSetDht()
+// set, or a slow drift around room conditions until it is called
+
+#include <Arduino.h>
+
+#define DHT11 11
+#define DHT21 21
+#define DHT22 22
+
+class DHT {
+public:
+  DHT(uint8_t pin, uint8_t type, uint8_t count = 6) : _pin(pin), _type(type) {}
+
+  void begin(uint8_t usecMinPulse = 55) {}
+  bool read(bool force = false);
+  float readTemperature(bool fahrenheit = false, bool force = false);
+  float readHumidity(bool force = false);
+
+private:
+  uint8_t _pin;
+  uint8_t _type;
+};
+
+#endif  // HOST_DHT_H
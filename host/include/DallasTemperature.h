@@ -0,0 +1,30 @@
+#ifndef HOST_DALLASTEMPERATURE_H
+#define HOST_DALLASTEMPERATURE_H
+
+// Host stand-in for a single DS18B20, reporting what hostSetDs18b20() set.
+// A conversion takes its real 750 ms at 12 bits: a read before that returns
+// the previous conversion, as the sensor's scratchpad would.
+
+#include <Arduino.h>
+#include <OneWire.h>
+
+#define DEVICE_DISCONNECTED_C -127
+
+class DallasTemperature {
+public:
+  DallasTemperature(OneWire *wire) {}
+
+  void begin() {}
+  void setResolution(uint8_t bits) {}
+  void setWaitForConversion(bool wait) { _wait = wait; }
+  void requestTemperatures();
+  float getTempCByIndex(uint8_t index);
+
+private:
+  bool _wait = true;
+  unsigned long _conversionStart = 0;
+  float _converted = 85.0f;  // Power-on value of the scratchpad
+  float _pending = 85.0f;
+};
+
+#endif  // HOST_DALLASTEMPERATURE_H
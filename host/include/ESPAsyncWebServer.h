@@ -0,0 +1,535 @@
+#ifndef HOST_ESPASYNCWEBSERVER_H
+#define HOST_ESPASYNCWEBSERVER_H
+
+// Host stand-in for ESPAsyncWebServer 1.2: the same classes and calls,
+// serving HTTP/1.1, Server-Sent Events and WebSockets over sockets on
+// localhost. Like AsyncTCP on the board, every handler runs on one server
+// thread; calls from other threads (loop(), the tasks) take the same lock
+// the server thread holds, see hostTcpLock() in host.h.
+//
+// It follows the library where the sketch can tell: handlers are picked in
+// the order they were added, filter first; uploads arrive in pieces before
+// the request handler runs; every response closes its connection; event
+// and WebSocket connections leave their request behind without calling
+// its disconnect callback.
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+#include <functional>
+#include <list>
+#include <vector>
+
+typedef enum {
+  HTTP_GET = 0b00000001,
+  HTTP_POST = 0b00000010,
+  HTTP_DELETE = 0b00000100,
+  HTTP_PUT = 0b00001000,
+  HTTP_PATCH = 0b00010000,
+  HTTP_HEAD = 0b00100000,
+  HTTP_OPTIONS = 0b01000000,
+  HTTP_ANY = 0b01111111,
+} WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+// _fillBuffer() result meaning "nothing yet, ask again later"
+#define RESPONSE_TRY_AGAIN 0xFFFFFFFF
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+class AsyncWebServerResponse;
+class AsyncWebHandler;
+
+class AsyncWebParameter {
+public:
+  AsyncWebParameter(const String &name, const String &value, bool form = false, bool file = false, size_t size = 0)
+    : _name(name), _value(value), _size(size), _isForm(form), _isFile(file) {}
+
+  const String &name() const { return _name; }
+  const String &value() const { return _value; }
+  size_t size() const { return _size; }
+  bool isPost() const { return _isForm; }
+  bool isFile() const { return _isFile; }
+
+private:
+  String _name;
+  String _value;
+  size_t _size;
+  bool _isForm;
+  bool _isFile;
+};
+
+class AsyncWebHeader {
+public:
+  AsyncWebHeader(const String &name, const String &value) : _name(name), _value(value) {}
+
+  const String &name() const { return _name; }
+  const String &value() const { return _value; }
+  String toString() const { return _name + ": " + _value + "\r\n"; }
+
+private:
+  String _name;
+  String _value;
+};
+
+typedef std::function<String(const String &)> AwsTemplateProcessor;
+typedef std::function<size_t(uint8_t *buffer, size_t maxLen, size_t index)> AwsResponseFiller;
+typedef std::function<void(void)> ArDisconnectHandler;
+typedef std::function<bool(AsyncWebServerRequest *request)> ArRequestFilterFunction;
+typedef std::function<void(AsyncWebServerRequest *request)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data,
+                           size_t len, bool final)>
+  ArUploadHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total)>
+  ArBodyHandlerFunction;
+
+//////////////////////// Responses ////////////////////////
+
+// What kind of connection a response leaves behind
+enum HostResponseKind : uint8_t {
+  HOST_RESPONSE_HTTP,       // Closed once the body is sent
+  HOST_RESPONSE_EVENTS,     // Kept open as an event stream
+  HOST_RESPONSE_WEBSOCKET,  // Switched to WebSocket frames
+};
+
+class AsyncWebServerResponse {
+public:
+  AsyncWebServerResponse();
+  virtual ~AsyncWebServerResponse() {}
+
+  void setCode(int code) { _code = code; }
+  void setContentLength(size_t length) { _contentLength = length; }
+  void setContentType(const String &type) { _contentType = type; }
+  void addHeader(const String &name, const String &value) { _headers.push_back(AsyncWebHeader(name, value)); }
+
+  virtual bool _sourceValid() const { return false; }
+
+  // Host side: the status line and headers, then the body a piece at a
+  // time, RESPONSE_TRY_AGAIN while the source has nothing yet, 0 at the end
+  virtual String _assembleHead(uint8_t version);
+  virtual size_t _nextBody(uint8_t *buffer, size_t maxLen) { return 0; }
+  virtual HostResponseKind _kind() const { return HOST_RESPONSE_HTTP; }
+  int _status() const { return _code; }
+
+protected:
+  int _code;
+  std::vector<AsyncWebHeader> _headers;
+  String _contentType;
+  size_t _contentLength;
+  bool _sendContentLength;
+  bool _chunked;
+};
+
+// Fixed body in a String
+class AsyncBasicResponse : public AsyncWebServerResponse {
+public:
+  AsyncBasicResponse(int code, const String &contentType = String(), const String &content = String());
+
+  bool _sourceValid() const override { return true; }
+  size_t _nextBody(uint8_t *buffer, size_t maxLen) override;
+
+private:
+  String _content;
+  size_t _sent = 0;
+};
+
+// Body produced by _fillBuffer(), sent chunked when the length is unknown
+class AsyncAbstractResponse : public AsyncWebServerResponse {
+public:
+  AsyncAbstractResponse(AwsTemplateProcessor callback = nullptr) {}
+
+  bool _sourceValid() const override { return false; }
+  virtual size_t _fillBuffer(uint8_t *buffer, size_t maxLen) { return 0; }
+  size_t _nextBody(uint8_t *buffer, size_t maxLen) override;
+
+private:
+  size_t _sent = 0;
+  bool _finished = false;
+};
+
+// Body straight from flash
+class AsyncProgmemResponse : public AsyncAbstractResponse {
+public:
+  AsyncProgmemResponse(int code, const String &contentType, const uint8_t *content, size_t length,
+                       AwsTemplateProcessor callback = nullptr);
+
+  bool _sourceValid() const override { return true; }
+  size_t _fillBuffer(uint8_t *buffer, size_t maxLen) override;
+
+private:
+  const uint8_t *_content;
+  size_t _readLength = 0;
+};
+
+// Body from a callback, with a known length or chunked
+class AsyncCallbackResponse : public AsyncAbstractResponse {
+public:
+  AsyncCallbackResponse(const String &contentType, size_t length, AwsResponseFiller callback, bool chunked = false);
+
+  bool _sourceValid() const override { return !!_content; }
+  size_t _fillBuffer(uint8_t *buffer, size_t maxLen) override;
+
+private:
+  AwsResponseFiller _content;
+  size_t _filledLength = 0;
+};
+
+// Body printed into a buffer before it is sent
+class AsyncResponseStream : public AsyncAbstractResponse, public Print {
+public:
+  AsyncResponseStream(const String &contentType, size_t bufferSize);
+
+  bool _sourceValid() const override { return true; }
+  size_t _fillBuffer(uint8_t *buffer, size_t maxLen) override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *data, size_t length) override;
+  using Print::write;
+
+private:
+  std::string _content;
+  size_t _readLength = 0;
+};
+
+//////////////////////// Requests ////////////////////////
+
+class AsyncWebServerRequest {
+  friend class AsyncWebServer;
+  friend class HostConnection;
+
+public:
+  AsyncWebServerRequest(AsyncWebServer *server, AsyncClient *client);
+  ~AsyncWebServerRequest();
+
+  // Anything a handler wants freed with the request, freed with free()
+  void *_tempObject = nullptr;
+
+  AsyncClient *client() { return _client; }
+  uint8_t version() const { return _version; }
+  WebRequestMethodComposite method() const { return _method; }
+  const char *methodToString() const;
+  const String &url() const { return _url; }
+  const String &host() const { return _host; }
+  const String &contentType() const { return _contentType; }
+  size_t contentLength() const { return _contentLength; }
+  bool multipart() const { return _isMultipart; }
+
+  size_t headers() const { return _headers.size(); }
+  bool hasHeader(const String &name) const { return getHeader(name) != nullptr; }
+  AsyncWebHeader *getHeader(const String &name) const;
+  AsyncWebHeader *getHeader(size_t index) const { return index < _headers.size() ? _headers[index] : nullptr; }
+
+  size_t params() const { return _params.size(); }
+  bool hasParam(const String &name, bool post = false, bool file = false) const {
+    return getParam(name, post, file) != nullptr;
+  }
+  AsyncWebParameter *getParam(const String &name, bool post = false, bool file = false) const;
+  AsyncWebParameter *getParam(size_t index) const { return index < _params.size() ? _params[index] : nullptr; }
+  bool hasArg(const char *name) const;
+  const String &arg(const String &name) const;
+
+  void onDisconnect(ArDisconnectHandler fn) { _onDisconnectfn = fn; }
+
+  void send(AsyncWebServerResponse *response);
+  void send(int code, const String &contentType = String(), const String &content = String());
+  void send(const String &contentType, size_t length, AwsResponseFiller callback,
+            AwsTemplateProcessor templateCallback = nullptr);
+  void sendChunked(const String &contentType, AwsResponseFiller callback,
+                   AwsTemplateProcessor templateCallback = nullptr);
+  void send_P(int code, const String &contentType, const uint8_t *content, size_t length,
+              AwsTemplateProcessor callback = nullptr);
+  void send_P(int code, const String &contentType, PGM_P content, AwsTemplateProcessor callback = nullptr);
+  void redirect(const String &url);
+
+  AsyncWebServerResponse *beginResponse(int code, const String &contentType = String(),
+                                        const String &content = String());
+  AsyncWebServerResponse *beginResponse(const String &contentType, size_t length, AwsResponseFiller callback,
+                                        AwsTemplateProcessor templateCallback = nullptr);
+  AsyncWebServerResponse *beginChunkedResponse(const String &contentType, AwsResponseFiller callback,
+                                               AwsTemplateProcessor templateCallback = nullptr);
+  AsyncResponseStream *beginResponseStream(const String &contentType, size_t bufferSize = 1460);
+  AsyncWebServerResponse *beginResponse_P(int code, const String &contentType, const uint8_t *content, size_t length,
+                                          AwsTemplateProcessor callback = nullptr);
+  AsyncWebServerResponse *beginResponse_P(int code, const String &contentType, PGM_P content,
+                                          AwsTemplateProcessor callback = nullptr);
+
+  // Host side
+  AsyncWebServerResponse *_response = nullptr;
+  AsyncWebHandler *_handler = nullptr;
+  ArDisconnectHandler _onDisconnectfn;
+  bool _isWebSocketUpgrade = false;
+
+private:
+  void addParam(AsyncWebParameter *param) { _params.push_back(param); }
+  void addHeader(AsyncWebHeader *header) { _headers.push_back(header); }
+
+  AsyncWebServer *_server;
+  AsyncClient *_client;
+  uint8_t _version = 1;
+  WebRequestMethodComposite _method = HTTP_GET;
+  String _url;
+  String _host;
+  String _contentType;
+  size_t _contentLength = 0;
+  bool _isMultipart = false;
+  std::vector<AsyncWebHeader *> _headers;
+  std::vector<AsyncWebParameter *> _params;
+};
+
+//////////////////////// Handlers ////////////////////////
+
+class AsyncWebHandler {
+public:
+  virtual ~AsyncWebHandler() {}
+
+  AsyncWebHandler &setFilter(ArRequestFilterFunction fn) {
+    _filter = fn;
+    return *this;
+  }
+  AsyncWebHandler &setAuthentication(const char *username, const char *password) { return *this; }
+  bool filter(AsyncWebServerRequest *request) { return !_filter || _filter(request); }
+
+  virtual bool canHandle(AsyncWebServerRequest *request) { return false; }
+  virtual void handleRequest(AsyncWebServerRequest *request) {}
+  virtual void handleUpload(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data,
+                            size_t len, bool final) {}
+  virtual void handleBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {}
+
+protected:
+  ArRequestFilterFunction _filter;
+};
+
+// What server.on() registers: a path and method with its callbacks
+class AsyncCallbackWebHandler : public AsyncWebHandler {
+public:
+  void setUri(const String &uri) { _uri = uri; }
+  void setMethod(WebRequestMethodComposite method) { _method = method; }
+  void onRequest(ArRequestHandlerFunction fn) { _onRequest = fn; }
+  void onUpload(ArUploadHandlerFunction fn) { _onUpload = fn; }
+  void onBody(ArBodyHandlerFunction fn) { _onBody = fn; }
+
+  bool canHandle(AsyncWebServerRequest *request) override;
+  void handleRequest(AsyncWebServerRequest *request) override;
+  void handleUpload(AsyncWebServerRequest *request, const String &filename, size_t index, uint8_t *data, size_t len,
+                    bool final) override;
+  void handleBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) override;
+
+private:
+  String _uri;
+  WebRequestMethodComposite _method = HTTP_ANY;
+  ArRequestHandlerFunction _onRequest;
+  ArUploadHandlerFunction _onUpload;
+  ArBodyHandlerFunction _onBody;
+};
+
+//////////////////////// Server-Sent Events ////////////////////////
+
+class AsyncEventSource;
+
+#define SSE_MAX_QUEUED_MESSAGES 32
+
+class AsyncEventSourceClient {
+public:
+  AsyncEventSourceClient(AsyncWebServerRequest *request, AsyncEventSource *server);
+
+  AsyncClient *client() { return _client; }
+  void close();
+  bool connected() const;
+  uint32_t lastId() const { return _lastId; }
+  size_t packetsWaiting() const;
+  void send(const char *message, const char *event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+
+private:
+  AsyncClient *_client;
+  AsyncEventSource *_server;
+  uint32_t _lastId = 0;
+};
+
+class AsyncEventSource : public AsyncWebHandler {
+  friend class HostConnection;
+
+public:
+  AsyncEventSource(const String &url) : _url(url) {}
+  ~AsyncEventSource();
+
+  const char *url() const { return _url.c_str(); }
+  void onConnect(std::function<void(AsyncEventSourceClient *client)> cb) { _connectcb = cb; }
+  void close();
+  void send(const char *message, const char *event = nullptr, uint32_t id = 0, uint32_t reconnect = 0);
+  size_t count() const;
+  size_t avgPacketsWaiting() const;
+
+  bool canHandle(AsyncWebServerRequest *request) override;
+  void handleRequest(AsyncWebServerRequest *request) override;
+
+  // Host side
+  void _addClient(AsyncEventSourceClient *client);
+  void _handleDisconnect(AsyncEventSourceClient *client);
+
+private:
+  String _url;
+  std::list<AsyncEventSourceClient *> _clients;
+  std::function<void(AsyncEventSourceClient *client)> _connectcb;
+};
+
+//////////////////////// WebSockets ////////////////////////
+
+class AsyncWebSocket;
+
+typedef enum { WS_EVT_CONNECT, WS_EVT_DISCONNECT, WS_EVT_PONG, WS_EVT_ERROR, WS_EVT_DATA } AwsEventType;
+typedef enum { WS_DISCONNECTED, WS_CONNECTED, WS_DISCONNECTING } AwsClientStatus;
+typedef enum { WS_CONTINUATION, WS_TEXT, WS_BINARY, WS_DISCONNECT = 0x08, WS_PING, WS_PONG } AwsFrameType;
+
+#define WS_MAX_QUEUED_MESSAGES 32
+
+typedef struct {
+  uint8_t message_opcode;  // Opcode of the message's first frame
+  uint32_t num;            // Frame number within the message
+  uint8_t final;
+  uint8_t masked;
+  uint8_t opcode;
+  uint64_t len;    // Length of the frame
+  uint8_t mask[4];
+  uint64_t index;  // Offset of this piece within the frame
+} AwsFrameInfo;
+
+class AsyncWebSocketClient {
+public:
+  AsyncWebSocketClient(AsyncWebServerRequest *request, AsyncWebSocket *server);
+
+  uint32_t id() const { return _clientId; }
+  AwsClientStatus status() const { return _status; }
+  AsyncClient *client() { return _client; }
+  AsyncWebSocket *server() { return _server; }
+  IPAddress remoteIP() const { return _client->remoteIP(); }
+  uint16_t remotePort() const { return _client->remotePort(); }
+
+  void close(uint16_t code = 0, const char *message = nullptr);
+  void ping(const uint8_t *data = nullptr, size_t len = 0);
+  void keepAlivePeriod(uint16_t seconds) { _keepAlivePeriod = seconds * 1000; }
+  uint16_t keepAlivePeriod() const { return _keepAlivePeriod / 1000; }
+  bool canSend() const;
+  size_t queueLength() const;
+
+  void text(const char *message, size_t len);
+  void text(const char *message) { text(message, strlen(message)); }
+  void text(const String &message) { text(message.c_str(), message.length()); }
+  void binary(const uint8_t *message, size_t len);
+  void binary(const char *message, size_t len) { binary((const uint8_t *)message, len); }
+
+  // Host side
+  void _queueFrame(uint8_t opcode, const uint8_t *data, size_t len);
+  void _onFrame(uint8_t opcode, bool final, const uint8_t *mask, uint8_t *data, size_t len);
+  void _onPoll(unsigned long now);
+  void _onDisconnect();
+  void _onActivity() { _lastMessageTime = millis(); }
+
+private:
+  AsyncClient *_client;
+  AsyncWebSocket *_server;
+  uint32_t _clientId;
+  AwsClientStatus _status = WS_CONNECTED;
+  uint8_t _messageOpcode = 0;
+  uint32_t _frameNumber = 0;
+  unsigned long _lastMessageTime;
+  uint32_t _keepAlivePeriod = 0;
+};
+
+typedef std::function<void(AsyncWebSocket *server, AsyncWebSocketClient *client, AwsEventType type, void *arg,
+                           uint8_t *data, size_t len)>
+  AwsEventHandler;
+
+class AsyncWebSocket : public AsyncWebHandler {
+public:
+  AsyncWebSocket(const String &url) : _url(url) {}
+  ~AsyncWebSocket();
+
+  const char *url() const { return _url.c_str(); }
+  void enable(bool enabled) { _enabled = enabled; }
+  bool enabled() const { return _enabled; }
+  void onEvent(AwsEventHandler handler) { _eventHandler = handler; }
+
+  size_t count() const;
+  AsyncWebSocketClient *client(uint32_t id);
+  bool hasClient(uint32_t id) { return client(id) != nullptr; }
+  void close(uint32_t id, uint16_t code = 0, const char *message = nullptr);
+  void closeAll(uint16_t code = 0, const char *message = nullptr);
+  void cleanupClients(uint16_t maxClients = 8);
+  bool availableForWriteAll();
+
+  void text(uint32_t id, const char *message);
+  void textAll(const char *message, size_t len);
+  void textAll(const char *message) { textAll(message, strlen(message)); }
+  void textAll(const String &message) { textAll(message.c_str(), message.length()); }
+  void binaryAll(const uint8_t *message, size_t len);
+
+  bool canHandle(AsyncWebServerRequest *request) override;
+  void handleRequest(AsyncWebServerRequest *request) override;
+
+  // Host side
+  uint32_t _getNextId() { return _cNextId++; }
+  void _addClient(AsyncWebSocketClient *client) { _clients.push_back(client); }
+  void _handleDisconnect(AsyncWebSocketClient *client);
+  void _handleEvent(AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data, size_t len);
+
+private:
+  String _url;
+  std::list<AsyncWebSocketClient *> _clients;
+  uint32_t _cNextId = 1;
+  bool _enabled = true;
+  AwsEventHandler _eventHandler;
+};
+
+//////////////////////// Server ////////////////////////
+
+class AsyncWebServer {
+  friend class HostConnection;
+  friend struct HostServerThread;
+
+public:
+  AsyncWebServer(uint16_t port);
+  ~AsyncWebServer();
+
+  // Listens on the port passed to the constructor, or the one
+  // hostSetHttpPort() picked, and starts the server thread
+  void begin();
+  void end();
+
+  AsyncWebHandler &addHandler(AsyncWebHandler *handler);
+  bool removeHandler(AsyncWebHandler *handler);
+
+  AsyncCallbackWebHandler &on(const char *uri, ArRequestHandlerFunction onRequest);
+  AsyncCallbackWebHandler &on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest);
+  AsyncCallbackWebHandler &on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                              ArUploadHandlerFunction onUpload);
+  AsyncCallbackWebHandler &on(const char *uri, WebRequestMethodComposite method, ArRequestHandlerFunction onRequest,
+                              ArUploadHandlerFunction onUpload, ArBodyHandlerFunction onBody);
+
+  void onNotFound(ArRequestHandlerFunction fn);
+  void onFileUpload(ArUploadHandlerFunction fn);
+  void onRequestBody(ArBodyHandlerFunction fn);
+  void reset();
+
+  // Host side
+  void _attachHandler(AsyncWebServerRequest *request);
+  uint16_t _port() const { return _listenPort; }
+
+private:
+  uint16_t _configuredPort;
+  uint16_t _listenPort = 0;
+  int _listenFd = -1;
+  std::vector<AsyncWebHandler *> _handlers;
+  AsyncCallbackWebHandler *_catchAllHandler;
+  struct HostServerThread *_thread = nullptr;
+};
+
+class DefaultHeaders {
+public:
+  static DefaultHeaders &Instance();
+
+  void addHeader(const String &name, const String &value) { _headers.push_back(AsyncWebHeader(name, value)); }
+  const std::vector<AsyncWebHeader> &headers() const { return _headers; }
+
+private:
+  std::vector<AsyncWebHeader> _headers;
+};
+
+#endif  // HOST_ESPASYNCWEBSERVER_H
@@ -0,0 +1,83 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+// Host stand-in for the ESP32 core's fs::FS and fs::File, see LittleFS.h
+
+#include <Arduino.h>
+#include <memory>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class FileImpl;
+typedef std::shared_ptr<FileImpl> FileImplPtr;
+class FSImpl;
+typedef std::shared_ptr<FSImpl> FSImplPtr;
+
+class File : public Stream {
+public:
+  File(FileImplPtr impl = FileImplPtr()) : _p(impl) {}
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int peek() override;
+  void flush() override;
+  size_t read(uint8_t *buffer, size_t size);
+  size_t readBytes(char *buffer, size_t length) { return read((uint8_t *)buffer, length); }
+
+  bool seek(uint32_t position, SeekMode mode);
+  bool seek(uint32_t position) { return seek(position, SeekSet); }
+  size_t position() const;
+  size_t size() const;
+  void close();
+  operator bool() const;
+  const char *path() const;
+  const char *name() const;  // Without the directory, as the 2.x core returns it
+
+  bool isDirectory() const;
+  File openNextFile(const char *mode = FILE_READ);
+  void rewindDirectory();
+
+private:
+  FileImplPtr _p;
+};
+
+class FS {
+public:
+  FS(FSImplPtr impl) : _impl(impl) {}
+
+  File open(const char *path, const char *mode = FILE_READ, const bool create = false);
+  File open(const String &path, const char *mode = FILE_READ, const bool create = false) {
+    return open(path.c_str(), mode, create);
+  }
+  bool exists(const char *path);
+  bool exists(const String &path) { return exists(path.c_str()); }
+  bool remove(const char *path);
+  bool remove(const String &path) { return remove(path.c_str()); }
+  bool rename(const char *from, const char *to);
+  bool mkdir(const char *path);
+  bool mkdir(const String &path) { return mkdir(path.c_str()); }
+  bool rmdir(const char *path);
+
+protected:
+  FSImplPtr _impl;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekCur;
+using fs::SeekEnd;
+using fs::SeekMode;
+using fs::SeekSet;
+
+#endif  // HOST_FS_H
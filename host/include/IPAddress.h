@@ -0,0 +1,31 @@
+#ifndef HOST_IPADDRESS_H
+#define HOST_IPADDRESS_H
+
+#include <Arduino.h>
+
+// IPv4 address, stored in network order as the ESP32 core does
+class IPAddress : public Printable {
+public:
+  IPAddress() {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{ a, b, c, d } {}
+  IPAddress(uint32_t address) { memcpy(bytes, &address, 4); }
+
+  operator uint32_t() const {
+    uint32_t address;
+    memcpy(&address, bytes, 4);
+    return address;
+  }
+  uint8_t operator[](int index) const { return bytes[index]; }
+  uint8_t &operator[](int index) { return bytes[index]; }
+  bool operator==(const IPAddress &other) const { return memcmp(bytes, other.bytes, 4) == 0; }
+  bool operator!=(const IPAddress &other) const { return !(*this == other); }
+
+  bool fromString(const char *text);
+  String toString() const;
+  size_t printTo(Print &out) const override;
+
+private:
+  uint8_t bytes[4] = {};
+};
+
+#endif  // HOST_IPADDRESS_H
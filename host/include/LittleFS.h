@@ -0,0 +1,28 @@
+#ifndef HOST_LITTLEFS_H
+#define HOST_LITTLEFS_H
+
+// Host stand-in for LittleFS: a file system in memory with the size and
+// block accounting of the board's 1.375 MB partition. It is empty at start,
+// host.h can format it, resize it and make mounts, writes or deletes fail.
+
+#include <FS.h>
+
+namespace fs {
+
+class LittleFSFS : public FS {
+public:
+  LittleFSFS();
+
+  bool begin(bool formatOnFail = false, const char *basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+             const char *partitionLabel = "spiffs");
+  void end();
+  bool format();
+  size_t totalBytes();
+  size_t usedBytes();
+};
+
+}  // namespace fs
+
+extern fs::LittleFSFS LittleFS;
+
+#endif  // HOST_LITTLEFS_H
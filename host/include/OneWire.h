@@ -0,0 +1,15 @@
+#ifndef HOST_ONEWIRE_H
+#define HOST_ONEWIRE_H
+
+#include <Arduino.h>
+
+// Host stand-in, the bus itself is never driven
+class OneWire {
+public:
+  OneWire(uint8_t pin) : _pin(pin) {}
+
+private:
+  uint8_t _pin;
+};
+
+#endif  // HOST_ONEWIRE_H
@@ -0,0 +1,43 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+// Host stand-in for the NVS Preferences library, kept in memory. Every
+// Preferences object sees the same store, as they do on the board, and it
+// survives end() and begin() but not the process.
+
+#include <Arduino.h>
+
+class Preferences {
+public:
+  bool begin(const char *name, bool readOnly = false, const char *partitionLabel = nullptr);
+  void end();
+
+  bool clear();
+  bool remove(const char *key);
+  bool isKey(const char *key);
+
+  size_t putBytes(const char *key, const void *value, size_t length);
+  size_t getBytes(const char *key, void *buffer, size_t maxLength);
+  size_t getBytesLength(const char *key);
+
+  size_t putString(const char *key, const char *value);
+  size_t putString(const char *key, const String &value) { return putString(key, value.c_str()); }
+  String getString(const char *key, const String &defaultValue = String());
+
+  size_t putUInt(const char *key, uint32_t value);
+  uint32_t getUInt(const char *key, uint32_t defaultValue = 0);
+  size_t putUChar(const char *key, uint8_t value);
+  uint8_t getUChar(const char *key, uint8_t defaultValue = 0);
+  size_t putBool(const char *key, bool value) { return putUChar(key, value); }
+  bool getBool(const char *key, bool defaultValue = false) { return getUChar(key, defaultValue); }
+
+private:
+  size_t put(const char *key, uint8_t type, const void *value, size_t length);
+  size_t get(const char *key, uint8_t type, void *buffer, size_t maxLength);
+
+  String _namespace;
+  bool _started = false;
+  bool _readOnly = false;
+};
+
+#endif  // HOST_PREFERENCES_H
@@ -0,0 +1,45 @@
+#ifndef HOST_PUBSUBCLIENT_H
+#define HOST_PUBSUBCLIENT_H
+
+// Host stand-in for PubSubClient. There is no broker: a connect succeeds
+// only while hostSetMqttBroker() says one is up, and what is published is
+// kept for the tests, see host.h.
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+class PubSubClient {
+public:
+  PubSubClient() {}
+  PubSubClient(WiFiClient &client) {}
+
+  PubSubClient &setServer(const char *domain, uint16_t port);
+  PubSubClient &setKeepAlive(uint16_t seconds) { return *this; }
+  PubSubClient &setSocketTimeout(uint16_t seconds) { return *this; }
+  bool setBufferSize(uint16_t size);
+  uint16_t getBufferSize() const { return _bufferSize; }
+
+  bool connect(const char *id);
+  bool connect(const char *id, const char *willTopic, uint8_t willQos, bool willRetain, const char *willMessage);
+  bool connect(const char *id, const char *user, const char *pass, const char *willTopic, uint8_t willQos,
+               bool willRetain, const char *willMessage);
+  void disconnect();
+  bool publish(const char *topic, const char *payload) { return publish(topic, payload, false); }
+  bool publish(const char *topic, const char *payload, bool retained);
+  bool loop();
+  bool connected();
+  int state() const { return _state; }
+
+private:
+  uint16_t _bufferSize = 256;
+  int _state = MQTT_DISCONNECTED;
+  uint32_t _session = 0;  // Broker session this client joined, see hostSetMqttBroker()
+};
+
+#endif  // HOST_PUBSUBCLIENT_H
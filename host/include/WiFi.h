@@ -0,0 +1,85 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+// Host stand-in for the ESP32 WiFi class. There is no radio: the networks
+// in range are the ones host.h adds, a join to one of them completes after
+// a short delay, and scans finish after a scan's usual time. The station
+// and access point addresses are fixed.
+
+#include <Arduino.h>
+#include <functional>
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+
+typedef enum {
+  WIFI_AUTH_OPEN = 0,
+  WIFI_AUTH_WEP,
+  WIFI_AUTH_WPA_PSK,
+  WIFI_AUTH_WPA2_PSK,
+  WIFI_AUTH_WPA_WPA2_PSK,
+} wifi_auth_mode_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t mode);
+  wifi_mode_t getMode();
+  bool persistent(bool persistent) { return true; }
+  bool setAutoReconnect(bool autoReconnect) { return true; }
+
+  // Station
+  wl_status_t begin(const char *ssid, const char *password = nullptr, int32_t channel = 0,
+                    const uint8_t *bssid = nullptr, bool connect = true);
+  bool disconnect(bool wifiOff = false, bool eraseAp = false);
+  bool reconnect();
+  wl_status_t status();
+  bool isConnected() { return status() == WL_CONNECTED; }
+  IPAddress localIP();
+  String SSID();
+  int32_t RSSI();
+  int32_t channel();
+  uint8_t *BSSID();
+
+  // Access point
+  bool softAP(const char *ssid, const char *password = nullptr, int channel = 1, int hidden = 0,
+              int maxConnection = 4);
+  bool softAPdisconnect(bool wifiOff = false);
+  IPAddress softAPIP();
+  uint8_t softAPgetStationNum() { return 0; }
+
+  // Scans, from the networks host.h added
+  int16_t scanNetworks(bool async = false, bool showHidden = false, bool passive = false,
+                       uint32_t maxMsPerChannel = 300, uint8_t channel = 0);
+  int16_t scanComplete();
+  void scanDelete();
+  String SSID(uint8_t index);
+  int32_t RSSI(uint8_t index);
+  int32_t channel(uint8_t index);
+  uint8_t *BSSID(uint8_t index);
+  wifi_auth_mode_t encryptionType(uint8_t index);
+};
+
+extern WiFiClass WiFi;
+
+// Not connected to anything, for code that only needs the type
+class WiFiClient {
+public:
+  int connect(const char *host, uint16_t port) { return 0; }
+  bool connected() { return false; }
+  void stop() {}
+};
+
+#endif  // HOST_WIFI_H
@@ -0,0 +1,180 @@
+#ifndef HOST_H
+#define HOST_H
+
+// Controls for the host stand-ins, used by the tests and host/main.cpp.
+// None of this exists on the board, sketch code never includes it.
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//////////////////////// Clock ////////////////////////
+
+// millis(), micros() and esp_timer_get_time() follow a monotonic clock
+// from process start. With the manual clock they only move when a test
+// moves them, and delay() and vTaskDelay() advance it instead of sleeping,
+// which suits a test that drives the update functions from one thread.
+void hostUseManualClock(uint64_t startUs = 1000000);
+void hostAdvanceUs(uint64_t us);
+void hostAdvanceMs(uint32_t ms);
+
+//////////////////////// Sensors ////////////////////////
+
+// NAN fails the read
+void hostSetDht(float temperature, float humidity);
+void hostSetDs18b20(float temperature);
+void hostSetBme280(float temperature, float humidity, float pressurePa, bool present = true);
+void hostSetAnalogMilliVolts(uint8_t pin, uint32_t milliVolts);
+
+// Reads each sensor library has answered
+struct HostSensorReads {
+  unsigned long dht;
+  unsigned long ds18b20Requests;
+  unsigned long ds18b20;
+  unsigned long bme280;
+  unsigned long analog;
+};
+HostSensorReads hostSensorReads();
+
+//////////////////////// Pins and PWM ////////////////////////
+
+// One change of a PWM output: a write, or the start of a hardware fade
+struct HostPwmEvent {
+  uint64_t us;        // esp_timer_get_time() when it was made
+  uint8_t channel;
+  uint32_t duty;      // Target of a fade
+  uint32_t fadeMs;    // 0 for a write
+};
+
+std::vector<HostPwmEvent> hostPwmEvents();
+void hostClearPwmEvents();
+uint32_t hostPwmDuty(uint8_t channel);  // With a running fade's progress
+int8_t hostPwmChannelPin(uint8_t channel);
+int hostPinLevel(uint8_t pin);          // digitalWrite() or analogWrite() value, -1 if never set
+
+//////////////////////// Wi-Fi ////////////////////////
+
+struct HostWiFiNetwork {
+  String ssid;
+  String password;
+  int32_t rssi;
+  uint8_t channel;
+  uint8_t bssid[6];
+};
+
+// Networks in range. A begin() for one of them with its password connects
+// after the join time, a shorter one with its channel and BSSID given.
+void hostAddWiFiNetwork(const HostWiFiNetwork &network);
+void hostRemoveWiFiNetworks();
+void hostSetWiFiJoinMs(uint32_t scanningJoinMs, uint32_t knownChannelJoinMs);
+void hostSetWiFiScanMs(uint32_t ms);
+void hostDropWiFi();  // The access point went away
+
+struct HostWiFiStats {
+  unsigned long begins;
+  unsigned long scans;
+  int32_t lastChannel;  // Channel the last begin() asked for, 0 to scan
+  bool lastBssid;       // The last begin() gave a BSSID
+  int apChannel;        // Channel of the access point, 0 while off
+  String apSSID;
+};
+HostWiFiStats hostWiFiStats();
+
+//////////////////////// NVS ////////////////////////
+
+void hostClearPreferences();
+void hostFailPreferenceWrites(bool fail);
+
+//////////////////////// LittleFS ////////////////////////
+
+void hostFormatLittleFS(size_t totalBytes = 0);  // 0 keeps the size
+void hostFailLittleFSMount(bool fail);
+void hostFailLittleFSWrites(bool fail);
+void hostFailLittleFSRemoves(bool fail);
+
+//////////////////////// OTA and restarts ////////////////////////
+
+const std::vector<uint8_t> &hostOtaPartition(uint8_t index);
+int hostOtaBootPartition();  // Partition set to boot next
+void hostSetOtaPendingVerify(bool pending);
+
+// ESP.restart() calls this, exit(0) by default
+void hostOnRestart(void (*restart)());
+unsigned long hostRestarts();
+
+//////////////////////// MQTT ////////////////////////
+
+struct HostMqttMessage {
+  String topic;
+  String payload;
+  bool retained;
+};
+
+// A broker going down drops every client's connection
+void hostSetMqttBroker(bool up);
+std::vector<HostMqttMessage> hostMqttMessages();
+void hostClearMqttMessages();
+
+//////////////////////// Heap ////////////////////////
+
+// Bytes in live malloc() blocks beyond what was in use at start. The
+// host library wraps the allocator to count them, so blocks glibc keeps
+// cached after free() don't count. ESP.getFreeHeap() and getMinFreeHeap()
+// are the same figures taken from HOST_HEAP_SIZE.
+size_t hostHeapInUse();
+size_t hostHeapPeak();     // Highest hostHeapInUse() since start or the last reset
+void hostResetHeapPeak();
+
+//////////////////////// HTTP ////////////////////////
+
+// The lock the server thread holds while it runs handlers. Anything else
+// touching the server's objects takes it, as AsyncTCP's calls do.
+std::recursive_mutex &hostTcpLock();
+
+// Port the servers listen on instead of the one passed to the
+// constructor, 80 needs privileges on Linux. 0 lets the system pick.
+void hostSetHttpPort(uint16_t port);
+
+// Report 127.x.y.z clients as 192.168.4.z, i.e. as clients of the access
+// point, which makes them admins once logged in
+void hostSetApClients(bool apClients);
+
+// A connection fed by a test instead of a socket. The request runs on the
+// calling thread, which must not be the server thread.
+class HostRequest {
+public:
+  HostRequest(AsyncWebServer &server, const std::string &raw, IPAddress from = IPAddress(192, 168, 4, 2));
+  ~HostRequest();
+
+  void write(const std::string &data);  // More bytes from the client
+  bool poll();                          // Moves the response along, true once the server closed
+  void close();                         // The client goes away
+  std::string read();                   // Bytes the server sent since the last read()
+
+  std::string output;                   // Everything the server sent
+
+private:
+  class HostConnection *_connection;
+  size_t _readLength = 0;
+};
+
+// A parsed response, with the chunked encoding undone
+struct HostResponse {
+  int status = 0;
+  std::vector<std::pair<std::string, std::string>> headers;
+  std::string body;
+  bool complete = false;  // The server closed the connection
+
+  std::string header(const char *name) const;
+};
+
+HostResponse hostParseResponse(const std::string &raw);
+
+// One request start to finish, polling up to maxPolls times
+HostResponse hostRequest(AsyncWebServer &server, const char *method, const char *path, const std::string &body = "",
+                         const std::string &headers = "", IPAddress from = IPAddress(192, 168, 4, 2),
+                         unsigned maxPolls = 1000);
+
+#endif  // HOST_H
@@ -0,0 +1,35 @@
+// The sketch on Linux: setup(), then loop() forever, with the web server
+// on localhost. See "Host build" in README.md.
+//
+//   esp32_web_server [--port N] [--ap-clients]
+//
+// --port        Port to listen on instead of 80, HOST_HTTP_PORT works too (default 8080)
+// --ap-clients  Treat local clients as clients of the access point (admins once logged in)
+
+#include "../ESP32_Web_Server/ESP32_Web_Server.ino"
+#include <host.h>
+
+int main(int argc, char **argv) {
+  int port = 8080;
+  const char *environmentPort = getenv("HOST_HTTP_PORT");
+  if (environmentPort) port = atoi(environmentPort);
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--port") && i + 1 < argc) {
+      port = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "--ap-clients")) {
+      hostSetApClients(true);
+    } else {
+      fprintf(stderr, "usage: %s [--port N] [--ap-clients]\n", argv[0]);
+      return 2;
+    }
+  }
+  hostSetHttpPort(port);
+  setvbuf(stdout, nullptr, _IOLBF, 0);  // Serial output shows up as it is printed
+
+  // The network of the default settings is in range
+  HostWiFiNetwork home = { config.ssid, config.wifiPassword, -58, 6, { 0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56 } };
+  hostAddWiFiNetwork(home);
+
+  setup();
+  for (;;) loop();
+}
@@ -0,0 +1,645 @@
+// Host stand-ins for the Arduino core: Print, String, Serial, time, pins,
+// LEDC, ESP and FreeRTOS tasks
+
+#include <Arduino.h>
+#include <driver/ledc.h>
+#include <errno.h>
+#include <host.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <thread>
+
+//////////////////////// Print ////////////////////////
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (!write(*buffer++)) break;
+    n++;
+  }
+  return n;
+}
+
+static size_t printNumber(Print &out, unsigned long long value, int base, bool negative) {
+  char digits[68];
+  char *p = digits + sizeof(digits);
+  *--p = '\0';
+  if (base < 2) base = 10;
+  do {
+    int digit = value % base;
+    *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+    value /= base;
+  } while (value);
+  if (negative) *--p = '-';
+  return out.write(p);
+}
+
+size_t Print::print(long value, int base) {
+  return print((long long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  return printNumber(*this, value, base, false);
+}
+
+size_t Print::print(long long value, int base) {
+  if (base == 10 && value < 0) return printNumber(*this, -(unsigned long long)value, base, true);
+  return printNumber(*this, (unsigned long long)value, base, false);
+}
+
+size_t Print::print(unsigned long long value, int base) {
+  return printNumber(*this, value, base, false);
+}
+
+size_t Print::print(double value, int digits) {
+  char text[64];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return write(text);
+}
+
+size_t Print::printf(const char *format, ...) {
+  char small[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(small, sizeof(small), format, args);
+  va_end(args);
+  if (length < 0) return 0;
+  if ((size_t)length < sizeof(small)) return write((const uint8_t *)small, length);
+
+  std::string large(length + 1, '\0');
+  va_start(args, format);
+  vsnprintf(&large[0], large.size(), format, args);
+  va_end(args);
+  return write((const uint8_t *)large.data(), length);
+}
+
+//////////////////////// String ////////////////////////
+
+static std::string formatInteger(unsigned long long value, unsigned char base, bool negative) {
+  std::string text;
+  if (base < 2) base = 10;
+  do {
+    int digit = value % base;
+    text.insert(text.begin(), digit < 10 ? '0' + digit : 'a' + digit - 10);
+    value /= base;
+  } while (value);
+  if (negative) text.insert(text.begin(), '-');
+  return text;
+}
+
+String::String(int value, unsigned char base) : String((long)value, base) {}
+
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+
+String::String(long value, unsigned char base)
+  : s(base == 10 && value < 0 ? formatInteger(-(unsigned long long)value, base, true)
+                              : formatInteger((unsigned long)value, base, false)) {}
+
+String::String(unsigned long value, unsigned char base) : s(formatInteger(value, base, false)) {}
+
+String::String(float value, unsigned int decimals) : String((double)value, decimals) {}
+
+String::String(double value, unsigned int decimals) {
+  char text[64];
+  snprintf(text, sizeof(text), "%.*f", decimals, value);
+  s = text;
+}
+
+bool String::equalsIgnoreCase(const String &other) const {
+  return s.size() == other.s.size() && strcasecmp(s.c_str(), other.s.c_str()) == 0;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) std::swap(from, to);
+  if (from >= s.size()) return String();
+  return s.substr(from, to - from);
+}
+
+void String::replace(const String &find, const String &replacement) {
+  if (find.s.empty()) return;
+  size_t position = 0;
+  while ((position = s.find(find.s, position)) != std::string::npos) {
+    s.replace(position, find.s.size(), replacement.s);
+    position += replacement.s.size();
+  }
+}
+
+void String::toLowerCase() {
+  for (char &c : s) c = tolower((unsigned char)c);
+}
+
+void String::toUpperCase() {
+  for (char &c : s) c = toupper((unsigned char)c);
+}
+
+void String::trim() {
+  size_t begin = s.find_first_not_of(" \t\r\n\f\v");
+  if (begin == std::string::npos) {
+    s.clear();
+    return;
+  }
+  size_t end = s.find_last_not_of(" \t\r\n\f\v");
+  s = s.substr(begin, end - begin + 1);
+}
+
+//////////////////////// IPAddress ////////////////////////
+
+bool IPAddress::fromString(const char *text) {
+  unsigned values[4];
+  char extra;
+  if (sscanf(text, "%u.%u.%u.%u%c", &values[0], &values[1], &values[2], &values[3], &extra) != 4) return false;
+  for (int i = 0; i < 4; i++) {
+    if (values[i] > 255) return false;
+    bytes[i] = values[i];
+  }
+  return true;
+}
+
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+  return text;
+}
+
+size_t IPAddress::printTo(Print &out) const {
+  return out.print(toString());
+}
+
+//////////////////////// Serial ////////////////////////
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t c) {
+  return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+//////////////////////// Time ////////////////////////
+
+static std::atomic<bool> manualClock(false);
+static std::atomic<uint64_t> manualUs(0);
+
+static uint64_t nowUs() {
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  if (manualClock) return manualUs;
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void hostUseManualClock(uint64_t startUs) {
+  manualUs = startUs;
+  manualClock = true;
+}
+
+void hostAdvanceUs(uint64_t us) {
+  manualUs += us;
+}
+
+void hostAdvanceMs(uint32_t ms) {
+  manualUs += (uint64_t)ms * 1000;
+}
+
+unsigned long millis() {
+  return (uint32_t)(nowUs() / 1000);  // Wraps like the board's, after 49 days
+}
+
+unsigned long micros() {
+  return (uint32_t)nowUs();
+}
+
+extern "C" int64_t esp_timer_get_time() {
+  return nowUs();
+}
+
+void delay(unsigned long ms) {
+  if (manualClock) {
+    hostAdvanceMs(ms);
+  } else {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  }
+}
+
+void delayMicroseconds(unsigned int us) {
+  if (manualClock) {
+    hostAdvanceUs(us);
+  } else {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+  }
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1, const char *server2,
+                const char *server3) {
+  // The host clock is already set
+}
+
+//////////////////////// Pins ////////////////////////
+
+static std::mutex pinLock;
+static int pinLevels[64];
+static uint32_t pinMilliVolts[64];
+static bool pinsReady = false;
+
+static void initPins() {
+  if (pinsReady) return;
+  for (int &level : pinLevels) level = -1;
+  pinsReady = true;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  std::lock_guard<std::mutex> guard(pinLock);
+  initPins();
+  if (pin < 64) pinLevels[pin] = level ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  std::lock_guard<std::mutex> guard(pinLock);
+  initPins();
+  return pin < 64 && pinLevels[pin] > 0 ? HIGH : LOW;
+}
+
+void analogWrite(uint8_t pin, int value) {
+  std::lock_guard<std::mutex> guard(pinLock);
+  initPins();
+  if (pin < 64) pinLevels[pin] = value;
+}
+
+int hostPinLevel(uint8_t pin) {
+  std::lock_guard<std::mutex> guard(pinLock);
+  initPins();
+  return pin < 64 ? pinLevels[pin] : -1;
+}
+
+void hostSetAnalogMilliVolts(uint8_t pin, uint32_t milliVolts) {
+  std::lock_guard<std::mutex> guard(pinLock);
+  if (pin < 64) pinMilliVolts[pin] = milliVolts;
+}
+
+extern std::atomic<unsigned long> hostAnalogReads;
+
+uint32_t analogReadMilliVolts(uint8_t pin) {
+  std::lock_guard<std::mutex> guard(pinLock);
+  hostAnalogReads++;
+  return pin < 64 ? pinMilliVolts[pin] : 0;
+}
+
+uint16_t analogRead(uint8_t pin) {
+  // 12 bits over the 3.1 V the ADC reads at 11 dB
+  uint32_t milliVolts = analogReadMilliVolts(pin);
+  return milliVolts >= 3100 ? 4095 : milliVolts * 4095 / 3100;
+}
+
+//////////////////////// LEDC ////////////////////////
+
+struct PwmChannel {
+  int8_t pin = -1;
+  uint8_t bits = 8;
+  uint32_t duty = 0;       // Duty at fadeStartUs, or the written one
+  uint32_t fadeTarget = 0;
+  uint32_t fadeMs = 0;     // 0 when no fade runs
+  uint64_t fadeStartUs = 0;
+  bool fadePrepared = false;  // ledc_set_fade_with_time() was called, the start is due
+  uint32_t preparedFadeMs = 0;
+};
+
+static std::mutex pwmLock;
+static PwmChannel pwmChannels[LEDC_CHANNEL_MAX];
+static std::vector<HostPwmEvent> pwmEvents;
+
+static uint32_t currentDuty(const PwmChannel &channel, uint64_t now) {
+  if (!channel.fadeMs) return channel.duty;
+  uint64_t elapsedUs = now - channel.fadeStartUs;
+  uint64_t totalUs = (uint64_t)channel.fadeMs * 1000;
+  if (elapsedUs >= totalUs) return channel.fadeTarget;
+  int64_t span = (int64_t)channel.fadeTarget - channel.duty;
+  return channel.duty + span * (int64_t)elapsedUs / (int64_t)totalUs;
+}
+
+uint32_t ledcSetup(uint8_t channel, uint32_t frequency, uint8_t resolutionBits) {
+  std::lock_guard<std::mutex> guard(pwmLock);
+  if (channel >= LEDC_CHANNEL_MAX) return 0;
+  pwmChannels[channel].bits = resolutionBits;
+  return frequency;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+  std::lock_guard<std::mutex> guard(pwmLock);
+  if (channel < LEDC_CHANNEL_MAX) pwmChannels[channel].pin = pin;
+}
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+  std::lock_guard<std::mutex> guard(pwmLock);
+  if (channel >= LEDC_CHANNEL_MAX) return;
+  PwmChannel &pwm = pwmChannels[channel];
+  pwm.duty = duty;
+  pwm.fadeMs = 0;
+  pwmEvents.push_back({ nowUs(), channel, duty, 0 });
+}
+
+uint32_t ledcRead(uint8_t channel) {
+  return hostPwmDuty(channel);
+}
+
+esp_err_t ledc_fade_func_install(int intrAllocFlags) {
+  return 0;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t channel, uint32_t targetDuty, int maxFadeTimeMs) {
+  std::lock_guard<std::mutex> guard(pwmLock);
+  if (channel >= LEDC_CHANNEL_MAX) return -1;
+  PwmChannel &pwm = pwmChannels[channel];
+  uint64_t now = nowUs();
+  pwm.duty = currentDuty(pwm, now);
+  pwm.fadeMs = 0;
+  pwm.fadeTarget = targetDuty;
+  pwm.fadePrepared = true;
+  pwm.preparedFadeMs = maxFadeTimeMs;
+  return 0;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t channel, ledc_fade_mode_t fadeMode) {
+  std::lock_guard<std::mutex> guard(pwmLock);
+  if (channel >= LEDC_CHANNEL_MAX || !pwmChannels[channel].fadePrepared) return -1;
+  PwmChannel &pwm = pwmChannels[channel];
+  pwm.fadePrepared = false;
+  pwm.fadeMs = pwm.preparedFadeMs;
+  pwm.fadeStartUs = nowUs();
+  pwmEvents.push_back({ pwm.fadeStartUs, (uint8_t)channel, pwm.fadeTarget, pwm.fadeMs });
+  if (pwm.fadeMs == 0) pwm.duty = pwm.fadeTarget;
+  return 0;
+}
+
+std::vector<HostPwmEvent> hostPwmEvents() {
+  std::lock_guard<std::mutex> guard(pwmLock);
+  return pwmEvents;
+}
+
+void hostClearPwmEvents() {
+  std::lock_guard<std::mutex> guard(pwmLock);
+  pwmEvents.clear();
+}
+
+uint32_t hostPwmDuty(uint8_t channel) {
+  std::lock_guard<std::mutex> guard(pwmLock);
+  return channel < LEDC_CHANNEL_MAX ? currentDuty(pwmChannels[channel], nowUs()) : 0;
+}
+
+int8_t hostPwmChannelPin(uint8_t channel) {
+  std::lock_guard<std::mutex> guard(pwmLock);
+  return channel < LEDC_CHANNEL_MAX ? pwmChannels[channel].pin : -1;
+}
+
+//////////////////////// Random ////////////////////////
+
+static std::mutex randomLock;
+static std::mt19937 randomEngine(std::random_device{}());
+
+extern "C" uint32_t esp_random() {
+  std::lock_guard<std::mutex> guard(randomLock);
+  return randomEngine();
+}
+
+void randomSeed(unsigned long seed) {
+  std::lock_guard<std::mutex> guard(randomLock);
+  randomEngine.seed(seed);
+}
+
+long random(long max) {
+  return max > 0 ? esp_random() % max : 0;
+}
+
+long random(long min, long max) {
+  return min < max ? min + random(max - min) : min;
+}
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh) {
+  return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+}
+
+//////////////////////// ESP ////////////////////////
+
+EspClass ESP;
+
+// Usable heap of an ESP32 with Wi-Fi running, roughly
+#define HOST_HEAP_SIZE 327680
+
+// Every allocation goes through these, so the heap figures count live
+// blocks only, whatever glibc keeps cached, and the lowest free heap is
+// exact rather than sampled
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *pointer);
+}
+
+static std::atomic<size_t> heapCounted(0);
+static std::atomic<size_t> heapPeak(0);
+
+static void *noteAllocated(void *pointer) {
+  if (!pointer) return pointer;
+  size_t counted = heapCounted.fetch_add(malloc_usable_size(pointer), std::memory_order_relaxed) +
+                   malloc_usable_size(pointer);
+  size_t peak = heapPeak.load(std::memory_order_relaxed);
+  while (counted > peak && !heapPeak.compare_exchange_weak(peak, counted, std::memory_order_relaxed)) {
+  }
+  return pointer;
+}
+
+static void noteFreed(void *pointer) {
+  if (pointer) heapCounted.fetch_sub(malloc_usable_size(pointer), std::memory_order_relaxed);
+}
+
+extern "C" void *malloc(size_t size) {
+  return noteAllocated(__libc_malloc(size));
+}
+
+extern "C" void *calloc(size_t count, size_t size) {
+  return noteAllocated(__libc_calloc(count, size));
+}
+
+extern "C" void *realloc(void *pointer, size_t size) {
+  size_t before = pointer ? malloc_usable_size(pointer) : 0;
+  void *result = __libc_realloc(pointer, size);
+  if (!result && size != 0) return result;  // Failed, the old block stays
+  heapCounted.fetch_sub(before, std::memory_order_relaxed);
+  return noteAllocated(result);
+}
+
+extern "C" void free(void *pointer) {
+  noteFreed(pointer);
+  __libc_free(pointer);
+}
+
+extern "C" void *memalign(size_t alignment, size_t size) {
+  return noteAllocated(__libc_memalign(alignment, size));
+}
+
+extern "C" void *aligned_alloc(size_t alignment, size_t size) {
+  return memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void **result, size_t alignment, size_t size) {
+  if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+  *result = memalign(alignment, size);
+  return *result || size == 0 ? 0 : ENOMEM;
+}
+
+extern "C" void *valloc(size_t size) {
+  return memalign(sysconf(_SC_PAGESIZE), size);
+}
+
+extern "C" void *pvalloc(size_t size) {
+  size_t page = sysconf(_SC_PAGESIZE);
+  return memalign(page, (size + page - 1) / page * page);
+}
+
+static const size_t heapAtStart = heapCounted.load();
+
+size_t hostHeapInUse() {
+  size_t inUse = heapCounted.load(std::memory_order_relaxed);
+  return inUse > heapAtStart ? inUse - heapAtStart : 0;
+}
+
+size_t hostHeapPeak() {
+  size_t peak = heapPeak.load(std::memory_order_relaxed);
+  return peak > heapAtStart ? peak - heapAtStart : 0;
+}
+
+void hostResetHeapPeak() {
+  heapPeak.store(heapCounted.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+uint32_t EspClass::getHeapSize() {
+  return HOST_HEAP_SIZE;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  size_t inUse = hostHeapInUse();
+  return inUse < HOST_HEAP_SIZE ? HOST_HEAP_SIZE - inUse : 0;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  size_t peak = hostHeapPeak();
+  return peak < HOST_HEAP_SIZE ? HOST_HEAP_SIZE - peak : 0;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  // glibc has no figure for the largest free block, the free total it is
+  return getFreeHeap();
+}
+
+uint64_t EspClass::getEfuseMac() {
+  return 0x0000A4CF12FE3C24ULL;
+}
+
+static void (*restartHandler)() = nullptr;
+static std::atomic<unsigned long> restarts(0);
+
+void hostOnRestart(void (*restart)()) {
+  restartHandler = restart;
+}
+
+unsigned long hostRestarts() {
+  return restarts;
+}
+
+void EspClass::restart() {
+  restarts++;
+  if (restartHandler) {
+    restartHandler();
+    return;
+  }
+  Serial.println("ESP.restart()");
+  Serial.flush();
+  exit(0);
+}
+
+//////////////////////// FreeRTOS ////////////////////////
+
+// Host threads need more stack than the board's tasks: x86-64 frames are
+// larger and glibc's printf alone takes a few KB
+#define HOST_STACK_SCALE 4
+#define HOST_STACK_EXTRA 32768
+#define HOST_STACK_FILL 0xA5
+
+struct HostTask {
+  const char *name;
+  TaskFunction_t function;
+  void *parameter;
+  uint8_t *stack;
+  size_t stackSize;
+};
+
+static void *runTask(void *argument) {
+  HostTask *task = (HostTask *)argument;
+  pthread_setname_np(pthread_self(), task->name);
+  task->function(task->parameter);
+  return nullptr;  // FreeRTOS tasks never return, the sketch's don't either
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackBytes, void *parameter,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+  HostTask *task = new HostTask{ name, function, parameter, nullptr, 0 };
+  task->stackSize = (size_t)stackBytes * HOST_STACK_SCALE + HOST_STACK_EXTRA;
+  task->stackSize = (task->stackSize + 4095) & ~(size_t)4095;
+  task->stack = (uint8_t *)mmap(nullptr, task->stackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (task->stack == MAP_FAILED) {
+    delete task;
+    return pdFAIL;
+  }
+  // Filled like FreeRTOS fills a new stack, the high water mark is where
+  // the pattern ends
+  memset(task->stack, HOST_STACK_FILL, task->stackSize);
+
+  pthread_attr_t attributes;
+  pthread_attr_init(&attributes);
+  pthread_attr_setstack(&attributes, task->stack, task->stackSize);
+  pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+  pthread_t thread;
+  int result = pthread_create(&thread, &attributes, runTask, task);
+  pthread_attr_destroy(&attributes);
+  if (result != 0) {
+    munmap(task->stack, task->stackSize);
+    delete task;
+    return pdFAIL;
+  }
+  if (handle) *handle = task;
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks * portTICK_PERIOD_MS);
+}
+
+// Bytes of the host stack never touched, not what the task would leave on
+// the board
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t handle) {
+  HostTask *task = (HostTask *)handle;
+  if (!task) return 0;
+  size_t untouched = 0;
+  while (untouched < task->stackSize && task->stack[untouched] == HOST_STACK_FILL) untouched++;
+  return untouched;
+}
+
+BaseType_t xPortGetCoreID() {
+  return 1;
+}
@@ -0,0 +1,376 @@
+// Host stand-in for LittleFS: files in memory, with the block accounting
+// and the failure cases the sensor log has to cope with
+
+#include <LittleFS.h>
+#include <host.h>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#define LITTLEFS_BLOCK_SIZE 4096
+#define LITTLEFS_DEFAULT_SIZE 0x160000  // The spiffs partition of the default partition table
+#define LITTLEFS_INLINE_MAX 512         // Smaller files live in their directory's metadata
+
+namespace fs {
+
+struct RamFile {
+  std::vector<uint8_t> data;
+};
+
+class FSImpl {
+public:
+  std::recursive_mutex lock;
+  std::map<std::string, std::shared_ptr<RamFile>> files;
+  std::set<std::string> dirs = { "/" };
+  size_t totalBytes = LITTLEFS_DEFAULT_SIZE;
+  bool mounted = false;
+  bool failMount = false;
+  bool failWrites = false;
+  bool failRemoves = false;
+
+  static size_t blocks(size_t bytes) { return (bytes + LITTLEFS_BLOCK_SIZE - 1) / LITTLEFS_BLOCK_SIZE; }
+
+  // Each directory is a metadata pair, each file above the inline size
+  // takes whole blocks
+  size_t usedBytes() {
+    size_t used = dirs.size() * 2;
+    for (const auto &file : files) {
+      if (file.second->data.size() > LITTLEFS_INLINE_MAX) used += blocks(file.second->data.size());
+    }
+    return used * LITTLEFS_BLOCK_SIZE;
+  }
+
+  // Whether a file may grow from one size to another
+  bool fits(size_t from, size_t to) {
+    size_t before = from > LITTLEFS_INLINE_MAX ? blocks(from) : 0;
+    size_t after = to > LITTLEFS_INLINE_MAX ? blocks(to) : 0;
+    return usedBytes() + (after - before) * LITTLEFS_BLOCK_SIZE <= totalBytes;
+  }
+};
+
+static std::string normalize(const char *path) {
+  std::string result = path && *path == '/' ? path : std::string("/") + (path ? path : "");
+  while (result.size() > 1 && result.back() == '/') result.pop_back();
+  return result;
+}
+
+static std::string parentOf(const std::string &path) {
+  size_t slash = path.rfind('/');
+  return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+class FileImpl {
+public:
+  FSImplPtr fs;
+  std::string path;
+  bool directory = false;
+  std::shared_ptr<RamFile> file;
+  size_t position = 0;
+  bool readable = false;
+  bool writable = false;
+  bool append = false;
+  bool open = true;
+  std::vector<std::string> entries;  // Directory listing, taken when opened
+  size_t nextEntry = 0;
+};
+
+}  // namespace fs
+
+using fs::FileImpl;
+using fs::FSImpl;
+
+static std::shared_ptr<FSImpl> littleFS = std::make_shared<FSImpl>();
+
+fs::LittleFSFS LittleFS;
+
+void hostFormatLittleFS(size_t totalBytes) {
+  std::lock_guard<std::recursive_mutex> guard(littleFS->lock);
+  littleFS->files.clear();
+  littleFS->dirs = { "/" };
+  if (totalBytes) littleFS->totalBytes = totalBytes;
+}
+
+void hostFailLittleFSMount(bool fail) {
+  std::lock_guard<std::recursive_mutex> guard(littleFS->lock);
+  littleFS->failMount = fail;
+}
+
+void hostFailLittleFSWrites(bool fail) {
+  std::lock_guard<std::recursive_mutex> guard(littleFS->lock);
+  littleFS->failWrites = fail;
+}
+
+void hostFailLittleFSRemoves(bool fail) {
+  std::lock_guard<std::recursive_mutex> guard(littleFS->lock);
+  littleFS->failRemoves = fail;
+}
+
+//////////////////////// File ////////////////////////
+
+namespace fs {
+
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t *buffer, size_t size) {
+  if (!*this || _p->directory || !_p->writable) return 0;
+  std::lock_guard<std::recursive_mutex> guard(_p->fs->lock);
+  std::vector<uint8_t> &data = _p->file->data;
+  if (_p->append) _p->position = data.size();
+  size_t end = _p->position + size;
+  if (_p->fs->failWrites || (end > data.size() && !_p->fs->fits(data.size(), end))) return 0;
+  if (end > data.size()) data.resize(end);
+  memcpy(data.data() + _p->position, buffer, size);
+  _p->position = end;
+  return size;
+}
+
+int File::available() {
+  if (!*this || _p->directory) return 0;
+  std::lock_guard<std::recursive_mutex> guard(_p->fs->lock);
+  size_t size = _p->file->data.size();
+  return _p->position < size ? size - _p->position : 0;
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::peek() {
+  if (!*this || _p->directory || !_p->readable) return -1;
+  std::lock_guard<std::recursive_mutex> guard(_p->fs->lock);
+  const std::vector<uint8_t> &data = _p->file->data;
+  return _p->position < data.size() ? data[_p->position] : -1;
+}
+
+void File::flush() {}
+
+size_t File::read(uint8_t *buffer, size_t size) {
+  if (!*this || _p->directory || !_p->readable) return 0;
+  std::lock_guard<std::recursive_mutex> guard(_p->fs->lock);
+  const std::vector<uint8_t> &data = _p->file->data;
+  if (_p->position >= data.size()) return 0;
+  size_t length = std::min(size, data.size() - _p->position);
+  memcpy(buffer, data.data() + _p->position, length);
+  _p->position += length;
+  return length;
+}
+
+bool File::seek(uint32_t position, SeekMode mode) {
+  if (!*this || _p->directory) return false;
+  std::lock_guard<std::recursive_mutex> guard(_p->fs->lock);
+  long base = mode == SeekSet ? 0 : mode == SeekCur ? (long)_p->position : (long)_p->file->data.size();
+  long target = base + (long)(int32_t)position;
+  if (target < 0) return false;
+  _p->position = target;
+  return true;
+}
+
+size_t File::position() const {
+  return *this ? _p->position : 0;
+}
+
+size_t File::size() const {
+  if (!*this || _p->directory) return 0;
+  std::lock_guard<std::recursive_mutex> guard(_p->fs->lock);
+  return _p->file->data.size();
+}
+
+void File::close() {
+  if (_p) _p->open = false;
+  _p.reset();
+}
+
+File::operator bool() const {
+  return _p && _p->open;
+}
+
+const char *File::path() const {
+  return *this ? _p->path.c_str() : nullptr;
+}
+
+const char *File::name() const {
+  if (!*this) return nullptr;
+  size_t slash = _p->path.rfind('/');
+  return _p->path.c_str() + slash + 1;
+}
+
+bool File::isDirectory() const {
+  return *this && _p->directory;
+}
+
+File File::openNextFile(const char *mode) {
+  if (!*this || !_p->directory) return File();
+  FSImplPtr fs = _p->fs;
+  std::lock_guard<std::recursive_mutex> guard(fs->lock);
+  while (_p->nextEntry < _p->entries.size()) {
+    const std::string &path = _p->entries[_p->nextEntry++];
+    FileImplPtr entry = std::make_shared<FileImpl>();
+    entry->fs = fs;
+    entry->path = path;
+    if (fs->dirs.count(path)) {
+      entry->directory = true;
+      return File(entry);
+    }
+    auto found = fs->files.find(path);
+    if (found == fs->files.end()) continue;  // Removed since the directory was opened
+    entry->file = found->second;
+    entry->readable = true;
+    return File(entry);
+  }
+  return File();
+}
+
+void File::rewindDirectory() {
+  if (*this && _p->directory) _p->nextEntry = 0;
+}
+
+//////////////////////// FS ////////////////////////
+
+File FS::open(const char *path, const char *mode, const bool create) {
+  std::lock_guard<std::recursive_mutex> guard(_impl->lock);
+  if (!_impl->mounted || !path || !mode) return File();
+  std::string name = normalize(path);
+
+  FileImplPtr file = std::make_shared<FileImpl>();
+  file->fs = _impl;
+  file->path = name;
+
+  if (_impl->dirs.count(name)) {
+    if (mode[0] != 'r') return File();
+    file->directory = true;
+    std::string prefix = name == "/" ? "/" : name + "/";
+    for (const std::string &dir : _impl->dirs) {
+      if (dir != name && dir.compare(0, prefix.size(), prefix) == 0 && dir.find('/', prefix.size()) == std::string::npos) {
+        file->entries.push_back(dir);
+      }
+    }
+    for (const auto &entry : _impl->files) {
+      const std::string &child = entry.first;
+      if (child.compare(0, prefix.size(), prefix) == 0 && child.find('/', prefix.size()) == std::string::npos) {
+        file->entries.push_back(child);
+      }
+    }
+    return File(file);
+  }
+
+  bool plus = strchr(mode, '+') != nullptr;
+  auto found = _impl->files.find(name);
+  if (mode[0] == 'r') {
+    if (found == _impl->files.end()) return File();
+    file->file = found->second;
+    file->readable = true;
+    file->writable = plus;
+    return File(file);
+  }
+  if (mode[0] != 'w' && mode[0] != 'a') return File();
+
+  if (found == _impl->files.end()) {
+    std::string parent = parentOf(name);
+    if (!_impl->dirs.count(parent)) {
+      if (!create) return File();
+      for (size_t slash = 1; (slash = name.find('/', slash)) != std::string::npos; slash++) {
+        _impl->dirs.insert(name.substr(0, slash));
+      }
+    }
+    if (!_impl->fits(0, 0) || _impl->failWrites) return File();
+    found = _impl->files.emplace(name, std::make_shared<RamFile>()).first;
+  } else if (mode[0] == 'w') {
+    // Truncating replaces the file, readers of the old one keep theirs
+    found->second = std::make_shared<RamFile>();
+  }
+  file->file = found->second;
+  file->writable = true;
+  file->readable = plus;
+  file->append = mode[0] == 'a';
+  if (file->append) file->position = file->file->data.size();
+  return File(file);
+}
+
+bool FS::exists(const char *path) {
+  std::lock_guard<std::recursive_mutex> guard(_impl->lock);
+  if (!_impl->mounted) return false;
+  std::string name = normalize(path);
+  return _impl->files.count(name) || _impl->dirs.count(name);
+}
+
+bool FS::remove(const char *path) {
+  std::lock_guard<std::recursive_mutex> guard(_impl->lock);
+  if (!_impl->mounted || _impl->failRemoves) return false;
+  return _impl->files.erase(normalize(path)) > 0;
+}
+
+bool FS::rename(const char *from, const char *to) {
+  std::lock_guard<std::recursive_mutex> guard(_impl->lock);
+  if (!_impl->mounted) return false;
+  auto found = _impl->files.find(normalize(from));
+  std::string target = normalize(to);
+  if (found == _impl->files.end() || !_impl->dirs.count(parentOf(target)) || _impl->dirs.count(target)) return false;
+  std::shared_ptr<RamFile> file = found->second;
+  _impl->files.erase(found);
+  _impl->files[target] = file;
+  return true;
+}
+
+bool FS::mkdir(const char *path) {
+  std::lock_guard<std::recursive_mutex> guard(_impl->lock);
+  if (!_impl->mounted) return false;
+  std::string name = normalize(path);
+  if (_impl->dirs.count(name) || _impl->files.count(name) || !_impl->dirs.count(parentOf(name))) return false;
+  if (_impl->usedBytes() + 2 * LITTLEFS_BLOCK_SIZE > _impl->totalBytes) return false;
+  _impl->dirs.insert(name);
+  return true;
+}
+
+bool FS::rmdir(const char *path) {
+  std::lock_guard<std::recursive_mutex> guard(_impl->lock);
+  if (!_impl->mounted) return false;
+  std::string name = normalize(path);
+  if (name == "/" || !_impl->dirs.count(name)) return false;
+  std::string prefix = name + "/";
+  for (const auto &file : _impl->files) {
+    if (file.first.compare(0, prefix.size(), prefix) == 0) return false;
+  }
+  for (const std::string &dir : _impl->dirs) {
+    if (dir.compare(0, prefix.size(), prefix) == 0) return false;
+  }
+  _impl->dirs.erase(name);
+  return true;
+}
+
+//////////////////////// LittleFS ////////////////////////
+
+LittleFSFS::LittleFSFS() : FS(littleFS) {}
+
+bool LittleFSFS::begin(bool formatOnFail, const char *basePath, uint8_t maxOpenFiles, const char *partitionLabel) {
+  std::lock_guard<std::recursive_mutex> guard(_impl->lock);
+  if (_impl->failMount) return false;
+  _impl->mounted = true;
+  return true;
+}
+
+void LittleFSFS::end() {
+  std::lock_guard<std::recursive_mutex> guard(_impl->lock);
+  _impl->mounted = false;
+}
+
+bool LittleFSFS::format() {
+  hostFormatLittleFS();
+  return true;
+}
+
+size_t LittleFSFS::totalBytes() {
+  std::lock_guard<std::recursive_mutex> guard(_impl->lock);
+  return _impl->totalBytes;
+}
+
+size_t LittleFSFS::usedBytes() {
+  std::lock_guard<std::recursive_mutex> guard(_impl->lock);
+  return _impl->usedBytes();
+}
+
+}  // namespace fs
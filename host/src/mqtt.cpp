@@ -0,0 +1,82 @@
+// Host stand-in for PubSubClient, with a broker that is up or down
+
+#include <PubSubClient.h>
+#include <host.h>
+#include <mutex>
+#include <vector>
+
+static std::mutex mqttLock;
+static bool brokerUp = false;
+static uint32_t brokerSession = 1;  // Bumped when the broker goes down, dropping every client
+static std::vector<HostMqttMessage> messages;
+
+void hostSetMqttBroker(bool up) {
+  std::lock_guard<std::mutex> guard(mqttLock);
+  if (brokerUp && !up) brokerSession++;
+  brokerUp = up;
+}
+
+std::vector<HostMqttMessage> hostMqttMessages() {
+  std::lock_guard<std::mutex> guard(mqttLock);
+  return messages;
+}
+
+void hostClearMqttMessages() {
+  std::lock_guard<std::mutex> guard(mqttLock);
+  messages.clear();
+}
+
+PubSubClient &PubSubClient::setServer(const char *domain, uint16_t port) {
+  return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+  if (size == 0) return false;
+  _bufferSize = size;
+  return true;
+}
+
+bool PubSubClient::connect(const char *id) {
+  return connect(id, nullptr, nullptr, nullptr, 0, false, nullptr);
+}
+
+bool PubSubClient::connect(const char *id, const char *willTopic, uint8_t willQos, bool willRetain,
+                           const char *willMessage) {
+  return connect(id, nullptr, nullptr, willTopic, willQos, willRetain, willMessage);
+}
+
+bool PubSubClient::connect(const char *id, const char *user, const char *pass, const char *willTopic,
+                           uint8_t willQos, bool willRetain, const char *willMessage) {
+  std::lock_guard<std::mutex> guard(mqttLock);
+  if (!brokerUp) {
+    _state = MQTT_CONNECT_FAILED;
+    return false;
+  }
+  _session = brokerSession;
+  _state = MQTT_CONNECTED;
+  return true;
+}
+
+void PubSubClient::disconnect() {
+  std::lock_guard<std::mutex> guard(mqttLock);
+  _state = MQTT_DISCONNECTED;
+}
+
+bool PubSubClient::connected() {
+  std::lock_guard<std::mutex> guard(mqttLock);
+  if (_state == MQTT_CONNECTED && (!brokerUp || _session != brokerSession)) _state = MQTT_CONNECTION_LOST;
+  return _state == MQTT_CONNECTED;
+}
+
+bool PubSubClient::loop() {
+  return connected();
+}
+
+bool PubSubClient::publish(const char *topic, const char *payload, bool retained) {
+  if (!connected()) return false;
+  // The whole packet has to fit the buffer, as in the library
+  if (5 + 2 + strlen(topic) + strlen(payload) > _bufferSize) return false;
+  std::lock_guard<std::mutex> guard(mqttLock);
+  messages.push_back({ topic, payload, retained });
+  return true;
+}
@@ -0,0 +1,151 @@
+// Host stand-in for the ESP-IDF OTA API, two app partitions in memory
+
+#include <Arduino.h>
+#include <esp_ota_ops.h>
+#include <host.h>
+#include <mutex>
+#include <vector>
+
+#define OTA_IMAGE_MAGIC 0xE9  // First byte of every ESP32 app image
+
+static const esp_partition_t partitions[2] = {
+  { 0x010000, 0x140000, "app0" },
+  { 0x150000, 0x140000, "app1" },
+};
+
+static std::mutex otaLock;
+static std::vector<uint8_t> partitionData[2];
+static int running = 0;
+static int bootPartition = 0;
+static bool pendingVerify = false;
+
+static int writing = -1;  // Partition an open handle writes to
+static esp_ota_handle_t openHandle = 0;
+static esp_ota_handle_t nextHandle = 1;
+
+static int partitionIndex(const esp_partition_t *partition) {
+  for (int i = 0; i < 2; i++) {
+    if (partition == &partitions[i]) return i;
+  }
+  return -1;
+}
+
+const std::vector<uint8_t> &hostOtaPartition(uint8_t index) {
+  return partitionData[index & 1];
+}
+
+int hostOtaBootPartition() {
+  std::lock_guard<std::mutex> guard(otaLock);
+  return bootPartition;
+}
+
+void hostSetOtaPendingVerify(bool pending) {
+  std::lock_guard<std::mutex> guard(otaLock);
+  pendingVerify = pending;
+}
+
+extern "C" {
+
+const esp_partition_t *esp_ota_get_running_partition(void) {
+  std::lock_guard<std::mutex> guard(otaLock);
+  return &partitions[running];
+}
+
+const esp_partition_t *esp_ota_get_next_update_partition(const esp_partition_t *start) {
+  std::lock_guard<std::mutex> guard(otaLock);
+  int from = start ? partitionIndex(start) : running;
+  return from < 0 ? nullptr : &partitions[1 - from];
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t *partition, size_t imageSize, esp_ota_handle_t *handle) {
+  std::lock_guard<std::mutex> guard(otaLock);
+  int index = partitionIndex(partition);
+  if (index < 0 || !handle) return ESP_ERR_INVALID_ARG;
+  if (index == running) return ESP_FAIL;  // Can't write the running app
+  if (imageSize != OTA_SIZE_UNKNOWN && imageSize != OTA_WITH_SEQUENTIAL_WRITES && imageSize > partition->size) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  partitionData[index].clear();
+  writing = index;
+  openHandle = nextHandle++;
+  *handle = openHandle;
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size) {
+  std::lock_guard<std::mutex> guard(otaLock);
+  if (handle != openHandle || writing < 0) return ESP_ERR_INVALID_ARG;
+  std::vector<uint8_t> &image = partitionData[writing];
+  if (image.size() + size > partitions[writing].size) return ESP_ERR_INVALID_SIZE;
+  if (image.empty() && size && ((const uint8_t *)data)[0] != OTA_IMAGE_MAGIC) return ESP_ERR_OTA_VALIDATE_FAILED;
+  image.insert(image.end(), (const uint8_t *)data, (const uint8_t *)data + size);
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t handle) {
+  std::lock_guard<std::mutex> guard(otaLock);
+  if (handle != openHandle || writing < 0) return ESP_ERR_NOT_FOUND;
+  bool valid = !partitionData[writing].empty() && partitionData[writing][0] == OTA_IMAGE_MAGIC;
+  openHandle = 0;
+  writing = -1;
+  return valid ? ESP_OK : ESP_ERR_OTA_VALIDATE_FAILED;
+}
+
+esp_err_t esp_ota_abort(esp_ota_handle_t handle) {
+  std::lock_guard<std::mutex> guard(otaLock);
+  if (handle != openHandle || writing < 0) return ESP_ERR_NOT_FOUND;
+  openHandle = 0;
+  writing = -1;
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition) {
+  std::lock_guard<std::mutex> guard(otaLock);
+  int index = partitionIndex(partition);
+  if (index < 0) return ESP_ERR_INVALID_ARG;
+  if (index != running && (partitionData[index].empty() || partitionData[index][0] != OTA_IMAGE_MAGIC)) {
+    return ESP_ERR_OTA_VALIDATE_FAILED;
+  }
+  bootPartition = index;
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_get_state_partition(const esp_partition_t *partition, esp_ota_img_states_t *state) {
+  std::lock_guard<std::mutex> guard(otaLock);
+  int index = partitionIndex(partition);
+  if (index < 0 || !state) return ESP_ERR_INVALID_ARG;
+  if (index != running) return ESP_ERR_NOT_FOUND;
+  *state = pendingVerify ? ESP_OTA_IMG_PENDING_VERIFY : ESP_OTA_IMG_VALID;
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_valid_cancel_rollback(void) {
+  std::lock_guard<std::mutex> guard(otaLock);
+  pendingVerify = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_mark_app_invalid_rollback_and_reboot(void) {
+  {
+    std::lock_guard<std::mutex> guard(otaLock);
+    if (!pendingVerify) return ESP_FAIL;
+    pendingVerify = false;
+    bootPartition = 1 - running;
+  }
+  ESP.restart();
+  return ESP_OK;
+}
+
+const char *esp_err_to_name(esp_err_t code) {
+  switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_OTA_VALIDATE_FAILED: return "ESP_ERR_OTA_VALIDATE_FAILED";
+    default: return "UNKNOWN ERROR";
+  }
+}
+
+}  // extern "C"
@@ -0,0 +1,136 @@
+// Host stand-in for NVS Preferences, one store in memory for the process
+
+#include <Preferences.h>
+#include <host.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum NvsType : uint8_t { NVS_BLOB, NVS_STRING, NVS_U32, NVS_U8 };
+
+struct NvsEntry {
+  uint8_t type;
+  std::vector<uint8_t> value;
+};
+
+#define NVS_KEY_MAX 15  // Longer keys and namespaces are refused, as on the board
+
+static std::mutex nvsLock;
+static std::map<std::string, std::map<std::string, NvsEntry>> nvs;
+static bool failWrites = false;
+
+void hostClearPreferences() {
+  std::lock_guard<std::mutex> guard(nvsLock);
+  nvs.clear();
+}
+
+void hostFailPreferenceWrites(bool fail) {
+  std::lock_guard<std::mutex> guard(nvsLock);
+  failWrites = fail;
+}
+
+bool Preferences::begin(const char *name, bool readOnly, const char *partitionLabel) {
+  if (_started || !name || strlen(name) > NVS_KEY_MAX) return false;
+  std::lock_guard<std::mutex> guard(nvsLock);
+  // Opening a namespace that was never written fails read-only
+  if (readOnly && nvs.find(name) == nvs.end()) return false;
+  nvs[name];
+  _namespace = name;
+  _readOnly = readOnly;
+  _started = true;
+  return true;
+}
+
+void Preferences::end() {
+  _started = false;
+}
+
+bool Preferences::clear() {
+  if (!_started || _readOnly) return false;
+  std::lock_guard<std::mutex> guard(nvsLock);
+  nvs[_namespace.c_str()].clear();
+  return true;
+}
+
+bool Preferences::remove(const char *key) {
+  if (!_started || _readOnly || !key) return false;
+  std::lock_guard<std::mutex> guard(nvsLock);
+  return nvs[_namespace.c_str()].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char *key) {
+  if (!_started || !key) return false;
+  std::lock_guard<std::mutex> guard(nvsLock);
+  const std::map<std::string, NvsEntry> &entries = nvs[_namespace.c_str()];
+  return entries.find(key) != entries.end();
+}
+
+size_t Preferences::put(const char *key, uint8_t type, const void *value, size_t length) {
+  if (!_started || _readOnly || !key || strlen(key) > NVS_KEY_MAX) return 0;
+  std::lock_guard<std::mutex> guard(nvsLock);
+  if (failWrites) return 0;
+  NvsEntry &entry = nvs[_namespace.c_str()][key];
+  entry.type = type;
+  entry.value.assign((const uint8_t *)value, (const uint8_t *)value + length);
+  return length;
+}
+
+// Copies the value if it has the type and fits, returns its length, or 0
+size_t Preferences::get(const char *key, uint8_t type, void *buffer, size_t maxLength) {
+  if (!_started || !key) return 0;
+  std::lock_guard<std::mutex> guard(nvsLock);
+  const std::map<std::string, NvsEntry> &entries = nvs[_namespace.c_str()];
+  auto found = entries.find(key);
+  if (found == entries.end() || found->second.type != type) return 0;
+  const std::vector<uint8_t> &value = found->second.value;
+  if (buffer) {
+    if (value.size() > maxLength) return 0;
+    memcpy(buffer, value.data(), value.size());
+  }
+  return value.size();
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t length) {
+  return value && length ? put(key, NVS_BLOB, value, length) : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, size_t maxLength) {
+  return buffer ? get(key, NVS_BLOB, buffer, maxLength) : 0;
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+  return get(key, NVS_BLOB, nullptr, 0);
+}
+
+size_t Preferences::putString(const char *key, const char *value) {
+  if (!value) return 0;
+  size_t length = strlen(value);
+  return put(key, NVS_STRING, value, length + 1) ? length : 0;
+}
+
+String Preferences::getString(const char *key, const String &defaultValue) {
+  size_t length = get(key, NVS_STRING, nullptr, 0);
+  if (!length) return defaultValue;
+  std::vector<char> value(length);
+  if (!get(key, NVS_STRING, value.data(), length)) return defaultValue;
+  return String(value.data());
+}
+
+size_t Preferences::putUInt(const char *key, uint32_t value) {
+  return put(key, NVS_U32, &value, sizeof(value));
+}
+
+uint32_t Preferences::getUInt(const char *key, uint32_t defaultValue) {
+  uint32_t value;
+  return get(key, NVS_U32, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+size_t Preferences::putUChar(const char *key, uint8_t value) {
+  return put(key, NVS_U8, &value, sizeof(value));
+}
+
+uint8_t Preferences::getUChar(const char *key, uint8_t defaultValue) {
+  uint8_t value;
+  return get(key, NVS_U8, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
@@ -0,0 +1,113 @@
+// Host stand-ins for the sensor libraries
+
+#include <Adafruit_BME280.h>
+#include <DHT.h>
+#include <DallasTemperature.h>
+#include <host.h>
+#include <atomic>
+#include <mutex>
+
+static std::mutex sensorLock;
+
+// Until a test sets them, the DHT22 drifts slowly around room conditions
+// so the dashboard has something to show
+static bool dhtSet = false;
+static float dhtTemperature = NAN;
+static float dhtHumidity = NAN;
+
+static float ds18b20Temperature = 21.25f;
+static bool bme280Present = true;
+static float bme280Temperature = 21.5f;
+static float bme280Humidity = 45.0f;
+static float bme280Pressure = 101325.0f;
+
+static HostSensorReads reads;
+std::atomic<unsigned long> hostAnalogReads(0);
+
+void hostSetDht(float temperature, float humidity) {
+  std::lock_guard<std::mutex> guard(sensorLock);
+  dhtSet = true;
+  dhtTemperature = temperature;
+  dhtHumidity = humidity;
+}
+
+void hostSetDs18b20(float temperature) {
+  std::lock_guard<std::mutex> guard(sensorLock);
+  ds18b20Temperature = temperature;
+}
+
+void hostSetBme280(float temperature, float humidity, float pressurePa, bool present) {
+  std::lock_guard<std::mutex> guard(sensorLock);
+  bme280Temperature = temperature;
+  bme280Humidity = humidity;
+  bme280Pressure = pressurePa;
+  bme280Present = present;
+}
+
+HostSensorReads hostSensorReads() {
+  std::lock_guard<std::mutex> guard(sensorLock);
+  HostSensorReads result = reads;
+  result.analog = hostAnalogReads;
+  return result;
+}
+
+//////////////////////// DHT ////////////////////////
+
+bool DHT::read(bool force) {
+  return !isnan(readTemperature());
+}
+
+float DHT::readTemperature(bool fahrenheit, bool force) {
+  std::lock_guard<std::mutex> guard(sensorLock);
+  reads.dht++;
+  float celsius = dhtSet ? dhtTemperature : 22.0f + 1.5f * sinf(millis() / 600000.0f);
+  return fahrenheit ? celsius * 1.8f + 32 : celsius;
+}
+
+float DHT::readHumidity(bool force) {
+  std::lock_guard<std::mutex> guard(sensorLock);
+  return dhtSet ? dhtHumidity : 45.0f + 5.0f * cosf(millis() / 900000.0f);
+}
+
+//////////////////////// DS18B20 ////////////////////////
+
+void DallasTemperature::requestTemperatures() {
+  std::lock_guard<std::mutex> guard(sensorLock);
+  reads.ds18b20Requests++;
+  _conversionStart = millis();
+  _pending = ds18b20Temperature;
+  if (_wait) _converted = _pending;
+}
+
+float DallasTemperature::getTempCByIndex(uint8_t index) {
+  std::lock_guard<std::mutex> guard(sensorLock);
+  if (index != 0 || isnan(ds18b20Temperature)) return DEVICE_DISCONNECTED_C;
+  reads.ds18b20++;
+  if (millis() - _conversionStart >= 750) _converted = _pending;
+  return _converted;
+}
+
+//////////////////////// BME280 ////////////////////////
+
+bool Adafruit_BME280::begin(uint8_t address) {
+  std::lock_guard<std::mutex> guard(sensorLock);
+  _found = bme280Present;
+  return _found;
+}
+
+float Adafruit_BME280::readTemperature() {
+  std::lock_guard<std::mutex> guard(sensorLock);
+  if (!_found || !bme280Present) return NAN;
+  reads.bme280++;
+  return bme280Temperature;
+}
+
+float Adafruit_BME280::readPressure() {
+  std::lock_guard<std::mutex> guard(sensorLock);
+  return _found && bme280Present ? bme280Pressure : NAN;
+}
+
+float Adafruit_BME280::readHumidity() {
+  std::lock_guard<std::mutex> guard(sensorLock);
+  return _found && bme280Present ? bme280Humidity : NAN;
+}
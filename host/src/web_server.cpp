@@ -0,0 +1,1800 @@
+// Host stand-in for ESPAsyncWebServer and AsyncTCP, see ESPAsyncWebServer.h
+
+#include <ESPAsyncWebServer.h>
+#include <host.h>
+#include <arpa/inet.h>
+#include <atomic>
+#include <deque>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#define HOST_TCP_SND_BUF 5744     // lwIP's send buffer on the board, what space() reports while idle
+#define HOST_MAX_HEAD 4096        // Request line and headers
+#define HOST_UPLOAD_PIECE 1460    // Uploads are handed over a TCP segment at a time
+#define HOST_MAX_FORM_BODY 16384  // Urlencoded bodies parsed into parameters
+#define HOST_MAX_WS_FRAME 16384   // Larger frames close the connection
+#define HOST_POLL_MS 5
+
+// Payload of the library's keepalive pings, their pongs raise no event
+#define WS_PING_PAYLOAD "ESPAsyncWebServer-PING"
+#define WS_PING_PAYLOAD_LEN 22
+
+static std::atomic<int> httpPortOverride(-1);
+static std::atomic<bool> apClients(false);
+static std::atomic<uint16_t> memoryPorts(40000);
+
+std::recursive_mutex &hostTcpLock() {
+  static std::recursive_mutex lock;
+  return lock;
+}
+
+void hostSetHttpPort(uint16_t port) {
+  httpPortOverride = port;
+}
+
+void hostSetApClients(bool enabled) {
+  apClients = enabled;
+}
+
+//////////////////////// Helpers ////////////////////////
+
+static bool equalsIgnoreCase(const std::string &a, const char *b) {
+  return strcasecmp(a.c_str(), b) == 0;
+}
+
+static std::string trim(const std::string &text) {
+  size_t start = text.find_first_not_of(" \t");
+  if (start == std::string::npos) return "";
+  size_t end = text.find_last_not_of(" \t\r");
+  return text.substr(start, end - start + 1);
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Percent-decoding as the library does it, '+' is a space
+static std::string urlDecode(const std::string &text) {
+  std::string decoded;
+  for (size_t i = 0; i < text.size(); i++) {
+    if (text[i] == '+') {
+      decoded += ' ';
+    } else if (text[i] == '%' && i + 2 < text.size() && hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+      decoded += (char)(hexValue(text[i + 1]) << 4 | hexValue(text[i + 2]));
+      i += 2;
+    } else {
+      decoded += text[i];
+    }
+  }
+  return decoded;
+}
+
+static void sha1(const uint8_t *data, size_t length, uint8_t digest[20]) {
+  uint32_t h[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+  std::string message((const char *)data, length);
+  message += (char)0x80;
+  while (message.size() % 64 != 56) message += (char)0;
+  uint64_t bits = (uint64_t)length * 8;
+  for (int i = 7; i >= 0; i--) message += (char)(bits >> (i * 8));
+
+  for (size_t block = 0; block < message.size(); block += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++) {
+      const uint8_t *p = (const uint8_t *)message.data() + block + i * 4;
+      w[i] = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+    }
+    for (int i = 16; i < 80; i++) {
+      uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+      w[i] = x << 1 | x >> 31;
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+      uint32_t f, k;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999;
+      } else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDC;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6;
+      }
+      uint32_t t = (a << 5 | a >> 27) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = b << 30 | b >> 2;
+      b = a;
+      a = t;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+  for (int i = 0; i < 20; i++) digest[i] = h[i / 4] >> (24 - (i % 4) * 8);
+}
+
+static std::string base64(const uint8_t *data, size_t length) {
+  static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string encoded;
+  for (size_t i = 0; i < length; i += 3) {
+    uint32_t group = (uint32_t)data[i] << 16;
+    if (i + 1 < length) group |= (uint32_t)data[i + 1] << 8;
+    if (i + 2 < length) group |= data[i + 2];
+    encoded += ALPHABET[group >> 18 & 63];
+    encoded += ALPHABET[group >> 12 & 63];
+    encoded += i + 1 < length ? ALPHABET[group >> 6 & 63] : '=';
+    encoded += i + 2 < length ? ALPHABET[group & 63] : '=';
+  }
+  return encoded;
+}
+
+static const char *statusText(int code) {
+  switch (code) {
+    case 101: return "Switching Protocols";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 303: return "See Other";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 408: return "Request Time-out";
+    case 409: return "Conflict";
+    case 413: return "Request Entity Too Large";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+//////////////////////// Upgrade responses ////////////////////////
+
+class HostEventSourceResponse : public AsyncWebServerResponse {
+public:
+  explicit HostEventSourceResponse(AsyncEventSource *source) : source(source) {
+    _code = 200;
+    _contentType = "text/event-stream";
+    _sendContentLength = false;
+    addHeader("Cache-Control", "no-cache");
+    addHeader("Connection", "keep-alive");
+  }
+
+  bool _sourceValid() const override { return true; }
+  HostResponseKind _kind() const override { return HOST_RESPONSE_EVENTS; }
+
+  AsyncEventSource *source;
+};
+
+class HostWebSocketResponse : public AsyncWebServerResponse {
+public:
+  HostWebSocketResponse(const String &key, AsyncWebSocket *socket) : socket(socket) {
+    std::string accept = std::string(key.c_str()) + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    uint8_t digest[20];
+    sha1((const uint8_t *)accept.data(), accept.size(), digest);
+    _code = 101;
+    _sendContentLength = false;
+    addHeader("Upgrade", "websocket");
+    addHeader("Connection", "Upgrade");
+    addHeader("Sec-WebSocket-Accept", base64(digest, sizeof(digest)).c_str());
+  }
+
+  bool _sourceValid() const override { return true; }
+  HostResponseKind _kind() const override { return HOST_RESPONSE_WEBSOCKET; }
+
+  AsyncWebSocket *socket;
+};
+
+//////////////////////// Connections ////////////////////////
+
+enum HostConnectionState : uint8_t {
+  CONN_HEAD,       // Reading the request line and headers
+  CONN_BODY,       // Reading the body
+  CONN_RESPONSE,   // Handled, sending the response
+  CONN_EVENTS,     // An event stream
+  CONN_WEBSOCKET,  // WebSocket frames
+  CONN_CLOSED,
+};
+
+enum MultipartState : uint8_t { MP_PREAMBLE, MP_HEADERS, MP_DATA, MP_END };
+
+// One TCP connection, a socket or a HostRequest's memory. Everything in
+// here runs with hostTcpLock() held.
+class HostConnection {
+public:
+  HostConnection(AsyncWebServer *server, int fd, IPAddress remoteIP, uint16_t remotePort)
+    : client(this), remoteIP(remoteIP), remotePort(remotePort), _server(server), _fd(fd) {}
+
+  ~HostConnection() {
+    if (_fd >= 0) ::close(_fd);
+  }
+
+  AsyncClient client;
+  IPAddress remoteIP;
+  uint16_t remotePort;
+
+  int fd() const { return _fd; }
+  bool closed() const { return _state == CONN_CLOSED; }
+  bool wantsRead() const { return !_peerFinished && _state != CONN_CLOSED; }
+  bool wantsWrite() const { return !_out.empty(); }
+  bool connected() const { return _state != CONN_CLOSED; }
+  size_t space() const { return _out.size() < HOST_TCP_SND_BUF ? HOST_TCP_SND_BUF - _out.size() : 0; }
+  size_t messagesWaiting() const { return _messagesWaiting; }
+
+  // Bytes from the client
+  void receive(const char *data, size_t length) {
+    if (_state == CONN_CLOSED) return;
+    _in.append(data, length);
+    if (_wsClient) _wsClient->_onActivity();
+    process();
+  }
+
+  // The client sent its FIN. A response already on its way is still sent,
+  // anything else goes as if the client had reset the connection.
+  void peerFinished() {
+    _peerFinished = true;
+    if (_state != CONN_RESPONSE || !_request || !_request->_response) abort();
+  }
+
+  // Moves the response along, called after every poll
+  void update() {
+    if (_state == CONN_RESPONSE && _upgradePending) finishUpgrade();
+    if (_state == CONN_RESPONSE) pump();
+    if (_state == CONN_WEBSOCKET && _wsClient) _wsClient->_onPoll(millis());
+    if (_fd >= 0) flush();
+    closeIfDrained();
+  }
+
+  // Everything queued for sending, as if the client had read and acknowledged it
+  std::string take() {
+    std::string data;
+    data.swap(_out);
+    sent(data.size());
+    return data;
+  }
+
+  void closeIfDrained() {
+    if (_closing && _out.empty() && _state != CONN_CLOSED) finish();
+  }
+
+  void close(bool now) {
+    if (now) {
+      abort();
+    } else {
+      _closing = true;
+    }
+  }
+
+  void abort() {
+    _out.clear();
+    _pending.clear();
+    _messagesWaiting = 0;
+    finish();
+  }
+
+  // Queue bytes for sending. A message counts against limit, 0 for bytes
+  // that always go out, as the library queues control frames apart.
+  bool queue(const std::string &data, size_t limit = 0) {
+    if (_state == CONN_CLOSED || _closing) return false;
+    if (limit && _messagesWaiting >= limit) return false;
+    _out += data;
+    _pending.push_back({ data.size(), limit != 0 });
+    if (limit) _messagesWaiting++;
+    return true;
+  }
+
+  void respond(AsyncWebServerRequest *request, AsyncWebServerResponse *response);
+
+private:
+  void process();
+  bool parseHead(const std::string &head);
+  void receiveBody(const char *data, size_t length);
+  void receiveMultipart(const char *data, size_t length);
+  void parsePartHeaders(const std::string &headers);
+  void receivePartData(const char *data, size_t length);
+  void endPart();
+  void endBody();
+  void dispatch();
+  void pump();
+  void finishUpgrade();
+  void receiveFrames();
+  void flush();
+  void finish();
+  void sent(size_t length);
+
+  AsyncWebServer *_server;
+  int _fd;
+  HostConnectionState _state = CONN_HEAD;
+  bool _closing = false;
+  bool _peerFinished = false;
+  bool _upgradePending = false;
+  std::string _in;
+  std::string _out;
+
+  struct Pending {
+    size_t remaining;
+    bool message;
+  };
+  std::deque<Pending> _pending;
+  size_t _messagesWaiting = 0;
+
+  AsyncWebServerRequest *_request = nullptr;
+  size_t _bodyReceived = 0;
+  bool _formBody = false;
+  std::string _formText;
+
+  std::string _boundary;
+  MultipartState _multipartState = MP_PREAMBLE;
+  std::string _multipartBuffer;
+  std::string _itemName;
+  std::string _itemFilename;
+  bool _itemIsFile = false;
+  std::string _itemValue;
+  std::string _itemPiece;
+  size_t _itemSize = 0;
+
+  AsyncEventSource *_eventSource = nullptr;
+  AsyncEventSourceClient *_eventClient = nullptr;
+  AsyncWebSocketClient *_wsClient = nullptr;
+};
+
+void HostConnection::process() {
+  for (;;) {
+    if (_state == CONN_HEAD) {
+      size_t end = _in.find("\r\n\r\n");
+      if (end == std::string::npos) {
+        if (_in.size() > HOST_MAX_HEAD) {
+          queue("HTTP/1.1 431 Request Header Fields Too Large\r\nConnection: close\r\n\r\n");
+          _closing = true;
+          _state = CONN_RESPONSE;
+        }
+        return;
+      }
+      std::string head = _in.substr(0, end);
+      _in.erase(0, end + 4);
+      if (!parseHead(head)) {
+        queue("HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+        _closing = true;
+        _state = CONN_RESPONSE;
+        return;
+      }
+      if (_request->_contentLength) {
+        _state = CONN_BODY;
+      } else {
+        dispatch();
+      }
+    } else if (_state == CONN_BODY) {
+      size_t length = std::min(_in.size(), _request->_contentLength - _bodyReceived);
+      if (length) {
+        std::string piece = _in.substr(0, length);
+        _in.erase(0, length);
+        receiveBody(piece.data(), piece.size());
+      }
+      if (_bodyReceived < _request->_contentLength) return;
+      endBody();
+      dispatch();
+    } else if (_state == CONN_WEBSOCKET) {
+      receiveFrames();
+      return;
+    } else {
+      // Nothing more is read from an HTTP connection, the library
+      // doesn't pipeline, and event streams only send
+      _in.clear();
+      return;
+    }
+  }
+}
+
+bool HostConnection::parseHead(const std::string &head) {
+  size_t lineEnd = head.find("\r\n");
+  std::string line = head.substr(0, lineEnd);
+  size_t first = line.find(' ');
+  size_t last = line.rfind(' ');
+  if (first == std::string::npos || last == first) return false;
+  std::string method = line.substr(0, first);
+  std::string target = line.substr(first + 1, last - first - 1);
+  std::string version = line.substr(last + 1);
+  if (version.compare(0, 7, "HTTP/1.") != 0 || target.empty()) return false;
+
+  static const struct {
+    const char *name;
+    WebRequestMethod method;
+  } METHODS[] = {
+    { "GET", HTTP_GET },   { "POST", HTTP_POST }, { "DELETE", HTTP_DELETE },   { "PUT", HTTP_PUT },
+    { "PATCH", HTTP_PATCH }, { "HEAD", HTTP_HEAD }, { "OPTIONS", HTTP_OPTIONS },
+  };
+  int methodIndex = -1;
+  for (size_t i = 0; i < sizeof(METHODS) / sizeof(METHODS[0]); i++) {
+    if (method == METHODS[i].name) methodIndex = i;
+  }
+  if (methodIndex < 0) return false;
+
+  _request = new AsyncWebServerRequest(_server, &client);
+  _request->_method = METHODS[methodIndex].method;
+  _request->_version = version == "HTTP/1.0" ? 0 : 1;
+
+  size_t query = target.find('?');
+  _request->_url = urlDecode(target.substr(0, query)).c_str();
+  if (query != std::string::npos) {
+    std::string params = target.substr(query + 1);
+    size_t start = 0;
+    while (start <= params.size()) {
+      size_t end = params.find('&', start);
+      if (end == std::string::npos) end = params.size();
+      std::string pair = params.substr(start, end - start);
+      if (!pair.empty()) {
+        size_t equals = pair.find('=');
+        std::string name = urlDecode(pair.substr(0, equals));
+        std::string value = equals == std::string::npos ? "" : urlDecode(pair.substr(equals + 1));
+        _request->addParam(new AsyncWebParameter(name.c_str(), value.c_str()));
+      }
+      start = end + 1;
+    }
+  }
+
+  size_t start = lineEnd == std::string::npos ? head.size() : lineEnd + 2;
+  while (start < head.size()) {
+    size_t end = head.find("\r\n", start);
+    if (end == std::string::npos) end = head.size();
+    std::string header = head.substr(start, end - start);
+    start = end + 2;
+    size_t colon = header.find(':');
+    if (colon == std::string::npos) continue;
+    std::string name = trim(header.substr(0, colon));
+    std::string value = trim(header.substr(colon + 1));
+    _request->addHeader(new AsyncWebHeader(name.c_str(), value.c_str()));
+
+    if (equalsIgnoreCase(name, "Host")) {
+      _request->_host = value.c_str();
+    } else if (equalsIgnoreCase(name, "Content-Length")) {
+      _request->_contentLength = strtoul(value.c_str(), nullptr, 10);
+    } else if (equalsIgnoreCase(name, "Content-Type")) {
+      size_t semicolon = value.find(';');
+      _request->_contentType = trim(value.substr(0, semicolon)).c_str();
+      if (strncasecmp(value.c_str(), "multipart/form-data", 19) == 0) {
+        size_t boundary = value.find("boundary=");
+        if (boundary != std::string::npos) {
+          _boundary = value.substr(boundary + 9);
+          size_t endBoundary = _boundary.find(';');
+          _boundary = trim(_boundary.substr(0, endBoundary));
+          if (_boundary.size() >= 2 && _boundary.front() == '"') _boundary = _boundary.substr(1, _boundary.size() - 2);
+          _request->_isMultipart = !_boundary.empty();
+        }
+      } else if (strncasecmp(value.c_str(), "application/x-www-form-urlencoded", 33) == 0) {
+        _formBody = true;
+      }
+    } else if (equalsIgnoreCase(name, "Upgrade") && equalsIgnoreCase(value, "websocket")) {
+      _request->_isWebSocketUpgrade = true;
+    }
+  }
+
+  // The library picks the handler once the headers are in
+  _server->_attachHandler(_request);
+  return true;
+}
+
+void HostConnection::receiveBody(const char *data, size_t length) {
+  if (_request->_isMultipart) {
+    receiveMultipart(data, length);
+  } else {
+    if (_request->_handler) {
+      _request->_handler->handleBody(_request, (uint8_t *)data, length, _bodyReceived, _request->_contentLength);
+    }
+    if (_formBody && _formText.size() + length <= HOST_MAX_FORM_BODY) _formText.append(data, length);
+  }
+  _bodyReceived += length;
+}
+
+void HostConnection::endBody() {
+  if (!_formBody) return;
+  size_t start = 0;
+  while (start <= _formText.size()) {
+    size_t end = _formText.find('&', start);
+    if (end == std::string::npos) end = _formText.size();
+    std::string pair = _formText.substr(start, end - start);
+    if (!pair.empty()) {
+      size_t equals = pair.find('=');
+      std::string name = urlDecode(pair.substr(0, equals));
+      std::string value = equals == std::string::npos ? "" : urlDecode(pair.substr(equals + 1));
+      _request->addParam(new AsyncWebParameter(name.c_str(), value.c_str(), true));
+    }
+    start = end + 1;
+  }
+}
+
+void HostConnection::receiveMultipart(const char *data, size_t length) {
+  _multipartBuffer.append(data, length);
+  for (;;) {
+    if (_multipartState == MP_PREAMBLE) {
+      std::string first = "--" + _boundary;
+      size_t at = _multipartBuffer.find(first);
+      if (at == std::string::npos) {
+        if (_multipartBuffer.size() > first.size()) _multipartBuffer.erase(0, _multipartBuffer.size() - first.size());
+        return;
+      }
+      size_t after = at + first.size();
+      if (_multipartBuffer.size() < after + 2) return;
+      if (_multipartBuffer.compare(after, 2, "--") == 0) {
+        _multipartState = MP_END;
+        continue;
+      }
+      _multipartBuffer.erase(0, after + 2);
+      _multipartState = MP_HEADERS;
+    } else if (_multipartState == MP_HEADERS) {
+      size_t end = _multipartBuffer.find("\r\n\r\n");
+      if (end == std::string::npos) {
+        if (_multipartBuffer.size() > HOST_MAX_HEAD) _multipartState = MP_END;
+        return;
+      }
+      parsePartHeaders(_multipartBuffer.substr(0, end));
+      _multipartBuffer.erase(0, end + 4);
+      _multipartState = MP_DATA;
+    } else if (_multipartState == MP_DATA) {
+      std::string delimiter = "\r\n--" + _boundary;
+      size_t at = _multipartBuffer.find(delimiter);
+      if (at == std::string::npos) {
+        // The end of the buffer may be the start of the delimiter
+        size_t keep = delimiter.size() - 1;
+        if (_multipartBuffer.size() > keep) {
+          size_t length = _multipartBuffer.size() - keep;
+          receivePartData(_multipartBuffer.data(), length);
+          _multipartBuffer.erase(0, length);
+        }
+        return;
+      }
+      receivePartData(_multipartBuffer.data(), at);
+      _multipartBuffer.erase(0, at);
+      if (_multipartBuffer.size() < delimiter.size() + 2) return;
+      endPart();
+      bool last = _multipartBuffer.compare(delimiter.size(), 2, "--") == 0;
+      _multipartBuffer.erase(0, delimiter.size() + 2);
+      _multipartState = last ? MP_END : MP_HEADERS;
+    } else {
+      _multipartBuffer.clear();
+      return;
+    }
+  }
+}
+
+void HostConnection::parsePartHeaders(const std::string &headers) {
+  _itemName.clear();
+  _itemFilename.clear();
+  _itemIsFile = false;
+  _itemValue.clear();
+  _itemPiece.clear();
+  _itemSize = 0;
+
+  size_t start = 0;
+  while (start < headers.size()) {
+    size_t end = headers.find("\r\n", start);
+    if (end == std::string::npos) end = headers.size();
+    std::string header = headers.substr(start, end - start);
+    start = end + 2;
+    if (strncasecmp(header.c_str(), "Content-Disposition:", 20) != 0) continue;
+
+    auto quoted = [&header](const char *key, std::string &value) {
+      size_t at = header.find(key);
+      if (at == std::string::npos) return false;
+      at += strlen(key);
+      size_t end = header.find('"', at);
+      value = header.substr(at, end == std::string::npos ? std::string::npos : end - at);
+      return true;
+    };
+    quoted(" name=\"", _itemName);
+    if (_itemName.empty()) quoted(";name=\"", _itemName);
+    _itemIsFile = quoted("filename=\"", _itemFilename);
+  }
+}
+
+void HostConnection::receivePartData(const char *data, size_t length) {
+  if (!_itemIsFile) {
+    _itemValue.append(data, length);
+    return;
+  }
+  _itemPiece.append(data, length);
+  _itemSize += length;
+  while (_itemPiece.size() >= HOST_UPLOAD_PIECE) {
+    size_t index = _itemSize - _itemPiece.size();
+    if (_request->_handler) {
+      _request->_handler->handleUpload(_request, _itemFilename.c_str(), index, (uint8_t *)&_itemPiece[0],
+                                       HOST_UPLOAD_PIECE, false);
+    }
+    _itemPiece.erase(0, HOST_UPLOAD_PIECE);
+  }
+}
+
+void HostConnection::endPart() {
+  if (_itemIsFile) {
+    // The last piece, possibly empty, carries final
+    size_t index = _itemSize - _itemPiece.size();
+    if (_request->_handler) {
+      _request->_handler->handleUpload(_request, _itemFilename.c_str(), index, (uint8_t *)&_itemPiece[0],
+                                       _itemPiece.size(), true);
+    }
+    _request->addParam(new AsyncWebParameter(_itemName.c_str(), _itemFilename.c_str(), true, true, _itemSize));
+  } else {
+    _request->addParam(new AsyncWebParameter(_itemName.c_str(), _itemValue.c_str(), true));
+  }
+  _itemPiece.clear();
+  _itemValue.clear();
+}
+
+void HostConnection::dispatch() {
+  _state = CONN_RESPONSE;
+  if (_request->_handler) {
+    _request->_handler->handleRequest(_request);
+  } else {
+    _request->send(501);
+  }
+  // The handler may have closed the connection, or taken the request for
+  // an event stream or a WebSocket
+  if (_state == CONN_RESPONSE && _upgradePending) finishUpgrade();
+}
+
+void HostConnection::respond(AsyncWebServerRequest *request, AsyncWebServerResponse *response) {
+  if (request != _request || _state != CONN_RESPONSE || request->_response) {
+    delete response;
+    return;
+  }
+  if (!response->_sourceValid()) {
+    delete response;
+    response = new AsyncBasicResponse(500);
+  }
+  request->_response = response;
+  queue(response->_assembleHead(request->_version).c_str());
+  if (response->_kind() == HOST_RESPONSE_HTTP) {
+    pump();
+  } else {
+    _upgradePending = true;
+  }
+}
+
+void HostConnection::pump() {
+  if (!_request || !_request->_response || _upgradePending || _closing) return;
+  uint8_t buffer[HOST_TCP_SND_BUF];
+  while (space() >= 64) {
+    size_t length = _request->_response->_nextBody(buffer, space());
+    if (length == RESPONSE_TRY_AGAIN) return;
+    if (length == 0) {
+      _closing = true;
+      return;
+    }
+    queue(std::string((const char *)buffer, length));
+  }
+}
+
+// The library hands the connection to an event or WebSocket client once
+// the head is out, and deletes the request without its disconnect callback
+void HostConnection::finishUpgrade() {
+  _upgradePending = false;
+  AsyncWebServerRequest *request = _request;
+  AsyncWebServerResponse *response = request->_response;
+  _request = nullptr;
+  if (response->_kind() == HOST_RESPONSE_EVENTS) {
+    _state = CONN_EVENTS;
+    _eventSource = static_cast<HostEventSourceResponse *>(response)->source;
+    _eventClient = new AsyncEventSourceClient(request, _eventSource);
+    _eventSource->_addClient(_eventClient);
+  } else {
+    _state = CONN_WEBSOCKET;
+    _wsClient = new AsyncWebSocketClient(request, static_cast<HostWebSocketResponse *>(response)->socket);
+  }
+  delete request;
+  if (_state == CONN_WEBSOCKET && !_in.empty()) receiveFrames();
+}
+
+void HostConnection::receiveFrames() {
+  while (_wsClient && _state == CONN_WEBSOCKET && _in.size() >= 2) {
+    const uint8_t *p = (const uint8_t *)_in.data();
+    bool final = p[0] & 0x80;
+    uint8_t opcode = p[0] & 0x0F;
+    bool masked = p[1] & 0x80;
+    uint64_t length = p[1] & 0x7F;
+    size_t header = 2;
+    if (length == 126) {
+      if (_in.size() < 4) return;
+      length = (uint64_t)p[2] << 8 | p[3];
+      header = 4;
+    } else if (length == 127) {
+      if (_in.size() < 10) return;
+      length = 0;
+      for (int i = 0; i < 8; i++) length = length << 8 | p[2 + i];
+      header = 10;
+    }
+    if (length > HOST_MAX_WS_FRAME) {
+      _in.clear();
+      _wsClient->close(1009);
+      return;
+    }
+    size_t maskAt = header;
+    if (masked) header += 4;
+    if (_in.size() < header + length) return;
+
+    uint8_t mask[4] = { 0 };
+    if (masked) memcpy(mask, p + maskAt, 4);
+    std::vector<uint8_t> payload(length + 1, 0);  // Text arrives terminated, as the library does it
+    memcpy(payload.data(), p + header, length);
+    _in.erase(0, header + length);
+    _wsClient->_onFrame(opcode, final, masked ? mask : nullptr, payload.data(), length);
+  }
+}
+
+void HostConnection::flush() {
+  while (!_out.empty()) {
+    ssize_t written = send(_fd, _out.data(), _out.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (written > 0) {
+      _out.erase(0, written);
+      sent(written);
+    } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+      return;
+    } else {
+      abort();
+      return;
+    }
+  }
+}
+
+void HostConnection::sent(size_t length) {
+  while (length && !_pending.empty()) {
+    Pending &pending = _pending.front();
+    size_t done = std::min(length, pending.remaining);
+    pending.remaining -= done;
+    length -= done;
+    if (!pending.remaining) {
+      if (pending.message) _messagesWaiting--;
+      _pending.pop_front();
+    }
+  }
+}
+
+void HostConnection::finish() {
+  if (_state == CONN_CLOSED) return;
+  _state = CONN_CLOSED;
+  _closing = false;
+  if (_fd >= 0) {
+    ::close(_fd);
+    _fd = -1;
+  }
+
+  if (_request) {
+    AsyncWebServerRequest *request = _request;
+    _request = nullptr;
+    if (request->_onDisconnectfn) request->_onDisconnectfn();
+    delete request;
+  }
+  if (_eventClient) {
+    AsyncEventSourceClient *eventClient = _eventClient;
+    _eventClient = nullptr;
+    _eventSource->_handleDisconnect(eventClient);
+  }
+  if (_wsClient) {
+    AsyncWebSocketClient *wsClient = _wsClient;
+    _wsClient = nullptr;
+    wsClient->_onDisconnect();
+  }
+}
+
+//////////////////////// AsyncClient ////////////////////////
+
+IPAddress AsyncClient::remoteIP() const {
+  return _connection->remoteIP;
+}
+
+uint16_t AsyncClient::remotePort() const {
+  return _connection->remotePort;
+}
+
+IPAddress AsyncClient::localIP() const {
+  IPAddress remote = _connection->remoteIP;
+  return remote[0] == 192 && remote[1] == 168 && remote[2] == 4 ? IPAddress(192, 168, 4, 1) : IPAddress(127, 0, 0, 1);
+}
+
+uint16_t AsyncClient::localPort() const {
+  return 80;
+}
+
+size_t AsyncClient::space() const {
+  return _connection->space();
+}
+
+bool AsyncClient::canSend() const {
+  return _connection->space() > 0;
+}
+
+bool AsyncClient::connected() const {
+  return _connection->connected();
+}
+
+void AsyncClient::close(bool now) {
+  _connection->close(now);
+}
+
+//////////////////////// Responses ////////////////////////
+
+AsyncWebServerResponse::AsyncWebServerResponse()
+  : _code(0), _contentLength(0), _sendContentLength(true), _chunked(false) {
+  for (const AsyncWebHeader &header : DefaultHeaders::Instance().headers()) _headers.push_back(header);
+}
+
+String AsyncWebServerResponse::_assembleHead(uint8_t version) {
+  if (!version) _chunked = false;  // HTTP/1.0 clients read until the connection closes
+
+  String head = "HTTP/1.";
+  head += version ? "1 " : "0 ";
+  head += _code;
+  head += " ";
+  head += statusText(_code);
+  head += "\r\n";
+  if (_kind() == HOST_RESPONSE_HTTP) {
+    head += "Connection: close\r\n";
+    if (version) head += "Accept-Ranges: none\r\n";
+  }
+  if (_sendContentLength) {
+    head += "Content-Length: ";
+    head += (unsigned long)_contentLength;
+    head += "\r\n";
+  }
+  if (_contentType.length()) head += "Content-Type: " + _contentType + "\r\n";
+  for (const AsyncWebHeader &header : _headers) head += header.toString();
+  if (_chunked) head += "Transfer-Encoding: chunked\r\n";
+  head += "\r\n";
+  return head;
+}
+
+AsyncBasicResponse::AsyncBasicResponse(int code, const String &contentType, const String &content)
+  : _content(content) {
+  _code = code;
+  _contentType = contentType;
+  _contentLength = content.length();
+  if (_contentLength && !_contentType.length()) _contentType = "text/plain";
+}
+
+size_t AsyncBasicResponse::_nextBody(uint8_t *buffer, size_t maxLen) {
+  size_t length = std::min(maxLen, (size_t)_content.length() - _sent);
+  memcpy(buffer, _content.c_str() + _sent, length);
+  _sent += length;
+  return length;
+}
+
+size_t AsyncAbstractResponse::_nextBody(uint8_t *buffer, size_t maxLen) {
+  if (_finished) return 0;
+
+  if (_chunked) {
+    // Room for a "%x\r\n" size line before the data and "\r\n" after it
+    if (maxLen < 16) return RESPONSE_TRY_AGAIN;
+    size_t length = _fillBuffer(buffer + 8, maxLen - 10);
+    if (length == RESPONSE_TRY_AGAIN) return length;
+    if (length == 0) {
+      _finished = true;
+      memcpy(buffer, "0\r\n\r\n", 5);
+      return 5;
+    }
+    char size[9];
+    int sizeLength = snprintf(size, sizeof(size), "%x\r\n", (unsigned)length);
+    memmove(buffer + sizeLength, buffer + 8, length);
+    memcpy(buffer, size, sizeLength);
+    memcpy(buffer + sizeLength + length, "\r\n", 2);
+    return sizeLength + length + 2;
+  }
+
+  size_t room = maxLen;
+  if (_sendContentLength) {
+    if (_sent >= _contentLength) {
+      _finished = true;
+      return 0;
+    }
+    room = std::min(room, _contentLength - _sent);
+  }
+  size_t length = _fillBuffer(buffer, room);
+  if (length == RESPONSE_TRY_AGAIN) return length;
+  if (length == 0) {
+    _finished = true;
+    return 0;
+  }
+  _sent += length;
+  return length;
+}
+
+AsyncProgmemResponse::AsyncProgmemResponse(int code, const String &contentType, const uint8_t *content,
+                                           size_t length, AwsTemplateProcessor callback)
+  : _content(content) {
+  _code = code;
+  _contentType = contentType;
+  _contentLength = length;
+}
+
+size_t AsyncProgmemResponse::_fillBuffer(uint8_t *buffer, size_t maxLen) {
+  size_t length = std::min(maxLen, _contentLength - _readLength);
+  memcpy(buffer, _content + _readLength, length);
+  _readLength += length;
+  return length;
+}
+
+AsyncCallbackResponse::AsyncCallbackResponse(const String &contentType, size_t length, AwsResponseFiller callback,
+                                             bool chunked)
+  : _content(callback) {
+  _code = 200;
+  _contentType = contentType;
+  _contentLength = length;
+  if (!length || chunked) _sendContentLength = false;
+  _chunked = chunked;
+}
+
+size_t AsyncCallbackResponse::_fillBuffer(uint8_t *buffer, size_t maxLen) {
+  size_t length = _content(buffer, maxLen, _filledLength);
+  if (length != RESPONSE_TRY_AGAIN) _filledLength += length;
+  return length;
+}
+
+AsyncResponseStream::AsyncResponseStream(const String &contentType, size_t bufferSize) {
+  _code = 200;
+  _contentType = contentType;
+  _content.reserve(bufferSize);
+}
+
+size_t AsyncResponseStream::_fillBuffer(uint8_t *buffer, size_t maxLen) {
+  size_t length = std::min(maxLen, _content.size() - _readLength);
+  memcpy(buffer, _content.data() + _readLength, length);
+  _readLength += length;
+  return length;
+}
+
+size_t AsyncResponseStream::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t AsyncResponseStream::write(const uint8_t *data, size_t length) {
+  _content.append((const char *)data, length);
+  _contentLength = _content.size();
+  return length;
+}
+
+//////////////////////// Requests ////////////////////////
+
+AsyncWebServerRequest::AsyncWebServerRequest(AsyncWebServer *server, AsyncClient *client)
+  : _server(server), _client(client) {}
+
+AsyncWebServerRequest::~AsyncWebServerRequest() {
+  for (AsyncWebHeader *header : _headers) delete header;
+  for (AsyncWebParameter *param : _params) delete param;
+  delete _response;
+  if (_tempObject) free(_tempObject);
+}
+
+const char *AsyncWebServerRequest::methodToString() const {
+  switch (_method) {
+    case HTTP_GET: return "GET";
+    case HTTP_POST: return "POST";
+    case HTTP_DELETE: return "DELETE";
+    case HTTP_PUT: return "PUT";
+    case HTTP_PATCH: return "PATCH";
+    case HTTP_HEAD: return "HEAD";
+    case HTTP_OPTIONS: return "OPTIONS";
+    default: return "UNKNOWN";
+  }
+}
+
+AsyncWebHeader *AsyncWebServerRequest::getHeader(const String &name) const {
+  for (AsyncWebHeader *header : _headers) {
+    if (header->name().equalsIgnoreCase(name)) return header;
+  }
+  return nullptr;
+}
+
+AsyncWebParameter *AsyncWebServerRequest::getParam(const String &name, bool post, bool file) const {
+  for (AsyncWebParameter *param : _params) {
+    if (param->name() == name && param->isPost() == post && param->isFile() == file) return param;
+  }
+  return nullptr;
+}
+
+bool AsyncWebServerRequest::hasArg(const char *name) const {
+  for (AsyncWebParameter *param : _params) {
+    if (param->name() == name) return true;
+  }
+  return false;
+}
+
+const String &AsyncWebServerRequest::arg(const String &name) const {
+  static const String empty;
+  for (AsyncWebParameter *param : _params) {
+    if (param->name() == name) return param->value();
+  }
+  return empty;
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse *response) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  _client->_connection->respond(this, response);
+}
+
+void AsyncWebServerRequest::send(int code, const String &contentType, const String &content) {
+  send(beginResponse(code, contentType, content));
+}
+
+void AsyncWebServerRequest::send(const String &contentType, size_t length, AwsResponseFiller callback,
+                                 AwsTemplateProcessor templateCallback) {
+  send(beginResponse(contentType, length, callback, templateCallback));
+}
+
+void AsyncWebServerRequest::sendChunked(const String &contentType, AwsResponseFiller callback,
+                                        AwsTemplateProcessor templateCallback) {
+  send(beginChunkedResponse(contentType, callback, templateCallback));
+}
+
+void AsyncWebServerRequest::send_P(int code, const String &contentType, const uint8_t *content, size_t length,
+                                   AwsTemplateProcessor callback) {
+  send(beginResponse_P(code, contentType, content, length, callback));
+}
+
+void AsyncWebServerRequest::send_P(int code, const String &contentType, PGM_P content,
+                                   AwsTemplateProcessor callback) {
+  send(beginResponse_P(code, contentType, content, callback));
+}
+
+void AsyncWebServerRequest::redirect(const String &url) {
+  AsyncWebServerResponse *response = beginResponse(302);
+  response->addHeader("Location", url);
+  send(response);
+}
+
+AsyncWebServerResponse *AsyncWebServerRequest::beginResponse(int code, const String &contentType,
+                                                             const String &content) {
+  return new AsyncBasicResponse(code, contentType, content);
+}
+
+AsyncWebServerResponse *AsyncWebServerRequest::beginResponse(const String &contentType, size_t length,
+                                                             AwsResponseFiller callback,
+                                                             AwsTemplateProcessor templateCallback) {
+  return new AsyncCallbackResponse(contentType, length, callback);
+}
+
+AsyncWebServerResponse *AsyncWebServerRequest::beginChunkedResponse(const String &contentType,
+                                                                    AwsResponseFiller callback,
+                                                                    AwsTemplateProcessor templateCallback) {
+  return new AsyncCallbackResponse(contentType, 0, callback, _version > 0);
+}
+
+AsyncResponseStream *AsyncWebServerRequest::beginResponseStream(const String &contentType, size_t bufferSize) {
+  return new AsyncResponseStream(contentType, bufferSize);
+}
+
+AsyncWebServerResponse *AsyncWebServerRequest::beginResponse_P(int code, const String &contentType,
+                                                               const uint8_t *content, size_t length,
+                                                               AwsTemplateProcessor callback) {
+  return new AsyncProgmemResponse(code, contentType, content, length, callback);
+}
+
+AsyncWebServerResponse *AsyncWebServerRequest::beginResponse_P(int code, const String &contentType, PGM_P content,
+                                                               AwsTemplateProcessor callback) {
+  return beginResponse_P(code, contentType, (const uint8_t *)content, strlen(content), callback);
+}
+
+//////////////////////// Handlers ////////////////////////
+
+bool AsyncCallbackWebHandler::canHandle(AsyncWebServerRequest *request) {
+  if (!_onRequest || !(_method & request->method())) return false;
+  const String &url = request->url();
+  if (_uri.length() && _uri.startsWith("/*.")) {
+    return url.endsWith(_uri.substring(_uri.lastIndexOf('.')));
+  }
+  if (_uri.length() && _uri.endsWith("*")) {
+    return url.startsWith(_uri.substring(0, _uri.length() - 1));
+  }
+  return !_uri.length() || _uri == url || url.startsWith(_uri + "/");
+}
+
+void AsyncCallbackWebHandler::handleRequest(AsyncWebServerRequest *request) {
+  if (_onRequest) {
+    _onRequest(request);
+  } else {
+    request->send(500);
+  }
+}
+
+void AsyncCallbackWebHandler::handleUpload(AsyncWebServerRequest *request, const String &filename, size_t index,
+                                           uint8_t *data, size_t len, bool final) {
+  if (_onUpload) _onUpload(request, filename, index, data, len, final);
+}
+
+void AsyncCallbackWebHandler::handleBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index,
+                                         size_t total) {
+  if (_onBody) _onBody(request, data, len, index, total);
+}
+
+//////////////////////// Server-Sent Events ////////////////////////
+
+AsyncEventSourceClient::AsyncEventSourceClient(AsyncWebServerRequest *request, AsyncEventSource *server)
+  : _client(request->client()), _server(server) {}
+
+void AsyncEventSourceClient::close() {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  if (_client) _client->close();
+}
+
+bool AsyncEventSourceClient::connected() const {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  return _client && _client->connected();
+}
+
+size_t AsyncEventSourceClient::packetsWaiting() const {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  return _client ? _client->_connection->messagesWaiting() : 0;
+}
+
+void AsyncEventSourceClient::send(const char *message, const char *event, uint32_t id, uint32_t reconnect) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  if (!connected()) return;
+
+  std::string text;
+  if (reconnect) text += "retry: " + std::to_string(reconnect) + "\r\n";
+  if (id) {
+    text += "id: " + std::to_string(id) + "\r\n";
+    _lastId = id;
+  }
+  if (event) text += std::string("event: ") + event + "\r\n";
+  if (message) {
+    const char *line = message;
+    for (;;) {
+      const char *end = line + strcspn(line, "\r\n");
+      text += "data: " + std::string(line, end - line) + "\r\n";
+      if (!*end) break;
+      line = end + (end[0] == '\r' && end[1] == '\n' ? 2 : 1);
+    }
+  }
+  text += "\r\n";
+  // Over the limit the library drops the message
+  _client->_connection->queue(text, SSE_MAX_QUEUED_MESSAGES);
+}
+
+AsyncEventSource::~AsyncEventSource() {
+  close();
+}
+
+void AsyncEventSource::close() {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  for (AsyncEventSourceClient *client : _clients) client->close();
+}
+
+void AsyncEventSource::send(const char *message, const char *event, uint32_t id, uint32_t reconnect) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  for (AsyncEventSourceClient *client : _clients) {
+    if (client->connected()) client->send(message, event, id, reconnect);
+  }
+}
+
+size_t AsyncEventSource::count() const {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  size_t connected = 0;
+  for (AsyncEventSourceClient *client : _clients) {
+    if (client->connected()) connected++;
+  }
+  return connected;
+}
+
+size_t AsyncEventSource::avgPacketsWaiting() const {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  size_t waiting = 0;
+  size_t connected = 0;
+  for (AsyncEventSourceClient *client : _clients) {
+    if (!client->connected()) continue;
+    waiting += client->packetsWaiting();
+    connected++;
+  }
+  return connected ? (waiting + connected / 2) / connected : 0;
+}
+
+bool AsyncEventSource::canHandle(AsyncWebServerRequest *request) {
+  return request->method() == HTTP_GET && request->url() == _url;
+}
+
+void AsyncEventSource::handleRequest(AsyncWebServerRequest *request) {
+  request->send(new HostEventSourceResponse(this));
+}
+
+void AsyncEventSource::_addClient(AsyncEventSourceClient *client) {
+  _clients.push_back(client);
+  if (_connectcb) _connectcb(client);
+}
+
+void AsyncEventSource::_handleDisconnect(AsyncEventSourceClient *client) {
+  _clients.remove(client);
+  delete client;
+}
+
+//////////////////////// WebSockets ////////////////////////
+
+AsyncWebSocketClient::AsyncWebSocketClient(AsyncWebServerRequest *request, AsyncWebSocket *server)
+  : _client(request->client()), _server(server), _clientId(server->_getNextId()), _lastMessageTime(millis()) {
+  _server->_addClient(this);
+  _server->_handleEvent(this, WS_EVT_CONNECT, request, nullptr, 0);
+}
+
+void AsyncWebSocketClient::close(uint16_t code, const char *message) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  if (_status != WS_CONNECTED) return;
+  std::string payload;
+  if (code) {
+    payload += (char)(code >> 8);
+    payload += (char)code;
+    if (message) payload += message;
+  }
+  _status = WS_DISCONNECTING;
+  _queueFrame(WS_DISCONNECT, (const uint8_t *)payload.data(), payload.size());
+  // The library waits for the peer's close frame, this closes once ours is out
+  _client->close();
+}
+
+void AsyncWebSocketClient::ping(const uint8_t *data, size_t len) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  if (_status == WS_CONNECTED) _queueFrame(WS_PING, data, len);
+}
+
+bool AsyncWebSocketClient::canSend() const {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  return _status == WS_CONNECTED && _client->_connection->messagesWaiting() < WS_MAX_QUEUED_MESSAGES;
+}
+
+size_t AsyncWebSocketClient::queueLength() const {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  return _client ? _client->_connection->messagesWaiting() : 0;
+}
+
+void AsyncWebSocketClient::text(const char *message, size_t len) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  _queueFrame(WS_TEXT, (const uint8_t *)message, len);
+}
+
+void AsyncWebSocketClient::binary(const uint8_t *message, size_t len) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  _queueFrame(WS_BINARY, message, len);
+}
+
+void AsyncWebSocketClient::_queueFrame(uint8_t opcode, const uint8_t *data, size_t len) {
+  bool control = opcode >= WS_DISCONNECT;
+  if (!_client || _status == WS_DISCONNECTED || (!control && _status != WS_CONNECTED)) return;
+
+  std::string frame;
+  frame += (char)(0x80 | opcode);
+  if (len < 126) {
+    frame += (char)len;
+  } else if (len < 65536) {
+    frame += (char)126;
+    frame += (char)(len >> 8);
+    frame += (char)len;
+  } else {
+    frame += (char)127;
+    for (int i = 7; i >= 0; i--) frame += (char)((uint64_t)len >> (i * 8));
+  }
+  if (len) frame.append((const char *)data, len);
+  // Data frames beyond WS_MAX_QUEUED_MESSAGES are dropped, as the library does
+  _client->_connection->queue(frame, control ? 0 : WS_MAX_QUEUED_MESSAGES);
+  _lastMessageTime = millis();
+}
+
+void AsyncWebSocketClient::_onFrame(uint8_t opcode, bool final, const uint8_t *mask, uint8_t *data, size_t len) {
+  if (mask) {
+    for (size_t i = 0; i < len; i++) data[i] ^= mask[i % 4];
+  }
+
+  if (opcode == WS_PING) {
+    _queueFrame(WS_PONG, data, len);
+  } else if (opcode == WS_PONG) {
+    // Answers to the keepalive pings are not reported
+    if (len != WS_PING_PAYLOAD_LEN || memcmp(data, WS_PING_PAYLOAD, WS_PING_PAYLOAD_LEN) != 0) {
+      _server->_handleEvent(this, WS_EVT_PONG, nullptr, data, len);
+    }
+  } else if (opcode == WS_DISCONNECT) {
+    if (_status == WS_CONNECTED) {
+      _status = WS_DISCONNECTING;
+      _queueFrame(WS_DISCONNECT, data, len);
+    }
+    _client->close();
+  } else if (opcode == WS_TEXT || opcode == WS_BINARY || opcode == WS_CONTINUATION) {
+    if (opcode != WS_CONTINUATION) {
+      _messageOpcode = opcode;
+      _frameNumber = 0;
+    } else {
+      _frameNumber++;
+    }
+    AwsFrameInfo info;
+    info.message_opcode = _messageOpcode;
+    info.num = _frameNumber;
+    info.final = final;
+    info.masked = mask != nullptr;
+    info.opcode = opcode;
+    info.len = len;
+    if (mask) {
+      memcpy(info.mask, mask, 4);
+    } else {
+      memset(info.mask, 0, 4);
+    }
+    info.index = 0;
+    _server->_handleEvent(this, WS_EVT_DATA, &info, data, len);
+  }
+}
+
+void AsyncWebSocketClient::_onPoll(unsigned long now) {
+  if (_status == WS_CONNECTED && _keepAlivePeriod && _client->_connection->messagesWaiting() == 0 &&
+      now - _lastMessageTime >= _keepAlivePeriod) {
+    ping((const uint8_t *)WS_PING_PAYLOAD, WS_PING_PAYLOAD_LEN);
+  }
+}
+
+void AsyncWebSocketClient::_onDisconnect() {
+  _status = WS_DISCONNECTED;
+  _server->_handleDisconnect(this);
+}
+
+AsyncWebSocket::~AsyncWebSocket() {
+  closeAll();
+}
+
+size_t AsyncWebSocket::count() const {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  size_t connected = 0;
+  for (AsyncWebSocketClient *client : _clients) {
+    if (client->status() == WS_CONNECTED) connected++;
+  }
+  return connected;
+}
+
+AsyncWebSocketClient *AsyncWebSocket::client(uint32_t id) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  for (AsyncWebSocketClient *client : _clients) {
+    if (client->id() == id && client->status() == WS_CONNECTED) return client;
+  }
+  return nullptr;
+}
+
+void AsyncWebSocket::close(uint32_t id, uint16_t code, const char *message) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  AsyncWebSocketClient *found = client(id);
+  if (found) found->close(code, message);
+}
+
+void AsyncWebSocket::closeAll(uint16_t code, const char *message) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  for (AsyncWebSocketClient *client : _clients) client->close(code, message);
+}
+
+// Closes the oldest connection while there are more than maxClients
+void AsyncWebSocket::cleanupClients(uint16_t maxClients) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  if (count() <= maxClients) return;
+  for (AsyncWebSocketClient *client : _clients) {
+    if (client->status() == WS_CONNECTED) {
+      client->close();
+      return;
+    }
+  }
+}
+
+bool AsyncWebSocket::availableForWriteAll() {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  for (AsyncWebSocketClient *client : _clients) {
+    if (client->status() == WS_CONNECTED && !client->canSend()) return false;
+  }
+  return true;
+}
+
+void AsyncWebSocket::text(uint32_t id, const char *message) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  AsyncWebSocketClient *found = client(id);
+  if (found) found->text(message);
+}
+
+void AsyncWebSocket::textAll(const char *message, size_t len) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  for (AsyncWebSocketClient *client : _clients) {
+    if (client->status() == WS_CONNECTED) client->text(message, len);
+  }
+}
+
+void AsyncWebSocket::binaryAll(const uint8_t *message, size_t len) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  for (AsyncWebSocketClient *client : _clients) {
+    if (client->status() == WS_CONNECTED) client->binary(message, len);
+  }
+}
+
+bool AsyncWebSocket::canHandle(AsyncWebServerRequest *request) {
+  return _enabled && request->method() == HTTP_GET && request->url() == _url && request->_isWebSocketUpgrade;
+}
+
+void AsyncWebSocket::handleRequest(AsyncWebServerRequest *request) {
+  AsyncWebHeader *version = request->getHeader("Sec-WebSocket-Version");
+  AsyncWebHeader *key = request->getHeader("Sec-WebSocket-Key");
+  if (!version || !key) {
+    request->send(400);
+    return;
+  }
+  if (version->value().toInt() != 13) {
+    AsyncWebServerResponse *response = request->beginResponse(400);
+    response->addHeader("Sec-WebSocket-Version", "13");
+    request->send(response);
+    return;
+  }
+  request->send(new HostWebSocketResponse(key->value(), this));
+}
+
+void AsyncWebSocket::_handleDisconnect(AsyncWebSocketClient *client) {
+  _clients.remove(client);
+  _handleEvent(client, WS_EVT_DISCONNECT, nullptr, nullptr, 0);
+  delete client;
+}
+
+void AsyncWebSocket::_handleEvent(AsyncWebSocketClient *client, AwsEventType type, void *arg, uint8_t *data,
+                                  size_t len) {
+  if (_eventHandler) _eventHandler(this, client, type, arg, data, len);
+}
+
+//////////////////////// Server ////////////////////////
+
+// The thread doing what AsyncTCP's task does on the board: accepting,
+// reading, running the handlers and sending, all under hostTcpLock()
+struct HostServerThread {
+  AsyncWebServer *server;
+  std::thread thread;
+  std::atomic<bool> stop{ false };
+  std::vector<HostConnection *> connections;
+
+  void run();
+  void accept();
+  void read(HostConnection *connection);
+};
+
+void HostServerThread::run() {
+  std::vector<pollfd> fds;
+  while (!stop) {
+    fds.clear();
+    fds.push_back({ server->_listenFd, POLLIN, 0 });
+    {
+      std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+      for (HostConnection *connection : connections) {
+        short events = (connection->wantsRead() ? POLLIN : 0) | (connection->wantsWrite() ? POLLOUT : 0);
+        fds.push_back({ connection->fd(), events, 0 });
+      }
+    }
+    poll(fds.data(), fds.size(), HOST_POLL_MS);
+
+    std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+    size_t polled = fds.size() - 1;
+    for (size_t i = 0; i < polled; i++) {
+      if (fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) read(connections[i]);
+    }
+    if (fds[0].revents & POLLIN) accept();
+    for (HostConnection *connection : connections) connection->update();
+
+    for (size_t i = 0; i < connections.size();) {
+      if (connections[i]->closed()) {
+        delete connections[i];
+        connections.erase(connections.begin() + i);
+      } else {
+        i++;
+      }
+    }
+  }
+}
+
+void HostServerThread::accept() {
+  for (;;) {
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    int fd = accept4(server->_listenFd, (sockaddr *)&address, &length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) return;
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    IPAddress remote(address.sin_addr.s_addr);
+    if (apClients && remote[0] == 127) remote = IPAddress(192, 168, 4, remote[3]);
+    connections.push_back(new HostConnection(server, fd, remote, ntohs(address.sin_port)));
+  }
+}
+
+void HostServerThread::read(HostConnection *connection) {
+  char buffer[4096];
+  for (int reads = 0; reads < 16 && !connection->closed(); reads++) {
+    ssize_t length = recv(connection->fd(), buffer, sizeof(buffer), MSG_DONTWAIT);
+    if (length > 0) {
+      connection->receive(buffer, length);
+    } else if (length == 0) {
+      connection->peerFinished();
+      return;
+    } else {
+      if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) connection->abort();
+      return;
+    }
+  }
+}
+
+// Stops every server before the sketch's globals are destroyed
+static std::vector<AsyncWebServer *> &runningServers() {
+  static std::vector<AsyncWebServer *> servers;
+  return servers;
+}
+
+static void stopServers() {
+  std::vector<AsyncWebServer *> servers;
+  {
+    std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+    servers = runningServers();
+  }
+  for (AsyncWebServer *server : servers) server->end();
+}
+
+AsyncWebServer::AsyncWebServer(uint16_t port) : _configuredPort(port) {
+  _catchAllHandler = new AsyncCallbackWebHandler();
+  reset();
+}
+
+AsyncWebServer::~AsyncWebServer() {
+  end();
+  delete _catchAllHandler;
+}
+
+void AsyncWebServer::begin() {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  if (_thread) return;
+
+  int port = httpPortOverride >= 0 ? (int)httpPortOverride : _configuredPort;
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  int reuse = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+  if (fd < 0 || bind(fd, (sockaddr *)&address, sizeof(address)) < 0 || listen(fd, 16) < 0 ||
+      getsockname(fd, (sockaddr *)&address, &length) < 0) {
+    fprintf(stderr, "AsyncWebServer: can't listen on port %d: %s\n", port, strerror(errno));
+    if (fd >= 0) ::close(fd);
+    return;
+  }
+  _listenFd = fd;
+  _listenPort = ntohs(address.sin_port);
+
+  static bool exitHook = (atexit(stopServers), true);
+  (void)exitHook;
+  runningServers().push_back(this);
+  _thread = new HostServerThread();
+  _thread->server = this;
+  _thread->thread = std::thread(&HostServerThread::run, _thread);
+}
+
+void AsyncWebServer::end() {
+  HostServerThread *thread;
+  {
+    std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+    thread = _thread;
+    if (!thread) return;
+    thread->stop = true;
+  }
+  // Without the lock, the thread takes it every round
+  thread->thread.join();
+
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  for (HostConnection *connection : thread->connections) {
+    connection->abort();
+    delete connection;
+  }
+  delete thread;
+  _thread = nullptr;
+  ::close(_listenFd);
+  _listenFd = -1;
+  _listenPort = 0;
+  std::vector<AsyncWebServer *> &servers = runningServers();
+  servers.erase(std::remove(servers.begin(), servers.end(), this), servers.end());
+}
+
+AsyncWebHandler &AsyncWebServer::addHandler(AsyncWebHandler *handler) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  _handlers.push_back(handler);
+  return *handler;
+}
+
+bool AsyncWebServer::removeHandler(AsyncWebHandler *handler) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  auto found = std::find(_handlers.begin(), _handlers.end(), handler);
+  if (found == _handlers.end()) return false;
+  _handlers.erase(found);
+  return true;
+}
+
+AsyncCallbackWebHandler &AsyncWebServer::on(const char *uri, ArRequestHandlerFunction onRequest) {
+  return on(uri, HTTP_ANY, onRequest, nullptr, nullptr);
+}
+
+AsyncCallbackWebHandler &AsyncWebServer::on(const char *uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest) {
+  return on(uri, method, onRequest, nullptr, nullptr);
+}
+
+AsyncCallbackWebHandler &AsyncWebServer::on(const char *uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload) {
+  return on(uri, method, onRequest, onUpload, nullptr);
+}
+
+AsyncCallbackWebHandler &AsyncWebServer::on(const char *uri, WebRequestMethodComposite method,
+                                            ArRequestHandlerFunction onRequest, ArUploadHandlerFunction onUpload,
+                                            ArBodyHandlerFunction onBody) {
+  AsyncCallbackWebHandler *handler = new AsyncCallbackWebHandler();
+  handler->setUri(uri);
+  handler->setMethod(method);
+  handler->onRequest(onRequest);
+  handler->onUpload(onUpload);
+  handler->onBody(onBody);
+  addHandler(handler);
+  return *handler;
+}
+
+void AsyncWebServer::onNotFound(ArRequestHandlerFunction fn) {
+  _catchAllHandler->onRequest(fn);
+}
+
+void AsyncWebServer::onFileUpload(ArUploadHandlerFunction fn) {
+  _catchAllHandler->onUpload(fn);
+}
+
+void AsyncWebServer::onRequestBody(ArBodyHandlerFunction fn) {
+  _catchAllHandler->onBody(fn);
+}
+
+void AsyncWebServer::reset() {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  _handlers.clear();
+  _catchAllHandler->onRequest([](AsyncWebServerRequest *request) { request->send(404); });
+  _catchAllHandler->onUpload(nullptr);
+  _catchAllHandler->onBody(nullptr);
+}
+
+// Handlers are asked in the order they were added, a filter first
+void AsyncWebServer::_attachHandler(AsyncWebServerRequest *request) {
+  for (AsyncWebHandler *handler : _handlers) {
+    if (handler->filter(request) && handler->canHandle(request)) {
+      request->_handler = handler;
+      return;
+    }
+  }
+  request->_handler = _catchAllHandler;
+}
+
+DefaultHeaders &DefaultHeaders::Instance() {
+  static DefaultHeaders instance;
+  return instance;
+}
+
+//////////////////////// Test connections ////////////////////////
+
+HostRequest::HostRequest(AsyncWebServer &server, const std::string &raw, IPAddress from) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  _connection = new HostConnection(&server, -1, from, memoryPorts++);
+  _connection->receive(raw.data(), raw.size());
+}
+
+HostRequest::~HostRequest() {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  _connection->abort();
+  delete _connection;
+}
+
+void HostRequest::write(const std::string &data) {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  _connection->receive(data.data(), data.size());
+}
+
+bool HostRequest::poll() {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  _connection->update();
+  output += _connection->take();
+  _connection->closeIfDrained();
+  return _connection->closed();
+}
+
+void HostRequest::close() {
+  std::lock_guard<std::recursive_mutex> lock(hostTcpLock());
+  _connection->abort();
+}
+
+std::string HostRequest::read() {
+  std::string data = output.substr(_readLength);
+  _readLength = output.size();
+  return data;
+}
+
+std::string HostResponse::header(const char *name) const {
+  for (const auto &header : headers) {
+    if (strcasecmp(header.first.c_str(), name) == 0) return header.second;
+  }
+  return "";
+}
+
+HostResponse hostParseResponse(const std::string &raw) {
+  HostResponse response;
+  size_t headEnd = raw.find("\r\n\r\n");
+  if (headEnd == std::string::npos || raw.compare(0, 5, "HTTP/") != 0) return response;
+  size_t space = raw.find(' ');
+  response.status = atoi(raw.c_str() + space + 1);
+
+  size_t start = raw.find("\r\n") + 2;
+  while (start < headEnd + 2) {
+    size_t end = raw.find("\r\n", start);
+    std::string line = raw.substr(start, end - start);
+    start = end + 2;
+    size_t colon = line.find(':');
+    if (colon != std::string::npos) response.headers.push_back({ line.substr(0, colon), trim(line.substr(colon + 1)) });
+  }
+
+  std::string body = raw.substr(headEnd + 4);
+  if (strcasecmp(response.header("Transfer-Encoding").c_str(), "chunked") == 0) {
+    size_t at = 0;
+    for (;;) {
+      size_t lineEnd = body.find("\r\n", at);
+      if (lineEnd == std::string::npos) break;
+      size_t size = strtoul(body.c_str() + at, nullptr, 16);
+      if (size == 0) {
+        response.complete = true;
+        break;
+      }
+      if (lineEnd + 2 + size > body.size()) break;
+      response.body += body.substr(lineEnd + 2, size);
+      at = lineEnd + 2 + size + 2;
+    }
+  } else {
+    response.body = body;
+    std::string length = response.header("Content-Length");
+    if (!length.empty()) {
+      size_t expected = strtoul(length.c_str(), nullptr, 10);
+      response.complete = response.body.size() >= expected;
+      response.body.resize(std::min(expected, response.body.size()));
+    }
+  }
+  return response;
+}
+
+HostResponse hostRequest(AsyncWebServer &server, const char *method, const char *path, const std::string &body,
+                         const std::string &headers, IPAddress from, unsigned maxPolls) {
+  std::string raw = std::string(method) + " " + path + " HTTP/1.1\r\nHost: 192.168.4.1\r\n" + headers;
+  if (!body.empty() || strcmp(method, "POST") == 0) {
+    if (strcasestr(headers.c_str(), "Content-Type:") == nullptr) {
+      raw += "Content-Type: application/x-www-form-urlencoded\r\n";
+    }
+    raw += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+  }
+  raw += "\r\n" + body;
+
+  HostRequest request(server, raw, from);
+  bool closed = false;
+  for (unsigned i = 0; i < maxPolls && !closed; i++) {
+    size_t before = request.output.size();
+    closed = request.poll();
+    // A source with nothing yet may be waiting for a task
+    if (!closed && request.output.size() == before) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  HostResponse response = hostParseResponse(request.output);
+  response.complete = closed;
+  return response;
+}
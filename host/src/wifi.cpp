@@ -0,0 +1,256 @@
+// Host stand-in for the ESP32 WiFi class, see WiFi.h
+
+#include <WiFi.h>
+#include <host.h>
+#include <mutex>
+#include <vector>
+
+WiFiClass WiFi;
+
+static std::mutex wifiLock;
+static std::vector<HostWiFiNetwork> networks;
+static uint32_t scanningJoinMs = 2500;    // Scan of all channels, then the join
+static uint32_t knownChannelJoinMs = 400;  // Straight to the channel and BSSID
+static uint32_t scanMs = 2200;             // All channels, the default 120 ms each
+
+static wifi_mode_t wifiMode = WIFI_OFF;
+static HostWiFiStats stats;
+
+struct Station {
+  bool connecting;
+  wl_status_t status;
+  unsigned long doneAt;
+  String ssid;
+  String password;
+  int32_t channel;      // 0 to scan for it
+  uint8_t bssid[6];
+  bool bssidGiven;
+  int network;          // Index in networks once connected, -1 otherwise
+};
+
+static Station station = { false, WL_IDLE_STATUS, 0, "", "", 0, {}, false, -1 };
+
+struct Scan {
+  bool running;
+  bool done;
+  unsigned long doneAt;
+  std::vector<HostWiFiNetwork> results;
+};
+
+static Scan scan = { false, false, 0, {} };
+
+void hostAddWiFiNetwork(const HostWiFiNetwork &network) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  networks.push_back(network);
+}
+
+void hostRemoveWiFiNetworks() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  networks.clear();
+  if (station.status == WL_CONNECTED) station.status = WL_CONNECTION_LOST;
+  station.network = -1;
+}
+
+void hostSetWiFiJoinMs(uint32_t scanning, uint32_t knownChannel) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  scanningJoinMs = scanning;
+  knownChannelJoinMs = knownChannel;
+}
+
+void hostSetWiFiScanMs(uint32_t ms) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  scanMs = ms;
+}
+
+void hostDropWiFi() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  if (station.status == WL_CONNECTED) station.status = WL_CONNECTION_LOST;
+  station.network = -1;
+}
+
+HostWiFiStats hostWiFiStats() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  return stats;
+}
+
+// Finish a join whose time has come, called with the lock held
+static void updateStation() {
+  if (!station.connecting || (long)(millis() - station.doneAt) < 0) return;
+  station.connecting = false;
+
+  station.status = WL_NO_SSID_AVAIL;
+  for (size_t i = 0; i < networks.size(); i++) {
+    const HostWiFiNetwork &network = networks[i];
+    if (network.ssid != station.ssid) continue;
+    // With a channel or BSSID the driver looks nowhere else
+    if (station.channel && station.channel != network.channel) continue;
+    if (station.bssidGiven && memcmp(station.bssid, network.bssid, 6) != 0) continue;
+    if (network.password != station.password) {
+      station.status = WL_CONNECT_FAILED;
+      continue;
+    }
+    station.status = WL_CONNECTED;
+    station.network = i;
+    return;
+  }
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  wifiMode = mode;
+  return true;
+}
+
+wifi_mode_t WiFiClass::getMode() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  return wifiMode;
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *password, int32_t channel, const uint8_t *bssid,
+                             bool connect) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  stats.begins++;
+  stats.lastChannel = channel;
+  stats.lastBssid = bssid != nullptr;
+
+  station.ssid = ssid ? ssid : "";
+  station.password = password ? password : "";
+  station.channel = channel;
+  station.bssidGiven = bssid != nullptr;
+  if (bssid) memcpy(station.bssid, bssid, 6);
+  station.network = -1;
+  station.status = WL_DISCONNECTED;
+  station.connecting = connect && !station.ssid.isEmpty();
+  station.doneAt = millis() + (channel && bssid ? knownChannelJoinMs : scanningJoinMs);
+  return station.status;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  station.connecting = false;
+  station.network = -1;
+  station.status = WL_DISCONNECTED;
+  return true;
+}
+
+bool WiFiClass::reconnect() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  if (station.ssid.isEmpty()) return false;
+  station.network = -1;
+  station.status = WL_DISCONNECTED;
+  station.connecting = true;
+  station.doneAt = millis() + scanningJoinMs;
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  updateStation();
+  return station.status;
+}
+
+IPAddress WiFiClass::localIP() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  return station.status == WL_CONNECTED ? IPAddress(192, 168, 1, 50) : IPAddress();
+}
+
+String WiFiClass::SSID() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  return station.network >= 0 ? networks[station.network].ssid : String();
+}
+
+int32_t WiFiClass::RSSI() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  return station.network >= 0 ? networks[station.network].rssi : 0;
+}
+
+int32_t WiFiClass::channel() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  return station.network >= 0 ? networks[station.network].channel : stats.apChannel;
+}
+
+uint8_t *WiFiClass::BSSID() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  return station.network >= 0 ? networks[station.network].bssid : nullptr;
+}
+
+bool WiFiClass::softAP(const char *ssid, const char *password, int channel, int hidden, int maxConnection) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  // The driver refuses WPA2 passwords shorter than 8 characters
+  if (!ssid || !*ssid || (password && *password && strlen(password) < 8)) return false;
+  if (channel < 1 || channel > 13) return false;
+  stats.apSSID = ssid;
+  stats.apChannel = channel;
+  return true;
+}
+
+bool WiFiClass::softAPdisconnect(bool wifiOff) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  stats.apChannel = 0;
+  stats.apSSID = "";
+  return true;
+}
+
+IPAddress WiFiClass::softAPIP() {
+  return IPAddress(192, 168, 4, 1);
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool showHidden, bool passive, uint32_t maxMsPerChannel,
+                                uint8_t channel) {
+  unsigned long duration;
+  {
+    std::lock_guard<std::mutex> guard(wifiLock);
+    if (scan.running) return WIFI_SCAN_RUNNING;
+    stats.scans++;
+    scan.running = true;
+    scan.done = false;
+    scan.doneAt = millis() + scanMs;
+    scan.results = networks;
+    duration = scanMs;
+  }
+  if (async) return WIFI_SCAN_RUNNING;
+  delay(duration);
+  return scanComplete();
+}
+
+int16_t WiFiClass::scanComplete() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  if (scan.running && (long)(millis() - scan.doneAt) >= 0) {
+    scan.running = false;
+    scan.done = true;
+  }
+  if (scan.running) return WIFI_SCAN_RUNNING;
+  return scan.done ? scan.results.size() : WIFI_SCAN_FAILED;
+}
+
+void WiFiClass::scanDelete() {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  scan.done = false;
+  scan.results.clear();
+}
+
+String WiFiClass::SSID(uint8_t index) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  return index < scan.results.size() ? scan.results[index].ssid : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t index) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  return index < scan.results.size() ? scan.results[index].rssi : 0;
+}
+
+int32_t WiFiClass::channel(uint8_t index) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  return index < scan.results.size() ? scan.results[index].channel : 0;
+}
+
+uint8_t *WiFiClass::BSSID(uint8_t index) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  return index < scan.results.size() ? scan.results[index].bssid : nullptr;
+}
+
+wifi_auth_mode_t WiFiClass::encryptionType(uint8_t index) {
+  std::lock_guard<std::mutex> guard(wifiLock);
+  if (index >= scan.results.size()) return WIFI_AUTH_OPEN;
+  return scan.results[index].password.isEmpty() ? WIFI_AUTH_OPEN : WIFI_AUTH_WPA2_PSK;
+}
@@ -0,0 +1,68 @@
+#ifndef TEST_H
+#define TEST_H
+
+// Checks for the host tests. Each test is one executable that includes the
+// sketch headers it exercises and links the stand-ins, see CMakeLists.txt.
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+
+static int testFailures = 0;
+
+#define CHECK(condition)                                                          \
+  do {                                                                            \
+    if (!(condition)) {                                                           \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      testFailures++;                                                             \
+    }                                                                             \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                       \
+  do {                                                                                                   \
+    long long actualValue = (long long)(actual);                                                         \
+    long long expectedValue = (long long)(expected);                                                     \
+    if (actualValue != expectedValue) {                                                                  \
+      fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, actualValue,    \
+              expectedValue);                                                                            \
+      testFailures++;                                                                                    \
+    }                                                                                                    \
+  } while (0)
+
+#define CHECK_STR(actual, expected)                                                                   \
+  do {                                                                                                \
+    std::string actualText = (actual);                                                                \
+    std::string expectedText = (expected);                                                            \
+    if (actualText != expectedText) {                                                                 \
+      fprintf(stderr, "%s:%d: %s is \"%.600s\", expected \"%.600s\"\n", __FILE__, __LINE__, #actual,     \
+              actualText.c_str(), expectedText.c_str());                                              \
+      testFailures++;                                                                                 \
+    }                                                                                                 \
+  } while (0)
+
+#define CHECK_CONTAINS(text, part)                                                                   \
+  do {                                                                                               \
+    if (strstr((text), (part)) == nullptr) {                                                         \
+      fprintf(stderr, "%s:%d: \"%s\" not found in:\n%.600s\n", __FILE__, __LINE__, (part), (text));      \
+      testFailures++;                                                                                \
+    }                                                                                                \
+  } while (0)
+
+#define RUN(test)                                                       \
+  do {                                                                  \
+    int failuresBefore = testFailures;                                  \
+    test();                                                             \
+    printf("%s %s\n", testFailures == failuresBefore ? "ok  " : "FAIL", #test); \
+  } while (0)
+
+// Result for main(). Tests that started tasks leave with _exit(), the
+// task threads never return and must not see the globals destroyed.
+static int testResult() {
+  fflush(stdout);
+  fflush(stderr);
+  return testFailures ? 1 : 0;
+}
+
+#endif  // TEST_H
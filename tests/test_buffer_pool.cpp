@@ -0,0 +1,152 @@
+// Response buffer pool and pooled responses (buffer_pool.h, pooled_response.h)
+
+#include "../ESP32_Web_Server/pooled_response.h"
+#include <host.h>
+#include <thread>
+#include "test.h"
+
+static AsyncWebServer server(80);
+
+static const uint32_t ALL_FREE = (uint32_t)((1ULL << POOL_BLOCK_COUNT) - 1);
+
+// A body of length bytes, each its offset modulo 251
+static void writePattern(Print &out, size_t length) {
+  for (size_t i = 0; i < length; i++) out.write((uint8_t)(i % 251));
+}
+
+static bool isPattern(const std::string &body, size_t length) {
+  if (body.size() != length) return false;
+  for (size_t i = 0; i < length; i++) {
+    if ((uint8_t)body[i] != i % 251) return false;
+  }
+  return true;
+}
+
+// Blocks go back to the pool as they are read, not when the body is done
+static void testWriteRead() {
+  {
+    PoolWriter writer;
+    writePattern(writer, 2 * POOL_BLOCK_SIZE + 100);
+    CHECK(!writer.overflowed());
+    CHECK_EQ(writer.length(), 2 * POOL_BLOCK_SIZE + 100);
+    CHECK_EQ(poolStats.inUse, 3);
+
+    std::string body;
+    uint8_t buffer[700];
+    for (size_t length; (length = writer.read(buffer, sizeof(buffer))) > 0;) {
+      body.append((const char *)buffer, length);
+      if (body.size() == 1400) CHECK_EQ(poolStats.inUse, 2);
+    }
+    CHECK(isPattern(body, 2 * POOL_BLOCK_SIZE + 100));
+    CHECK_EQ(poolStats.inUse, 0);
+  }
+  CHECK_EQ(poolFreeMap.load(), ALL_FREE);
+}
+
+static void testBodyLimit() {
+  {
+    PoolWriter writer(2);
+    writePattern(writer, 3 * POOL_BLOCK_SIZE);
+    CHECK(writer.overflowed());
+    CHECK_EQ(writer.length(), 2 * POOL_BLOCK_SIZE);
+    CHECK_EQ(writer.write('x'), 0);
+  }
+  CHECK_EQ(poolStats.inUse, 0);  // An unsent body gives its blocks back too
+}
+
+// An empty pool fails the body, and the handler answers 503
+static void testExhausted() {
+  PoolWriter *holders[POOL_BLOCK_COUNT];
+  for (int i = 0; i < POOL_BLOCK_COUNT; i++) {
+    holders[i] = new PoolWriter();
+    holders[i]->write('x');
+  }
+  CHECK_EQ(poolFreeMap.load(), 0);
+  uint32_t exhaustedBefore = poolStats.exhausted;
+
+  HostResponse response = hostRequest(server, "GET", "/body?length=10");
+  CHECK_EQ(response.status, 503);
+  CHECK_EQ(poolStats.exhausted - exhaustedBefore, 1);
+
+  delete holders[3];
+  response = hostRequest(server, "GET", "/body?length=10");
+  CHECK_EQ(response.status, 200);
+  CHECK(isPattern(response.body, 10));
+
+  for (int i = 0; i < POOL_BLOCK_COUNT; i++) {
+    if (i != 3) delete holders[i];
+  }
+  CHECK_EQ(poolFreeMap.load(), ALL_FREE);
+}
+
+// Bodies of every size up to the limit
+static int serveBodies(int first, int count) {
+  int failed = 0;
+  for (int i = first; i < first + count; i++) {
+    size_t length = 1 + (i * 7919) % (RESPONSE_MAX_BLOCKS * POOL_BLOCK_SIZE);
+    std::string path = "/body?length=" + std::to_string(length);
+    HostResponse response = hostRequest(server, "GET", path.c_str());
+    if (response.status != 200 || !isPattern(response.body, length)) failed++;
+  }
+  return failed;
+}
+
+// Thousands of responses in, the heap is where it was after the first thousand
+static void testSoak() {
+  CHECK_EQ(serveBodies(0, 1000), 0);
+  size_t heapBefore = hostHeapInUse();
+
+  CHECK_EQ(serveBodies(1000, 5000), 0);
+  CHECK_EQ(poolStats.inUse, 0);
+  CHECK(hostHeapInUse() <= heapBefore + 1024);
+}
+
+// Two tasks taking and returning blocks at once never share one
+static void testConcurrentAcquire() {
+  static std::atomic<uint32_t> shared(0);
+  static uint8_t owner[POOL_BLOCK_COUNT];
+  auto churn = [](uint8_t id) {
+    for (int i = 0; i < 200000; i++) {
+      PoolBlock *block = acquireBlock();
+      if (!block) continue;
+      uint8_t &slot = owner[block - poolBlocks];
+      if (slot != 0) shared++;
+      slot = id;
+      block->length = id;
+      if (block->length != id || slot != id) shared++;
+      slot = 0;
+      releaseBlock(block);
+    }
+  };
+  std::thread first(churn, 1);
+  std::thread second(churn, 2);
+  first.join();
+  second.join();
+  CHECK_EQ(shared, 0);
+  CHECK_EQ(poolStats.inUse, 0);
+  CHECK_EQ(poolFreeMap.load(), ALL_FREE);
+}
+
+static void testPrintTo() {
+  PoolWriter writer;
+  CHECK_EQ(printTo(writer, "%s=%d\n", "answer", 42), 10);
+  std::string longText(300, 'a');
+  CHECK_EQ(printTo(writer, "%s", longText.c_str()), 191);  // Cut to the stack buffer
+  CHECK_EQ(writer.length(), 201);
+}
+
+int main() {
+  server.on("/body", HTTP_GET, [](AsyncWebServerRequest *request) {
+    PooledResponse *response = beginPooledResponse(request, "application/octet-stream");
+    writePattern(response->source, atoi(request->getParam("length")->value().c_str()));
+    sendPooledResponse(request, response);
+  });
+
+  RUN(testWriteRead);
+  RUN(testBodyLimit);
+  RUN(testExhausted);
+  RUN(testSoak);
+  RUN(testConcurrentAcquire);
+  RUN(testPrintTo);
+  return testResult();
+}
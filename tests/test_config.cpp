@@ -0,0 +1,307 @@
+// Settings in NVS: slots, checksums, migration and batched commits (config.h)
+
+#include "../ESP32_Web_Server/routes.h"
+#include <host.h>
+#include "test.h"
+
+Preferences preferences;
+AsyncWebServer server(80);
+
+static Config defaults;
+
+// A board with NVS as the test left it, booting
+static void boot() {
+  config = defaults;
+  configDirty = 0;
+  configSequence = 0;
+  configLegacyKeys = false;
+  ConfigUpdate update;
+  while (webConfigUpdates.pop(update)) {}
+  loadConfig();
+}
+
+// loop() for a while
+static void run(uint32_t ms) {
+  for (uint32_t elapsed = 0; elapsed < ms; elapsed += 100) {
+    updateConfig();
+    hostAdvanceMs(100);
+  }
+}
+
+static void writeSlot(const char *key, const void *stored, size_t size) {
+  preferences.begin(CONFIG_NAMESPACE, false);
+  preferences.putBytes(key, stored, size);
+  preferences.end();
+}
+
+static bool readSlot(const char *key, StoredConfig &stored) {
+  preferences.begin(CONFIG_NAMESPACE, true);
+  bool valid = readConfigSlot(key, stored);
+  preferences.end();
+  return valid;
+}
+
+static bool hasKey(const char *key) {
+  if (!preferences.begin(CONFIG_NAMESPACE, true)) return false;
+  bool found = preferences.isKey(key);
+  preferences.end();
+  return found;
+}
+
+// A first boot writes the defaults once, to the second slot
+static void testFirstBoot() {
+  hostClearPreferences();
+  boot();
+  CHECK_STR(readConfig().apSSID, "ESP32_001");
+  CHECK_EQ(configDirty, CONFIG_ALL);
+
+  unsigned long commits = configCommits;
+  run(2000);
+  CHECK_EQ(configCommits - commits, 1);
+  CHECK_EQ(configSequence, 1);
+  StoredConfig stored;
+  CHECK(readSlot("config_b", stored));
+  CHECK(!readSlot("config_a", stored));
+
+  boot();
+  CHECK_EQ(configDirty, 0);
+  CHECK_EQ(configSequence, 1);
+}
+
+// The old string keys are read once, written as a blob and removed
+static void testLegacyMigration() {
+  hostClearPreferences();
+  preferences.begin(CONFIG_NAMESPACE, false);
+  preferences.putString("ssid", "home");
+  preferences.putString("wifi_password", "homepass");
+  preferences.putString("apssid", "garden");
+  preferences.putString("password", "secret");
+  preferences.end();
+
+  boot();
+  Config loaded = readConfig();
+  CHECK_STR(loaded.ssid, "home");
+  CHECK_STR(loaded.wifiPassword, "homepass");
+  CHECK_STR(loaded.apSSID, "garden");
+  CHECK_STR(loaded.apPassword, defaults.apPassword);
+  CHECK_STR(loaded.password, "secret");
+  CHECK(configLegacyKeys);
+
+  run(2000);
+  CHECK(!hasKey("ssid"));
+  CHECK(!hasKey("password"));
+  boot();
+  CHECK_STR(readConfig().ssid, "home");
+  CHECK_EQ(configDirty, 0);
+}
+
+// A version 1 slot keeps its values and gains the MQTT defaults
+static void testVersion1Slot() {
+  hostClearPreferences();
+  StoredConfigV1 old;
+  memset(&old, 0, sizeof(old));
+  old.version = 1;
+  old.size = sizeof(old);
+  old.sequence = 7;
+  strcpy(old.values.ssid, "office");
+  strcpy(old.values.wifiPassword, "officepass");
+  strcpy(old.values.apSSID, "ESP32_007");
+  strcpy(old.values.apPassword, "apsecret");
+  strcpy(old.values.username, "root");
+  strcpy(old.values.password, "toor");
+  old.checksum = configChecksum(&old, offsetof(StoredConfigV1, checksum));
+  writeSlot("config_b", &old, sizeof(old));
+
+  boot();
+  Config loaded = readConfig();
+  CHECK_STR(loaded.ssid, "office");
+  CHECK_STR(loaded.username, "root");
+  CHECK_STR(loaded.mqttPort, defaults.mqttPort);
+  CHECK_EQ(configSequence, 7);
+  CHECK_EQ(configDirty, CONFIG_ALL);
+
+  run(2000);
+  StoredConfig stored;
+  CHECK(readSlot("config_a", stored));
+  CHECK_EQ(stored.version, CONFIG_VERSION);
+  CHECK_EQ(stored.sequence, 8);
+}
+
+// Changes made close together cost one write, to the older slot, and
+// changes undone before then none
+static void testBatchedCommit() {
+  hostClearPreferences();
+  boot();
+  run(2000);
+  unsigned long commits = configCommits;
+
+  CHECK(setConfig(CONFIG_USERNAME, "alice"));
+  run(500);
+  CHECK(setConfig(CONFIG_PASSWORD, "wonderland"));
+  CHECK(setConfig(CONFIG_MQTT_HOST, "broker.local"));
+  run(500);
+  CHECK_STR(readConfig().username, "alice");  // Seen at once, written later
+  CHECK_EQ(configCommits, commits);
+  run(1000);
+  CHECK_EQ(configCommits - commits, 1);
+  CHECK_EQ(configSequence, 2);
+
+  // Unchanged values and values that don't fit are not written
+  CHECK(setConfig(CONFIG_USERNAME, "alice"));
+  CHECK(!setConfig(CONFIG_MQTT_PORT, "123456"));
+  run(2000);
+  CHECK_EQ(configCommits - commits, 1);
+
+  // Fields set back to their saved values before the commit cost nothing
+  CHECK(setConfig(CONFIG_USERNAME, "bob"));
+  CHECK(setConfig(CONFIG_MQTT_HOST, "other.local"));
+  run(500);
+  CHECK(setConfig(CONFIG_USERNAME, "alice"));
+  CHECK(setConfig(CONFIG_MQTT_HOST, "broker.local"));
+  run(2000);
+  CHECK_EQ(configCommits - commits, 1);
+  CHECK_EQ(configDirty, 0);
+
+  // Only the fields still changed are kept dirty
+  CHECK(setConfig(CONFIG_USERNAME, "bob"));
+  CHECK(setConfig(CONFIG_MQTT_HOST, "other.local"));
+  run(500);
+  CHECK(setConfig(CONFIG_USERNAME, "alice"));
+  hostFailPreferenceWrites(true);
+  run(2000);
+  CHECK_EQ(configDirty, CONFIG_MQTT_HOST);
+  hostFailPreferenceWrites(false);
+  run(2000);
+  CHECK_EQ(configCommits - commits, 2);
+  CHECK_EQ(configSequence, 3);
+
+  boot();
+  CHECK_STR(readConfig().password, "wonderland");
+  CHECK_STR(readConfig().mqttHost, "other.local");
+}
+
+// A slot that fails its checksum, as a write cut by a reset leaves it,
+// falls back to the other one
+static void testFallback() {
+  hostClearPreferences();
+  boot();
+  run(2000);
+  CHECK(setConfig(CONFIG_AP_SSID, "first"));
+  run(2000);
+  CHECK(setConfig(CONFIG_AP_SSID, "second"));
+  run(2000);
+  CHECK_EQ(configSequence, 3);
+
+  StoredConfig stored;
+  CHECK(readSlot("config_b", stored));
+  stored.values.apSSID[0] ^= 1;
+  writeSlot("config_b", &stored, sizeof(stored));
+  boot();
+  CHECK_STR(readConfig().apSSID, "first");
+  CHECK_EQ(configSequence, 2);
+
+  // The next commit goes over the damaged slot
+  CHECK(setConfig(CONFIG_AP_SSID, "third"));
+  run(2000);
+  CHECK(readSlot("config_b", stored));
+  CHECK_STR(stored.values.apSSID, "third");
+
+  // A slot of the wrong size is ignored too
+  writeSlot("config_b", "short", 5);
+  boot();
+  CHECK_STR(readConfig().apSSID, "first");
+}
+
+// Sequence numbers compare across the wrap
+static void testSequenceWrap() {
+  hostClearPreferences();
+  StoredConfig stored;
+  memset(&stored, 0, sizeof(stored));
+  stored.version = CONFIG_VERSION;
+  stored.size = sizeof(stored);
+  stored.values = defaults;
+  stored.sequence = 0xFFFFFFFF;
+  strcpy(stored.values.apSSID, "older");
+  stored.checksum = configChecksum(&stored, offsetof(StoredConfig, checksum));
+  writeSlot("config_b", &stored, sizeof(stored));
+  stored.sequence = 0;
+  strcpy(stored.values.apSSID, "newer");
+  stored.checksum = configChecksum(&stored, offsetof(StoredConfig, checksum));
+  writeSlot("config_a", &stored, sizeof(stored));
+
+  boot();
+  CHECK_STR(readConfig().apSSID, "newer");
+}
+
+// A write NVS refuses is retried after the next delay
+static void testWriteFailure() {
+  hostClearPreferences();
+  boot();
+  run(2000);
+  unsigned long commits = configCommits;
+
+  CHECK(setConfig(CONFIG_SSID, "cafe"));
+  hostFailPreferenceWrites(true);
+  run(3000);
+  CHECK_EQ(configCommits, commits);
+  CHECK_EQ(configDirty, CONFIG_SSID);
+
+  hostFailPreferenceWrites(false);
+  run(1000);
+  CHECK_EQ(configCommits - commits, 1);
+  CHECK_EQ(configDirty, 0);
+  boot();
+  CHECK_STR(readConfig().ssid, "cafe");
+}
+
+// A settings POST is queued whole or answered 503, never half saved
+static void testQueueFull() {
+  hostClearPreferences();
+  boot();
+  hostAdvanceMs(2000);
+  HostResponse login =
+    hostRequest(server, "POST", "/login", "username=admin&password=password", "", IPAddress(192, 168, 4, 2));
+  std::string setCookie = login.header("Set-Cookie");
+  std::string headers = "Cookie: " + setCookie.substr(0, setCookie.find(';')) +
+                        "\r\nContent-Type: application/x-www-form-urlencoded\r\n";
+  std::string body = "apssid=ESP32_009&ap_password=longenough&mqtt_host=broker&mqtt_port=1884&mqtt_topic=home";
+
+  while (webConfigUpdates.space() >= CONFIG_FIELDS_PER_UPDATE) CHECK(setConfig(CONFIG_SSID, "filler"));
+  size_t space = webConfigUpdates.space();
+  hostAdvanceMs(1000);
+  HostResponse response = hostRequest(server, "POST", "/update_settings", body, headers);
+  CHECK_EQ(response.status, 503);
+  CHECK_EQ(webConfigUpdates.space(), space);
+
+  // Once the persistence task has drained the queue the same POST goes through
+  updateConfig();
+  hostAdvanceMs(1000);
+  response = hostRequest(server, "POST", "/update_settings", body, headers);
+  CHECK_EQ(response.status, 200);
+  CHECK_CONTAINS(response.body.c_str(), "Settings Updated");
+  run(2000);
+  Config saved = readConfig();
+  CHECK_STR(saved.apSSID, "ESP32_009");
+  CHECK_STR(saved.mqttHost, "broker");
+  CHECK_STR(saved.mqttPort, "1884");
+
+  // A full queue refuses further changes instead of dropping them
+  while (webConfigUpdates.space() > 0) CHECK(setConfig(CONFIG_SSID, "filler"));
+  CHECK(!setConfig(CONFIG_SSID, "lost"));
+}
+
+int main() {
+  hostUseManualClock();
+  defaults = config;
+  setupRoutes();
+
+  RUN(testFirstBoot);
+  RUN(testLegacyMigration);
+  RUN(testVersion1Slot);
+  RUN(testBatchedCommit);
+  RUN(testFallback);
+  RUN(testSequenceWrap);
+  RUN(testWriteFailure);
+  RUN(testQueueFull);
+  return testResult();
+}
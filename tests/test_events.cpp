@@ -0,0 +1,149 @@
+// Server-Sent Events stream (events.h)
+
+#include "../ESP32_Web_Server/auth.h"
+#include "../ESP32_Web_Server/events.h"
+#include <host.h>
+#include "test.h"
+
+Preferences preferences;
+AsyncWebServer server(80);
+
+static std::string sessionCookie;
+
+static std::string eventsRequest(const std::string &cookie) {
+  std::string raw = "GET /events HTTP/1.1\r\nHost: esp32\r\nAccept: text/event-stream\r\n";
+  if (!cookie.empty()) raw += "Cookie: " SESSION_COOKIE "=" + cookie + "\r\n";
+  return raw + "\r\n";
+}
+
+static size_t countOf(const std::string &text, const char *part) {
+  size_t count = 0;
+  for (size_t at = text.find(part); at != std::string::npos; at = text.find(part, at + 1)) count++;
+  return count;
+}
+
+static void testNeedsSession() {
+  HostResponse response = hostRequest(server, "GET", "/events");
+  CHECK(response.status != 200);
+  CHECK_EQ(events.count(), 0);
+
+  response = hostRequest(server, "GET", "/events", "", "Cookie: " SESSION_COOKIE "=00ffffffffffffffff\r\n");
+  CHECK(response.status != 200);
+  CHECK_EQ(events.count(), 0);
+}
+
+// A new client gets the current sensor and LED state before any change
+static void testInitialState() {
+  HostRequest client(server, eventsRequest(sessionCookie));
+  client.poll();
+  std::string received = client.read();
+  CHECK_CONTAINS(received.c_str(), "HTTP/1.1 200");
+  CHECK_CONTAINS(received.c_str(), "text/event-stream");
+  CHECK_CONTAINS(received.c_str(), "event: sensor\r\n");
+  CHECK_CONTAINS(received.c_str(), "event: led\r\n");
+  CHECK_EQ(events.count(), 1);
+
+  client.close();
+  CHECK_EQ(events.count(), 0);
+}
+
+// Only what changed is pushed, and only once
+static void testPushOnChange() {
+  updateEvents();  // Catch up with the state so far
+  HostRequest client(server, eventsRequest(sessionCookie));
+  client.poll();
+  client.read();
+
+  updateEvents();
+  client.poll();
+  CHECK(client.read().empty());
+
+  queueLEDToggle(1);
+  processLEDCommands();
+  publishLEDSnapshot();
+  updateEvents();
+  client.poll();
+  std::string received = client.read();
+  CHECK_EQ(countOf(received, "event: led\r\n"), 1);
+  CHECK_EQ(countOf(received, "event: sensor\r\n"), 0);
+  CHECK_CONTAINS(received.c_str(), "\"led1State\":true");
+
+  hostSetDht(25.0f, 45.0f);
+  hostAdvanceMs(SENSORS[0]->periodMs);
+  updateSensors();
+  updateEvents();
+  client.poll();
+  received = client.read();
+  CHECK_EQ(countOf(received, "event: sensor\r\n"), 1);
+  CHECK_EQ(countOf(received, "event: led\r\n"), 0);
+
+  updateEvents();
+  client.poll();
+  CHECK(client.read().empty());
+}
+
+// Each stream holds a connection, so the count is capped
+static void testClientCap() {
+  std::vector<HostRequest *> clients;
+  for (int i = 0; i < EVENTS_MAX_CLIENTS; i++) {
+    clients.push_back(new HostRequest(server, eventsRequest(sessionCookie)));
+    clients.back()->poll();
+  }
+  CHECK_EQ(events.count(), EVENTS_MAX_CLIENTS);
+
+  HostResponse refused = hostRequest(server, "GET", "/events", "", "Cookie: " SESSION_COOKIE "=" + sessionCookie + "\r\n");
+  CHECK(refused.status != 200);
+  CHECK_EQ(events.count(), EVENTS_MAX_CLIENTS);
+
+  // A slot frees up when a client goes away
+  clients[0]->close();
+  CHECK_EQ(events.count(), EVENTS_MAX_CLIENTS - 1);
+  HostRequest another(server, eventsRequest(sessionCookie));
+  another.poll();
+  CHECK_CONTAINS(another.read().c_str(), "HTTP/1.1 200");
+  CHECK_EQ(events.count(), EVENTS_MAX_CLIENTS);
+
+  another.close();
+  for (HostRequest *client : clients) delete client;
+  CHECK_EQ(events.count(), 0);
+}
+
+// A payload that doesn't fit the buffer is dropped whole, not cut
+static void testOverflowDropped() {
+  EventBuffer buffer;
+  JsonWriter json(buffer);
+  json.beginObject();
+  for (int i = 0; i < EVENT_BUFFER_SIZE; i++) json.field("k", i);
+  json.endObject();
+  CHECK(buffer.overflow());
+
+  HostRequest client(server, eventsRequest(sessionCookie));
+  client.poll();
+  client.read();
+  unsigned long droppedBefore = eventsDropped;
+  sendEvent(buffer, "sensor");
+  client.poll();
+  CHECK_EQ(eventsDropped, droppedBefore + 1);
+  CHECK(client.read().empty());
+}
+
+int main() {
+  hostUseManualClock();
+  hostSetDht(21.5f, 40.0f);
+  setupSensors();
+  setupLEDs();
+  setupLEDControl();
+  updateSensors();
+  setupEventRoutes();
+
+  char token[SESSION_TOKEN_LENGTH + 1];
+  createSession(ROLE_VIEWER, token);
+  sessionCookie = token;
+
+  RUN(testNeedsSession);
+  RUN(testInitialState);
+  RUN(testPushOnChange);
+  RUN(testClientCap);
+  RUN(testOverflowDropped);
+  return testResult();
+}
@@ -0,0 +1,120 @@
+// Streaming JSON writer (json_writer.h) and the payloads built with it
+
+#include "../ESP32_Web_Server/dashboard.h"
+#include <host.h>
+#include "test.h"
+
+Preferences preferences;
+AsyncWebServer server(80);
+
+static void testCommas() {
+  JsonBuffer<128> buffer;
+  JsonWriter json(buffer);
+  json.beginObject();
+  json.field("a", 1);
+  json.key("list");
+  json.beginArray();
+  json.value(true);
+  json.beginObject();
+  json.endObject();
+  json.beginArray();
+  json.endArray();
+  json.value("x");
+  json.endArray();
+  json.field("b", false);
+  json.endObject();
+  CHECK_STR(buffer.c_str(), "{\"a\":1,\"list\":[true,{},[],\"x\"],\"b\":false}");
+  CHECK(!buffer.overflow());
+}
+
+static void testEscaping() {
+  JsonBuffer<128> buffer;
+  JsonWriter json(buffer);
+  json.beginArray();
+  json.value("q\"b\\s/\n\t\x01");
+  json.value((const char *)nullptr);
+  json.endArray();
+  CHECK_STR(buffer.c_str(), "[\"q\\\"b\\\\s/\\u000a\\u0009\\u0001\",null]");
+}
+
+static void testNumbers() {
+  JsonBuffer<128> buffer;
+  JsonWriter json(buffer);
+  json.beginArray();
+  json.value(-42);
+  json.value(4294967295UL);
+  json.value(21.456, 2);
+  json.value(-0.5, 0);
+  json.value(NAN, 1);
+  json.value(INFINITY, 1);
+  json.endArray();
+  CHECK_STR(buffer.c_str(), "[-42,4294967295,21.46,-0,null,null]");
+}
+
+// Output past the end is dropped and flagged, the text stays terminated
+static void testOverflow() {
+  JsonBuffer<8> buffer;
+  JsonWriter json(buffer);
+  json.beginArray();
+  json.value("abcdefgh");
+  json.endArray();
+  CHECK(buffer.overflow());
+  CHECK_EQ(buffer.length(), 7);
+  CHECK_STR(buffer.c_str(), "[\"abcde");
+}
+
+// Nesting past the tracked depth still writes, without running off the bitmask
+static void testDeepNesting() {
+  JsonBuffer<128> buffer;
+  JsonWriter json(buffer);
+  for (int i = 0; i < JSON_MAX_DEPTH + 4; i++) json.beginArray();
+  for (int i = 0; i < JSON_MAX_DEPTH + 4; i++) json.endArray();
+  CHECK_EQ(buffer.length(), 2 * (JSON_MAX_DEPTH + 4));
+  CHECK(!buffer.overflow());
+}
+
+static void testLEDState() {
+  LedSnapshot snapshot = {};
+  snapshot.on[0] = true;
+  snapshot.level[0] = 200;
+  JsonBuffer<512> buffer;
+  JsonWriter json(buffer);
+  writeLEDState(json, snapshot);
+  CHECK_CONTAINS(buffer.c_str(), "{\"led1State\":true,\"led2State\":false");
+  CHECK_CONTAINS(buffer.c_str(), "\"led1Intensity\":200,\"led2Intensity\":0");
+}
+
+// A payload built on the stack costs no heap
+static void testNoAllocation() {
+  hostUseManualClock();
+  hostSetDht(21.5f, 40.0f);
+  setupSensors();
+  updateSensors();
+  SensorSnapshot sensors = readSensorSnapshot();
+  LedSnapshot leds = {};
+
+  size_t heapBefore = hostHeapInUse();
+  for (int i = 0; i < 100; i++) {
+    JsonBuffer<1024> buffer;
+    JsonWriter json(buffer);
+    writeSensorData(json, sensors);
+    writeLEDState(json, leds);
+  }
+  CHECK_EQ(hostHeapInUse(), heapBefore);
+
+  JsonBuffer<1024> buffer;
+  JsonWriter json(buffer);
+  writeSensorData(json, sensors);
+  CHECK_CONTAINS(buffer.c_str(), "{\"sensors\":[{\"valid\":true,\"age\":0,\"values\":[21.5");
+}
+
+int main() {
+  RUN(testCommas);
+  RUN(testEscaping);
+  RUN(testNumbers);
+  RUN(testOverflow);
+  RUN(testDeepNesting);
+  RUN(testLEDState);
+  RUN(testNoAllocation);
+  return testResult();
+}
@@ -0,0 +1,186 @@
+// LEDC driver, scenes and the LED command path (led_driver.h, scenes.h, led_control.h)
+
+#include "../ESP32_Web_Server/led_control.h"
+#include <host.h>
+#include "test.h"
+
+// One pass of the I/O task's LED work, then its period
+static void tick(uint32_t ms = 10) {
+  processLEDCommands();
+  updateScenes();
+  updateLEDs();
+  publishLEDSnapshot();
+  hostAdvanceMs(ms);
+}
+
+static void run(uint32_t ms) {
+  for (uint32_t elapsed = 0; elapsed < ms; elapsed += 10) tick();
+}
+
+static void start() {
+  hostUseManualClock();
+  for (uint8_t i = 0; i < SCHEDULE_CAPACITY; i++) sceneSchedules[i].scene = -1;
+  activeScene = SCENE_NONE;
+  setupLEDs();
+  setupLEDControl();
+  hostClearPwmEvents();
+}
+
+static void testSetup() {
+  start();
+  CHECK_EQ(ledGamma[0], 0);
+  CHECK_EQ(ledGamma[255], LED_PWM_MAX);
+  bool increasing = true;
+  for (int i = 1; i < 256; i++) increasing &= ledGamma[i] >= ledGamma[i - 1];
+  CHECK(increasing);
+  CHECK(ledGamma[128] < LED_PWM_MAX / 4);  // Perceived half brightness is well below half duty
+
+  for (uint8_t i = 0; i < LED_COUNT; i++) {
+    CHECK_EQ(hostPwmChannelPin(i), LED_PINS[i]);
+    CHECK_EQ(hostPwmDuty(i), 0);
+  }
+}
+
+// A toggle switches at once, to the kept level
+static void testToggle() {
+  start();
+  CHECK(queueLEDToggle(1));
+  tick();
+  CHECK_EQ(hostPwmDuty(0), LED_PWM_MAX);
+  CHECK_EQ(hostPwmDuty(1), 0);
+  CHECK(readLEDSnapshot().on[0]);
+
+  CHECK(queueLEDToggle(1));
+  tick();
+  CHECK_EQ(hostPwmDuty(0), 0);
+  CHECK(!readLEDSnapshot().on[0]);
+  CHECK_EQ(readLEDSnapshot().level[0], 255);
+
+  // An unknown LED changes nothing
+  unsigned long version = readLEDSnapshot().version;
+  CHECK(queueLEDToggle(LED_COUNT + 1));
+  tick();
+  CHECK_EQ(readLEDSnapshot().version, version);
+}
+
+// A long fade runs as hardware fades of one segment each, along the gamma curve
+static void testFade() {
+  start();
+  CHECK(queueLEDFade(1, 255, 1000));
+  tick(0);
+  std::vector<HostPwmEvent> events = hostPwmEvents();
+  CHECK_EQ(events.size(), 1);
+  CHECK_EQ(events[0].fadeMs, LED_FADE_SEGMENT_MS);
+  CHECK_EQ(events[0].duty, ledGamma[255 / 4]);
+
+  run(1100);
+  events = hostPwmEvents();
+  CHECK_EQ(events.size(), 1000 / LED_FADE_SEGMENT_MS);
+  for (const HostPwmEvent &event : events) CHECK_EQ(event.channel, 0);
+  CHECK_EQ(events.back().duty, LED_PWM_MAX);
+  CHECK_EQ(hostPwmDuty(0), LED_PWM_MAX);
+  CHECK_EQ(readLEDSnapshot().level[0], 255);
+}
+
+// A change during a fade starts once the running segment is done
+static void testFadeInterrupted() {
+  start();
+  CHECK(queueLEDFade(1, 255, 1000));
+  tick(0);
+  hostAdvanceMs(100);
+  CHECK(queueLEDFade(1, 0, 0));
+  tick();
+  CHECK_EQ(hostPwmEvents().size(), 1);
+
+  run(LED_FADE_SEGMENT_MS);
+  std::vector<HostPwmEvent> events = hostPwmEvents();
+  CHECK_EQ(events.size(), 2);
+  CHECK_EQ(events.back().duty, 0);
+  CHECK_EQ(events.back().fadeMs, 0);
+  run(1000);
+  CHECK_EQ(hostPwmEvents().size(), 2);
+}
+
+// Slider values in between two passes collapse into the last one
+static void testIntensityMailbox() {
+  start();
+  for (int level = 10; level <= 200; level += 10) postLEDIntensity(2, level);
+  tick();
+  std::vector<HostPwmEvent> events = hostPwmEvents();
+  CHECK_EQ(events.size(), 1);
+  CHECK_EQ(events[0].channel, 1);
+  CHECK_EQ(events[0].duty, ledGamma[200]);
+
+  tick();
+  CHECK_EQ(hostPwmEvents().size(), 1);
+}
+
+static void testScene() {
+  start();
+  CHECK_EQ(findScene("alternate"), 4);
+  CHECK_EQ(findScene("disco"), -1);
+
+  CHECK(queueScene(findScene("alternate")));
+  run(600);
+  CHECK_EQ(hostPwmDuty(0), LED_PWM_MAX);
+  CHECK_EQ(hostPwmDuty(1), 0);
+  CHECK_EQ(readLEDSnapshot().activeScene, 4);
+
+  run(1000);
+  CHECK_EQ(hostPwmDuty(0), 0);
+  CHECK_EQ(hostPwmDuty(1), LED_PWM_MAX);
+
+  run(1000);  // The period restarts the scene
+  CHECK_EQ(hostPwmDuty(0), LED_PWM_MAX);
+
+  // A manual change stops it
+  CHECK(queueLEDToggle(2));
+  run(3000);
+  CHECK_EQ(readLEDSnapshot().activeScene, SCENE_NONE);
+  CHECK_EQ(hostPwmDuty(0), LED_PWM_MAX);
+
+  // A scene without a period ends by itself
+  CHECK(queueScene(findScene("off")));
+  run(1200);
+  CHECK_EQ(readLEDSnapshot().activeScene, SCENE_NONE);
+  CHECK_EQ(hostPwmDuty(0), 0);
+  CHECK_EQ(hostPwmDuty(1), 0);
+}
+
+static void testSchedules() {
+  start();
+  uint16_t once = queueSceneSchedule(findScene("on"), 500, 0);
+  CHECK(once != 0);
+  run(490);
+  CHECK(hostPwmEvents().empty());
+  run(20);
+  CHECK_EQ(hostPwmEvents().size(), LED_COUNT);  // "on" starts fading both LEDs
+  run(1200);
+  CHECK_EQ(hostPwmDuty(0), LED_PWM_MAX);
+
+  // The one-shot slot is free again, the table holds four
+  uint16_t ids[SCHEDULE_CAPACITY];
+  for (uint8_t i = 0; i < SCHEDULE_CAPACITY; i++) {
+    ids[i] = queueSceneSchedule(findScene("off"), 60000, 60000);
+    CHECK(ids[i] != 0);
+  }
+  CHECK_EQ(queueSceneSchedule(findScene("off"), 60000, 0), 0);  // Counted while still queued
+  tick();
+  CHECK_EQ(readLEDSnapshot().schedulesAdded, SCHEDULE_CAPACITY + 1);
+
+  CHECK(queueCancelSchedule(ids[0]));
+  CHECK(!queueCancelSchedule(once));
+  tick();
+  CHECK(queueSceneSchedule(findScene("off"), 60000, 0) != 0);
+}
+
+int main() {
+  RUN(testSetup);
+  RUN(testToggle);
+  RUN(testFade);
+  RUN(testFadeInterrupted);
+  RUN(testIntensityMailbox);
+  RUN(testScene);
+  RUN(testSchedules);
+  return testResult();
+}
@@ -0,0 +1,200 @@
+// Firmware upload, verification and rollback (ota.h)
+
+#include "../ESP32_Web_Server/routes.h"
+#include <host.h>
+#include "test.h"
+
+Preferences preferences;
+AsyncWebServer server(80);
+
+#define BOUNDARY "----hostOtaBoundary"
+
+static std::string adminCookie;
+static std::string viewerCookie;
+
+static std::vector<uint8_t> makeImage(size_t size, uint8_t magic = 0xE9) {
+  std::vector<uint8_t> image(size);
+  for (size_t i = 0; i < size; i++) image[i] = (uint8_t)(i * 31 + 7);
+  image[0] = magic;
+  return image;
+}
+
+static std::string sha256Hex(const std::vector<uint8_t> &data) {
+  uint8_t hash[32];
+  mbedtls_sha256_ret(data.data(), data.size(), hash, 0);
+  char hex[65];
+  for (int i = 0; i < 32; i++) snprintf(hex + i * 2, 3, "%02x", hash[i]);
+  return hex;
+}
+
+static std::string multipart(const std::vector<uint8_t> &image) {
+  return "--" BOUNDARY "\r\nContent-Disposition: form-data; name=\"firmware\"; filename=\"firmware.bin\"\r\n"
+         "Content-Type: application/octet-stream\r\n\r\n" +
+         std::string(image.begin(), image.end()) + "\r\n--" BOUNDARY "--\r\n";
+}
+
+static std::string uploadHeaders(const std::string &cookie) {
+  return "Cookie: " + cookie + "\r\nContent-Type: multipart/form-data; boundary=" BOUNDARY "\r\n";
+}
+
+// POST the image, announcing size and hash, which default to the image's own
+static HostResponse upload(const std::vector<uint8_t> &image, long size = -1, std::string hash = "",
+                           const std::string &cookie = adminCookie) {
+  hostAdvanceMs(1000);  // Stay clear of the rate limit
+  if (size < 0) size = image.size();
+  if (hash.empty()) hash = sha256Hex(image);
+  std::string path = "/update?size=" + std::to_string(size) + "&sha256=" + hash;
+  return hostRequest(server, "POST", path.c_str(), multipart(image), uploadHeaders(cookie));
+}
+
+static std::string status() {
+  return hostRequest(server, "GET", "/update", "", "Cookie: " + adminCookie + "\r\n").body;
+}
+
+static std::string login(IPAddress from) {
+  hostAdvanceMs(2000);
+  HostResponse response = hostRequest(server, "POST", "/login", "username=admin&password=password", "", from);
+  std::string setCookie = response.header("Set-Cookie");
+  return setCookie.substr(0, setCookie.find(';'));
+}
+
+// The sketch's upload state back to idle, the partitions keep what tests wrote
+static void start() {
+  otaStatus = { OTA_IDLE, nullptr, 0, 0, 0, 0, 0, 0 };
+  otaRestartAt = 0;
+  otaRequest = nullptr;
+}
+
+static void testGoodUpload() {
+  start();
+  std::vector<uint8_t> image = makeImage(100000);
+  HostResponse response = upload(image);
+  CHECK_EQ(response.status, 200);
+  CHECK(hostOtaPartition(1) == image);
+  CHECK_EQ(hostOtaBootPartition(), 1);
+  CHECK_CONTAINS(status().c_str(), "\"state\":\"done\",\"error\":null,\"size\":100000,\"bytes\":100000");
+
+  // The restart comes after the delay, from loop()
+  unsigned long restarts = hostRestarts();
+  updateOta();
+  CHECK_EQ(hostRestarts(), restarts);
+  hostAdvanceMs(OTA_RESTART_DELAY_MS);
+  updateOta();
+  CHECK_EQ(hostRestarts(), restarts + 1);
+
+  // No second image until then
+  response = upload(image);
+  CHECK_EQ(response.status, 409);
+}
+
+static void testRejected() {
+  std::vector<uint8_t> image = makeImage(20000);
+  struct {
+    const char *name;
+    std::vector<uint8_t> image;
+    long size;
+    std::string hash;
+    const char *error;
+  } cases[] = {
+    { "no magic", makeImage(20000, 0x00), -1, "", "Flash write failed" },  // esp_ota_write() checks the first byte
+    { "wrong hash", image, -1, sha256Hex(makeImage(20001)), "SHA-256 mismatch" },
+    { "bad hash", image, -1, std::string(64, 'g'), "size and sha256 are required" },
+    { "short", image, 30000, "", "Image shorter than size" },
+    { "long", image, 10000, "", "Image larger than size" },
+    { "too big", image, 0x200000, "", "No OTA partition for an image this size" },
+  };
+  for (auto &test : cases) {
+    start();
+    int bootBefore = hostOtaBootPartition();
+    HostResponse response = upload(test.image, test.size, test.hash);
+    if (response.status != 400) fprintf(stderr, "Case \"%s\":\n", test.name);
+    CHECK_EQ(response.status, 400);
+    CHECK_STR(response.body, test.error);
+    CHECK_EQ(hostOtaBootPartition(), bootBefore);
+    CHECK_CONTAINS(status().c_str(), "\"state\":\"failed\"");
+  }
+}
+
+// Viewers can't write firmware, not even a piece of it
+static void testViewer() {
+  start();
+  std::vector<uint8_t> before = hostOtaPartition(1);
+  HostResponse response = upload(makeImage(5000), -1, "", viewerCookie);
+  CHECK_EQ(response.status, 302);
+  CHECK(hostOtaPartition(1) == before);
+  CHECK_CONTAINS(status().c_str(), "\"state\":\"idle\"");
+}
+
+// A client that goes away mid-upload leaves nothing running
+static void testInterrupted() {
+  start();
+  int bootBefore = hostOtaBootPartition();
+  std::vector<uint8_t> image = makeImage(50000);
+  std::string body = multipart(image);
+  std::string raw = "POST /update?size=50000&sha256=" + sha256Hex(image) + " HTTP/1.1\r\nHost: esp32\r\n" +
+                    uploadHeaders(adminCookie) + "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+  hostAdvanceMs(1000);
+  {
+    HostRequest request(server, raw + body.substr(0, 20000), IPAddress(192, 168, 4, 2));
+    request.poll();
+    CHECK_CONTAINS(status().c_str(), "\"state\":\"receiving\"");
+
+    // Another upload meanwhile is turned away
+    HostResponse busy = upload(makeImage(1000));
+    CHECK_EQ(busy.status, 409);
+    request.close();
+  }
+  CHECK_CONTAINS(status().c_str(), "\"state\":\"failed\",\"error\":\"Upload interrupted\"");
+  CHECK_EQ(hostOtaBootPartition(), bootBefore);
+  CHECK(otaRequest == nullptr);
+
+  CHECK_EQ(upload(image).status, 200);
+  CHECK(hostOtaPartition(1) == image);
+}
+
+// A new image is kept once it ran a minute with every task up, else rolled back
+static void testRollback() {
+  start();
+  hostSetOtaPendingVerify(true);
+  setupOta();
+  CHECK(otaPendingVerify);
+  CHECK_CONTAINS(status().c_str(), "\"pendingVerify\":true");
+
+  unsigned long restarts = hostRestarts();
+  while (millis() < OTA_HEALTH_CHECK_MS) hostAdvanceMs(1000);
+  updateOta();  // The tasks were never started here
+  CHECK(!otaPendingVerify);
+  CHECK_EQ(hostRestarts(), restarts + 1);
+  CHECK_EQ(hostOtaBootPartition(), 1);  // The other partition, the previous image
+
+  hostSetOtaPendingVerify(true);
+  setupOta();
+  for (const TaskInfo &task : TASKS) *task.handle = (TaskHandle_t)&task;
+  updateOta();
+  for (const TaskInfo &task : TASKS) *task.handle = nullptr;
+  CHECK(!otaPendingVerify);
+  CHECK_EQ(hostRestarts(), restarts + 1);
+  esp_ota_img_states_t state;
+  esp_ota_get_state_partition(esp_ota_get_running_partition(), &state);
+  CHECK_EQ(state, ESP_OTA_IMG_VALID);
+}
+
+int main() {
+  hostUseManualClock();
+  hostOnRestart([] {});
+  hostClearPreferences();
+  loadConfig();
+  setupLEDs();
+  setupLEDControl();
+  setupOta();
+  setupRoutes();
+  adminCookie = login(IPAddress(192, 168, 4, 2));
+  viewerCookie = login(IPAddress(192, 168, 1, 50));
+
+  RUN(testGoodUpload);
+  RUN(testRejected);
+  RUN(testViewer);
+  RUN(testInterrupted);
+  RUN(testRollback);
+  return testResult();
+}
@@ -0,0 +1,168 @@
+// Request admission: per-client token buckets and the in-flight cap (rate_limit.h)
+
+#include "../ESP32_Web_Server/routes.h"
+#include <host.h>
+#include "test.h"
+
+Preferences preferences;
+AsyncWebServer server(80);
+
+static std::string adminCookie;
+
+static std::string login(IPAddress from) {
+  hostAdvanceMs(2000);
+  HostResponse response = hostRequest(server, "POST", "/login", "username=admin&password=password", "", from);
+  std::string setCookie = response.header("Set-Cookie");
+  return setCookie.substr(0, setCookie.find(';'));
+}
+
+// Every test starts with the default limits and a full bucket
+static void start() {
+  rateLimitRate = RATE_LIMIT_DEFAULT_RATE;
+  rateLimitBurst = RATE_LIMIT_DEFAULT_BURST;
+  maxInFlightRequests = RATE_LIMIT_DEFAULT_IN_FLIGHT;
+  hostAdvanceMs(10000);
+}
+
+// The burst goes through at once, then one request per refilled token
+static void testBurstAndRefill() {
+  start();
+  IPAddress client(192, 168, 1, 20);
+  for (uint32_t i = 0; i < RATE_LIMIT_DEFAULT_BURST; i++) {
+    CHECK_EQ(hostRequest(server, "GET", "/login", "", "", client).status, 200);
+  }
+  unsigned long limited = rateLimitStats.limited;
+  HostResponse response = hostRequest(server, "GET", "/login", "", "", client);
+  CHECK_EQ(response.status, 429);
+  CHECK_STR(response.header("Retry-After"), "1");
+  CHECK_EQ(rateLimitStats.limited - limited, 1);
+
+  // Another client has its own bucket
+  CHECK_EQ(hostRequest(server, "GET", "/login", "", "", IPAddress(192, 168, 1, 21)).status, 200);
+
+  hostAdvanceMs(1000 / RATE_LIMIT_DEFAULT_RATE);
+  CHECK_EQ(hostRequest(server, "GET", "/login", "", "", client).status, 200);
+  CHECK_EQ(hostRequest(server, "GET", "/login", "", "", client).status, 429);
+
+  // A long pause refills up to the burst and no further
+  hostAdvanceMs(60000);
+  int admitted = 0;
+  for (int i = 0; i < 100; i++) admitted += hostRequest(server, "GET", "/login", "", "", client).status == 200;
+  CHECK_EQ(admitted, RATE_LIMIT_DEFAULT_BURST);
+}
+
+// A client sending 1000 requests over one second gets the burst plus a
+// second's refill
+static void testFlood() {
+  start();
+  uint32_t ip = IPAddress(192, 168, 1, 30);
+  int admitted = 0;
+  for (int i = 0; i < 1000; i++) {
+    admitted += takeRateLimitTokens(ip, 1);
+    hostAdvanceMs(1);
+  }
+  CHECK_EQ(admitted, 59);  // 40 at once, then one every 50 ms up to 950 ms
+}
+
+// A login attempt costs RATE_LIMIT_LOGIN_COST tokens, so guessing is slow
+static void testLoginCost() {
+  start();
+  IPAddress client(192, 168, 1, 40);
+  int attempts = 0;
+  while (hostRequest(server, "POST", "/login", "username=admin&password=wrong", "", client).status != 429) attempts++;
+  CHECK_EQ(attempts, RATE_LIMIT_DEFAULT_BURST / RATE_LIMIT_LOGIN_COST);
+  hostAdvanceMs(RATE_LIMIT_LOGIN_COST * 1000 / RATE_LIMIT_DEFAULT_RATE);
+  CHECK(hostRequest(server, "POST", "/login", "username=admin&password=wrong", "", client).status != 429);
+}
+
+// The table holds RATE_LIMIT_CLIENTS buckets, a new client takes over the
+// least recently used one
+static void testBucketTable() {
+  start();
+  memset(rateLimitBuckets, 0, sizeof(rateLimitBuckets));
+  for (uint32_t i = 0; i < RATE_LIMIT_DEFAULT_BURST; i++) takeRateLimitTokens(IPAddress(10, 0, 0, 1), 1);
+  hostAdvanceMs(1);
+  for (uint32_t i = 0; i < RATE_LIMIT_DEFAULT_BURST; i++) takeRateLimitTokens(IPAddress(10, 0, 0, 2), 1);
+  hostAdvanceMs(1);
+  CHECK(!takeRateLimitTokens(IPAddress(10, 0, 0, 1), 1));  // Touches 10.0.0.1, 10.0.0.2 is now the oldest
+  hostAdvanceMs(1);
+  for (uint8_t i = 0; i < RATE_LIMIT_CLIENTS - 1; i++) {
+    hostAdvanceMs(1);
+    CHECK(takeRateLimitTokens(IPAddress(10, 0, 1, i), 1));
+  }
+  CHECK(!takeRateLimitTokens(IPAddress(10, 0, 0, 1), 1));  // Kept its empty bucket
+  CHECK(takeRateLimitTokens(IPAddress(10, 0, 0, 2), 1));   // Lost its bucket, starts with a full one
+}
+
+// Past the in-flight cap any request is answered 503, until one ends
+static void testInFlight() {
+  start();
+  HostResponse response = hostRequest(server, "POST", "/limits", "max_in_flight=2",
+                                      "Cookie: " + adminCookie + "\r\nContent-Type: application/x-www-form-urlencoded\r\n");
+  CHECK_EQ(response.status, 200);
+  CHECK_CONTAINS(response.body.c_str(), "\"maxInFlight\":2");
+  CHECK_EQ(maxInFlightRequests, 2);
+
+  // /log exports stay in flight while nothing reads the log for them
+  std::string raw = "GET /log HTTP/1.1\r\nHost: esp32\r\nCookie: " + adminCookie + "\r\n\r\n";
+  HostRequest *first = new HostRequest(server, raw);
+  HostRequest second(server, raw);
+  first->poll();
+  second.poll();
+  CHECK_EQ(inFlightRequests, 2);
+
+  unsigned long overloaded = rateLimitStats.overloaded;
+  response = hostRequest(server, "GET", "/login", "", "", IPAddress(192, 168, 1, 50));
+  CHECK_EQ(response.status, 503);
+  CHECK_STR(response.body, "Server Busy");
+  CHECK_EQ(rateLimitStats.overloaded - overloaded, 1);
+
+  delete first;  // The client went away
+  CHECK_EQ(inFlightRequests, 1);
+  CHECK_EQ(hostRequest(server, "GET", "/login", "", "", IPAddress(192, 168, 1, 50)).status, 200);
+  CHECK_EQ(inFlightRequests, 1);
+
+  // Limits that would lock out logins are refused
+  response = hostRequest(server, "POST", "/limits", "burst=5&rate=0",
+                         "Cookie: " + adminCookie + "\r\nContent-Type: application/x-www-form-urlencoded\r\n");
+  CHECK_EQ(rateLimitBurst, RATE_LIMIT_DEFAULT_BURST);
+  CHECK_EQ(rateLimitRate, RATE_LIMIT_DEFAULT_RATE);
+}
+
+// /events only checks the rate, an open stream is not a request in flight
+static void testConnections() {
+  start();
+  IPAddress client(192, 168, 1, 60);
+  std::string cookie = login(client);
+  hostAdvanceMs(10000);
+  std::string raw = "GET /events HTTP/1.1\r\nHost: esp32\r\nAccept: text/event-stream\r\nCookie: " + cookie + "\r\n\r\n";
+  HostRequest stream(server, raw, client);
+  stream.poll();
+  CHECK_EQ(events.count(), 1);
+  CHECK_EQ(inFlightRequests, 0);  // A stream is not a request in flight
+
+  for (uint32_t i = 0; i < RATE_LIMIT_DEFAULT_BURST - 1; i++) takeRateLimitTokens(client, 1);
+  unsigned long limited = rateLimitStats.limited;
+  HostRequest refused(server, raw, client);
+  refused.poll();
+  CHECK_EQ(events.count(), 1);
+  CHECK_EQ(rateLimitStats.limited - limited, 1);
+}
+
+int main() {
+  hostUseManualClock();
+  hostClearPreferences();
+  hostFormatLittleFS();
+  loadConfig();
+  setupLog();
+  setupRoutes();
+  adminCookie = login(IPAddress(192, 168, 4, 2));
+
+  RUN(testBurstAndRefill);
+  RUN(testFlood);
+  RUN(testLoginCost);
+  RUN(testBucketTable);
+  RUN(testInFlight);
+  RUN(testConnections);
+  return testResult();
+}
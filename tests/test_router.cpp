@@ -0,0 +1,135 @@
+// Route table, role checks and login (routes.h, router.h, auth.h)
+
+#include "../ESP32_Web_Server/routes.h"
+#include <host.h>
+#include "test.h"
+
+Preferences preferences;
+AsyncWebServer server(80);
+
+static const IPAddress AP_CLIENT(192, 168, 4, 2);
+static const IPAddress STA_CLIENT(192, 168, 1, 50);
+
+// The session cookie a response sets, without its attributes
+static std::string cookieFrom(const HostResponse &response) {
+  std::string setCookie = response.header("Set-Cookie");
+  return setCookie.substr(0, setCookie.find(';'));
+}
+
+static HostResponse get(const char *path, const std::string &cookie = "", IPAddress from = AP_CLIENT) {
+  hostAdvanceMs(1000);  // Stay clear of the rate limit
+  return hostRequest(server, "GET", path, "", cookie.empty() ? "" : "Cookie: " + cookie + "\r\n", from);
+}
+
+static HostResponse login(const std::string &form, IPAddress from = AP_CLIENT) {
+  hostAdvanceMs(2000);  // A login takes a quarter of the bucket
+  return hostRequest(server, "POST", "/login", form, "", from);
+}
+
+// Every path and method once, and only login, logout and /metrics public
+static void testTable() {
+  for (size_t i = 0; i < ROUTE_COUNT; i++) {
+    for (size_t j = i + 1; j < ROUTE_COUNT; j++) {
+      CHECK(strcmp(ROUTES[i].path, ROUTES[j].path) != 0 || ROUTES[i].method != ROUTES[j].method);
+    }
+    if (ROUTES[i].role == ROLE_NONE) {
+      CHECK(!strcmp(ROUTES[i].path, "/login") || !strcmp(ROUTES[i].path, "/logout") ||
+            !strcmp(ROUTES[i].path, "/metrics"));
+    }
+    CHECK(ROUTES[i].cost >= 1);
+  }
+}
+
+static void testNotLoggedIn() {
+  HostResponse response = get("/");
+  CHECK_EQ(response.status, 302);
+  CHECK_STR(response.header("Location"), "/login");
+
+  response = get("/settings");
+  CHECK_EQ(response.status, 302);
+  CHECK_STR(response.header("Location"), "/login");
+
+  CHECK_EQ(get("/login").status, 200);
+  CHECK_EQ(get("/metrics").status, 200);
+  CHECK_EQ(get("/no-such-page").status, 404);
+}
+
+// A form missing a field, or with wrong values, is a failed login
+static void testFailedLogin() {
+  const char *forms[] = { "", "username=admin", "password=password", "username=admin&password=wrong",
+                          "username=&password=" };
+  for (const char *form : forms) {
+    HostResponse response = login(form);
+    CHECK_EQ(response.status, 302);
+    CHECK_STR(response.header("Location"), "/login?error");
+    CHECK(response.header("Set-Cookie").empty());
+  }
+}
+
+// Clients of the access point are admins, the rest viewers
+static void testRoles() {
+  HostResponse response = login("username=admin&password=password", AP_CLIENT);
+  CHECK_EQ(response.status, 302);
+  CHECK_STR(response.header("Location"), "/settings");
+  std::string admin = cookieFrom(response);
+  CHECK_EQ(admin.size(), strlen(SESSION_COOKIE "=") + SESSION_TOKEN_LENGTH);
+  CHECK_EQ(get("/settings", admin).status, 200);
+  CHECK_EQ(get("/", admin).status, 200);
+
+  response = login("username=admin&password=password", STA_CLIENT);
+  CHECK_STR(response.header("Location"), "/");
+  std::string viewer = cookieFrom(response);
+  CHECK_EQ(get("/", viewer, STA_CLIENT).status, 200);
+  CHECK_EQ(get("/led-state", viewer, STA_CLIENT).status, 200);
+
+  // Too low a role goes back to the dashboard
+  response = get("/settings", viewer, STA_CLIENT);
+  CHECK_EQ(response.status, 302);
+  CHECK_STR(response.header("Location"), "/");
+
+  // Logging in again sends each to their start page
+  hostAdvanceMs(2000);
+  response = hostRequest(server, "POST", "/login", "", "Cookie: " + viewer + "\r\n", STA_CLIENT);
+  CHECK_STR(response.header("Location"), "/");
+  CHECK(response.header("Set-Cookie").empty());
+}
+
+static void testLogout() {
+  std::string cookie = cookieFrom(login("username=admin&password=password"));
+  HostResponse response = get("/logout", cookie);
+  CHECK_EQ(response.status, 302);
+  CHECK_STR(response.header("Location"), "/login");
+  CHECK_CONTAINS(response.header("Set-Cookie").c_str(), "Max-Age=0");
+  CHECK_STR(get("/", cookie).header("Location"), "/login");
+}
+
+// Each route's requests are counted under its own index
+static void testMetrics() {
+  uint8_t index = 0;
+  while (strcmp(ROUTES[index].path, "/led-state") != 0) index++;
+  uint32_t okBefore = routeMetrics[index].statuses[1];
+  uint32_t redirectsBefore = routeMetrics[index].statuses[2];
+
+  std::string cookie = cookieFrom(login("username=admin&password=password"));
+  get("/led-state", cookie);
+  get("/led-state");
+  CHECK_EQ(routeMetrics[index].statuses[1] - okBefore, 1);
+  CHECK_EQ(routeMetrics[index].statuses[2] - redirectsBefore, 1);
+}
+
+int main() {
+  hostUseManualClock();
+  hostClearPreferences();
+  loadConfig();
+  setupLEDs();
+  setupLEDControl();
+  setupRoutes();
+
+  RUN(testTable);
+  RUN(testNotLoggedIn);
+  RUN(testFailedLogin);
+  RUN(testRoles);
+  RUN(testLogout);
+  RUN(testMetrics);
+  return testResult();
+}
@@ -0,0 +1,131 @@
+// Optional sensor drivers and the scheduler running them together
+// (sensor_drivers.h, sensors.h). Built with DS18B20_PIN, BME280_ADDRESS and
+// ADC_SENSOR_PIN defined, see CMakeLists.txt.
+
+#include "../ESP32_Web_Server/events.h"
+#include <host.h>
+#include "test.h"
+
+Preferences preferences;
+AsyncWebServer server(80);
+
+enum { DHT, DS18B20, BME280, ADC };
+
+static void start(bool bme280Present = true) {
+  hostUseManualClock();
+  hostSetDht(21.5f, 40.0f);
+  hostSetDs18b20(19.25f);
+  hostSetBme280(22.75f, 45.5f, 101320.0f, bme280Present);
+  hostSetAnalogMilliVolts(ADC_SENSOR_PIN, 1650);
+  setupSensors();
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) sensorPeriodMs[i] = 0;
+}
+
+static void run(uint32_t ms) {
+  for (uint32_t elapsed = 0; elapsed < ms; elapsed += 10) {
+    updateSensors();
+    hostAdvanceMs(10);
+  }
+}
+
+static void testRegistry() {
+  CHECK_EQ(SENSOR_COUNT, 4);
+  CHECK_STR(SENSORS[DHT]->name, "dht22");
+  CHECK_STR(SENSORS[DS18B20]->name, "ds18b20");
+  CHECK_STR(SENSORS[BME280]->name, "bme280");
+  CHECK_STR(SENSORS[ADC]->name, "adc");
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) CHECK(SENSORS[i]->valueCount <= SENSOR_MAX_VALUES);
+}
+
+// One sensor is read per pass, the one that has waited longest
+static void testOneReadPerPass() {
+  start();
+  HostSensorReads before = hostSensorReads();
+  updateSensors();
+  HostSensorReads after = hostSensorReads();
+  CHECK_EQ((after.dht - before.dht) + (after.bme280 - before.bme280) + (after.analog - before.analog), 1);
+
+  run(30);
+  after = hostSensorReads();
+  CHECK_EQ(after.dht - before.dht, 1);
+  CHECK_EQ(after.bme280 - before.bme280, 1);
+  CHECK(after.analog - before.analog >= 1);
+}
+
+// The conversion runs while the others are read, the value is fetched once it is done
+static void testDs18b20Conversion() {
+  start();
+  unsigned long readsBefore = hostSensorReads().ds18b20;
+  run(740);
+  CHECK(hostSensorReads().ds18b20Requests > 0);
+  CHECK_EQ(hostSensorReads().ds18b20, readsBefore);
+  CHECK(!readSensorSnapshot().readings[DS18B20].valid);
+
+  run(30);
+  SensorSnapshot snapshot = readSensorSnapshot();
+  CHECK(snapshot.readings[DS18B20].valid);
+  CHECK(snapshot.readings[DS18B20].values[0] == 19.25f);
+
+  // One conversion per period
+  unsigned long requestsBefore = hostSensorReads().ds18b20Requests;
+  run(20000);
+  CHECK_EQ(hostSensorReads().ds18b20Requests - requestsBefore, 20000 / SENSORS[DS18B20]->periodMs);
+
+  hostSetDs18b20(NAN);
+  run(SENSORS[DS18B20]->periodMs + 1000);
+  CHECK(!readSensorSnapshot().readings[DS18B20].valid);
+}
+
+static void testBme280() {
+  start();
+  run(100);
+  SensorSnapshot snapshot = readSensorSnapshot();
+  CHECK(snapshot.readings[BME280].valid);
+  CHECK(snapshot.readings[BME280].values[0] == 22.75f);
+  CHECK(snapshot.readings[BME280].values[1] == 45.5f);
+  CHECK(fabsf(snapshot.readings[BME280].values[2] - 1013.2f) < 0.01f);
+
+  // Missing at begin() it stays failed, the others go on
+  start(false);
+  run(100);
+  snapshot = readSensorSnapshot();
+  CHECK(!snapshot.readings[BME280].valid);
+  CHECK_EQ(snapshot.stats[BME280].failures, 1);
+  CHECK(snapshot.readings[DHT].valid);
+  CHECK(snapshot.readings[ADC].valid);
+}
+
+static void testAdc() {
+  start();
+  run(100);
+  CHECK(fabsf(readSensorSnapshot().readings[ADC].values[0] - 1.65f) < 0.001f);
+}
+
+// Each sensor is one object with its own number of values
+static void testSensorData() {
+  start();
+  run(1000);
+  JsonBuffer<1024> buffer;
+  JsonWriter json(buffer);
+  writeSensorData(json, readSensorSnapshot());
+  CHECK(!buffer.overflow());
+  CHECK_CONTAINS(buffer.c_str(), "\"values\":[21.5,40.0]}");
+  CHECK_CONTAINS(buffer.c_str(), "\"values\":[19.25]}");
+  CHECK_CONTAINS(buffer.c_str(), "\"values\":[22.75,45.5,1013.2]}");
+  CHECK_CONTAINS(buffer.c_str(), "\"values\":[1.650]}]}");
+
+  // The /events buffer is sized for every registered sensor
+  EventBuffer event;
+  formatSensorEvent(event, readSensorSnapshot());
+  CHECK(!event.overflow());
+}
+
+int main() {
+  RUN(testRegistry);
+  RUN(testOneReadPerPass);
+  RUN(testDs18b20Conversion);
+  RUN(testBme280);
+  RUN(testAdc);
+  RUN(testSensorData);
+  return testResult();
+}
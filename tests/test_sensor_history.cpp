@@ -0,0 +1,114 @@
+// History ring buffer and the /sensor_history stream (sensor_history.h)
+
+#include "../ESP32_Web_Server/sensor_history.h"
+#include <host.h>
+#include "test.h"
+
+static AsyncWebServer server(80);
+
+static void clearHistory() {
+  historyHead = 0;
+  historyCount = 0;
+  historyHeadTime = 0;
+  historyLastTime = 0;
+  historyStart.publish({ 0, 0 });
+}
+
+static HostResponse getHistory(const char *query) {
+  std::string path = std::string("/sensor_history") + query;
+  return hostRequest(server, "GET", path.c_str());
+}
+
+static size_t countBuckets(const std::string &body) {
+  size_t buckets = 0;
+  for (size_t at = body.find("[", 1); at != std::string::npos; at = body.find("[", at + 1)) buckets++;
+  return buckets - 1;  // The array holding them
+}
+
+static void testEmpty() {
+  clearHistory();
+  HostResponse response = getHistory("");
+  CHECK_EQ(response.status, 200);
+  CHECK(response.complete);
+  CHECK_STR(response.header("Transfer-Encoding"), "chunked");
+  CHECK_CONTAINS(response.body.c_str(), "\"step\":60000,\"buckets\":[]}");
+}
+
+// Min, average and max per bucket, from centi-unit samples
+static void testBuckets() {
+  clearHistory();
+  recordSensorHistory(20.0f, 40.0f, 10000);
+  recordSensorHistory(21.0f, 42.0f, 12000);
+  recordSensorHistory(23.0f, 41.0f, 14000);
+  recordSensorHistory(25.5f, 50.25f, 20000);
+
+  HostResponse response = getHistory("?step=10000");
+  CHECK_CONTAINS(response.body.c_str(), "[10000,3,20.00,21.33,23.00,40.00,41.00,42.00]");
+  CHECK_CONTAINS(response.body.c_str(), ",[20000,1,25.50,25.50,25.50,50.25,50.25,50.25]]}");
+
+  // since skips older samples, and a step below the minimum is raised to it
+  response = getHistory("?since=12000&step=10");
+  CHECK_CONTAINS(response.body.c_str(), "\"step\":1000,");
+  CHECK_CONTAINS(response.body.c_str(), "[[12000,1,21.00");
+  CHECK_EQ(countBuckets(response.body), 3);
+}
+
+// A full buffer drops the oldest sample and moves the base time with it
+static void testWrap() {
+  clearHistory();
+  for (uint32_t i = 0; i < HISTORY_CAPACITY + 100; i++) recordSensorHistory(20.0f, 40.0f, 1000 + i * 2000);
+  CHECK_EQ(historyCount.load(), HISTORY_CAPACITY);
+  CHECK_EQ(historyHead.load(), 100);
+  CHECK_EQ(historyHeadTime, 1000 + 100 * 2000);
+
+  HistoryStart start;
+  historyStart.read(start);
+  CHECK_EQ(start.seq, 100);
+  CHECK_EQ(start.time, 1000 + 100 * 2000);
+
+  HostResponse response = getHistory("?step=2000");
+  CHECK(response.complete);
+  CHECK_EQ(countBuckets(response.body), HISTORY_CAPACITY);
+  CHECK_CONTAINS(response.body.c_str(), "[[200000,1,");
+}
+
+// A gap longer than a delta can hold is clamped, not wrapped
+static void testLongGap() {
+  clearHistory();
+  recordSensorHistory(20.0f, 40.0f, 1000);
+  recordSensorHistory(20.0f, 40.0f, 1000 + 10000000);
+  CHECK_EQ(historySamples[1].delta, HISTORY_MAX_DELTA);
+}
+
+// Samples overwritten under a running response end it early, still as JSON
+static void testOverwrittenWhileStreaming() {
+  clearHistory();
+  for (uint32_t i = 0; i < HISTORY_CAPACITY; i++) recordSensorHistory(20.0f, 40.0f, 1000 + i * 2000);
+
+  HostRequest request(server, "GET /sensor_history?step=1000 HTTP/1.1\r\nHost: esp32\r\n\r\n");
+  request.poll();  // The first pieces are out, the rest not yet produced
+  for (uint32_t i = 0; i < HISTORY_CAPACITY; i++) {
+    recordSensorHistory(30.0f, 50.0f, 1000 + (HISTORY_CAPACITY + i) * 2000);
+  }
+  for (int i = 0; i < 100 && !request.poll(); i++) {}
+
+  HostResponse response = hostParseResponse(request.output);
+  CHECK(response.complete);
+  size_t buckets = countBuckets(response.body);
+  CHECK(buckets > 0 && buckets < HISTORY_CAPACITY);
+  CHECK(response.body.compare(response.body.size() - 3, 3, "]]}") == 0);
+  CHECK(response.body.find("30.00") == std::string::npos);
+}
+
+int main() {
+  server.on("/sensor_history", HTTP_GET, [](AsyncWebServerRequest *request) {
+    handleSensorHistory({ request, nullptr });
+  });
+
+  RUN(testEmpty);
+  RUN(testBuckets);
+  RUN(testWrap);
+  RUN(testLongGap);
+  RUN(testOverwrittenWhileStreaming);
+  return testResult();
+}
@@ -0,0 +1,376 @@
+// Sensor log on LittleFS and the /log export (sensor_log.h), on the RAM
+// file system of the host build
+
+#include "../ESP32_Web_Server/routes.h"
+#include <host.h>
+#include "test.h"
+
+Preferences preferences;
+AsyncWebServer server(80);
+
+#define T0 1700000000UL  // Unix seconds of the first test reading
+
+static std::string viewerCookie;
+
+// The persistence task starting again, as after a reset
+static void reboot() {
+  if (logSegmentOpen) logFile.close();
+  logSegmentOpen = false;
+  logReady = false;
+  logIndex = {};
+  setupLog();
+}
+
+static void login() {
+  hostAdvanceMs(2000);
+  HostResponse response =
+    hostRequest(server, "POST", "/login", "username=admin&password=password", "", IPAddress(192, 168, 1, 50));
+  std::string setCookie = response.header("Set-Cookie");
+  viewerCookie = setCookie.substr(0, setCookie.find(';'));
+}
+
+// An empty log with a segment open for readings, and a viewer logged in
+static void start() {
+  login();
+  hostFailLittleFSWrites(false);
+  hostFailLittleFSRemoves(false);
+  hostFormatLittleFS();
+  reboot();
+  CHECK(openLogSegment(true));
+}
+
+// One DHT22 reading per ten seconds, values that change a little each time
+static void appendReadings(uint32_t first, uint32_t count) {
+  for (uint32_t i = first; i < first + count; i++) {
+    float values[SENSOR_MAX_VALUES] = { 20.0f + (i % 50) * 0.1f, 60.0f - (i % 40) * 0.5f };
+    appendLogRecord(0, T0 + i * 10, values);
+  }
+}
+
+static std::string row(uint32_t i, uint16_t boot = 0) {
+  char line[64];
+  snprintf(line, sizeof(line), "%lu,%u,dht22,%.1f,%.1f\n", T0 + i * 10UL, boot, 20.0 + (i % 50) * 0.1,
+           60.0 - (i % 40) * 0.5);
+  return line;
+}
+
+static std::string rows(uint32_t first, uint32_t count, uint16_t boot = 0) {
+  std::string text;
+  for (uint32_t i = first; i < first + count; i++) text += row(i, boot);
+  return text;
+}
+
+// Polls the response and runs the persistence task's side in turn
+static HostResponse exportLog(const std::string &query) {
+  hostAdvanceMs(1000);  // Stay clear of the rate limit
+  std::string raw = "GET /log" + query + " HTTP/1.1\r\nHost: esp32\r\nCookie: " + viewerCookie + "\r\n\r\n";
+  HostResponse response;
+  {
+    HostRequest request(server, raw, IPAddress(192, 168, 1, 50));
+    for (int i = 0; i < 100000 && !request.poll(); i++) updateLogExports();
+    response = hostParseResponse(request.output);
+  }
+  updateLogExports();  // Frees the export
+  return response;
+}
+
+static std::string readFile(uint32_t sequence) {
+  char path[24];
+  logSegmentPath(path, sizeof(path), sequence);
+  File file = logFS->open(path, FILE_READ);
+  std::string data(file.size(), '\0');
+  file.read((uint8_t *)&data[0], data.size());
+  return data;
+}
+
+static void writeFile(uint32_t sequence, const std::string &data) {
+  char path[24];
+  logSegmentPath(path, sizeof(path), sequence);
+  File file = logFS->open(path, FILE_WRITE);
+  file.write((const uint8_t *)data.data(), data.size());
+  file.close();
+}
+
+static void testEncoding() {
+  uint8_t buffer[5];
+  size_t pos = 0;
+  uint32_t value;
+  CHECK_EQ(putVarint(buffer, 300), 2);
+  CHECK(getVarint(buffer, 2, pos, value));
+  CHECK_EQ(value, 300);
+  CHECK_EQ(putVarint(buffer, UINT32_MAX), 5);
+  pos = 0;
+  CHECK(!getVarint(buffer, 4, pos, value));  // Cut short
+
+  CHECK_EQ(zigzag(0), 0);
+  CHECK_EQ(zigzag(-1), 1);
+  CHECK_EQ(zigzag(1), 2);
+  CHECK_EQ(unzigzag(zigzag(-123456)), -123456);
+  CHECK_EQ(unzigzag(zigzag(INT32_MIN)), INT32_MIN);
+}
+
+// What goes in comes out as CSV, and a range returns just its rows
+static void testRoundTrip() {
+  start();
+  appendReadings(0, 200);
+  writeLogBatch();
+  LogIndex index = readLogIndex();
+  CHECK_EQ(index.count, 1);
+  CHECK(index.batchesWritten > 1);  // Records are a few bytes each, dozens to a batch
+  CHECK_EQ(index.segments[0].firstTime, T0);
+  CHECK_EQ(index.segments[0].lastTime, T0 + 1990);
+  CHECK_EQ(index.totalBytes, readFile(1).size());
+
+  HostResponse response = exportLog("");
+  CHECK_EQ(response.status, 200);
+  CHECK_STR(response.header("Content-Type"), "text/csv");
+  CHECK_STR(response.body, "time,boot,sensor,values\n" + rows(0, 200));
+
+  std::string query = "?from=" + std::to_string(T0 + 500) + "&to=" + std::to_string(T0 + 1000);
+  CHECK_STR(exportLog(query).body, "time,boot,sensor,values\n" + rows(50, 51));
+
+  query = "?to=" + std::to_string(T0 - 1);
+  CHECK_STR(exportLog(query).body, "time,boot,sensor,values\n");
+}
+
+// The binary export is the segment file as stored
+static void testBinary() {
+  start();
+  appendReadings(0, 200);
+  writeLogBatch();
+  HostResponse response = exportLog("?format=binary");
+  CHECK_STR(response.header("Content-Type"), "application/octet-stream");
+  CHECK(response.body == readFile(1));
+}
+
+// A reset loses the batch being filled, the index is rebuilt from the
+// files and the next boot gets its own segment
+static void testReboot() {
+  start();
+  appendReadings(0, 100);
+  writeLogBatch();
+  appendReadings(100, 5);
+  reboot();
+  CHECK_EQ(logBoot, 1);
+  LogIndex index = readLogIndex();
+  CHECK_EQ(index.count, 1);
+  CHECK_EQ(index.segments[0].lastTime, T0 + 990);
+
+  CHECK(openLogSegment(true));
+  appendReadings(200, 10);
+  writeLogBatch();
+  CHECK_EQ(readLogIndex().count, 2);
+  CHECK_STR(exportLog("").body, "time,boot,sensor,values\n" + rows(0, 100) + rows(200, 10, 1));
+}
+
+// A damaged batch is skipped, a batch cut short ends its segment
+static void testDamage() {
+  start();
+  appendReadings(0, 200);
+  writeLogBatch();
+  std::string full = exportLog("").body;
+  std::string file = readFile(1);
+
+  // Flip a byte in the second batch's payload
+  LogBatchHeader first;
+  memcpy(&first, file.data() + sizeof(LogSegmentHeader), sizeof(first));
+  size_t second = sizeof(LogSegmentHeader) + sizeof(LogBatchHeader) + first.length;
+  LogBatchHeader header;
+  memcpy(&header, file.data() + second, sizeof(header));
+  std::string damaged = file;
+  damaged[second + sizeof(LogBatchHeader) + 3] ^= 0x40;
+  writeFile(1, damaged);
+  reboot();
+
+  uint32_t crcErrors = logCrcErrors;
+  std::string body = exportLog("").body;
+  CHECK_EQ(logCrcErrors - crcErrors, 1);
+  CHECK_STR(body, "time,boot,sensor,values\n" + rows(0, first.count) + rows(first.count + header.count, 200 - first.count - header.count));
+
+  // Cut into the last batch, as a reset during its write would
+  writeFile(1, file.substr(0, file.size() - 10));
+  reboot();
+  LogIndex index = readLogIndex();
+  CHECK_EQ(index.count, 1);
+  CHECK(index.segments[0].size < file.size() - 10);
+  body = exportLog("").body;
+  CHECK(body.size() < full.size());
+  CHECK_STR(body, full.substr(0, body.size()));
+
+  // A segment whose header is damaged is removed
+  damaged = file;
+  damaged[0] ^= 1;
+  writeFile(1, damaged);
+  reboot();
+  CHECK_EQ(readLogIndex().count, 0);
+  CHECK(!logFS->exists("/log/00000001"));
+}
+
+static size_t filesInLog() {
+  size_t count = 0;
+  File dir = logFS->open(LOG_DIR);
+  for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) count++;
+  return count;
+}
+
+// The oldest segments go once the log reaches LOG_MAX_BYTES, an export
+// reading one of them goes on with the next
+static void testEviction() {
+  start();
+  uint32_t written = 0;
+  while (readLogIndex().evicted < 3) {
+    appendReadings(written, 1000);
+    written += 1000;
+  }
+  writeLogBatch();
+  LogIndex index = readLogIndex();
+  CHECK(index.totalBytes <= LOG_MAX_BYTES);
+  CHECK(index.totalBytes + LOG_SEGMENT_SIZE > LOG_MAX_BYTES);
+  CHECK_EQ(index.segments[0].sequence, 4);
+  CHECK_EQ(filesInLog(), index.count);
+  CHECK(!logFS->exists("/log/00000003"));
+
+  // An export part way through the oldest segment
+  uint32_t oldestFirst = (index.segments[0].firstTime - T0) / 10;
+  uint32_t oldestLast = (index.segments[0].lastTime - T0) / 10;
+  uint32_t nextFirst = (index.segments[1].firstTime - T0) / 10;
+  std::string raw = "GET /log HTTP/1.1\r\nHost: esp32\r\nCookie: " + viewerCookie + "\r\n\r\n";
+  std::string body;
+  {
+    hostAdvanceMs(1000);
+    HostRequest request(server, raw, IPAddress(192, 168, 1, 50));
+    request.poll();
+    updateLogExports();  // Reads the first LOG_EXPORT_AHEAD batches
+    CHECK(evictLogSegment());
+    for (int i = 0; i < 100000 && !request.poll(); i++) updateLogExports();
+    body = hostParseResponse(request.output).body;
+  }
+  updateLogExports();
+  CHECK_STR(body.substr(0, 24 + row(oldestFirst).size()), "time,boot,sensor,values\n" + row(oldestFirst));
+  CHECK(body.find(row(oldestLast)) == std::string::npos);
+  CHECK(body.find(rows(nextFirst, written - nextFirst)) != std::string::npos);  // The rest of the log, whole
+}
+
+// A delete that fails keeps the segment and its bytes, and no new segment
+// starts until there is room
+static void testEvictFailure() {
+  start();
+  uint32_t written = 0;
+  while (readLogIndex().totalBytes + LOG_SEGMENT_SIZE <= LOG_MAX_BYTES) {
+    appendReadings(written, 1000);
+    written += 1000;
+  }
+  writeLogBatch();
+  LogIndex before = readLogIndex();
+
+  hostFailLittleFSRemoves(true);
+  CHECK(!openLogSegment(true));
+  LogIndex index = readLogIndex();
+  CHECK_EQ(index.evictFailures - before.evictFailures, 1);
+  CHECK_EQ(index.count, before.count);
+  CHECK_EQ(index.totalBytes, before.totalBytes);
+  CHECK_EQ(filesInLog(), index.count);
+
+  // Readings meanwhile are dropped, not written past the budget
+  hostAdvanceMs(5000);
+  sensorStates[0].reading = { { 21.0f, 50.0f }, millis(), true };
+  publishSensorSnapshot();
+  updateLog();
+  CHECK(!logSegmentOpen);
+  CHECK_EQ(readLogIndex().totalBytes, before.totalBytes);
+
+  // The next reading retries and succeeds
+  hostFailLittleFSRemoves(false);
+  hostAdvanceMs(5000);
+  sensorStates[0].reading.timestamp = millis();
+  publishSensorSnapshot();
+  updateLog();
+  CHECK(logSegmentOpen);
+  index = readLogIndex();
+  CHECK_EQ(index.evicted - before.evicted, 1);
+  CHECK(index.totalBytes <= LOG_MAX_BYTES);
+  CHECK_EQ(filesInLog(), index.count);
+}
+
+// A failed write loses its batch and closes the segment, the log goes on after
+static void testWriteFailure() {
+  start();
+  appendReadings(0, 10);
+  hostFailLittleFSWrites(true);
+  writeLogBatch();
+  CHECK_EQ(readLogIndex().writeFailures, 1);
+  CHECK(!logSegmentOpen);
+  CHECK(!openLogSegment(true));
+  CHECK_EQ(readLogIndex().writeFailures, 2);
+
+  hostFailLittleFSWrites(false);
+  CHECK(openLogSegment(true));
+  appendReadings(10, 10);
+  writeLogBatch();
+  CHECK_STR(exportLog("").body, "time,boot,sensor,values\n" + rows(10, 10));
+}
+
+// Readings reach the log through updateLog(), a partial batch is written
+// once it is old enough
+static void testUpdateLog() {
+  start();
+  hostSetDht(22.5f, 55.0f);
+  setupSensors();
+  for (int i = 0; i < 30; i++) {
+    updateSensors();
+    updateLog();
+    hostAdvanceMs(SENSORS[0]->periodMs);
+  }
+  CHECK_EQ(readLogIndex().batchesWritten, 0);
+  CHECK(logBatch.header.count >= 20);
+
+  hostAdvanceMs(LOG_MAX_BATCH_AGE_MS);
+  updateLog();
+  CHECK_EQ(readLogIndex().batchesWritten, 1);
+  login();  // The session ran out meanwhile
+  std::string body = exportLog("").body;
+  CHECK_CONTAINS(body.c_str(), ",0,dht22,22.5,55.0\n");
+}
+
+// Two exports at a time, a third is turned away until one is done
+static void testExportSlots() {
+  start();
+  appendReadings(0, 10);
+  writeLogBatch();
+  std::string raw = "GET /log HTTP/1.1\r\nHost: esp32\r\nCookie: " + viewerCookie + "\r\n\r\n";
+  hostAdvanceMs(1000);
+  HostRequest *first = new HostRequest(server, raw, IPAddress(192, 168, 1, 50));
+  HostRequest second(server, raw, IPAddress(192, 168, 1, 51));
+  first->poll();
+  second.poll();
+  CHECK_EQ(exportLog("").status, 503);
+
+  delete first;
+  updateLogExports();
+  CHECK_EQ(exportLog("").status, 200);
+
+  logReady = false;
+  HostResponse response = exportLog("");
+  CHECK_EQ(response.status, 503);
+  CHECK_STR(response.body, "Sensor log not mounted");
+  logReady = true;
+}
+
+int main() {
+  hostUseManualClock();
+  hostClearPreferences();
+  loadConfig();
+  setupRoutes();
+
+  RUN(testEncoding);
+  RUN(testRoundTrip);
+  RUN(testBinary);
+  RUN(testReboot);
+  RUN(testDamage);
+  RUN(testEviction);
+  RUN(testEvictFailure);
+  RUN(testWriteFailure);
+  RUN(testUpdateLog);
+  RUN(testExportSlots);
+  return testResult();
+}
@@ -0,0 +1,119 @@
+// Sensor scheduler and cache (sensors.h)
+
+#include "../ESP32_Web_Server/sensors.h"
+#include <host.h>
+#include "test.h"
+
+static void start() {
+  hostUseManualClock();
+  hostSetDht(21.5f, 40.0f);
+  setupSensors();
+  for (uint8_t i = 0; i < SENSOR_COUNT; i++) sensorPeriodMs[i] = 0;
+}
+
+// Reading the cache never reads the sensor, only the scheduler does
+static void testCachedReads() {
+  start();
+  unsigned long readsBefore = hostSensorReads().dht;
+  updateSensors();
+  CHECK_EQ(hostSensorReads().dht - readsBefore, 1);
+
+  SensorSnapshot snapshot = readSensorSnapshot();
+  CHECK(snapshot.readings[0].valid);
+  CHECK(snapshot.readings[0].values[0] == 21.5f);
+  CHECK(snapshot.readings[0].values[1] == 40.0f);
+
+  for (int i = 0; i < 1000; i++) readSensorSnapshot();
+  CHECK_EQ(hostSensorReads().dht - readsBefore, 1);
+}
+
+// One read per period of the driver, however often the I/O task runs
+static void testDriverPeriod() {
+  start();
+  unsigned long readsBefore = hostSensorReads().dht;
+  for (int tick = 0; tick < 1000; tick++) {  // 10 s in I/O task ticks
+    updateSensors();
+    hostAdvanceMs(10);
+  }
+  CHECK_EQ(hostSensorReads().dht - readsBefore, 10000 / SENSORS[0]->periodMs);
+}
+
+static void testSetPeriod() {
+  start();
+  CHECK(!setSensorPeriod(SENSOR_COUNT, 5000));
+
+  // Faster than the part can go is clamped to the driver's period
+  CHECK(setSensorPeriod(0, 100));
+  CHECK_EQ(sensorPeriodMs[0].load(), SENSORS[0]->periodMs);
+
+  CHECK(setSensorPeriod(0, 5000));
+  unsigned long readsBefore = hostSensorReads().dht;
+  for (int tick = 0; tick < 2000; tick++) {  // 20 s
+    updateSensors();
+    hostAdvanceMs(10);
+  }
+  CHECK_EQ(hostSensorReads().dht - readsBefore, 4);
+
+  // A shorter period applies from the next start, without waiting out the old one
+  CHECK(setSensorPeriod(0, 0));
+  readsBefore = hostSensorReads().dht;
+  for (int tick = 0; tick < 500; tick++) {  // 5 s
+    updateSensors();
+    hostAdvanceMs(10);
+  }
+  CHECK(hostSensorReads().dht - readsBefore >= 2);
+}
+
+// The version only moves when a value or the validity changes
+static void testVersion() {
+  start();
+  updateSensors();
+  unsigned long version = readSensorSnapshot().version;
+
+  hostAdvanceMs(SENSORS[0]->periodMs);
+  updateSensors();
+  CHECK_EQ(readSensorSnapshot().version, version);
+
+  hostSetDht(22.0f, 40.0f);
+  hostAdvanceMs(SENSORS[0]->periodMs);
+  updateSensors();
+  CHECK_EQ(readSensorSnapshot().version, version + 1);
+}
+
+// A failed read flags the cache but keeps the last good values
+static void testFailedRead() {
+  start();
+  updateSensors();
+  unsigned long version = readSensorSnapshot().version;
+
+  hostSetDht(NAN, NAN);
+  hostAdvanceMs(SENSORS[0]->periodMs);
+  updateSensors();
+  SensorSnapshot snapshot = readSensorSnapshot();
+  CHECK(!snapshot.readings[0].valid);
+  CHECK(snapshot.readings[0].values[0] == 21.5f);
+  CHECK_EQ(snapshot.stats[0].failures, 1);
+  CHECK_EQ(snapshot.version, version + 1);
+
+  hostSetDht(21.5f, 40.0f);
+  hostAdvanceMs(SENSORS[0]->periodMs);
+  updateSensors();
+  CHECK(readSensorSnapshot().readings[0].valid);
+}
+
+static void testSampleAge() {
+  start();
+  updateSensors();
+  hostAdvanceMs(1234);
+  CHECK_EQ(sensorSampleAge(readSensorSnapshot().readings[0]), 1234);
+}
+
+int main() {
+  RUN(testCachedReads);
+  RUN(testDriverPeriod);
+  RUN(testSetPeriod);
+  RUN(testVersion);
+  RUN(testFailedRead);
+  RUN(testSampleAge);
+  return testResult();
+}
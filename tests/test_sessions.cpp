@@ -0,0 +1,108 @@
+// Session table and cookie tokens (sessions.h)
+
+#include "../ESP32_Web_Server/sessions.h"
+#include <host.h>
+#include "test.h"
+
+static AsyncWebServer server(80);
+
+// Status of a request carrying cookies: 200 with a session, 401 without
+static int statusWith(const std::string &cookies) {
+  std::string headers = cookies.empty() ? "" : "Cookie: " + cookies + "\r\n";
+  return hostRequest(server, "GET", "/whoami", "", headers).status;
+}
+
+static std::string newSession(Role role = ROLE_VIEWER) {
+  char token[SESSION_TOKEN_LENGTH + 1];
+  createSession(role, token);
+  return token;
+}
+
+static void clearSessions() {
+  for (uint16_t i = 0; i < SESSION_CAPACITY; i++) removeSession(&sessions[i]);
+}
+
+static void testToken() {
+  clearSessions();
+  std::string token = newSession();
+  CHECK_EQ(token.size(), SESSION_TOKEN_LENGTH);
+  CHECK_STR(token.substr(0, 2), "00");
+  CHECK_EQ(activeSessionCount(), 1);
+  CHECK_EQ(statusWith(SESSION_COOKIE "=" + token), 200);
+}
+
+static void testCookieParsing() {
+  clearSessions();
+  std::string token = newSession();
+  CHECK_EQ(statusWith(""), 401);
+  CHECK_EQ(statusWith("theme=dark; " SESSION_COOKIE "=" + token), 200);
+  CHECK_EQ(statusWith(SESSION_COOKIE "=" + token + "; theme=dark"), 200);
+
+  // Another cookie ending in the name, a cut token, non-hex digits
+  CHECK_EQ(statusWith("old" SESSION_COOKIE "=" + token), 401);
+  CHECK_EQ(statusWith(SESSION_COOKIE "=" + token.substr(0, SESSION_TOKEN_LENGTH - 1)), 401);
+  std::string upper = token;
+  for (char &c : upper) c = toupper(c);
+  if (upper != token) CHECK_EQ(statusWith(SESSION_COOKIE "=" + upper), 401);
+
+  // An empty slot and a secret of another slot
+  CHECK_EQ(statusWith(SESSION_COOKIE "=ff" + token.substr(2)), 401);
+  CHECK_EQ(statusWith(SESSION_COOKIE "=01" + token.substr(2)), 401);
+  CHECK_EQ(statusWith(SESSION_COOKIE "=000000000000000000"), 401);
+}
+
+// Idle sessions expire, use pushes the expiry out
+static void testExpiry() {
+  clearSessions();
+  std::string cookie = SESSION_COOKIE "=" + newSession();
+  hostAdvanceMs(SESSION_TIMEOUT_MS - 1000);
+  CHECK_EQ(statusWith(cookie), 200);
+  hostAdvanceMs(SESSION_TIMEOUT_MS - 1000);
+  CHECK_EQ(statusWith(cookie), 200);
+  hostAdvanceMs(SESSION_TIMEOUT_MS);
+  CHECK_EQ(statusWith(cookie), 401);
+  CHECK_EQ(activeSessionCount(), 0);
+}
+
+// A full table gives the least recently seen slot to the new session
+static void testFullTable() {
+  clearSessions();
+  std::string tokens[SESSION_CAPACITY];
+  for (uint16_t i = 0; i < SESSION_CAPACITY; i++) {
+    tokens[i] = newSession();
+    hostAdvanceMs(10);
+  }
+  CHECK_EQ(activeSessionCount(), SESSION_CAPACITY);
+  CHECK_EQ(statusWith(SESSION_COOKIE "=" + tokens[0]), 200);  // Slot 1 is now the oldest
+
+  std::string newest = newSession();
+  CHECK_STR(newest.substr(0, 2), "01");
+  CHECK_EQ(activeSessionCount(), SESSION_CAPACITY);
+  CHECK_EQ(statusWith(SESSION_COOKIE "=" + tokens[1]), 401);
+  CHECK_EQ(statusWith(SESSION_COOKIE "=" + tokens[0]), 200);
+  CHECK_EQ(statusWith(SESSION_COOKIE "=" + newest), 200);
+}
+
+static void testRemove() {
+  clearSessions();
+  std::string token = newSession(ROLE_ADMIN);
+  CHECK_EQ(sessions[0].role, ROLE_ADMIN);
+  removeSession(&sessions[0]);
+  removeSession(nullptr);
+  CHECK_EQ(statusWith(SESSION_COOKIE "=" + token), 401);
+  CHECK_EQ(activeSessionCount(), 0);
+}
+
+int main() {
+  hostUseManualClock();
+  server.on("/whoami", HTTP_GET, [](AsyncWebServerRequest *request) {
+    request->send(findSession(request) ? 200 : 401);
+  });
+
+  RUN(testToken);
+  RUN(testCookieParsing);
+  RUN(testExpiry);
+  RUN(testFullTable);
+  RUN(testRemove);
+  return testResult();
+}
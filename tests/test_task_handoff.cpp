@@ -0,0 +1,121 @@
+// Lock-free handoff between tasks (spsc_queue.h, snapshot.h), run on
+// real threads
+
+#include "../ESP32_Web_Server/snapshot.h"
+#include "../ESP32_Web_Server/spsc_queue.h"
+#include <host.h>
+#include <thread>
+#include "test.h"
+
+static void testQueueFull() {
+  SpscQueue<int, 4> queue;
+  CHECK_EQ(queue.space(), 3);
+  CHECK(queue.push(1));
+  CHECK(queue.push(2));
+  CHECK(queue.push(3));
+  CHECK(!queue.push(4));
+  CHECK_EQ(queue.space(), 0);
+
+  int item = 0;
+  CHECK(queue.pop(item));
+  CHECK_EQ(item, 1);
+  CHECK_EQ(queue.space(), 1);
+}
+
+// Indices wrap many times over without losing or reordering items
+static void testQueueWrap() {
+  SpscQueue<int, 4> queue;
+  int next = 0;
+  int expected = 0;
+  for (int round = 0; round < 100; round++) {
+    while (queue.push(next)) next++;
+    int item;
+    for (int i = 0; i < 1 + round % 3 && queue.pop(item); i++) CHECK_EQ(item, expected++);
+  }
+  int item;
+  while (queue.pop(item)) CHECK_EQ(item, expected++);
+  CHECK_EQ(expected, next);
+  CHECK(!queue.pop(item));
+  CHECK_EQ(queue.space(), 3);
+}
+
+// A producer and a consumer thread: everything arrives once and in order
+static void testQueueThreads() {
+  static SpscQueue<uint32_t, 16> queue;
+  const uint32_t count = 1000000;
+
+  std::thread producer([] {
+    for (uint32_t i = 0; i < count; i++) {
+      while (!queue.push(i)) std::this_thread::yield();
+    }
+  });
+
+  uint32_t expected = 0;
+  uint32_t outOfOrder = 0;
+  while (expected < count) {
+    uint32_t item;
+    if (!queue.pop(item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (item != expected) outOfOrder++;
+    expected = item + 1;
+  }
+  producer.join();
+  CHECK_EQ(outOfOrder, 0);
+}
+
+// Large enough that a publish is often cut by the scheduler, even on one
+// core, with every word the same
+struct Block {
+  uint32_t words[16384];
+};
+
+// Readers never see half of one publish and half of another
+static void testSnapshotNotTorn() {
+  static Snapshot<Block> snapshot;
+  static std::atomic<bool> stop(false);
+  static std::atomic<uint32_t> published(0);
+
+  std::thread writer([] {
+    static Block block;
+    for (uint32_t value = 1; !stop; value++) {
+      for (uint32_t &word : block.words) word = value;
+      snapshot.publish(block);
+      published = value;
+    }
+  });
+
+  static Block block;
+  uint32_t torn = 0;
+  uint32_t backwards = 0;
+  uint32_t reads = 0;
+  uint32_t last = 0;
+  unsigned long start = millis();
+  while (millis() - start < 300) {
+    snapshot.read(block);
+    reads++;
+    for (uint32_t word : block.words) {
+      if (word != block.words[0]) {
+        torn++;
+        break;
+      }
+    }
+    if (block.words[0] < last) backwards++;
+    last = block.words[0];
+  }
+  stop = true;
+  writer.join();
+  CHECK_EQ(torn, 0);
+  CHECK_EQ(backwards, 0);
+  CHECK(reads > 10);
+  CHECK(published > 10);
+}
+
+int main() {
+  RUN(testQueueFull);
+  RUN(testQueueWrap);
+  RUN(testQueueThreads);
+  RUN(testSnapshotNotTorn);
+  return testResult();
+}
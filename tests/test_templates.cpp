@@ -0,0 +1,126 @@
+// Streaming %PLACEHOLDER% templates (templates.h)
+
+#include "../ESP32_Web_Server/templates.h"
+#include "../ESP32_Web_Server/html_pages.h"
+#include <host.h>
+#include "test.h"
+
+static AsyncWebServer server(80);
+
+struct Values {
+  const char *name;
+  const char *html;
+};
+
+static const char *lookupValue(const Values &values, const char *name, size_t length) {
+  if (templateNameIs(name, length, "NAME")) return values.name;
+  if (templateNameIs(name, length, "HTML")) return values.html;
+  return nullptr;
+}
+
+static const char PAGE_TEXT[] PROGMEM = "<p>%NAME%</p><div>%!HTML%</div><i>%MISSING%</i>";
+
+// Render through buffers of one size, as the response would pull it
+static std::string render(PageTemplate &page, const Values &values, size_t bufferSize) {
+  parseTemplate(page);
+  TemplateSource<Values> source;
+  source.page = &page;
+  source.values = lookupValue;
+  source.context = values;
+
+  std::string out;
+  uint8_t buffer[256];
+  for (size_t length; (length = source.read(buffer, bufferSize)) > 0;) out.append((const char *)buffer, length);
+  return out;
+}
+
+static void testSegments() {
+  PageTemplate page = { PAGE_TEXT };
+  parseTemplate(page);
+  CHECK_EQ(page.segmentCount, 7);
+  CHECK(page.segments[1].placeholder && !page.segments[1].raw);
+  CHECK_EQ(page.segments[1].length, 4);
+  CHECK(page.segments[3].placeholder && page.segments[3].raw);
+}
+
+// Values are escaped unless the name starts with '!', unknown names are empty
+static void testRender() {
+  PageTemplate page = { PAGE_TEXT };
+  Values values = { "Tom & \"Jerry\" <3", "<b>bold</b>" };
+  CHECK_STR(render(page, values, 256), "<p>Tom &amp; &quot;Jerry&quot; &lt;3</p><div><b>bold</b></div><i></i>");
+}
+
+// Any buffer size gives the same page, entities split across buffers included
+static void testBufferBoundaries() {
+  PageTemplate page = { PAGE_TEXT };
+  Values values = { "a&b<c>'d'", "raw" };
+  std::string whole = render(page, values, 256);
+  CHECK_STR(whole, "<p>a&amp;b&lt;c&gt;&#39;d&#39;</p><div>raw</div><i></i>");
+  for (size_t size = 1; size < 16; size++) CHECK_STR(render(page, values, size), whole);
+}
+
+// A '%' that doesn't open a placeholder stays in the text
+static void testLiteralPercent() {
+  static const char text[] PROGMEM = "width: 100%; %lower% %NAME %% 50%NAME%";
+  PageTemplate page = { text };
+  Values values = { "x", nullptr };
+  CHECK_STR(render(page, values, 256), "width: 100%; %lower% %NAME %% 50x");
+}
+
+// Segments past the limit are not written out of bounds, the page is cut
+// where they start and ends in the marker
+static void testSegmentLimit() {
+  std::string text;
+  for (int i = 0; i < TEMPLATE_MAX_SEGMENTS / 2; i++) text += "-%NAME%";
+  PageTemplate page = { text.c_str() };
+  parseTemplate(page);
+  CHECK_EQ(page.segmentCount, TEMPLATE_MAX_SEGMENTS);
+  CHECK(!page.cut);
+
+  text += "+%NAME%";
+  page = { text.c_str() };
+  parseTemplate(page);
+  CHECK_EQ(page.segmentCount, TEMPLATE_MAX_SEGMENTS);
+  CHECK(page.cut);
+  Values values = { "x", nullptr };
+  std::string whole = render(page, values, 256);
+  std::string expected;
+  for (int i = 0; i < TEMPLATE_MAX_SEGMENTS / 2; i++) expected += "-x";
+  CHECK_STR(whole, expected + TEMPLATE_CUT_MARKER);
+  for (size_t size = 1; size < 16; size++) CHECK_STR(render(page, values, size), whole);
+}
+
+// Every template the server renders fits in TEMPLATE_MAX_SEGMENTS
+static void testKnownTemplates() {
+  for (const char *text : { RESULT_TEMPLATE }) {
+    PageTemplate page = { text };
+    parseTemplate(page);
+    CHECK(!page.cut);
+  }
+}
+
+// Through the server: a chunked response with the code the handler gave
+static void testSendTemplate() {
+  static PageTemplate page = { PAGE_TEXT };
+  server.on("/page", HTTP_GET, [](AsyncWebServerRequest *request) {
+    Values values = { "esp32", "<hr>" };
+    sendTemplate(request, 201, page, lookupValue, values);
+  });
+
+  HostResponse response = hostRequest(server, "GET", "/page");
+  CHECK_EQ(response.status, 201);
+  CHECK(response.complete);
+  CHECK_STR(response.header("Content-Type"), "text/html");
+  CHECK_STR(response.body, "<p>esp32</p><div><hr></div><i></i>");
+}
+
+int main() {
+  RUN(testSegments);
+  RUN(testRender);
+  RUN(testBufferBoundaries);
+  RUN(testLiteralPercent);
+  RUN(testSegmentLimit);
+  RUN(testKnownTemplates);
+  RUN(testSendTemplate);
+  return testResult();
+}
@@ -0,0 +1,194 @@
+// WebSocket control channel: commands, keepalive pings and the client cap (websocket.h)
+
+#include "../ESP32_Web_Server/auth.h"
+#include "../ESP32_Web_Server/websocket.h"
+#include <host.h>
+#include "test.h"
+
+Preferences preferences;
+AsyncWebServer server(80);
+
+static std::string sessionCookie;
+
+struct Frame {
+  uint8_t opcode;
+  std::string payload;
+};
+
+static std::string upgradeRequest(const std::string &cookie) {
+  std::string raw = "GET /ws HTTP/1.1\r\nHost: esp32\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                    "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n";
+  if (!cookie.empty()) raw += "Cookie: " SESSION_COOKIE "=" + cookie + "\r\n";
+  return raw + "\r\n";
+}
+
+// A frame as a browser sends it, masked
+static std::string clientFrame(uint8_t opcode, const std::string &payload) {
+  static const uint8_t mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+  std::string frame;
+  frame += (char)(0x80 | opcode);
+  frame += (char)(0x80 | payload.size());
+  frame.append((const char *)mask, 4);
+  for (size_t i = 0; i < payload.size(); i++) frame += (char)(payload[i] ^ mask[i % 4]);
+  return frame;
+}
+
+// The frames in what the server sent, after the upgrade response if it is there
+static std::vector<Frame> serverFrames(std::string bytes) {
+  size_t head = bytes.find("\r\n\r\n");
+  if (bytes.compare(0, 5, "HTTP/") == 0 && head != std::string::npos) bytes.erase(0, head + 4);
+  std::vector<Frame> frames;
+  size_t at = 0;
+  while (at + 2 <= bytes.size()) {
+    size_t length = (uint8_t)bytes[at + 1] & 0x7F;  // The server's frames here are all short
+    frames.push_back({ (uint8_t)(bytes[at] & 0x0F), bytes.substr(at + 2, length) });
+    at += 2 + length;
+  }
+  return frames;
+}
+
+static HostRequest *connect(const std::string &cookie = sessionCookie) {
+  hostAdvanceMs(100);  // Stay clear of the rate limit
+  HostRequest *client = new HostRequest(server, upgradeRequest(cookie));
+  client->poll();
+  return client;
+}
+
+// The loop() side, then the connection
+static std::vector<Frame> run(HostRequest &client) {
+  updateWebSocket();
+  client.poll();
+  return serverFrames(client.read());
+}
+
+static void testNeedsSession() {
+  HostRequest *client = connect("");
+  CHECK(client->output.compare(0, 12, "HTTP/1.1 101") != 0);
+  CHECK_EQ(ws.count(), 0);
+  delete client;
+
+  client = connect("00ffffffffffffffff");
+  CHECK(client->output.compare(0, 12, "HTTP/1.1 101") != 0);
+  CHECK_EQ(ws.count(), 0);
+  delete client;
+}
+
+// A new client gets the state, then a broadcast after each change it causes
+static void testCommands() {
+  HostRequest *client = connect();
+  CHECK_CONTAINS(client->output.c_str(), "HTTP/1.1 101");
+  std::vector<Frame> frames = serverFrames(client->read());
+  CHECK_EQ(frames.size(), 1);
+  CHECK_STR(frames[0].payload, "s:0,0,255,255");
+  CHECK_EQ(ws.count(), 1);
+
+  client->write(clientFrame(WS_TEXT, "t1"));
+  client->poll();
+  processLEDCommands();
+  publishLEDSnapshot();
+  frames = run(*client);
+  CHECK_EQ(frames.size(), 1);
+  CHECK_STR(frames[0].payload, "s:1,0,255,255");
+
+  client->write(clientFrame(WS_TEXT, "i1:999"));
+  client->poll();
+  frames = serverFrames(client->read());
+  CHECK_EQ(frames.size(), 1);
+  CHECK_STR(frames[0].payload, "e:invalid command");
+
+  delete client;
+  CHECK_EQ(ws.count(), 0);
+}
+
+// An idle connection is pinged, and kept for as long as the pongs come back
+static void testKeepAlive() {
+  HostRequest *client = connect();
+  client->read();
+  unsigned long idleClosed = wsStats.idleClosed;
+  unsigned long lastPong = millis();
+
+  hostAdvanceMs(WS_PING_INTERVAL_MS - 1000);
+  CHECK(run(*client).empty());
+  for (int i = 0; i < 6; i++) {
+    hostAdvanceMs(1000);
+    std::vector<Frame> frames = run(*client);
+    CHECK_EQ(frames.size(), 1);
+    CHECK_EQ(frames[0].opcode, WS_PING);
+    client->write(clientFrame(WS_PONG, frames[0].payload));
+    client->poll();
+    lastPong = millis();
+    hostAdvanceMs(WS_PING_INTERVAL_MS - 1000);
+    CHECK(run(*client).empty());
+  }
+  CHECK_EQ(ws.count(), 1);  // Well past WS_IDLE_TIMEOUT_MS without a frame
+  CHECK_EQ(wsStats.idleClosed, idleClosed);
+
+  // A peer that stopped answering is closed, once, after the timeout
+  int pings = 0;
+  while (millis() - lastPong < WS_IDLE_TIMEOUT_MS) {
+    CHECK_EQ(ws.count(), 1);
+    hostAdvanceMs(1000);
+    for (const Frame &frame : run(*client)) pings += frame.opcode == WS_PING;
+  }
+  CHECK_EQ(pings, WS_IDLE_TIMEOUT_MS / WS_PING_INTERVAL_MS - 1);
+  CHECK_EQ(wsStats.idleClosed - idleClosed, 1);
+  CHECK_EQ(ws.count(), 0);
+  delete client;
+}
+
+// A logout closes the connection at its next frame
+static void testSessionClosed() {
+  char token[SESSION_TOKEN_LENGTH + 1];
+  Session *session = createSession(ROLE_VIEWER, token);
+  HostRequest *client = connect(token);
+  client->read();
+  unsigned long sessionClosed = wsStats.sessionClosed;
+
+  removeSession(session);
+  client->write(clientFrame(WS_TEXT, "t1"));
+  client->poll();
+  std::vector<Frame> frames = serverFrames(client->read());
+  CHECK(!frames.empty());
+  CHECK_STR(frames[0].payload, "e:session expired");
+  CHECK_EQ(wsStats.sessionClosed - sessionClosed, 1);
+  CHECK_EQ(ws.count(), 0);
+  delete client;
+}
+
+// Each connection holds lwIP buffers, so the count is capped
+static void testClientCap() {
+  std::vector<HostRequest *> clients;
+  for (int i = 0; i < WS_MAX_CLIENTS; i++) clients.push_back(connect());
+  CHECK_EQ(ws.count(), WS_MAX_CLIENTS);
+
+  unsigned long rejected = wsStats.rejected;
+  HostRequest *refused = connect();
+  CHECK(refused->output.compare(0, 12, "HTTP/1.1 101") != 0);
+  CHECK_EQ(wsStats.rejected - rejected, 1);
+  CHECK_EQ(ws.count(), WS_MAX_CLIENTS);
+  delete refused;
+
+  delete clients[0];
+  clients[0] = connect();
+  CHECK_CONTAINS(clients[0]->output.c_str(), "HTTP/1.1 101");
+  for (HostRequest *client : clients) delete client;
+  CHECK_EQ(ws.count(), 0);
+}
+
+int main() {
+  hostUseManualClock();
+  setupLEDs();
+  setupLEDControl();
+  setupWebSocketRoutes();
+
+  char token[SESSION_TOKEN_LENGTH + 1];
+  createSession(ROLE_VIEWER, token);
+  sessionCookie = token;
+
+  RUN(testNeedsSession);
+  RUN(testCommands);
+  RUN(testKeepAlive);
+  RUN(testSessionClosed);
+  RUN(testClientCap);
+  return testResult();
+}
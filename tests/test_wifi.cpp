@@ -0,0 +1,194 @@
+// STA connection manager and its channel and BSSID cache (wifi_manager.h,
+// wifi_control.h)
+
+#include "../ESP32_Web_Server/wifi_control.h"
+#include <host.h>
+#include "test.h"
+
+Preferences preferences;
+
+static const HostWiFiNetwork HOME = { "home", "homepass", -55, 6, { 0x24, 0x0a, 0xc4, 0x01, 0x02, 0x03 } };
+static const HostWiFiNetwork HOME_MOVED = { "home", "homepass", -60, 11, { 0x24, 0x0a, 0xc4, 0x09, 0x08, 0x07 } };
+static const HostWiFiNetwork OFFICE = { "office", "officepass", -70, 1, { 0x3c, 0x71, 0xbf, 0x01, 0x02, 0x03 } };
+
+#define SCANNING_JOIN_MS 2500
+#define KNOWN_CHANNEL_JOIN_MS 400
+
+// A reset: the STA link is gone, NVS keeps what was committed, the Wi-Fi
+// task starts connecting to the saved network
+static void boot(const char *ssid = "home", const char *password = "homepass") {
+  WiFi.disconnect();
+  strcpy(config.ssid, ssid);
+  strcpy(config.wifiPassword, password);
+  configSnapshot.publish(config);
+
+  wifiState = WIFI_STATE_IDLE;
+  wifiJobState = WIFI_JOB_NONE;
+  wifiCache = {};
+  wifiCacheStale = false;
+  wifiConnectStats = {};
+  WiFiCache pending;
+  while (wifiCacheUpdates.pop(pending)) {}
+
+  loadWiFiCache();
+  startWiFiConnection();
+}
+
+// The Wi-Fi and persistence tasks for a while
+static void run(uint32_t ms) {
+  for (uint32_t elapsed = 0; elapsed < ms; elapsed += 10) {
+    processWiFiCommands();
+    updateWiFiConnection();
+    commitWiFiCache();
+    hostAdvanceMs(10);
+  }
+}
+
+static void networks(std::initializer_list<HostWiFiNetwork> inRange) {
+  hostRemoveWiFiNetworks();
+  for (const HostWiFiNetwork &network : inRange) hostAddWiFiNetwork(network);
+}
+
+static WiFiCache storedCache() {
+  WiFiCache stored = {};
+  preferences.begin(CONFIG_NAMESPACE, true);
+  preferences.getBytes(WIFI_CACHE_KEY, &stored, sizeof(stored));
+  preferences.end();
+  return stored;
+}
+
+// With nothing cached the driver scans, and the network found is cached
+static void testFirstJoin() {
+  hostClearPreferences();
+  networks({ HOME, OFFICE });
+  boot();
+  CHECK_EQ(hostWiFiStats().lastChannel, 0);
+  CHECK(!hostWiFiStats().lastBssid);
+
+  run(SCANNING_JOIN_MS + 100);
+  CHECK_EQ(wifiState, WIFI_STATE_CONNECTED);
+  CHECK_EQ(wifiConnectStats.connects, 1);
+  CHECK_EQ(wifiConnectStats.fastConnects, 0);
+  CHECK(wifiConnectStats.lastConnectMs >= SCANNING_JOIN_MS);
+
+  WiFiCache stored = storedCache();
+  CHECK_STR(stored.ssid, "home");
+  CHECK_EQ(stored.channel, 6);
+  CHECK(memcmp(stored.bssid, HOME.bssid, 6) == 0);
+}
+
+// The next boot goes straight to the cached channel and BSSID
+static void testCachedJoin() {
+  boot();
+  CHECK_EQ(wifiCache.channel, 6);
+  CHECK_EQ(hostWiFiStats().lastChannel, 6);
+  CHECK(hostWiFiStats().lastBssid);
+
+  run(KNOWN_CHANNEL_JOIN_MS + 100);
+  CHECK_EQ(wifiState, WIFI_STATE_CONNECTED);
+  CHECK_EQ(wifiConnectStats.fastConnects, 1);
+  CHECK(wifiConnectStats.lastConnectMs < SCANNING_JOIN_MS);
+  CHECK_EQ(wifiCacheUpdates.space(), 1);  // Nothing moved, nothing to write
+
+  // A dropped link reconnects the fast way too
+  hostDropWiFi();
+  run(WIFI_RETRY_MIN_MS + KNOWN_CHANNEL_JOIN_MS + 100);
+  CHECK_EQ(wifiState, WIFI_STATE_CONNECTED);
+  CHECK_EQ(wifiConnectStats.fastConnects, 2);
+}
+
+// An access point that moved costs WIFI_FAST_CONNECT_TIMEOUT_MS, then the
+// same attempt scans and the cache follows it
+static void testMovedAccessPoint() {
+  networks({ HOME_MOVED });
+  boot();
+  unsigned long begins = hostWiFiStats().begins;
+  run(WIFI_FAST_CONNECT_TIMEOUT_MS + 100);
+  CHECK_EQ(wifiConnectStats.fastConnectFailures, 1);
+  CHECK_EQ(hostWiFiStats().begins - begins, 1);
+  CHECK_EQ(hostWiFiStats().lastChannel, 0);
+
+  run(SCANNING_JOIN_MS);
+  CHECK_EQ(wifiState, WIFI_STATE_CONNECTED);
+  CHECK_EQ(wifiConnectStats.fastConnects, 0);
+  CHECK(wifiConnectStats.lastConnectMs >= WIFI_FAST_CONNECT_TIMEOUT_MS + SCANNING_JOIN_MS);
+  CHECK(wifiConnectStats.lastConnectMs < WIFI_CONNECT_TIMEOUT_MS);
+  CHECK_EQ(storedCache().channel, 11);
+
+  boot();
+  run(KNOWN_CHANNEL_JOIN_MS + 100);
+  CHECK_EQ(wifiConnectStats.fastConnects, 1);
+}
+
+// The cache only applies to the network it was made on, and only if intact
+static void testCacheChecks() {
+  networks({ HOME_MOVED, OFFICE });
+  boot("office", "officepass");
+  CHECK_EQ(hostWiFiStats().lastChannel, 0);
+  run(SCANNING_JOIN_MS + 100);
+  CHECK_EQ(wifiState, WIFI_STATE_CONNECTED);
+  CHECK_STR(storedCache().ssid, "office");
+
+  WiFiCache damaged = storedCache();
+  damaged.channel = 3;
+  preferences.begin(CONFIG_NAMESPACE, false);
+  preferences.putBytes(WIFI_CACHE_KEY, &damaged, sizeof(damaged));
+  preferences.end();
+  boot("office", "officepass");
+  CHECK_EQ(wifiCache.channel, 0);
+  CHECK_EQ(hostWiFiStats().lastChannel, 0);
+}
+
+// New credentials from the settings page are kept once they work
+static void testJob() {
+  networks({ HOME, OFFICE });
+  boot("office", "officepass");
+  run(SCANNING_JOIN_MS + 100);
+  uint32_t job = startWiFiJob("home", "homepass");
+  CHECK(job != 0);
+  run(SCANNING_JOIN_MS + 100);
+  CHECK_EQ(wifiJobState, WIFI_JOB_DONE);
+  ConfigUpdate update;
+  CHECK(wifiConfigUpdates.pop(update));
+  CHECK_EQ(update.field, CONFIG_SSID);
+  CHECK_STR(update.value, "home");
+  CHECK_STR(storedCache().ssid, "home");
+
+  // Wrong ones go back to the previous network
+  while (wifiConfigUpdates.pop(update)) {}
+  job = startWiFiJob("office", "wrong");
+  run(WIFI_CONNECT_TIMEOUT_MS + 100);
+  CHECK_EQ(wifiJobState, WIFI_JOB_FAILED);
+  CHECK(!wifiConfigUpdates.pop(update));
+}
+
+// The access point stays on the STA channel when it is restarted
+static void testAccessPointChannel() {
+  networks({ HOME });
+  boot();
+  run(SCANNING_JOIN_MS + 100);
+  CHECK_EQ(wifiCache.channel, 6);
+  CHECK(startAccessPoint("ESP32_002", "longenough"));
+  run(10);
+  CHECK_EQ(hostWiFiStats().apChannel, 6);
+  CHECK_STR(hostWiFiStats().apSSID.c_str(), "ESP32_002");
+
+  hostClearPreferences();
+  boot();
+  CHECK(startAccessPoint("ESP32_003", "longenough"));
+  processWiFiCommands();
+  CHECK_EQ(hostWiFiStats().apChannel, 1);
+}
+
+int main() {
+  hostUseManualClock();
+  hostSetWiFiJoinMs(SCANNING_JOIN_MS, KNOWN_CHANNEL_JOIN_MS);
+
+  RUN(testFirstJoin);
+  RUN(testCachedJoin);
+  RUN(testMovedAccessPoint);
+  RUN(testCacheChecks);
+  RUN(testJob);
+  RUN(testAccessPointChannel);
+  return testResult();
+}
@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""Precompress the pages in html_pages.h into html_pages_gz.h.
+
+The Arduino IDE has no pre-build hook, so the generated header is kept in
+the repository. Run this script again after editing html_pages.h:
+
+    python3 tools/gzip_pages.py
+"""
+
+import gzip
+import hashlib
+import os
+import re
+
+SKETCH_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "ESP32_Web_Server")
+SOURCE = os.path.join(SKETCH_DIR, "html_pages.h")
+OUTPUT = os.path.join(SKETCH_DIR, "html_pages_gz.h")
+
+# Only the static *_HTML pages, *_TEMPLATE pages are rendered at runtime
+PAGE_PATTERN = re.compile(r'const char (\w+_HTML)\[\] PROGMEM = R"rawliteral\((.*?)\)rawliteral";', re.S)
+
+
+def format_bytes(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("  " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    with open(SOURCE, encoding="utf-8") as f:
+        pages = PAGE_PATTERN.findall(f.read())
+
+    out = [
+        "#ifndef HTML_PAGES_GZ_H",
+        "#define HTML_PAGES_GZ_H",
+        "",
+        "// Generated by tools/gzip_pages.py from html_pages.h, do not edit by hand",
+        "",
+    ]
+    for name, html in pages:
+        raw = html.encode("utf-8")
+        # mtime=0 keeps the output reproducible, so the ETag only changes with the page
+        compressed = gzip.compress(raw, compresslevel=9, mtime=0)
+        etag = hashlib.sha1(raw).hexdigest()[:16]
+
+        out.append("// %s: %d bytes, %d bytes gzipped" % (name, len(raw), len(compressed)))
+        out.append('const char %s_ETAG[] = "\\"%s\\"";' % (name, etag))
+        out.append('const char %s_GZ_ETAG[] = "\\"%s-gz\\"";' % (name, etag))
+        out.append("const uint8_t %s_GZ[] PROGMEM = {" % name)
+        out.append(format_bytes(compressed))
+        out.append("};")
+        out.append("")
+        print("%-14s %6d -> %5d bytes" % (name, len(raw), len(compressed)))
+
+    out.append("#endif  // HTML_PAGES_GZ_H")
+    with open(OUTPUT, "w", encoding="utf-8") as f:
+        f.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
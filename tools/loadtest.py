@@ -0,0 +1,463 @@
+#!/usr/bin/env python3
+r"""Load-test the web server routes and write the results as JSON.
+
+Each client logs in once, then runs a scenario in a loop for the given
+duration. Between scenarios the device heap is read from /heap. Point
+--base-url at a board or at any local stand-in serving the same routes:
+
+    python3 tools/loadtest.py --base-url http://192.168.4.1 --clients 4 \
+        --duration 30 --output results.json
+
+Scenarios:
+    dashboard  page load, then /sensor_data and /led-state polling
+    slider     bursts of /set_led_intensity like a dragged slider
+    toggle     /toggle followed by /led-state
+    settings   /settings and /settings_data (needs an admin, i.e. AP, client)
+    ws_toggle  the toggle scenario over one /ws connection per client
+    ws_slider  the slider scenario over one /ws connection per client
+    poll       an open dashboard without /events: /sensor_data once a second
+    push       an open dashboard on /events, reading the pushed events
+
+poll and push compare the two ways a dashboard keeps up to date. Their
+clients pace themselves like a browser instead of sending flat out, so
+throughput_rps is the load N open dashboards put on the device. push also
+reports the events its clients received.
+
+Each scenario reports the TCP connections its clients opened. The HTTP
+scenarios open one per request, as the server closes each connection
+after the response; the ws_ ones open one per client. Compare toggle with
+ws_toggle and slider with ws_slider for the cost of the connection setup.
+A /ws command's latency is the time until the next state broadcast.
+
+Every scenario samples /heap halfway through as heap_during, from a
+separate client, so it includes what the open connections hold.
+
+The device rate-limits and admits by client IP. Against the host
+emulator (esp32_web_server --ap-clients) --local-addresses gives each
+client its own 127.0.0.x source address, so they are told apart as on
+a real network, and --raise-limits lifts the rate limit for scenarios
+that send flat out (it needs an admin, which --ap-clients makes every
+local client):
+
+    python3 tools/loadtest.py --base-url http://127.0.0.1:8080 --local-addresses \
+        --raise-limits --scenario toggle --scenario ws_toggle
+
+With --soak N the scenarios run N rounds and the heap is sampled after
+each one, with fragmentation as 1 - largest block / free. A fragmentation
+that keeps climbing across rounds means requests are leaving holes:
+
+    python3 tools/loadtest.py --soak 100 --duration 60 --output soak.json
+"""
+
+import argparse
+import base64
+import os
+import socket
+import struct
+import http.client
+import json
+import statistics
+import threading
+import time
+import urllib.parse
+
+
+def percentile(samples, fraction):
+    if not samples:
+        return None
+    ordered = sorted(samples)
+    index = min(len(ordered) - 1, int(round(fraction * (len(ordered) - 1))))
+    return ordered[index]
+
+
+class Client:
+    """One simulated browser: a session cookie and a connection per request."""
+
+    def __init__(self, base_url, timeout, source=None):
+        url = urllib.parse.urlsplit(base_url)
+        self.host = url.hostname
+        self.port = url.port or 80
+        self.timeout = timeout
+        self.source = (source, 0) if source else None  # Local address to connect from
+        self.cookie = None
+        self.connections = 0  # TCP connections opened
+        self.ws = None
+        self.stream = None
+
+    def request(self, method, path, body=None):
+        headers = {"Accept-Encoding": "gzip"}
+        if self.cookie:
+            headers["Cookie"] = self.cookie
+        if body is not None:
+            headers["Content-Type"] = "application/x-www-form-urlencoded"
+
+        # The server closes connections after each response, like a browser
+        # hitting it over a fresh socket
+        connection = http.client.HTTPConnection(self.host, self.port, timeout=self.timeout,
+                                                source_address=self.source)
+        self.connections += 1
+        start = time.perf_counter()
+        try:
+            connection.request(method, path, body=body, headers=headers)
+            response = connection.getresponse()
+            data = response.read()
+            elapsed = time.perf_counter() - start
+            cookie = response.getheader("Set-Cookie")
+            if cookie and cookie.startswith("session=") and "Max-Age=0" not in cookie:
+                self.cookie = cookie.split(";", 1)[0]
+            return response.status, data, elapsed
+        finally:
+            connection.close()
+
+    def login(self, username, password):
+        body = urllib.parse.urlencode({"username": username, "password": password})
+        status, _, _ = self.request("POST", "/login", body)
+        if self.cookie is None:
+            raise RuntimeError("login failed (status %d)" % status)
+
+
+    def websocket(self):
+        """The client's /ws connection, opened on first use."""
+        if self.ws is None:
+            self.ws = WebSocket(self.host, self.port, self.cookie, self.timeout, self.source)
+            self.connections += 1
+        return self.ws
+
+    def events(self):
+        """The client's /events stream, opened on first use."""
+        if self.stream is None:
+            self.stream = EventStream(self.host, self.port, self.cookie, self.timeout, self.source)
+            self.connections += 1
+        return self.stream
+
+    def close(self):
+        if self.ws is not None:
+            self.ws.close()
+            self.ws = None
+        if self.stream is not None:
+            self.stream.close()
+            self.stream = None
+
+
+class WebSocket:
+    """Just enough of RFC 6455 for the /ws text protocol."""
+
+    def __init__(self, host, port, cookie, timeout, source=None):
+        self.sock = socket.create_connection((host, port), timeout=timeout, source_address=source)
+        key = base64.b64encode(os.urandom(16)).decode()
+        request = ("GET /ws HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                   "Sec-WebSocket-Key: %s\r\nSec-WebSocket-Version: 13\r\nCookie: %s\r\n\r\n") % (host, key, cookie)
+        self.sock.sendall(request.encode())
+        head = b""
+        while b"\r\n\r\n" not in head:
+            chunk = self.sock.recv(1024)
+            if not chunk:
+                raise OSError("connection closed during the upgrade")
+            head += chunk
+        if not head.startswith(b"HTTP/1.1 101"):
+            raise OSError("upgrade refused: %s" % head.split(b"\r\n", 1)[0].decode(errors="replace"))
+        self.buffer = head.split(b"\r\n\r\n", 1)[1]
+
+    def send(self, text):
+        payload = text.encode()
+        mask = os.urandom(4)
+        masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+        self.sock.sendall(struct.pack("!BB", 0x81, 0x80 | len(payload)) + mask + masked)
+
+    def _read(self, count):
+        while len(self.buffer) < count:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise OSError("connection closed")
+            self.buffer += chunk
+        data, self.buffer = self.buffer[:count], self.buffer[count:]
+        return data
+
+    def receive(self):
+        """Next text message, answering pings on the way."""
+        while True:
+            first, second = self._read(2)
+            length = second & 0x7F
+            if length == 126:
+                length = struct.unpack("!H", self._read(2))[0]
+            elif length == 127:
+                length = struct.unpack("!Q", self._read(8))[0]
+            payload = self._read(length)
+            opcode = first & 0x0F
+            if opcode == 0x9:
+                mask = os.urandom(4)
+                masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+                self.sock.sendall(struct.pack("!BB", 0x8A, 0x80 | len(payload)) + mask + masked)
+            elif opcode == 0x8:
+                raise OSError("closed by the server")
+            elif opcode == 0x1:
+                return payload.decode()
+
+    def command(self, text):
+        """Send a command and wait for the state broadcast that follows it."""
+        start = time.perf_counter()
+        self.send(text)
+        while True:
+            message = self.receive()
+            if message.startswith("s:"):
+                return 101, message, time.perf_counter() - start
+            if message.startswith("e:"):
+                return 400, message, time.perf_counter() - start
+
+    def close(self):
+        self.sock.close()
+
+
+class EventStream:
+    """An open /events stream, read one event at a time."""
+
+    def __init__(self, host, port, cookie, timeout, source=None):
+        self.sock = socket.create_connection((host, port), timeout=timeout, source_address=source)
+        request = ("GET /events HTTP/1.1\r\nHost: %s\r\nAccept: text/event-stream\r\nCookie: %s\r\n\r\n"
+                   % (host, cookie))
+        self.sock.sendall(request.encode())
+        self.buffer = b""
+        head = self._until(b"\n\n")
+        if not head.startswith(b"HTTP/1.1 200"):
+            raise OSError("stream refused: %s" % head.split(b"\n", 1)[0].decode(errors="replace"))
+
+    def _until(self, separator):
+        # Lines may end in CRLF or LF, the buffer keeps them as LF
+        while separator not in self.buffer:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise OSError("connection closed")
+            self.buffer = (self.buffer + chunk).replace(b"\r\n", b"\n")
+        data, self.buffer = self.buffer.split(separator, 1)
+        return data
+
+    def receive(self, timeout):
+        """Name of the next event, None if none came within timeout seconds."""
+        self.sock.settimeout(timeout)
+        try:
+            event = self._until(b"\n\n").decode(errors="replace")
+        except socket.timeout:
+            return None
+        for line in event.split("\n"):
+            if line.startswith("event:"):
+                return line[6:].strip()
+        return "message"
+
+    def close(self):
+        self.sock.close()
+
+
+def scenario_dashboard(client, record):
+    record("/", *client.request("GET", "/"))
+    for _ in range(5):
+        record("/sensor_data", *client.request("GET", "/sensor_data"))
+    record("/led-state", *client.request("GET", "/led-state"))
+
+
+def scenario_slider(client, record):
+    for intensity in range(0, 256, 16):
+        path = "/set_led_intensity?led=1&intensity=%d" % intensity
+        record("/set_led_intensity", *client.request("GET", path))
+
+
+def scenario_toggle(client, record):
+    record("/toggle", *client.request("GET", "/toggle?led=2"))
+    record("/led-state", *client.request("GET", "/led-state"))
+
+
+def scenario_ws_toggle(client, record):
+    record("/ws t", *client.websocket().command("t2"))
+
+
+def scenario_ws_slider(client, record):
+    ws = client.websocket()
+    for intensity in range(0, 256, 16):
+        # Only a change is broadcast, so step away from the last value first
+        record("/ws i", *ws.command("i1:%d" % (intensity + 1)))
+
+
+def scenario_poll(client, record):
+    # What the page did before /events: one /sensor_data a second
+    started = time.perf_counter()
+    record("/sensor_data", *client.request("GET", "/sensor_data"))
+    time.sleep(max(0, 1 - (time.perf_counter() - started)))
+
+
+def scenario_push(client, record):
+    # The stream sends the current state on connect, then only changes
+    started = time.perf_counter()
+    name = client.events().receive(1)
+    if name is not None:
+        record("/events " + name, 200, None, time.perf_counter() - started)
+
+
+def scenario_settings(client, record):
+    record("/settings", *client.request("GET", "/settings"))
+    record("/settings_data", *client.request("GET", "/settings_data"))
+
+
+SCENARIOS = {
+    "dashboard": scenario_dashboard,
+    "slider": scenario_slider,
+    "toggle": scenario_toggle,
+    "settings": scenario_settings,
+    "ws_toggle": scenario_ws_toggle,
+    "ws_slider": scenario_ws_slider,
+    "poll": scenario_poll,
+    "push": scenario_push,
+}
+
+# Scenarios whose records are events received rather than requests made
+EVENT_SCENARIOS = {"push"}
+
+
+def read_heap(client):
+    try:
+        status, data, _ = client.request("GET", "/heap")
+        heap = json.loads(data) if status == 200 else None
+    except (OSError, ValueError):
+        return None
+    if heap and heap.get("free"):
+        heap["fragmentation"] = round(1 - heap["maxAlloc"] / heap["free"], 3)
+    return heap
+
+
+def local_address(index, args):
+    """Source address of client index, 127.0.0.2 onwards with --local-addresses."""
+    return "127.0.0.%d" % (2 + index) if args.local_addresses else None
+
+
+def run_scenario(name, args):
+    clients = [Client(args.base_url, args.timeout, local_address(i, args)) for i in range(args.clients)]
+    for client in clients:
+        client.login(args.username, args.password)
+    monitor = Client(args.base_url, args.timeout, local_address(args.clients, args))
+    monitor.login(args.username, args.password)
+
+    lock = threading.Lock()
+    latencies = {}
+    statuses = {}
+    errors = [0]
+
+    def record(route, status, _data, elapsed):
+        with lock:
+            latencies.setdefault(route, []).append(elapsed * 1000)
+            key = "%s %d" % (route, status)
+            statuses[key] = statuses.get(key, 0) + 1
+
+    deadline = time.monotonic() + args.duration
+
+    def worker(client):
+        while time.monotonic() < deadline:
+            try:
+                SCENARIOS[name](client, record)
+            except OSError:
+                client.close()  # A broken /ws connection is reopened by the next pass
+                with lock:
+                    errors[0] += 1
+
+    heap_before = read_heap(monitor)
+    connections_before = sum(client.connections for client in clients)
+    started = time.monotonic()
+    threads = [threading.Thread(target=worker, args=(client,)) for client in clients]
+    for thread in threads:
+        thread.start()
+    time.sleep(args.duration / 2)
+    heap_during = read_heap(monitor)
+    for thread in threads:
+        thread.join()
+    elapsed = time.monotonic() - started
+    for client in clients:
+        client.close()
+    connections = sum(client.connections for client in clients) - connections_before
+    heap_after = read_heap(monitor)
+
+    routes = {}
+    total = 0
+    for route, samples in sorted(latencies.items()):
+        total += len(samples)
+        routes[route] = {
+            "requests": len(samples),
+            "p50_ms": round(percentile(samples, 0.50), 2),
+            "p99_ms": round(percentile(samples, 0.99), 2),
+            "mean_ms": round(statistics.mean(samples), 2),
+            "max_ms": round(max(samples), 2),
+        }
+
+    events = name in EVENT_SCENARIOS
+    return {
+        "clients": args.clients,
+        "duration_s": round(elapsed, 2),
+        "requests": 0 if events else total,
+        "events": total if events else 0,
+        "throughput_rps": 0 if events else round(total / elapsed, 2) if elapsed else 0,
+        "errors": errors[0],
+        "connections": connections,
+        "connections_per_request": round(connections / total, 3) if total else None,
+        "statuses": statuses,
+        "routes": routes,
+        "heap_before": heap_before,
+        "heap_during": heap_during,
+        "heap_after": heap_after,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--base-url", default="http://192.168.4.1")
+    parser.add_argument("--username", default="admin")
+    parser.add_argument("--password", default="password")
+    parser.add_argument("--clients", type=int, default=4)
+    parser.add_argument("--duration", type=float, default=20, help="seconds per scenario")
+    parser.add_argument("--timeout", type=float, default=10, help="seconds per request")
+    parser.add_argument("--scenario", action="append", choices=sorted(SCENARIOS),
+                        help="scenario to run, may be repeated (default: all)")
+    parser.add_argument("--soak", type=int, metavar="ROUNDS", help="repeat the scenarios and track the heap")
+    parser.add_argument("--output", help="write the JSON results to this file")
+    parser.add_argument("--local-addresses", action="store_true",
+                        help="connect each client from its own 127.0.0.x address (host emulator)")
+    parser.add_argument("--raise-limits", action="store_true",
+                        help="lift the rate limit and in-flight cap first (needs an admin)")
+    args = parser.parse_args()
+
+    if args.raise_limits:
+        admin = Client(args.base_url, args.timeout, local_address(args.clients + 1, args))
+        admin.login(args.username, args.password)
+        status, _, _ = admin.request("POST", "/limits", "rate=100000&burst=100000&max_in_flight=64")
+        if status != 200:
+            raise SystemExit("POST /limits answered %d, --raise-limits needs an admin" % status)
+
+    results = {
+        "base_url": args.base_url,
+        "timestamp": time.strftime("%Y-%m-%dT%H:%M:%S%z"),
+        "scenarios": {},
+    }
+    names = args.scenario or sorted(SCENARIOS)
+    if args.soak:
+        results["soak"] = []
+        monitor = Client(args.base_url, args.timeout)
+        for round_number in range(args.soak):
+            requests = 0
+            for name in names:
+                result = run_scenario(name, args)
+                requests += result["requests"]
+                results["scenarios"][name] = result  # Last round
+            monitor.login(args.username, args.password)  # A soak outlives any session
+            heap = read_heap(monitor) or {}
+            results["soak"].append({"round": round_number + 1, "requests": requests, "heap": heap})
+            print("Round %d: %d requests, free %s, largest block %s, fragmentation %s" % (
+                round_number + 1, requests, heap.get("free"), heap.get("maxAlloc"), heap.get("fragmentation")))
+    else:
+        for name in names:
+            print("Running %s with %d clients for %gs..." % (name, args.clients, args.duration))
+            results["scenarios"][name] = run_scenario(name, args)
+
+    text = json.dumps(results, indent=2, sort_keys=True)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    print(text)
+
+
+if __name__ == "__main__":
+    main()